@@ -0,0 +1,6 @@
+varying vec4 lineColor;
+
+void main(void)
+{
+    gl_FragColor = lineColor;
+}
@@ -0,0 +1,45 @@
+// One instance per cubic segment, starting at the sample p0. Positions are
+// split into high and low floats relative to the origin of the plot.
+attribute vec3 in_Position;     // p0, high part
+attribute vec3 in_Normal;       // p0, low part
+attribute vec4 in_TexCoord0;    // xyz: first order coefficient, w: start time
+attribute vec4 in_TexCoord1;    // xyz: second order coefficient, w: duration
+attribute vec4 in_TexCoord2;    // xyz: third order coefficient, w: bounding radius
+attribute float in_Intensity;   // curve parameter of the vertex, 0 - 1
+
+uniform mat3 viewMat;
+uniform vec3 cameraHigh;
+uniform vec3 cameraLow;
+uniform vec4 color;
+uniform vec2 window;            // time range drawn
+uniform vec2 fade;              // opacity = fade.x * t + fade.y
+uniform float farZ;
+uniform float subdivisionThreshold;
+
+varying vec4 lineColor;
+
+void main(void)
+{
+    float t0 = in_TexCoord0.w;
+    float dt = in_TexCoord1.w;
+    float radius = in_TexCoord2.w;
+
+    vec3 p0 = viewMat * ((in_Position - cameraHigh) + (in_Normal - cameraLow));
+
+    // Segments close enough to need subdivision are drawn on the CPU
+    float s0 = clamp((window.x - t0) / dt, 0.0, 1.0);
+    float s1 = clamp((window.y - t0) / dt, 0.0, 1.0);
+    if (s0 >= s1 || radius >= subdivisionThreshold * (length(p0) - radius) || p0.z + radius < farZ)
+    {
+        // Outside of the clip volume
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        lineColor = vec4(0.0);
+        return;
+    }
+
+    float s = mix(s0, s1, in_Intensity);
+    vec3 p = p0 + viewMat * (s * (in_TexCoord0.xyz + s * (in_TexCoord1.xyz + s * in_TexCoord2.xyz)));
+    float opacity = clamp(fade.x * (t0 + s * dt) + fade.y, 0.0, 1.0);
+    lineColor = vec4(color.rgb, color.a * opacity);
+    set_vp(vec4(p, 1.0));
+}
@@ -31,5 +31,5 @@ void main(void)
     gl_PointSize = s * min(obsDistanceToStarRatio, 1.0);
 
     color = vec4(texture2D(colorTex, vec2(colorIndex, 0.0)).rgb, min(1.0, br * (1.0 - pixelWeight * relStarDensity)));
-    set_vp(vec4(p, 1.0));
+    set_vp(vec4(p + offset, 1.0));
 }
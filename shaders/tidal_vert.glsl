@@ -3,6 +3,7 @@ attribute vec3 in_TexCoord0; // reuse [3] as colorIndex
 
 uniform sampler2D colorTex;
 uniform mat3 viewMat;
+uniform vec3 offset;
 uniform float tidalSize;
 uniform float brightness;
 uniform float pixelWeight;
@@ -16,5 +17,5 @@ void main(void)
     texCoord = in_TexCoord0.st;
     float colorIndex = in_TexCoord0.p;
     color = vec4(texture2D(colorTex, vec2(colorIndex, 0.0)).rgb, min(1.0, 2.0 * brightness * pixelWeight));
-    set_vp(vec4(p, 1.0));
+    set_vp(vec4(p + offset, 1.0));
 }
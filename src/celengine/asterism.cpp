@@ -29,7 +29,7 @@ Asterism::Asterism(std::string_view _name) :
 #endif
 }
 
-std::string Asterism::getName(bool i18n) const
+const std::string& Asterism::getName(bool i18n) const
 {
 #ifdef ENABLE_NLS
     return i18n ? i18nName : name;
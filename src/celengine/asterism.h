@@ -35,7 +35,7 @@ class Asterism
 
     using Chain = std::vector<Eigen::Vector3f>;
 
-    std::string getName(bool i18n = false) const;
+    const std::string& getName(bool i18n = false) const;
     int getChainCount() const;
     const Chain& getChain(int) const;
 
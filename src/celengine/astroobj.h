@@ -9,3 +9,7 @@ namespace AstroCatalog
     using IndexNumber = std::uint32_t;
     constexpr inline IndexNumber InvalidIndex = UINT32_MAX;
 }
+
+// Bit n is set for an object in the user category with id n; categories from
+// id 64 on aren't recorded.
+using UserCategoryMask = std::uint64_t;
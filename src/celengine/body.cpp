@@ -13,6 +13,7 @@
 #include <celcompat/numbers.h>
 #include <celmath/mathlib.h>
 #include <celutil/gettext.h>
+#include <celutil/memoryusage.h>
 #include <celutil/utf8.h>
 #include "geometry.h"
 #include "meshmanager.h"
@@ -37,11 +38,13 @@ Body::Body(PlanetarySystem* _system, const string& _name) :
     setName(_name);
     recomputeCullingRadius();
     system->addBody(this);
+    celestia::util::AddMemoryUsage(celestia::util::MemoryCategory::Bodies, sizeof(Body));
 }
 
 
 Body::~Body()
 {
+    celestia::util::RemoveMemoryUsage(celestia::util::MemoryCategory::Bodies, sizeof(Body));
     if (system)
         system->removeBody(this);
     // Remove from frame hierarchy
@@ -112,7 +115,7 @@ const vector<string>& Body::getNames() const
 /*! Return the primary name for the body; if i18n, return the
  *  localized name of the body.
  */
-string Body::getName(bool i18n) const
+const string& Body::getName(bool i18n) const
 {
     if (i18n && hasLocalizedName())
         return localizedName;
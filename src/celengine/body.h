@@ -196,7 +196,7 @@ class Body
 
     PlanetarySystem* getSystem() const;
     const std::vector<std::string>& getNames() const;
-    std::string getName(bool i18n = false) const;
+    const std::string& getName(bool i18n = false) const;
     std::string getLocalizedName() const;
     bool hasLocalizedName() const;
     void addAlias(const std::string& alias);
@@ -331,6 +331,9 @@ class Body
     bool isSecondaryIlluminator() const { return secondaryIlluminator; }
     void setSecondaryIlluminator(bool enable);
 
+    UserCategoryMask getCategoryMask() const { return categoryMask; }
+    void setCategoryMask(UserCategoryMask mask) { categoryMask = mask; }
+
     bool hasVisibleGeometry() const { return classification != Invisible && visible; }
 
     VisibilityPolicy getOrbitVisibility() const { return orbitVisibility; }
@@ -406,6 +409,7 @@ class Body
     RingSystem* rings{ nullptr };
 
     int classification{ Unknown };
+    UserCategoryMask categoryMask{ 0 };
 
     std::string infoURL;
 
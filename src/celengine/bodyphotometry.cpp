@@ -0,0 +1,177 @@
+// bodyphotometry.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Batched apparent magnitudes and disc sizes of solar system bodies.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include "bodyphotometry.h"
+
+#include <celengine/astro.h>
+#include <celengine/body.h>
+
+namespace
+{
+
+constexpr float NoLightMagnitude = 100.0f;
+
+// Phase function coefficients of the H-G system (Bowell et al. 1989)
+constexpr float HG_A1 = 3.33f;
+constexpr float HG_B1 = 0.63f;
+constexpr float HG_A2 = 1.87f;
+constexpr float HG_B2 = 1.22f;
+
+template<typename T>
+Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>
+column(std::vector<T>& v, std::size_t first)
+{
+    return { v.data() + first, static_cast<Eigen::Index>(v.size() - first) };
+}
+
+template<typename T>
+Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>
+column(const std::vector<T>& v, std::size_t first, std::size_t n)
+{
+    return { v.data() + first, static_cast<Eigen::Index>(n) };
+}
+
+} // end unnamed namespace
+
+
+void
+BodyPhotometry::truncate(std::size_t n)
+{
+    xs.resize(n);
+    ys.resize(n);
+    zs.resize(n);
+    radii.resize(n);
+    discRadii.resize(n);
+    brightness.resize(n);
+    slopeParameters.resize(n);
+}
+
+
+void
+BodyPhotometry::reserve(std::size_t n)
+{
+    xs.reserve(n);
+    ys.reserve(n);
+    zs.reserve(n);
+    radii.reserve(n);
+    discRadii.reserve(n);
+    brightness.reserve(n);
+    slopeParameters.reserve(n);
+}
+
+
+std::size_t
+BodyPhotometry::add(const Eigen::Vector3d& position, float radius, float reflectivity)
+{
+    return add(position, radius, reflectivity, 0.0f);
+}
+
+
+std::size_t
+BodyPhotometry::add(const Eigen::Vector3d& position, const Body& body)
+{
+    std::size_t i = add(position, body.getRadius(), body.getReflectivity());
+    discRadii[i] = body.getCullingRadius();
+    return i;
+}
+
+
+std::size_t
+BodyPhotometry::add(const Eigen::Vector3d& position, float radius, float absMag, float slopeParameter)
+{
+    xs.push_back(position.x());
+    ys.push_back(position.y());
+    zs.push_back(position.z());
+    radii.push_back(radius);
+    discRadii.push_back(radius);
+    brightness.push_back(absMag);
+    slopeParameters.push_back(slopeParameter);
+    return xs.size() - 1;
+}
+
+
+void
+BodyPhotometry::computeDistances(std::size_t first, float pixelSize)
+{
+    std::size_t n = size() - first;
+    distances.resize(size());
+    appMags.resize(size());
+    discSizes.resize(size());
+    lightDistances.resize(size());
+    cosPhaseAngles.resize(size());
+
+    auto x = column(xs, first, n);
+    auto y = column(ys, first, n);
+    auto z = column(zs, first, n);
+    auto distance = column(distances, first);
+    distance = (x.square() + y.square() + z.square()).sqrt();
+
+    column(discSizes, first) = column(discRadii, first, n) / (distance.cast<float>() * pixelSize);
+    column(appMags, first).setConstant(NoLightMagnitude);
+}
+
+
+void
+BodyPhotometry::addLight(std::size_t first,
+                         Model model,
+                         const Eigen::Vector3d& lightPosition,
+                         float luminosity)
+{
+    std::size_t n = size() - first;
+    auto x = column(xs, first, n);
+    auto y = column(ys, first, n);
+    auto z = column(zs, first, n);
+    auto viewerDistance = column(distances, first);
+
+    // Vector from the light to the body, and the cosine of the angle
+    // between it and the vector from the viewer to the body. The cosine is
+    // 1 at opposition, with the body fully lit.
+    auto sx = x - lightPosition.x();
+    auto sy = y - lightPosition.y();
+    auto sz = z - lightPosition.z();
+    auto lightDistance = column(lightDistances, first);
+    lightDistance = (sx.square() + sy.square() + sz.square()).sqrt();
+    auto cosPhase = column(cosPhaseAngles, first);
+    cosPhase = ((x * sx + y * sy + z * sz) / (viewerDistance * lightDistance)).cast<float>();
+
+    auto viewerDistanceF = viewerDistance.cast<float>();
+    auto lightDistanceF = lightDistance.cast<float>();
+    auto param = column(brightness, first, n);
+    auto appMag = column(appMags, first);
+
+    if (model == Model::Lambertian)
+    {
+        // Reflected luminosity relative to the sun's of a sphere of albedo
+        // p, scaled by the illuminated fraction of its disc:
+        //   L * p * (r / d)^2 / 4 * (1 + cos a) / 2
+        auto relativeRadius = column(radii, first, n) / lightDistanceF;
+        auto lum = luminosity * param * relativeRadius.square() * (0.125f * (1.0f + cosPhase));
+        auto mag = (SOLAR_ABSMAG - 5.0f) - LN_MAG * lum.log()
+                 + 5.0f * (viewerDistanceF / KM_PER_PARSEC<float>).log10();
+        appMag = appMag.min(mag);
+    }
+    else
+    {
+        // tan(a / 2) from the cosine, with the Phi functions' powers
+        // computed as exp(b * log(t)).
+        auto logTanHalf = 0.5f * ((1.0f - cosPhase).max(0.0f) / (1.0f + cosPhase).max(1.0e-12f)).log();
+        auto phi1 = (-HG_A1 * (HG_B1 * logTanHalf).exp()).exp();
+        auto phi2 = (-HG_A2 * (HG_B2 * logTanHalf).exp()).exp();
+        auto slope = column(slopeParameters, first, n);
+        auto phase = (1.0f - slope) * phi1 + slope * phi2;
+
+        constexpr float kmPerAU = KM_PER_AU<float>;
+        auto mag = param
+                 + 5.0f * ((lightDistanceF / kmPerAU) * (viewerDistanceF / kmPerAU)).log10()
+                 - LN_MAG * (phase * luminosity).log();
+        appMag = appMag.min(mag);
+    }
+}
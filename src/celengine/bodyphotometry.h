@@ -0,0 +1,100 @@
+// bodyphotometry.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Batched apparent magnitudes and disc sizes of solar system bodies.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <Eigen/Core>
+
+class Body;
+
+/*! Apparent magnitudes, distances and disc sizes of many bodies at once.
+ *  Positions and the per-body photometric parameters are appended as
+ *  columns and evaluated with Eigen array expressions, which the compiler
+ *  turns into SIMD code. This lets the renderer reject faint, small bodies
+ *  without touching the Body objects themselves.
+ *
+ *  Each level of a recursive traversal can append its own entries after
+ *  those of its parent, evaluate them from the index returned by size()
+ *  before adding, and truncate() back to that index when done.
+ */
+class BodyPhotometry
+{
+ public:
+    enum class Model
+    {
+        //! Diffuse sphere with a geometric albedo, as Body::getApparentMagnitude
+        Lambertian,
+        //! IAU H-G system used for asteroids
+        HG,
+    };
+
+    std::size_t size() const { return xs.size(); }
+    void truncate(std::size_t n);
+    void reserve(std::size_t n);
+
+    /*! Add a body for the Lambertian model. The position is relative to the
+     *  viewer in km; radius is used for the disc size.
+     */
+    std::size_t add(const Eigen::Vector3d& position, float radius, float reflectivity);
+
+    /*! Add a body for the Lambertian model. The magnitude uses the radius of
+     *  the body itself, the disc size its culling radius, which includes
+     *  rings, atmosphere and the coma of comets.
+     */
+    std::size_t add(const Eigen::Vector3d& position, const Body& body);
+
+    //! Add a body for the H-G model given its absolute magnitude and slope
+    std::size_t add(const Eigen::Vector3d& position, float radius, float absMag, float slopeParameter);
+
+    /*! Evaluate entries from first to the end. Lights is a range of objects
+     *  with viewer-relative position and luminosity members, such as the
+     *  renderer's LightSource. As in the renderer, a body takes the
+     *  magnitude of its brightest light source; with no lights the
+     *  magnitude is 100.
+     */
+    template<typename Lights>
+    void evaluate(std::size_t first, Model model, const Lights& lights, float pixelSize)
+    {
+        computeDistances(first, pixelSize);
+        for (const auto& light : lights)
+            addLight(first, model, light.position, light.luminosity);
+    }
+
+    double distance(std::size_t i) const { return distances[i]; }
+    float appMag(std::size_t i) const { return appMags[i]; }
+    float discSize(std::size_t i) const { return discSizes[i]; }
+
+ private:
+    void computeDistances(std::size_t first, float pixelSize);
+    void addLight(std::size_t first, Model model, const Eigen::Vector3d& lightPosition, float luminosity);
+
+    // Inputs
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<double> zs;
+    std::vector<float> radii;
+    std::vector<float> discRadii;
+    // Reflectivity for the Lambertian model, absolute magnitude for H-G
+    std::vector<float> brightness;
+    std::vector<float> slopeParameters;
+
+    // Results
+    std::vector<double> distances;
+    std::vector<float> appMags;
+    std::vector<float> discSizes;
+
+    // Per-light scratch space
+    std::vector<double> lightDistances;
+    std::vector<float> cosPhaseAngles;
+};
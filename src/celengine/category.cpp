@@ -1,11 +1,48 @@
 #include "category.h"
 
 #include <algorithm>
-#include <initializer_list>
 #include <utility>
 
 #include <celutil/gettext.h>
+#include "body.h"
+#include "deepskyobj.h"
 #include "hash.h"
+#include "star.h"
+
+namespace
+{
+
+// Keep the mask the renderer tests in step with the object map
+void
+setCategoryMask(Selection selection, UserCategoryMask mask)
+{
+    switch (selection.getType())
+    {
+    case SelectionType::Star:
+        selection.star()->setCategoryMask(mask);
+        break;
+    case SelectionType::Body:
+        selection.body()->setCategoryMask(mask);
+        break;
+    case SelectionType::DeepSky:
+        selection.deepsky()->setCategoryMask(mask);
+        break;
+    default:
+        break;
+    }
+}
+
+
+UserCategoryMask
+computeCategoryMask(const std::vector<UserCategoryId>& categories)
+{
+    UserCategoryMask mask = 0;
+    for (UserCategoryId category : categories)
+        mask |= UserCategoryBit(category);
+    return mask;
+}
+
+} // end unnamed namespace
 
 
 UserCategoryManager::UserCategoryManager() = default;
@@ -68,6 +105,7 @@ UserCategoryManager::destroy(UserCategoryId category)
         if (auto item = std::find(categories.begin(), categories.end(), category); item != categories.end())
         {
             categories.erase(item);
+            setCategoryMask(sel, computeCategoryMask(categories));
             if (categories.empty())
                 m_objectMap.erase(it);
         }
@@ -86,6 +124,7 @@ UserCategoryManager::destroy(UserCategoryId category)
     m_categoryMap.erase(entry->m_name);
     m_categories[categoryIndex] = nullptr;
     m_available.push_back(category);
+    ++m_revision;
 
     entry.reset();
     return true;
@@ -162,10 +201,9 @@ UserCategoryManager::addObject(Selection selection, UserCategoryId category)
     if (!m_categories[categoryIndex]->m_members.emplace(selection).second)
         return false;
 
-    if (auto it = m_objectMap.find(selection); it == m_objectMap.end())
-        m_objectMap.try_emplace(selection, std::initializer_list<UserCategoryId> { category });
-    else
-        it->second.push_back(category);
+    auto& categories = m_objectMap[selection];
+    categories.push_back(category);
+    setCategoryMask(selection, computeCategoryMask(categories));
     return true;
 }
 
@@ -191,6 +229,7 @@ UserCategoryManager::removeObject(Selection selection, UserCategoryId category)
     if (auto item = std::find(categories.begin(), categories.end(), category); item != categories.end())
     {
         categories.erase(item);
+        setCategoryMask(selection, computeCategoryMask(categories));
         if (categories.empty())
             m_objectMap.erase(it);
     }
@@ -212,6 +251,7 @@ UserCategoryManager::clearCategories(Selection selection)
     }
 
     m_objectMap.erase(selection);
+    setCategoryMask(selection, 0);
 }
 
 
@@ -11,6 +11,7 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include <celengine/astroobj.h>
 #include <celengine/parseobject.h>
 #include <celengine/selection.h>
 #include <celutil/array_view.h>
@@ -24,6 +25,15 @@ enum class UserCategoryId : std::uint32_t
 };
 
 
+// The bit of a category in the masks kept by stars, DSOs and bodies
+constexpr UserCategoryMask
+UserCategoryBit(UserCategoryId category)
+{
+    auto index = static_cast<std::uint32_t>(category);
+    return index < 64 ? UserCategoryMask(1) << index : UserCategoryMask(0);
+}
+
+
 class UserCategory;
 
 class UserCategoryManager
@@ -48,6 +58,8 @@ public:
 
     const std::unordered_set<UserCategoryId>& active() const { return m_active; }
     const std::unordered_set<UserCategoryId>& roots() const { return m_roots; }
+    // Incremented when a category is destroyed, after which its id may be reused
+    std::uint32_t revision() const { return m_revision; }
 
     bool addObject(Selection, UserCategoryId);
     bool removeObject(Selection, UserCategoryId);
@@ -69,6 +81,7 @@ private:
     std::unordered_set<UserCategoryId> m_roots;
     std::map<std::string, UserCategoryId, std::less<>> m_categoryMap;
     std::unordered_map<Selection, std::vector<UserCategoryId>> m_objectMap;
+    std::uint32_t m_revision{ 0 };
     friend class UserCategory;
 };
 
@@ -90,6 +103,7 @@ public:
 
     static const std::unordered_set<UserCategoryId>& active();
     static const std::unordered_set<UserCategoryId>& roots();
+    static std::uint32_t revision();
     static const UserCategory* get(UserCategoryId category);
     static UserCategoryId find(std::string_view name);
 
@@ -136,6 +150,13 @@ UserCategory::roots()
 }
 
 
+inline std::uint32_t
+UserCategory::revision()
+{
+    return manager.revision();
+}
+
+
 inline UserCategoryId
 UserCategory::find(std::string_view name)
 {
@@ -0,0 +1,129 @@
+// categoryfilter.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Render filtering and styling of objects by user category.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include "categoryfilter.h"
+
+#include <cstddef>
+
+#include "category.h"
+
+namespace
+{
+
+constexpr std::string_view Whitespace = " \t\r\n";
+
+std::string_view
+trim(std::string_view s)
+{
+    std::size_t start = s.find_first_not_of(Whitespace);
+    if (start == std::string_view::npos)
+        return {};
+    std::size_t end = s.find_last_not_of(Whitespace);
+    return s.substr(start, end - start + 1);
+}
+
+
+// Split the first word off s, leaving the remainder trimmed
+std::string_view
+nextWord(std::string_view& s)
+{
+    std::size_t end = s.find_first_of(Whitespace);
+    std::string_view word = s.substr(0, end);
+    s = end == std::string_view::npos ? std::string_view{} : trim(s.substr(end));
+    return word;
+}
+
+} // end unnamed namespace
+
+
+std::optional<CategoryFilter>
+CategoryFilter::parse(std::string_view expression, const UserCategoryManager* manager)
+{
+    CategoryFilter filter;
+    filter.expression = std::string(expression);
+    filter.revision = manager == nullptr ? UserCategory::revision() : manager->revision();
+
+    while (!expression.empty())
+    {
+        std::size_t end = expression.find(';');
+        std::string_view rule = trim(expression.substr(0, end));
+        expression = end == std::string_view::npos ? std::string_view{} : expression.substr(end + 1);
+        if (rule.empty())
+            continue;
+
+        std::string_view op = nextWord(rule);
+        Color color;
+        if (op == "color")
+        {
+            if (!Color::parse(nextWord(rule), color))
+                return std::nullopt;
+        }
+        else if (op != "show" && op != "hide" && op != "label")
+        {
+            return std::nullopt;
+        }
+
+        // The rest of the rule is the category name, which may contain spaces
+        if (rule.empty())
+            return std::nullopt;
+        UserCategoryId category = manager == nullptr
+            ? UserCategory::find(rule)
+            : manager->find(rule);
+        UserCategoryMask bit = category == UserCategoryId::Invalid ? 0 : UserCategoryBit(category);
+        if (bit == 0)
+            return std::nullopt;
+
+        if (op == "show")
+        {
+            filter.showMask |= bit;
+        }
+        else if (op == "hide")
+        {
+            filter.hideMask |= bit;
+        }
+        else if (op == "label")
+        {
+            filter.labelMask |= bit;
+        }
+        else
+        {
+            filter.colorMask |= bit;
+            filter.colorRules.push_back({ bit, color });
+        }
+    }
+
+    return filter;
+}
+
+
+bool
+CategoryFilter::isCurrent(const UserCategoryManager* manager) const
+{
+    if (isEmpty())
+        return true;
+    return revision == (manager == nullptr ? UserCategory::revision() : manager->revision());
+}
+
+
+const Color*
+CategoryFilter::getColor(UserCategoryMask mask) const
+{
+    if ((mask & colorMask) == 0)
+        return nullptr;
+
+    for (const ColorRule& rule : colorRules)
+    {
+        if ((mask & rule.mask) != 0)
+            return &rule.color;
+    }
+
+    return nullptr;
+}
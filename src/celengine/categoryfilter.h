@@ -0,0 +1,85 @@
+// categoryfilter.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Render filtering and styling of objects by user category.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <celengine/astroobj.h>
+#include <celutil/color.h>
+
+class UserCategoryManager;
+
+/*! A list of rules over user categories, separated by semicolons:
+ *
+ *      show <category>           only objects in a shown category are drawn
+ *      hide <category>           objects in the category aren't drawn
+ *      color <color> <category>  labels and orbits use the color
+ *      label <category>          drawn objects are labeled whatever their brightness
+ *
+ *  Category names are resolved to their bits when the filter is parsed, so
+ *  the renderer tests an object with a mask operation against the category
+ *  mask kept by the object. Hiding wins over showing, and the first color
+ *  rule matching an object applies. Destroying a category frees its bit for
+ *  reuse, so a filter parsed before has to be parsed again.
+ */
+class CategoryFilter
+{
+ public:
+    CategoryFilter() = default;
+
+    /*! Parse a filter, looking up the categories in manager or in the global
+     *  categories if it is null. Fails on a malformed rule, an unknown
+     *  category or one without a mask bit.
+     */
+    static std::optional<CategoryFilter> parse(std::string_view expression,
+                                               const UserCategoryManager* manager = nullptr);
+
+    const std::string& getExpression() const { return expression; }
+
+    //! False if a category was destroyed since the filter was parsed
+    bool isCurrent(const UserCategoryManager* manager = nullptr) const;
+
+    bool isEmpty() const { return (showMask | hideMask | colorMask | labelMask) == 0; }
+    //! True if some objects aren't drawn
+    bool hidesObjects() const { return (showMask | hideMask) != 0; }
+    //! True if some drawn objects are labeled whatever their brightness
+    bool labelsObjects() const { return labelMask != 0; }
+
+    bool isVisible(UserCategoryMask mask) const
+    {
+        return (mask & hideMask) == 0 && (showMask == 0 || (mask & showMask) != 0);
+    }
+
+    bool isLabeled(UserCategoryMask mask) const { return (mask & labelMask) != 0; }
+
+    //! Returns the color for objects with the mask, or nullptr if no rule applies
+    const Color* getColor(UserCategoryMask mask) const;
+
+ private:
+    struct ColorRule
+    {
+        UserCategoryMask mask;
+        Color color;
+    };
+
+    std::string expression;
+    std::uint32_t revision{ 0 };
+    UserCategoryMask showMask{ 0 };
+    UserCategoryMask hideMask{ 0 };
+    UserCategoryMask colorMask{ 0 };
+    UserCategoryMask labelMask{ 0 };
+    std::vector<ColorRule> colorRules;
+};
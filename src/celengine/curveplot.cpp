@@ -8,6 +8,10 @@
 // required. The cubics are adaptively subdivided based on distance from
 // the camera position.
 //
+// When instancing is available, the cubics are instead kept in a GPU buffer
+// as pairs of floats relative to an origin, and evaluated in the vertex
+// shader. Only the segments that need subdividing are drawn in software.
+//
 // curveplot is free software; you can redistribute it and/or
 // modify it under the terms of the GNU Lesser General Public
 // License as published by the Free Software Foundation; either
@@ -29,14 +33,19 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <memory>
 #include <vector>
+#include <celrender/gl/buffer.h>
+#include <celrender/gl/vertexobject.h>
 #include <celrender/linerenderer.h>
 
 #include "curveplot.h"
+#include "glsupport.h"
 #include "render.h"
 #include "shadermanager.h"
 
+namespace gl = celestia::gl;
 using celestia::render::LineRenderer;
 
 namespace
@@ -335,18 +344,76 @@ private:
 
 HighPrec_VertexBuffer vbuf;
 
+
+bool
+hasInstancing()
+{
+#ifdef GL_ES
+    return gl::checkVersion(gl::GLES_3);
+#else
+    return gl::checkVersion(gl::GL_3_3) || epoxy_has_gl_extension("GL_ARB_instanced_arrays");
+#endif
+}
+
+
+// Per instance attributes of a segment, see curveplot_vert.glsl
+struct SegmentVertex
+{
+    Eigen::Vector3f high;
+    Eigen::Vector3f low;
+    Eigen::Vector3f c1;
+    float startTime;
+    Eigen::Vector3f c2;
+    float duration;
+    Eigen::Vector3f c3;
+    float boundingRadius;
+};
+
+
+// Split a vector into a float approximation and the remainder
+inline void
+splitDouble(const Eigen::Vector3d& v, Eigen::Vector3f& high, Eigen::Vector3f& low)
+{
+    high = v.cast<float>();
+    low = (v - high.cast<double>()).cast<float>();
+}
+
+
+// Curve parameter of the vertices of a segment, shared by all plots
+std::unique_ptr<gl::Buffer> segmentParams;
+
 } // end unnamed namespace
 
 
+struct CurvePlot::GPUSegments
+{
+    gl::Buffer buffer;
+    gl::VertexObject vo{ gl::VertexObject::Primitive::LineStrip };
+    int count{ 0 };
+
+    // Positions and times are stored relative to the first sample
+    Eigen::Vector3d origin{ Eigen::Vector3d::Zero() };
+    double timeOrigin{ 0.0 };
+
+    // Bounding sphere of the curve, and largest segment
+    Eigen::Vector3d center{ Eigen::Vector3d::Zero() };
+    double radius{ 0.0 };
+    double maxSegmentRadius{ 0.0 };
+};
+
+
 CurvePlot::CurvePlot(const Renderer &renderer) :
     m_renderer(renderer)
 {
 }
 
+CurvePlot::~CurvePlot() = default;
+
 void
 CurvePlot::deinit()
 {
     vbuf.deinit();
+    segmentParams = nullptr;
 }
 
 /** Add a new sample to the path. If the sample time is less than the first time,
@@ -377,6 +444,7 @@ CurvePlot::addSample(const CurvePlotSample& sample)
         m_samples.push_back(sample);
     else
         m_samples.push_front(sample);
+    m_gpuSegmentsDirty = true;
 
     if (m_samples.size() > 1)
     {
@@ -418,6 +486,7 @@ CurvePlot::removeSamplesBefore(double t)
     while (!m_samples.empty() && m_samples.front().t < t)
     {
         m_samples.pop_front();
+        m_gpuSegmentsDirty = true;
     }
 }
 
@@ -430,6 +499,7 @@ CurvePlot::removeSamplesAfter(double t)
     while (!m_samples.empty() && m_samples.back().t > t)
     {
         m_samples.pop_back();
+        m_gpuSegmentsDirty = true;
     }
 }
 
@@ -441,6 +511,223 @@ CurvePlot::setDuration(double duration)
 }
 
 
+/** Rebuild the buffer of segments drawn by the vertex shader from the samples.
+  */
+void
+CurvePlot::updateGPUSegments() const
+{
+    if (segmentParams == nullptr)
+    {
+        std::vector<float> params;
+        for (unsigned int i = 0; i <= SubdivisionFactor; i++)
+            params.push_back(static_cast<float>(i * InvSubdivisionFactor));
+        segmentParams = std::make_unique<gl::Buffer>(gl::Buffer::TargetHint::Array, params);
+    }
+
+    if (m_gpuSegments == nullptr)
+    {
+        m_gpuSegments = std::make_unique<GPUSegments>();
+        auto& vo = m_gpuSegments->vo;
+        const auto& buffer = m_gpuSegments->buffer;
+        constexpr int stride = sizeof(SegmentVertex);
+        vo.addVertexBuffer(*segmentParams, CelestiaGLProgram::IntensityAttributeIndex,
+                           1, gl::VertexObject::DataType::Float);
+        vo.addVertexBuffer(buffer, CelestiaGLProgram::VertexCoordAttributeIndex,
+                           3, gl::VertexObject::DataType::Float, false, stride,
+                           offsetof(SegmentVertex, high), 1);
+        vo.addVertexBuffer(buffer, CelestiaGLProgram::NormalAttributeIndex,
+                           3, gl::VertexObject::DataType::Float, false, stride,
+                           offsetof(SegmentVertex, low), 1);
+        vo.addVertexBuffer(buffer, CelestiaGLProgram::TextureCoord0AttributeIndex,
+                           4, gl::VertexObject::DataType::Float, false, stride,
+                           offsetof(SegmentVertex, c1), 1);
+        vo.addVertexBuffer(buffer, CelestiaGLProgram::TextureCoord1AttributeIndex,
+                           4, gl::VertexObject::DataType::Float, false, stride,
+                           offsetof(SegmentVertex, c2), 1);
+        vo.addVertexBuffer(buffer, CelestiaGLProgram::TextureCoord2AttributeIndex,
+                           4, gl::VertexObject::DataType::Float, false, stride,
+                           offsetof(SegmentVertex, c3), 1);
+    }
+
+    GPUSegments& gpu = *m_gpuSegments;
+    gpu.origin = m_samples.front().position;
+    gpu.timeOrigin = m_samples.front().t;
+    gpu.maxSegmentRadius = 0.0;
+
+    Eigen::AlignedBox3d bounds(gpu.origin);
+    std::vector<SegmentVertex> segments;
+    segments.reserve(m_samples.size() - 1);
+    for (std::size_t i = 1; i < m_samples.size(); i++)
+    {
+        const CurvePlotSample& s0 = m_samples[i - 1];
+        const CurvePlotSample& s1 = m_samples[i];
+        double dt = s1.t - s0.t;
+        Eigen::Vector3d v0 = s0.velocity * dt;
+        Eigen::Vector3d v1 = s1.velocity * dt;
+        Eigen::Vector3d dp = s1.position - s0.position;
+
+        // Same coefficients as cubicHermiteCoefficients()
+        SegmentVertex& segment = segments.emplace_back();
+        splitDouble(s0.position - gpu.origin, segment.high, segment.low);
+        segment.c1 = v0.cast<float>();
+        segment.startTime = static_cast<float>(s0.t - gpu.timeOrigin);
+        segment.c2 = (3.0 * dp - (2.0 * v0 + v1)).cast<float>();
+        segment.duration = static_cast<float>(dt);
+        segment.c3 = (v1 + v0 - 2.0 * dp).cast<float>();
+        segment.boundingRadius = static_cast<float>(s1.boundingRadius);
+
+        bounds.extend(s1.position);
+        gpu.maxSegmentRadius = std::max(gpu.maxSegmentRadius, s1.boundingRadius);
+    }
+
+    // Every point of a segment lies within its bounding radius of the start
+    gpu.center = bounds.center();
+    gpu.radius = bounds.sizes().norm() * 0.5 + gpu.maxSegmentRadius;
+    gpu.count = static_cast<int>(segments.size());
+    gpu.buffer.bind().setData(segments, gl::Buffer::BufferUsage::DynamicDraw);
+    gpu.buffer.unbind();
+
+    m_gpuSegmentsDirty = false;
+}
+
+
+/** Draw the part of the curve between startTime and endTime with the segments
+  * evaluated in the vertex shader. The segments too close to the camera for a
+  * fixed subdivision are drawn on the CPU. Return false if the GL or the line
+  * width doesn't allow it.
+  *
+  * @param fadeRate opacity change per day from full opacity at fadeStartTime,
+  * or zero to draw the curve without fading
+  */
+bool
+CurvePlot::renderGPU(const Eigen::Affine3d& modelview,
+                     double nearZ,
+                     double farZ,
+                     const Eigen::Vector3d viewFrustumPlaneNormals[],
+                     double subdivisionThreshold,
+                     double startTime,
+                     double endTime,
+                     const Eigen::Vector4f& color,
+                     double fadeStartTime,
+                     double fadeRate) const
+{
+    if (m_samples.size() < 2 || !hasInstancing())
+        return false;
+
+    // Wider lines are drawn as triangles by the line renderer
+    float lineWidth = OrbitThickness * m_renderer.getScaleFactor();
+    if ((m_renderer.getRenderFlags() & Renderer::ShowSmoothLines) != 0)
+        lineWidth *= 1.5f;
+    if (lineWidth > gl::maxLineWidth)
+        return false;
+
+    auto *prog = m_renderer.getShaderManager().getShader("curveplot");
+    if (prog == nullptr)
+        return false;
+
+    if (m_gpuSegmentsDirty)
+        updateGPUSegments();
+    GPUSegments& gpu = *m_gpuSegments;
+
+    // Camera position in the coordinates of the samples
+    Eigen::Vector3d camera = modelview.inverse().translation();
+    Eigen::Vector3f cameraHigh;
+    Eigen::Vector3f cameraLow;
+    splitDouble(camera - gpu.origin, cameraHigh, cameraLow);
+
+    Eigen::Vector2f fade(0.0f, 1.0f);
+    if (fadeRate != 0.0)
+        fade = Eigen::Vector2f(static_cast<float>(fadeRate), static_cast<float>((gpu.timeOrigin - fadeStartTime) * fadeRate));
+
+    prog->use();
+    prog->setMVPMatrices(m_renderer.getCurrentProjectionMatrix());
+    prog->mat3Param("viewMat") = modelview.linear().cast<float>();
+    prog->vec3Param("cameraHigh") = cameraHigh;
+    prog->vec3Param("cameraLow") = cameraLow;
+    prog->vec4Param("color") = color;
+    prog->vec2Param("window") = Eigen::Vector2f(static_cast<float>(startTime - gpu.timeOrigin),
+                                                static_cast<float>(endTime - gpu.timeOrigin));
+    prog->vec2Param("fade") = fade;
+    prog->floatParam("farZ") = static_cast<float>(farZ);
+    prog->floatParam("subdivisionThreshold") = static_cast<float>(subdivisionThreshold);
+    glLineWidth(lineWidth);
+    gpu.vo.drawInstanced(gl::VertexObject::Primitive::LineStrip, SubdivisionFactor + 1, gpu.count);
+
+    // No segment needs subdividing unless the camera is close to the curve
+    double distance = (camera - gpu.center).norm() - gpu.radius;
+    if (gpu.maxSegmentRadius < subdivisionThreshold * (distance - gpu.maxSegmentRadius))
+        return true;
+
+    HighPrec_Frustum viewFrustum(nearZ, farZ, viewFrustumPlaneNormals);
+    HighPrec_RenderContext rc(vbuf, viewFrustum, subdivisionThreshold);
+
+    // Flag to indicate whether we need to start a new line strip
+    bool restartCurve = true;
+    bool started = false;
+
+    for (unsigned int i = 1; i < m_samples.size(); i++)
+    {
+        const CurvePlotSample& s0 = m_samples[i - 1];
+        const CurvePlotSample& s1 = m_samples[i];
+        if (s1.t <= startTime)
+            continue;
+        if (s0.t >= endTime)
+            break;
+
+        // The test of the vertex shader, skipping the segments it has drawn
+        double curveBoundingRadius = s1.boundingRadius;
+        Eigen::Vector4d p0 = modelview * Eigen::Vector4d(s0.position.x(), s0.position.y(), s0.position.z(), 1.0);
+        if (curveBoundingRadius < subdivisionThreshold * (p0.head(3).norm() - curveBoundingRadius) ||
+            viewFrustum.cullSphere(p0, curveBoundingRadius))
+        {
+            if (!restartCurve)
+            {
+                vbuf.end();
+                restartCurve = true;
+            }
+            continue;
+        }
+
+        if (!started)
+        {
+            vbuf.setup(m_renderer, color);
+            started = true;
+        }
+
+        double dt = s1.t - s0.t;
+        Eigen::Vector4d p1 = modelview * Eigen::Vector4d(s1.position.x(), s1.position.y(), s1.position.z(), 1.0);
+        Eigen::Vector4d v0 = modelview * zeroExtend(s0.velocity);
+        Eigen::Vector4d v1 = modelview * zeroExtend(s1.velocity);
+        double t0 = std::clamp((startTime - s0.t) / dt, 0.0, 1.0);
+        double t1 = std::clamp((endTime - s0.t) / dt, 0.0, 1.0);
+
+        Eigen::Matrix4d coeff = cubicHermiteCoefficients(p0, p1, v0 * dt, v1 * dt);
+        if (fadeRate == 0.0)
+        {
+            restartCurve = rc.renderCubic(restartCurve, coeff, t0, t1, curveBoundingRadius, 1);
+        }
+        else
+        {
+            restartCurve = rc.renderCubicFaded(restartCurve, coeff,
+                                               t0, t1,
+                                               color,
+                                               (fadeStartTime - s0.t) / dt, fadeRate * dt,
+                                               curveBoundingRadius, 1);
+        }
+    }
+
+    if (started)
+    {
+        if (!restartCurve)
+            vbuf.end();
+        vbuf.flush();
+        vbuf.finish();
+    }
+
+    return true;
+}
+
+
 // Trajectory consists of segments, each of which is a cubic
 // polynomial.
 
@@ -460,6 +747,12 @@ CurvePlot::render(const Eigen::Affine3d& modelview,
                   double subdivisionThreshold,
                   const Eigen::Vector4f& color) const
 {
+    if (renderGPU(modelview, nearZ, farZ, viewFrustumPlaneNormals, subdivisionThreshold,
+                  startTime(), endTime(), color, 0.0, 0.0))
+    {
+        return;
+    }
+
     // Flag to indicate whether we need to issue a glBegin()
     bool restartCurve = true;
 
@@ -587,6 +880,12 @@ CurvePlot::render(const Eigen::Affine3d& modelview,
     if (m_samples.empty() || endTime <= m_samples.front().t || startTime >= m_samples.back().t)
         return;
 
+    if (renderGPU(modelview, nearZ, farZ, viewFrustumPlaneNormals, subdivisionThreshold,
+                  startTime, endTime, color, 0.0, 0.0))
+    {
+        return;
+    }
+
     // Linear search for the first sample
     unsigned int startSample = 0;
     while (startSample < m_samples.size() - 1 && startTime > m_samples[startSample].t)
@@ -752,6 +1051,15 @@ CurvePlot::renderFaded(const Eigen::Affine3d& modelview,
     if (m_samples.empty() || endTime <= m_samples.front().t || startTime >= m_samples.back().t)
         return;
 
+    double fadeDuration = fadeEndTime - fadeStartTime;
+    double fadeRate = 1.0 / fadeDuration;
+
+    if (renderGPU(modelview, nearZ, farZ, viewFrustumPlaneNormals, subdivisionThreshold,
+                  startTime, endTime, color, fadeStartTime, fadeRate))
+    {
+        return;
+    }
+
     // Linear search for the first sample
     unsigned int startSample = 0;
     while (startSample < m_samples.size() - 1 && startTime > m_samples[startSample].t)
@@ -761,9 +1069,6 @@ CurvePlot::renderFaded(const Eigen::Affine3d& modelview,
     if (startSample > 0)
         startSample--;
 
-    double fadeDuration = fadeEndTime - fadeStartTime;
-    double fadeRate = 1.0 / fadeDuration;
-
     const Eigen::Vector3d& p0_ = m_samples[startSample].position;
     const Eigen::Vector3d& v0_ = m_samples[startSample].velocity;
     Eigen::Vector4d p0 = modelview * Eigen::Vector4d(p0_.x(), p0_.y(), p0_.z(), 1.0);
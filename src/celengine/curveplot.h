@@ -8,6 +8,10 @@
 // required. The cubics are adaptively subdivided based on distance from
 // the camera position.
 //
+// When instancing is available, the cubics are instead kept in a GPU buffer
+// as pairs of floats relative to an origin, and evaluated in the vertex
+// shader. Only the segments that need subdividing are drawn in software.
+//
 // curveplot is free software; you can redistribute it and/or
 // modify it under the terms of the GNU Lesser General Public
 // License as published by the Free Software Foundation; either
@@ -30,6 +34,7 @@
 #pragma once
 
 #include <deque>
+#include <memory>
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
@@ -53,6 +58,7 @@ class CurvePlot
 {
  public:
     explicit CurvePlot(const Renderer &renderer);
+    ~CurvePlot();
 
     double duration() const { return m_duration; }
     void setDuration(double duration);
@@ -106,9 +112,26 @@ class CurvePlot
     static void deinit();
 
  private:
+    struct GPUSegments;
+
+    bool renderGPU(const Eigen::Affine3d& modelview,
+                   double nearZ,
+                   double farZ,
+                   const Eigen::Vector3d viewFrustumPlaneNormals[],
+                   double subdivisionThreshold,
+                   double startTime,
+                   double endTime,
+                   const Eigen::Vector4f& color,
+                   double fadeStartTime,
+                   double fadeRate) const;
+    void updateGPUSegments() const;
+
     std::deque<CurvePlotSample>     m_samples;
     const Renderer                 &m_renderer;
     double                          m_duration      { 0.0 };
     unsigned int                    m_lastUsed      { 0   };
+
+    mutable std::unique_ptr<GPUSegments> m_gpuSegments;
+    mutable bool                    m_gpuSegmentsDirty { true };
 };
 
@@ -93,12 +93,16 @@ public:
     AstroCatalog::IndexNumber getIndex() const { return indexNumber; }
     void setIndex(AstroCatalog::IndexNumber idx) { indexNumber = idx; }
 
+    UserCategoryMask getCategoryMask() const { return categoryMask; }
+    void setCategoryMask(UserCategoryMask mask) { categoryMask = mask; }
+
 private:
     Eigen::Vector3d position{ Eigen::Vector3d::Zero() };
     Eigen::Quaternionf orientation{ Eigen::Quaternionf::Identity() };
     float        radius{ 1 };
     float        absMag{ DSO_DEFAULT_ABS_MAGNITUDE } ;
     AstroCatalog::IndexNumber indexNumber{ AstroCatalog::InvalidIndex };
+    UserCategoryMask categoryMask{ 0 };
     std::string infoURL;
 
     bool visible { true };
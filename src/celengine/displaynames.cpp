@@ -0,0 +1,71 @@
+// displaynames.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Label text of catalog objects.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include "displaynames.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+
+constexpr std::size_t BlockSize = 65536;
+constexpr std::size_t LengthSize = 2;
+constexpr std::size_t MaxNameLength = BlockSize - LengthSize;
+
+} // end unnamed namespace
+
+
+void
+DisplayNameTable::reset(std::size_t count)
+{
+    index.assign(count, NotComputed);
+    blocks.clear();
+    blockUsed = 0;
+    memory.set(index.capacity() * sizeof(std::uint32_t));
+}
+
+
+std::string_view
+DisplayNameTable::lookup(std::uint32_t position) const
+{
+    const char* entry = blocks[position / BlockSize].get() + position % BlockSize;
+    auto length = static_cast<std::size_t>(static_cast<unsigned char>(entry[0])) |
+                  static_cast<std::size_t>(static_cast<unsigned char>(entry[1])) << 8;
+    return std::string_view(entry + LengthSize, length);
+}
+
+
+std::string_view
+DisplayNameTable::add(std::size_t i, std::string_view name)
+{
+    name = name.substr(0, MaxNameLength);
+    std::size_t entrySize = LengthSize + name.size();
+    if (blocks.empty() || blockUsed + entrySize > BlockSize)
+    {
+        blocks.push_back(std::make_unique<char[]>(BlockSize));
+        blockUsed = 0;
+        memory.add(BlockSize);
+    }
+
+    std::size_t position = (blocks.size() - 1) * BlockSize + blockUsed;
+    assert(position < NotComputed);
+
+    char* entry = blocks.back().get() + blockUsed;
+    entry[0] = static_cast<char>(name.size() & 0xff);
+    entry[1] = static_cast<char>(name.size() >> 8);
+    std::memcpy(entry + LengthSize, name.data(), name.size());
+    blockUsed += entrySize;
+
+    index[i] = static_cast<std::uint32_t>(position);
+    return std::string_view(entry + LengthSize, name.size());
+}
@@ -0,0 +1,64 @@
+// displaynames.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Label text of catalog objects.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <celutil/memoryusage.h>
+
+/*! Display names of the objects of a catalog, indexed by the position of
+ *  the object in the catalog. Each name is computed on first use and then
+ *  kept in blocks that are never reallocated, so the views returned stay
+ *  valid until the table is reset. Lookups of names already computed are
+ *  an index and a length read. Not thread safe.
+ */
+class DisplayNameTable
+{
+ public:
+    DisplayNameTable() = default;
+    ~DisplayNameTable() = default;
+
+    DisplayNameTable(const DisplayNameTable&) = delete;
+    DisplayNameTable& operator=(const DisplayNameTable&) = delete;
+
+    //! Forget all names and make room for count objects
+    void reset(std::size_t count);
+    std::size_t size() const { return index.size(); }
+
+    /*! Return the name of object i, calling makeName() to compute it the
+     *  first time. Names are truncated to just under 64 KiB.
+     */
+    template<typename F>
+    std::string_view get(std::size_t i, F&& makeName)
+    {
+        if (std::uint32_t position = index[i]; position != NotComputed)
+            return lookup(position);
+        return add(i, makeName());
+    }
+
+ private:
+    static constexpr std::uint32_t NotComputed = UINT32_MAX;
+
+    std::string_view lookup(std::uint32_t position) const;
+    std::string_view add(std::size_t i, std::string_view name);
+
+    // Positions of the names in the blocks, where each name is stored as a
+    // 16-bit length followed by its characters
+    std::vector<std::uint32_t> index;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::size_t blockUsed{ 0 };
+    celestia::util::MemoryTracker memory{ celestia::util::MemoryCategory::Names };
+};
@@ -11,6 +11,7 @@
 //
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <utility>
 
@@ -104,6 +105,24 @@ std::string DSODatabase::getDSOName(const DeepSkyObject* const & dso, bool i18n)
 }
 
 
+std::string_view DSODatabase::getDSODisplayName(const DeepSkyObject* dso) const
+{
+    std::size_t count = FirstAutoCatalogNumber - nextAutoCatalogNumber;
+    std::size_t i = FirstAutoCatalogNumber - dso->getIndex();
+    assert(i < count);
+
+    if (displayNames.size() != count)
+        displayNames.reset(count);
+    return displayNames.get(i, [&] { return getDSOName(dso, true); });
+}
+
+
+void DSODatabase::invalidateDisplayNames() const
+{
+    displayNames.reset(0);
+}
+
+
 std::string DSODatabase::getDSONameList(const DeepSkyObject* const & dso, const unsigned int maxNames) const
 {
     std::string dsoNames;
@@ -164,6 +183,26 @@ void DSODatabase::findVisibleDSOs(DSOHandler& dsoHandler,
 }
 
 
+void DSODatabase::findVisibleDSOs(DSOHandler& dsoHandler,
+                                  const Eigen::Vector3d& obsPos,
+                                  float limitingMag,
+                                  OctreeProcStats *stats) const
+{
+    // Planes with a zero normal never reject an octree node, so only the
+    // magnitude limit is applied.
+    Eigen::Hyperplane<double, 3> frustumPlanes[5];
+    for (auto& plane : frustumPlanes)
+        plane = Eigen::Hyperplane<double, 3>(Eigen::Vector3d::Zero(), 0.0);
+
+    octreeRoot->processVisibleObjects(dsoHandler,
+                                      obsPos,
+                                      frustumPlanes,
+                                      limitingMag,
+                                      DSO_OCTREE_ROOT_SIZE,
+                                      stats);
+}
+
+
 void DSODatabase::findCloseDSOs(DSOHandler& dsoHandler,
                                 const Eigen::Vector3d& obsPos,
                                 float radius) const
@@ -184,6 +223,7 @@ DSONameDatabase* DSODatabase::getNameDatabase() const
 void DSODatabase::setNameDatabase(std::unique_ptr<DSONameDatabase>&& _namesDB)
 {
     namesDB = std::move(_namesDB);
+    invalidateDisplayNames();
 }
 
 
@@ -234,17 +274,31 @@ bool DSODatabase::load(std::istream& in, const fs::path& resourcePath)
         }
 
         DeepSkyObject* obj = nullptr;
+        std::size_t objSize = 0;
         if (compareIgnoringCase(objType, "Galaxy") == 0)
+        {
             obj = new Galaxy();
+            objSize = sizeof(Galaxy);
+        }
         else if (compareIgnoringCase(objType, "Globular") == 0)
+        {
             obj = new Globular();
+            objSize = sizeof(Globular);
+        }
         else if (compareIgnoringCase(objType, "Nebula") == 0)
+        {
             obj = new Nebula();
+            objSize = sizeof(Nebula);
+        }
         else if (compareIgnoringCase(objType, "OpenCluster") == 0)
+        {
             obj = new OpenCluster();
+            objSize = sizeof(OpenCluster);
+        }
 
         if (obj != nullptr && obj->load(objParams, resourcePath))
         {
+            memory.add(objSize);
             UserCategory::loadCategories(obj, *objParams, DataDisposition::Add, resourcePath.string());
 
             // Ensure that the DSO array is large enough
@@ -321,6 +375,7 @@ void DSODatabase::finish()
     buildOctree();
     buildIndexes();
     calcAvgAbsMag();
+    memory.add(2 * nDSOs * sizeof(DeepSkyObject*) + octreeRoot->memoryUsage());
     /*
     // Put AbsMag = avgAbsMag for Add-ons without AbsMag entry
     for (int i = 0; i < nDSOs; ++i)
@@ -354,6 +409,7 @@ void DSODatabase::buildOctree()
     // The spatial sorting part is useless for DSOs since we
     // are storing pointers to objects and not the objects themselves:
     root->rebuildAndSort(octreeRoot, firstDSO);
+    octreeRoot->computeAggregates();
 
     GetLogger()->debug("{} DSOs total.\nOctree has {} nodes and {} DSOs.\n",
                        static_cast<int>(firstDSO - sortedDSOs),
@@ -24,7 +24,9 @@
 
 #include <celcompat/filesystem.h>
 #include <celengine/dsooctree.h>
+#include <celengine/displaynames.h>
 #include <celengine/dsoname.h>
+#include <celutil/memoryusage.h>
 
 constexpr inline unsigned int MAX_DSO_NAMES = 10;
 
@@ -55,6 +57,12 @@ class DSODatabase
                          float limitingMag,
                          OctreeProcStats * = nullptr) const;
 
+    // Find DSOs brighter than limitingMag in all directions.
+    void findVisibleDSOs(DSOHandler& dsoHandler,
+                         const Eigen::Vector3d& obsPosition,
+                         float limitingMag,
+                         OctreeProcStats * = nullptr) const;
+
     void findCloseDSOs(DSOHandler& dsoHandler,
                        const Eigen::Vector3d& obsPosition,
                        float radius) const;
@@ -62,6 +70,11 @@ class DSODatabase
     std::string getDSOName    (const DeepSkyObject* const &, bool i18n = false) const;
     std::string getDSONameList(const DeepSkyObject* const &, const unsigned int maxNames = MAX_DSO_NAMES) const;
 
+    // Localized name of a DSO of this database for labels, computed once;
+    // see StarDatabase::getStarDisplayName().
+    std::string_view getDSODisplayName(const DeepSkyObject*) const;
+    void invalidateDisplayNames() const;
+
     DSONameDatabase* getNameDatabase() const;
     void setNameDatabase(std::unique_ptr<DSONameDatabase>&&);
 
@@ -84,9 +97,16 @@ private:
     std::unique_ptr<DSONameDatabase> namesDB{ nullptr };
     DeepSkyObject**  catalogNumberIndex{ nullptr };
     DSOOctree*       octreeRoot{ nullptr };
-    AstroCatalog::IndexNumber nextAutoCatalogNumber{ 0xfffffffe };
+    // DSOs are numbered downwards from here in the order they're loaded
+    static constexpr AstroCatalog::IndexNumber FirstAutoCatalogNumber = 0xfffffffe;
+    AstroCatalog::IndexNumber nextAutoCatalogNumber{ FirstAutoCatalogNumber };
+
+    mutable DisplayNameTable displayNames;
 
     float            avgAbsMag{ 0.0f };
+
+    // The objects, their arrays and the octree
+    celestia::util::MemoryTracker memory{ celestia::util::MemoryCategory::DeepSkyObjects };
 };
 
 
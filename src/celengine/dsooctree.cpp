@@ -72,7 +72,8 @@ void DSOOctree::processVisibleObjects(DSOHandler&    processor,
                                       const Hyperplane<double, 3>*  frustumPlanes,
                                       float          limitingFactor,
                                       double         scale,
-                                      OctreeProcStats *stats) const
+                                      OctreeProcStats *stats,
+                                      const DSOOctreeMotion* /*motion*/) const
 {
 #ifdef OCTREE_DEBUG
     size_t h;
@@ -95,6 +96,9 @@ void DSOOctree::processVisibleObjects(DSOHandler&    processor,
             return;
     }
 
+    if (processor.occluder && processor.occluder->hides(cellCenterPos - obsPosition, scale * DSOOctree::SQRT3))
+        return;
+
     // Compute the distance to node; this is equal to the distance to
     // the cellCenterPos of the node minus the boundingRadius of the node, scale * SQRT3.
     double minDistance = (obsPosition - cellCenterPos).norm() - scale * DSOOctree::SQRT3;
@@ -121,8 +125,12 @@ void DSOOctree::processVisibleObjects(DSOHandler&    processor,
     }
 
     // See if any of the objects in child nodes are potentially included
-    // that we need to recurse deeper.
-    if (minDistance <= 0.0 || astro::absToAppMag((double) exclusionFactor, minDistance) <= limitingFactor)
+    // that we need to recurse deeper, or if they can be drawn as one.
+    float childrenAppMag = minDistance > 0.0 ? (float) astro::absToAppMag((double) exclusionFactor, minDistance) : -1000.0f;
+    if (processAggregate(processor, obsPosition, minDistance, scale * DSOOctree::SQRT3, childrenAppMag, limitingFactor))
+        return;
+
+    if (minDistance <= 0.0 || childrenAppMag <= limitingFactor)
     {
         // Recurse into the child nodes
         if (_children != nullptr)
@@ -153,7 +161,8 @@ template<>
 void DSOOctree::processCloseObjects(DSOHandler&    processor,
                                     const PointType& obsPosition,
                                     double         boundingRadius,
-                                    double         scale) const
+                                    double         scale,
+                                    const DSOOctreeMotion* /*motion*/) const
 {
     // Compute the distance to node; this is equal to the distance to
     // the cellCenterPos of the node minus the boundingRadius of the node, scale * SQRT3.
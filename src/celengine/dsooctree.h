@@ -19,3 +19,20 @@
 using DynamicDSOOctree = DynamicOctree<DeepSkyObject*, double>;
 using DSOOctree = StaticOctree<DeepSkyObject*, double>;
 using DSOHandler = OctreeProcessor<DeepSkyObject*, double>;
+using DSOOctreeMotion = OctreeMotion<DeepSkyObject*, double>;
+
+
+// Only galaxies are aggregated; the others are too few and too bright.
+template<> struct OctreeObjectLight<DeepSkyObject*, double>
+{
+    static bool get(DeepSkyObject* const& dso, Eigen::Vector3d& position, float& absMag, float& temperature)
+    {
+        if (dso->getObjType() != DeepSkyObjectType::Galaxy || !dso->isVisible())
+            return false;
+
+        position    = dso->getPosition();
+        absMag      = dso->getAbsoluteMagnitude();
+        temperature = 0.0f;
+        return true;
+    }
+};
@@ -8,12 +8,17 @@
 // as published by the Free Software Foundation; either version 2
 // of the License, or (at your option) any later version.
 
+#include <algorithm>
+#include <cmath>
+
+#include <celengine/categoryfilter.h>
 #include <celengine/dsodb.h>
 #include <celengine/deepskyobj.h>
 #include <celrender/galaxyrenderer.h>
 #include <celrender/globularrenderer.h>
 #include <celrender/nebularenderer.h>
 #include <celrender/openclusterrenderer.h>
+#include "pointstarrenderer.h"
 #include "render.h"
 #include "dsorenderer.h"
 
@@ -27,6 +32,7 @@ namespace
 constexpr double enhance = 4.0;
 constexpr double pc10 = 32.6167; // 10 parsecs
 constexpr float CubeCornerToCenterDistance = 1.7320508075688772f;
+const Color GalaxyGlowColor(1.0f, 0.95f, 0.85f);
 
 float
 brightness(float avgAbsMag, float absMag, float appMag, float brightnessCorr, float faintestMag)
@@ -46,6 +52,20 @@ brightness(float avgAbsMag, float absMag, float appMag, float brightnessCorr, fl
     return std::max(0.0f, b * brightnessCorr);
 }
 
+// Widen a depth range to powers of two, so that objects at similar distances
+// end up with identical ranges and the DSO renderers can draw them with one
+// projection matrix. The ratio farZ/nearZ grows by at most a factor of four.
+void
+snapDepthRange(float &nearZ, float &farZ)
+{
+    int exponent;
+    std::frexp(nearZ, &exponent);
+    nearZ = std::ldexp(0.5f, exponent);
+
+    if (std::frexp(farZ, &exponent) != 0.5f)
+        farZ = std::ldexp(1.0f, exponent);
+}
+
 } // anonymous namespace
 
 DSORenderer::DSORenderer() :
@@ -60,6 +80,17 @@ void DSORenderer::process(DeepSkyObject* const &dso,
     if (distanceToDSO > distanceLimit || !dso->isVisible())
         return;
 
+    bool categoryLabeled = false;
+    const Color* categoryColor = nullptr;
+    if (categoryFilter != nullptr)
+    {
+        UserCategoryMask categoryMask = dso->getCategoryMask();
+        if (!categoryFilter->isVisible(categoryMask))
+            return;
+        categoryLabeled = categoryFilter->isLabeled(categoryMask);
+        categoryColor = categoryFilter->getColor(categoryMask);
+    }
+
     Eigen::Vector3f relPos = (dso->getPosition() - obsPos).cast<float>();
     Eigen::Vector3f center = orientationMatrixT * relPos;
 
@@ -71,6 +102,9 @@ void DSORenderer::process(DeepSkyObject* const &dso,
     if (frustum.testSphere(center, (float) dsoRadius) == celmath::Frustum::Outside)
         return;
 
+    if (occluder && occluder->hides(relPos.cast<double>(), dsoRadius))
+        return;
+
     float appMag;
     if (distanceToDSO >= pc10)
         appMag = (float) astro::absToAppMag((double) absMag, distanceToDSO);
@@ -87,7 +121,8 @@ void DSORenderer::process(DeepSkyObject* const &dso,
             // Small objects may be prone to clipping; give them special
             // handling.  We don't want to always set the projection
             // matrix, since that could be expensive with large galaxy
-            // catalogs.
+            // catalogs, so the ranges are snapped to a coarse set shared
+            // by many objects.
             nearZ = static_cast<float>(distanceToDSO / 2.0);
             farZ = static_cast<float>(distanceToDSO + dsoRadius * 2.0 * CubeCornerToCenterDistance);
             auto minZ = static_cast<float>(dsoRadius * 0.001);
@@ -96,6 +131,7 @@ void DSORenderer::process(DeepSkyObject* const &dso,
                 nearZ = minZ;
                 farZ = nearZ * 10000.0f;
             }
+            snapDepthRange(nearZ, farZ);
         }
 
         float b = 2.3f * (faintestMag - 4.75f) / renderer->getFaintestAM45deg(); // brightnesCorr
@@ -130,7 +166,7 @@ void DSORenderer::process(DeepSkyObject* const &dso,
     //
     unsigned int labelMask = dso->getLabelMask();
 
-    if ((labelMask & labelMode) != 0)
+    if ((labelMask & labelMode) != 0 || categoryLabeled)
     {
         Color labelColor;
         float appMagEff = 6.0f;
@@ -174,14 +210,27 @@ void DSORenderer::process(DeepSkyObject* const &dso,
             break;
         }
 
-        if (appMagEff < labelThresholdMag)
+        if (categoryColor != nullptr)
+            labelColor = *categoryColor;
+
+        if (categoryLabeled)
+        {
+            renderer->addBackgroundAnnotation(rep,
+                                              dsoDB->getDSODisplayName(dso),
+                                              labelColor,
+                                              relPos,
+                                              Renderer::LabelHorizontalAlignment::Start,
+                                              Renderer::LabelVerticalAlignment::Center,
+                                              symbolSize);
+        }
+        else if (appMagEff < labelThresholdMag)
         {
             // introduce distance dependent label transparency.
             float distr = std::min(1.0f, step * (labelThresholdMag - appMagEff) / labelThresholdMag);
             labelColor.alpha(distr * labelColor.alpha());
 
             renderer->addBackgroundAnnotation(rep,
-                                              dsoDB->getDSOName(dso, true),
+                                              dsoDB->getDSODisplayName(dso),
                                               labelColor,
                                               relPos,
                                               Renderer::LabelHorizontalAlignment::Start,
@@ -190,3 +239,36 @@ void DSORenderer::process(DeepSkyObject* const &dso,
         }
     }     // labels enabled
 }
+
+
+void DSORenderer::processAggregate(const OctreeAggregate<double>& aggregate,
+                                   double distance,
+                                   float appMag)
+{
+    if ((renderFlags & Renderer::ShowGalaxies) == 0 || appMag > faintestMag)
+        return;
+
+    Eigen::Vector3d offset = aggregate.center - obsPos;
+    if (occluder && occluder->hides(offset, aggregate.radius))
+        return;
+
+    Eigen::Vector3f relPos = offset.cast<float>();
+    if (frustum.testSphere(orientationMatrixT * relPos, static_cast<float>(aggregate.radius)) == celmath::Frustum::Outside)
+        return;
+
+    float pointSize, alpha, glareSize, glareAlpha;
+    float size = BaseStarDiscSize * static_cast<float>(renderer->getScreenDpi()) / 96.0f;
+    renderer->calculatePointSize(appMag, size, pointSize, alpha, glareSize, glareAlpha);
+    if (pointSize == 0.0f)
+        return;
+
+    // Spread the light over the apparent size of the group
+    auto extent = static_cast<float>(2.0 * aggregate.radius / (distance * pixelSize));
+    if (extent > pointSize)
+    {
+        alpha *= (pointSize / extent) * (pointSize / extent);
+        pointSize = std::min(extent, MaxAggregateSize);
+    }
+
+    aggregatePoints.push_back({ relPos, Color(GalaxyGlowColor, alpha), pointSize });
+}
@@ -10,8 +10,10 @@
 
 #pragma once
 
+#include <vector>
 #include <Eigen/Core>
 #include <celengine/projectionmode.h>
+#include <celutil/color.h>
 #include <celmath/frustum.h>
 #include <celrender/rendererfwd.h>
 #include "objectrenderer.h"
@@ -24,6 +26,16 @@ public:
     DSORenderer();
 
     void process(DeepSkyObject* const &, double, float) override;
+    void processAggregate(const OctreeAggregate<double>&, double, float) override;
+
+    // Galaxies too faint or too small to be drawn one by one, as points
+    // for the point star vertex buffer
+    struct AggregatePoint
+    {
+        Eigen::Vector3f position;
+        Color color;
+        float size;
+    };
 
     Eigen::Vector3d     obsPos;
     Eigen::Matrix3f     orientationMatrixT;
@@ -33,6 +45,8 @@ public:
     float               avgAbsMag       { 0.0f };
     uint32_t            dsosProcessed   { 0 };
 
+    std::vector<AggregatePoint> aggregatePoints;
+
     celestia::render::GalaxyRenderer      *galaxyRenderer{ nullptr };
     celestia::render::GlobularRenderer    *globularRenderer{ nullptr };
     celestia::render::NebulaRenderer      *nebulaRenderer{ nullptr };
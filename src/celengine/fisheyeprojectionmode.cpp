@@ -77,6 +77,11 @@ float FisheyeProjectionMode::getNormalizedDeviceZ(float nearZ, float farZ, float
     return 1.0f - (z - nearZ) / d0 * 2.0f;
 }
 
+bool FisheyeProjectionMode::isPerspective() const
+{
+    return false;
+}
+
 Eigen::Vector3f FisheyeProjectionMode::getPickRay(float x, float y, float /*zoom*/) const
 {
     float r = std::hypot(x, y);
@@ -16,6 +16,7 @@
 #include <celengine/deepskyobj.h>
 #include <celengine/location.h>
 #include <celengine/frame.h>
+#include <celephem/cachebypass.h>
 
 using namespace Eigen;
 using namespace std;
@@ -457,6 +458,9 @@ CachingFrame::CachingFrame(Selection _center) :
 Quaterniond
 CachingFrame::getOrientation(double tjd) const
 {
+    if (celestia::ephem::CacheBypass::active())
+        return computeOrientation(tjd);
+
     if (tjd != lastTime)
     {
         lastTime = tjd;
@@ -476,6 +480,9 @@ CachingFrame::getOrientation(double tjd) const
 
 Vector3d CachingFrame::getAngularVelocity(double tjd) const
 {
+    if (celestia::ephem::CacheBypass::active())
+        return computeAngularVelocity(tjd);
+
     if (tjd != lastTime)
     {
         lastTime = tjd;
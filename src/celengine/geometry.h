@@ -10,9 +10,12 @@
 
 #pragma once
 
+#include <vector>
+
 #include <Eigen/Geometry>
 
 #include <celmodel/material.h>
+#include <celutil/reshandle.h>
 
 class RenderContext;
 
@@ -51,4 +54,11 @@ public:
     virtual void loadTextures()
     {
     }
+
+    /*! Append the texture manager handles of the textures used by the
+     *  model, so that they can be preloaded.
+     */
+    virtual void getTextureHandles(std::vector<ResourceHandle>& /*handles*/) const
+    {
+    }
 };
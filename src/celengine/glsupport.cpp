@@ -11,6 +11,7 @@ CELAPI bool OES_geometry_shader            = false;
 #else
 CELAPI bool ARB_vertex_array_object        = false;
 CELAPI bool ARB_framebuffer_object         = false;
+CELAPI bool ARB_clip_control               = false;
 #endif
 CELAPI bool ARB_shader_texture_lod         = false;
 CELAPI bool EXT_texture_compression_s3tc   = false;
@@ -48,6 +49,7 @@ bool init(util::array_view<std::string> ignore) noexcept
 #else
     ARB_vertex_array_object        = check_extension(ignore, "GL_ARB_vertex_array_object");
     ARB_framebuffer_object         = check_extension(ignore, "GL_ARB_framebuffer_object") || check_extension(ignore, "GL_EXT_framebuffer_object");
+    ARB_clip_control               = check_extension(ignore, "GL_ARB_clip_control") || checkVersion(GL_4_5);
 #endif
     ARB_shader_texture_lod         = check_extension(ignore, "GL_ARB_shader_texture_lod");
     EXT_texture_compression_s3tc   = check_extension(ignore, "GL_EXT_texture_compression_s3tc");
@@ -31,6 +31,7 @@ enum Version
     GL_3_1   = 31,
     GL_3_2   = 32,
     GL_3_3   = 33,
+    GL_4_5   = 45,
     GLES_2   = 20,
     GLES_2_0 = 20,
     GLES_3   = 30,
@@ -50,6 +51,7 @@ extern CELAPI bool OES_geometry_shader; //NOSONAR
 #else
 extern CELAPI bool ARB_vertex_array_object; //NOSONAR
 extern CELAPI bool ARB_framebuffer_object; //NOSONAR
+extern CELAPI bool ARB_clip_control; //NOSONAR
 #endif
 extern CELAPI GLint maxPointSize; //NOSONAR
 extern CELAPI GLint maxTextureSize; //NOSONAR
@@ -0,0 +1,308 @@
+// glupload.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Texture uploads on a shared GL context or in per-frame slices.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include "glupload.h"
+
+#include <algorithm>
+#include <future>
+#include <utility>
+
+#include <celutil/logger.h>
+
+using celestia::util::GetLogger;
+
+namespace celestia::engine
+{
+
+namespace
+{
+
+bool
+hasFences()
+{
+#ifdef GL_ES
+    return gl::checkVersion(gl::GLES_3);
+#else
+    return gl::checkVersion(gl::GL_3_2) || epoxy_has_gl_extension("GL_ARB_sync");
+#endif
+}
+
+} // end unnamed namespace
+
+
+void
+UploadJob::addStep(std::size_t bytes, Step&& step)
+{
+    steps.push_back({ bytes, std::move(step) });
+}
+
+
+void
+UploadJob::keepAlive(std::shared_ptr<const void>&& _data)
+{
+    data = std::move(_data);
+}
+
+
+void
+UploadJob::run()
+{
+    bool last = steps.empty();
+    while (!last)
+        runStep(last);
+    finish();
+}
+
+
+std::size_t
+UploadJob::runStep(bool& last)
+{
+    StepInfo& step = steps[nextStep++];
+    step.run();
+    // Release what the step captured
+    step.run = nullptr;
+    last = nextStep == steps.size();
+    return step.bytes;
+}
+
+
+void
+UploadJob::finish()
+{
+    data = nullptr;
+    ready.store(true, std::memory_order_release);
+}
+
+
+GLUploader::~GLUploader()
+{
+    stopThread();
+}
+
+
+bool
+GLUploader::startThread(std::unique_ptr<SharedGLContext>&& sharedContext)
+{
+    if (thread.joinable() || sharedContext == nullptr)
+        return false;
+
+    if (!hasFences())
+    {
+        GetLogger()->info("GL fences unavailable, uploading textures on the render thread\n");
+        return false;
+    }
+
+    context = std::move(sharedContext);
+    std::promise<bool> started;
+    std::future<bool> result = started.get_future();
+    thread = std::thread([this, started = std::move(started)]() mutable
+    {
+        bool current = context->makeCurrent();
+        started.set_value(current);
+        if (current)
+        {
+            threadMain();
+            context->doneCurrent();
+        }
+    });
+
+    if (!result.get())
+    {
+        thread.join();
+        context = nullptr;
+        GetLogger()->warn("Failed to activate the shared GL context, uploading textures on the render thread\n");
+        return false;
+    }
+
+    return true;
+}
+
+
+void
+GLUploader::stopThread()
+{
+    if (!thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+    context = nullptr;
+    stopping = false;
+}
+
+
+void
+GLUploader::threadMain()
+{
+    for (;;)
+    {
+        std::shared_ptr<UploadJob> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || (credit > 0 && !queue.empty()); });
+            if (stopping)
+                return;
+
+            job = queue.front();
+            running = job.get();
+        }
+
+        // Only this thread advances the steps of a queued job
+        bool last = false;
+        std::size_t bytes = job->runStep(last);
+
+        GLsync fence = nullptr;
+        if (last)
+        {
+            fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            // The fence must reach the GL before another context waits on it
+            glFlush();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            credit -= std::min(credit, bytes);
+            running = nullptr;
+            if (last && !job->cancelled)
+            {
+                queue.pop_front();
+                fenced.push_back({ std::move(job), fence });
+                fence = nullptr;
+            }
+        }
+        idle.notify_all();
+
+        if (fence != nullptr)
+            glDeleteSync(fence);
+    }
+}
+
+
+void
+GLUploader::submit(const std::shared_ptr<UploadJob>& job)
+{
+    if (job->steps.empty())
+    {
+        job->finish();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(job);
+    }
+    wake.notify_one();
+}
+
+
+void
+GLUploader::cancel(const std::shared_ptr<UploadJob>& job)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    job->cancelled = true;
+    idle.wait(lock, [this, &job] { return running != job.get(); });
+
+    queue.erase(std::remove(queue.begin(), queue.end(), job), queue.end());
+    auto fencedEnd = std::remove_if(fenced.begin(), fenced.end(),
+                                    [&job](const FencedJob& f) { return f.job == job; });
+    for (auto iter = fencedEnd; iter != fenced.end(); ++iter)
+        glDeleteSync(iter->fence);
+    fenced.erase(fencedEnd, fenced.end());
+
+    job->steps.clear();
+    job->data = nullptr;
+}
+
+
+unsigned int
+GLUploader::updateFences()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    unsigned int completed = 0;
+    auto iter = fenced.begin();
+    while (iter != fenced.end())
+    {
+        GLenum status = glClientWaitSync(iter->fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            ++iter;
+            continue;
+        }
+
+        glDeleteSync(iter->fence);
+        iter->job->finish();
+        iter = fenced.erase(iter);
+        ++completed;
+    }
+
+    return completed;
+}
+
+
+unsigned int
+GLUploader::update(std::size_t budget)
+{
+    // Jobs fenced before the thread was stopped are checked here as well
+    unsigned int completed = updateFences();
+    if (thread.joinable())
+    {
+        {
+            // Budget not used in the last frame isn't carried over
+            std::lock_guard<std::mutex> lock(mutex);
+            credit = budget;
+        }
+        wake.notify_one();
+        return completed;
+    }
+
+    // The objects are shared, so the steps left by a stopped thread can
+    // continue here.
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t spent = 0;
+    while (!queue.empty() && spent < budget)
+    {
+        UploadJob& job = *queue.front();
+        bool last = false;
+        spent += job.runStep(last);
+        if (last)
+        {
+            job.finish();
+            queue.pop_front();
+            ++completed;
+        }
+    }
+
+    return completed;
+}
+
+
+std::size_t
+GLUploader::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size() + fenced.size();
+}
+
+
+GLUploader&
+GetGLUploader()
+{
+    static GLUploader* uploader = nullptr;
+    if (uploader == nullptr)
+        uploader = std::make_unique<GLUploader>().release();
+    return *uploader;
+}
+
+} // end namespace celestia::engine
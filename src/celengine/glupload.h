@@ -0,0 +1,156 @@
+// glupload.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Texture uploads on a shared GL context or in per-frame slices.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "glsupport.h"
+
+namespace celestia::engine
+{
+
+/*! A GL context in the share group of the render context, created by a
+ *  frontend. makeCurrent() is called once on the upload thread when it
+ *  starts, and doneCurrent() once before it exits.
+ */
+class SharedGLContext
+{
+ public:
+    virtual ~SharedGLContext() = default;
+
+    virtual bool makeCurrent() = 0;
+    virtual void doneCurrent() = 0;
+};
+
+
+/*! The GL calls creating one object, split into steps of roughly known
+ *  size. The steps run in order, either on the upload thread or on the
+ *  render thread, and the job becomes ready once the GL has executed all
+ *  of them.
+ */
+class UploadJob
+{
+ public:
+    using Step = std::function<void()>;
+
+    UploadJob() = default;
+    ~UploadJob() = default;
+    UploadJob(const UploadJob&) = delete;
+    UploadJob& operator=(const UploadJob&) = delete;
+
+    void addStep(std::size_t bytes, Step&& step);
+
+    //! Keep data the steps refer to alive until they have run
+    void keepAlive(std::shared_ptr<const void>&& data);
+
+    //! Run all the steps now on the current context
+    void run();
+
+    bool isReady() const { return ready.load(std::memory_order_acquire); }
+
+ private:
+    struct StepInfo
+    {
+        std::size_t bytes;
+        Step run;
+    };
+
+    // Run the next step, returning its size; sets last if it was the last
+    std::size_t runStep(bool& last);
+    void finish();
+
+    std::vector<StepInfo> steps;
+    std::size_t nextStep{ 0 };
+    std::shared_ptr<const void> data;
+    std::atomic<bool> ready{ false };
+    // Guarded by the uploader mutex
+    bool cancelled{ false };
+
+    friend class GLUploader;
+};
+
+
+/*! Runs upload jobs without stalling the render thread. With a shared
+ *  context, a dedicated thread executes the steps and places a fence after
+ *  each job; the render thread marks the job ready once its fence has
+ *  signalled. Without one, the steps are executed on the render thread.
+ *  Either way, update() hands out a per-frame budget of bytes, so large
+ *  images are spread over several frames.
+ */
+class GLUploader
+{
+ public:
+    GLUploader() = default;
+    ~GLUploader();
+
+    GLUploader(const GLUploader&) = delete;
+    GLUploader& operator=(const GLUploader&) = delete;
+
+    /*! Start the upload thread. Returns false, leaving uploads on the render
+     *  thread, when the GL lacks fences or the context can't be made current.
+     */
+    bool startThread(std::unique_ptr<SharedGLContext>&& sharedContext);
+    //! Stop the upload thread; the jobs left are finished on the render thread
+    void stopThread();
+    bool hasThread() const { return thread.joinable(); }
+
+    void submit(const std::shared_ptr<UploadJob>& job);
+
+    /*! Drop a job that isn't ready, waiting for a step that is running.
+     *  Must be called before deleting the objects the job uploads to.
+     */
+    void cancel(const std::shared_ptr<UploadJob>& job);
+
+    /*! Called by the render thread once per frame with the bytes that may be
+     *  uploaded until the next call. Returns the number of jobs completed.
+     */
+    unsigned int update(std::size_t budget);
+
+    //! Number of jobs submitted and not ready yet
+    std::size_t getPendingCount() const;
+
+ private:
+    struct FencedJob
+    {
+        std::shared_ptr<UploadJob> job;
+        GLsync fence;
+    };
+
+    void threadMain();
+    unsigned int updateFences();
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<std::shared_ptr<UploadJob>> queue;
+    std::vector<FencedJob> fenced;
+    // Job whose step the upload thread is running
+    const UploadJob* running{ nullptr };
+    std::size_t credit{ 0 };
+    bool stopping{ false };
+
+    std::unique_ptr<SharedGLContext> context;
+    std::thread thread;
+};
+
+
+GLUploader& GetGLUploader();
+
+} // end namespace celestia::engine
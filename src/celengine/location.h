@@ -12,6 +12,7 @@
 #include <string>
 #include <celengine/astroobj.h>
 #include <celutil/color.h>
+#include <celutil/memoryusage.h>
 #include <Eigen/Core>
 
 class Selection;
@@ -134,4 +135,5 @@ public:
     bool overrideLabelColor{ false };
     Color labelColor{ 1.0f, 1.0f, 1.0f };
     std::string infoURL;
+    celestia::util::MemoryTracker memory{ celestia::util::MemoryCategory::Locations, sizeof(Location) };
 };
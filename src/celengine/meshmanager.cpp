@@ -10,9 +10,11 @@
 
 #include "meshmanager.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <functional>
 #include <ios>
 #include <utility>
 #include <vector>
@@ -38,6 +40,8 @@ using celestia::util::GetLogger;
 namespace
 {
 
+using TextureGetter = GeometryInfo::TextureGetter;
+
 std::unique_ptr<cmod::Model>
 LoadCelestiaMesh(const fs::path& filename)
 {
@@ -294,7 +298,7 @@ ConvertTriangleMesh(const M3DTriangleMesh& mesh,
 
 
 std::unique_ptr<cmod::Model>
-Convert3DSModel(const M3DScene& scene, const fs::path& texPath)
+Convert3DSModel(const M3DScene& scene, const fs::path& texPath, const TextureGetter& getTexture)
 {
     auto model = std::make_unique<cmod::Model>();
 
@@ -323,7 +327,7 @@ Convert3DSModel(const M3DScene& scene, const fs::path& texPath)
 
         if (!material->getTextureMap().empty())
         {
-            ResourceHandle tex = GetTextureManager()->getHandle(TextureInfo(material->getTextureMap(), texPath, TextureInfo::WrapTexture));
+            ResourceHandle tex = getTexture(TextureInfo(material->getTextureMap(), texPath, TextureInfo::WrapTexture));
             newMaterial.setMap(cmod::TextureSemantic::DiffuseMap, tex);
         }
 
@@ -357,13 +361,13 @@ Convert3DSModel(const M3DScene& scene, const fs::path& texPath)
 
 
 std::unique_ptr<cmod::Model>
-Load3DSModel(const GeometryInfo::ResourceKey& key, const fs::path& path)
+Load3DSModel(const GeometryInfo::ResourceKey& key, const fs::path& path, const TextureGetter& getTexture)
 {
     std::unique_ptr<M3DScene> scene = Read3DSFile(key.resolvedPath);
     if (scene == nullptr)
         return nullptr;
 
-    std::unique_ptr<cmod::Model> model = Convert3DSModel(*scene, key.resolvedToPath ? path : fs::path());
+    std::unique_ptr<cmod::Model> model = Convert3DSModel(*scene, key.resolvedToPath ? path : fs::path(), getTexture);
 
     if (key.isNormalized)
         model->normalize(key.center);
@@ -375,7 +379,7 @@ Load3DSModel(const GeometryInfo::ResourceKey& key, const fs::path& path)
 
 
 std::unique_ptr<cmod::Model>
-LoadCMODModel(const GeometryInfo::ResourceKey& key, const fs::path& path)
+LoadCMODModel(const GeometryInfo::ResourceKey& key, const fs::path& path, const TextureGetter& getTexture)
 {
     std::ifstream in(key.resolvedPath, std::ios::binary);
     if (!in.good())
@@ -385,7 +389,7 @@ LoadCMODModel(const GeometryInfo::ResourceKey& key, const fs::path& path)
         in,
         [&](const fs::path& name)
         {
-            return GetTextureManager()->getHandle(TextureInfo(name, path, TextureInfo::WrapTexture));
+            return getTexture(TextureInfo(name, path, TextureInfo::WrapTexture));
         });
 
     if (model == nullptr)
@@ -447,6 +451,67 @@ GeometryInfo::resolve(const fs::path& baseDir) const
 
 std::unique_ptr<Geometry>
 GeometryInfo::load(const ResourceKey& key) const
+{
+    std::unique_ptr<cmod::Model> model = loadModel(key, [](const TextureInfo& info)
+    {
+        return GetTextureManager()->getHandle(info);
+    });
+
+    if (model == nullptr)
+        return nullptr;
+
+    return std::make_unique<ModelGeometry>(std::move(model));
+}
+
+
+std::unique_ptr<GeometryInfo::PreparedModel>
+GeometryInfo::prepare(const ResourceKey& key) const
+{
+    // The texture manager may only be used from the main thread, so the
+    // textures are collected and the model's handles index them for now.
+    auto prepared = std::make_unique<PreparedModel>();
+    prepared->model = loadModel(key, [&prepared](const TextureInfo& info)
+    {
+        auto& textures = prepared->textures;
+        auto iter = std::find_if(textures.begin(), textures.end(),
+                                 [&info](const TextureInfo& t) { return !(t < info) && !(info < t); });
+        if (iter == textures.end())
+            iter = textures.insert(textures.end(), info);
+        return static_cast<ResourceHandle>(iter - textures.begin());
+    });
+
+    if (prepared->model == nullptr)
+        return nullptr;
+
+    return prepared;
+}
+
+
+std::unique_ptr<Geometry>
+GeometryInfo::load(const ResourceKey& key, std::unique_ptr<PreparedModel>&& prepared) const
+{
+    if (prepared == nullptr)
+        return load(key);
+
+    cmod::Model& model = *prepared->model;
+    for (unsigned int i = 0; i < model.getMaterialCount(); ++i)
+    {
+        cmod::Material material = model.getMaterial(i)->clone();
+        for (int j = 0; j < static_cast<int>(cmod::TextureSemantic::TextureSemanticMax); ++j)
+        {
+            auto semantic = static_cast<cmod::TextureSemantic>(j);
+            if (ResourceHandle index = material.getMap(semantic); index != InvalidResource)
+                material.setMap(semantic, GetTextureManager()->getHandle(prepared->textures[index]));
+        }
+        model.setMaterial(i, std::move(material));
+    }
+
+    return std::make_unique<ModelGeometry>(std::move(prepared->model));
+}
+
+
+std::unique_ptr<cmod::Model>
+GeometryInfo::loadModel(const ResourceKey& key, const TextureGetter& getTexture) const
 {
     GetLogger()->info(_("Loading model: {}\n"), key.resolvedPath);
     std::unique_ptr<cmod::Model> model = nullptr;
@@ -454,10 +519,10 @@ GeometryInfo::load(const ResourceKey& key) const
     switch (ContentType fileType = DetermineFileType(key.resolvedPath); fileType)
     {
     case ContentType::_3DStudio:
-        model = Load3DSModel(key, path);
+        model = Load3DSModel(key, path, getTexture);
         break;
     case ContentType::CelestiaModel:
-        model = LoadCMODModel(key, path);
+        model = LoadCMODModel(key, path, getTexture);
         break;
     case ContentType::CelestiaMesh:
         model = LoadCMSModel(key);
@@ -496,5 +561,5 @@ GeometryInfo::load(const ResourceKey& key) const
                          originalMaterialCount,
                          model->getMaterialCount());
 
-    return std::make_unique<ModelGeometry>(std::move(model));
+    return model;
 }
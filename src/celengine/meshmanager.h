@@ -9,15 +9,19 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include <Eigen/Core>
 
 #include <celcompat/filesystem.h>
+#include <celmodel/model.h>
 #include <celutil/resmanager.h>
 #include "geometry.h"
+#include "texmanager.h"
 
 
 class GeometryInfo
@@ -46,6 +50,17 @@ class GeometryInfo
         {}
     };
 
+    //! A model loaded off the main thread by prepare()
+    struct PreparedModel
+    {
+        std::unique_ptr<cmod::Model> model;
+        //! Textures of the model, indexed by its texture handles until load()
+        std::vector<TextureInfo> textures;
+    };
+
+    //! Returns the handle a model should use for a texture
+    using TextureGetter = std::function<ResourceHandle(const TextureInfo&)>;
+
  private:
     fs::path source;
     fs::path path;
@@ -57,6 +72,7 @@ class GeometryInfo
 
  public:
     using ResourceType = Geometry;
+    using PreparedType = PreparedModel;
 
     GeometryInfo(const fs::path& _source,
                  const fs::path& _path = "") :
@@ -81,6 +97,12 @@ class GeometryInfo
 
     ResourceKey resolve(const fs::path&) const;
     std::unique_ptr<Geometry> load(const ResourceKey&) const;
+
+    std::unique_ptr<PreparedModel> prepare(const ResourceKey&) const;
+    std::unique_ptr<Geometry> load(const ResourceKey&, std::unique_ptr<PreparedModel>&&) const;
+
+ private:
+    std::unique_ptr<cmod::Model> loadModel(const ResourceKey&, const TextureGetter&) const;
 };
 
 inline bool operator<(const GeometryInfo& g0, const GeometryInfo& g1)
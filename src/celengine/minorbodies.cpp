@@ -0,0 +1,335 @@
+// minorbodies.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Compact storage for large catalogs of minor planets.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include "minorbodies.h"
+
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <system_error>
+
+#include <celcompat/charconv.h>
+#include <celcompat/numbers.h>
+#include <celephem/orbit.h>
+#include <celmath/mathlib.h>
+#include <celutil/logger.h>
+#include <celutil/stringutils.h>
+#include "astro.h"
+
+using celestia::util::GetLogger;
+
+namespace
+{
+
+// Gaussian gravitational constant, radians per day
+constexpr double GaussianConstant = 0.01720209895;
+
+// Extract a field given as 1-based inclusive column numbers, as in the
+// MPC documentation, with surrounding blanks removed.
+std::string_view
+field(std::string_view line, std::size_t first, std::size_t last)
+{
+    if (line.size() < first)
+        return {};
+
+    auto value = line.substr(first - 1, last - first + 1);
+    auto start = value.find_first_not_of(' ');
+    if (start == std::string_view::npos)
+        return {};
+    auto end = value.find_last_not_of(" \r");
+    return value.substr(start, end - start + 1);
+}
+
+template<typename T>
+bool
+parseNumber(std::string_view str, T& value)
+{
+    using celestia::compat::from_chars;
+    if (str.empty())
+        return false;
+    auto [ptr, ec] = from_chars(str.data(), str.data() + str.size(), value);
+    return ec == std::errc{} && ptr == str.data() + str.size();
+}
+
+// Digits of the packed form: 0-9, then A-Z for 10-35
+int
+unpackDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// Epochs are packed as century letter (I, J, K for 1800, 1900, 2000), two
+// digits of year and single character month and day, e.g. K239D for
+// 2023 September 13.
+bool
+unpackEpoch(std::string_view packed, double& jd)
+{
+    if (packed.size() != 5 || packed[0] < 'I' || packed[0] > 'L')
+        return false;
+
+    int yearInCentury;
+    if (!parseNumber(packed.substr(1, 2), yearInCentury))
+        return false;
+
+    int month = unpackDigit(packed[3]);
+    int day = unpackDigit(packed[4]);
+    if (month < 1 || month > 12 || day < 1 || day > 31)
+        return false;
+
+    int year = (packed[0] - 'I' + 18) * 100 + yearInCentury;
+    jd = astro::Date(year, month, day);
+    return true;
+}
+
+// Parse a line of MPCORB.DAT; see
+// https://minorplanetcenter.net/iau/info/MPOrbitFormat.html
+bool
+parseMPCOrbitLine(std::string_view line,
+                  std::string& name,
+                  std::uint32_t& number,
+                  MinorBodyCatalog::Elements& elements)
+{
+    if (line.size() < 103)
+        return false;
+
+    if (!unpackEpoch(field(line, 21, 25), elements.epoch) ||
+        !parseNumber(field(line, 27, 35), elements.meanAnomaly) ||
+        !parseNumber(field(line, 38, 46), elements.argOfPericenter) ||
+        !parseNumber(field(line, 49, 57), elements.ascendingNode) ||
+        !parseNumber(field(line, 60, 68), elements.inclination) ||
+        !parseNumber(field(line, 71, 79), elements.eccentricity) ||
+        !parseNumber(field(line, 93, 103), elements.semiMajorAxis))
+    {
+        return false;
+    }
+
+    // Only elliptical orbits are stored
+    if (elements.eccentricity >= 1.0 || elements.semiMajorAxis <= 0.0)
+        return false;
+
+    // Magnitude parameters may be blank
+    if (float h; parseNumber(field(line, 9, 13), h))
+        elements.absMag = h;
+    if (float g; parseNumber(field(line, 15, 19), g))
+        elements.slopeParameter = g;
+
+    // The readable designation is either "(number) Name" for numbered
+    // objects or a provisional designation such as "2023 AB1". Fall back to
+    // the packed designation if it is missing.
+    number = 0;
+    auto designation = field(line, 167, 194);
+    if (designation.empty())
+        designation = field(line, 1, 7);
+
+    if (!designation.empty() && designation.front() == '(')
+    {
+        auto close = designation.find(')');
+        if (close == std::string_view::npos || !parseNumber(designation.substr(1, close - 1), number))
+            return false;
+        designation = field(designation, close + 2, designation.size());
+    }
+
+    if (designation.empty())
+        return false;
+
+    name.assign(designation);
+    return true;
+}
+
+} // end unnamed namespace
+
+
+MinorBodyCatalog::MinorBodyCatalog(Star* _primary) :
+    primary(_primary)
+{
+}
+
+
+MinorBodyCatalog::IndexNumber
+MinorBodyCatalog::add(std::string_view name,
+                      std::uint32_t number,
+                      const Elements& elements)
+{
+    auto index = static_cast<IndexNumber>(size());
+
+    epochs.push_back(elements.epoch);
+    meanAnomalies.push_back(elements.meanAnomaly);
+    argsOfPericenter.push_back(elements.argOfPericenter);
+    ascendingNodes.push_back(elements.ascendingNode);
+    inclinations.push_back(elements.inclination);
+    eccentricities.push_back(elements.eccentricity);
+    semiMajorAxes.push_back(elements.semiMajorAxis);
+    absMags.push_back(elements.absMag);
+    slopeParameters.push_back(elements.slopeParameter);
+    numbers.push_back(number);
+
+    names.append(name);
+    nameOffsets.push_back(static_cast<std::uint32_t>(names.size()));
+
+    return index;
+}
+
+
+void
+MinorBodyCatalog::finish()
+{
+    nameIndex.resize(size());
+    for (IndexNumber i = 0; i < nameIndex.size(); ++i)
+        nameIndex[i] = i;
+
+    std::sort(nameIndex.begin(), nameIndex.end(),
+              [this](IndexNumber a, IndexNumber b) { return compareIgnoringCase(getName(a), getName(b)) < 0; });
+
+    // Trim the spare capacity left by loading
+    names.shrink_to_fit();
+    nameOffsets.shrink_to_fit();
+    epochs.shrink_to_fit();
+    meanAnomalies.shrink_to_fit();
+    argsOfPericenter.shrink_to_fit();
+    ascendingNodes.shrink_to_fit();
+    inclinations.shrink_to_fit();
+    eccentricities.shrink_to_fit();
+    semiMajorAxes.shrink_to_fit();
+    absMags.shrink_to_fit();
+    slopeParameters.shrink_to_fit();
+    numbers.shrink_to_fit();
+}
+
+
+MinorBodyCatalog::IndexNumber
+MinorBodyCatalog::find(std::string_view name) const
+{
+    auto it = std::lower_bound(nameIndex.begin(), nameIndex.end(), name,
+                               [this](IndexNumber a, std::string_view n) { return compareIgnoringCase(getName(a), n) < 0; });
+    if (it != nameIndex.end() && compareIgnoringCase(getName(*it), name) == 0)
+        return *it;
+
+    // Names prefixed with the minor planet number, as in "1 Ceres"
+    std::uint32_t number;
+    if (auto space = name.find(' '); space != std::string_view::npos && parseNumber(name.substr(0, space), number))
+    {
+        IndexNumber index = find(name.substr(space + 1));
+        if (index != InvalidIndex && numbers[index] == number)
+            return index;
+    }
+
+    return InvalidIndex;
+}
+
+
+std::string_view
+MinorBodyCatalog::getName(IndexNumber index) const
+{
+    std::string_view all = names;
+    return all.substr(nameOffsets[index], nameOffsets[index + 1] - nameOffsets[index]);
+}
+
+
+MinorBodyCatalog::Elements
+MinorBodyCatalog::getElements(IndexNumber index) const
+{
+    return Elements
+    {
+        epochs[index],
+        meanAnomalies[index],
+        argsOfPericenter[index],
+        ascendingNodes[index],
+        inclinations[index],
+        eccentricities[index],
+        semiMajorAxes[index],
+        absMags[index],
+        slopeParameters[index],
+    };
+}
+
+
+double
+MinorBodyCatalog::getPeriod(IndexNumber index) const
+{
+    double a = semiMajorAxes[index];
+    return 2.0 * celestia::numbers::pi / GaussianConstant * a * std::sqrt(a);
+}
+
+
+float
+MinorBodyCatalog::getRadius(IndexNumber index) const
+{
+    if (std::isnan(absMags[index]))
+        return 0.0f;
+
+    // D = 1329 km / sqrt(p) * 10^(-H/5)
+    double diameter = 1329.0 / std::sqrt(DefaultAlbedo) * std::pow(10.0, -0.2 * absMags[index]);
+    return static_cast<float>(diameter / 2.0);
+}
+
+
+Eigen::Vector3d
+MinorBodyCatalog::getPosition(IndexNumber index, double tjd) const
+{
+    celestia::ephem::EllipticalOrbit orbit(semiMajorAxes[index] * (1.0 - eccentricities[index]) * KM_PER_AU<double>,
+                                           eccentricities[index],
+                                           celmath::degToRad(inclinations[index]),
+                                           celmath::degToRad(ascendingNodes[index]),
+                                           celmath::degToRad(argsOfPericenter[index]),
+                                           celmath::degToRad(meanAnomalies[index]),
+                                           getPeriod(index),
+                                           epochs[index]);
+    return orbit.positionAtTime(tjd);
+}
+
+
+Body*
+MinorBodyCatalog::getBody(IndexNumber index) const
+{
+    auto it = promoted.find(index);
+    return it == promoted.end() ? nullptr : it->second;
+}
+
+
+void
+MinorBodyCatalog::setBody(IndexNumber index, Body* body)
+{
+    promoted[index] = body;
+}
+
+
+std::size_t
+LoadMPCOrbitElements(std::istream& in, MinorBodyCatalog& catalog)
+{
+    std::size_t count = 0;
+    std::size_t skipped = 0;
+    std::string line;
+    std::string name;
+    while (std::getline(in, line))
+    {
+        std::uint32_t number;
+        MinorBodyCatalog::Elements elements;
+        if (!parseMPCOrbitLine(line, name, number, elements))
+        {
+            // Blank lines and the header of MPCORB.DAT are expected
+            if (line.size() >= 103)
+                ++skipped;
+            continue;
+        }
+
+        catalog.add(name, number, elements);
+        ++count;
+    }
+
+    if (skipped > 0)
+        GetLogger()->warn("Skipped {} unreadable lines in minor planet orbit file\n", skipped);
+
+    return count;
+}
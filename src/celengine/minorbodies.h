@@ -0,0 +1,125 @@
+// minorbodies.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Compact storage for large catalogs of minor planets.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Core>
+
+class Body;
+class Star;
+
+/*! A catalog of minor bodies orbiting a star, kept as columns of orbital
+ *  elements, magnitudes and names rather than as full Body objects. A
+ *  catalog entry needs a little under a hundred bytes, compared to several
+ *  hundred for a Body with its surface, timeline and orbit. Entries are
+ *  promoted to real bodies by the Universe when they are looked up by name
+ *  or modified by a solar system catalog.
+ */
+class MinorBodyCatalog
+{
+ public:
+    using IndexNumber = std::uint32_t;
+    static constexpr IndexNumber InvalidIndex = std::numeric_limits<IndexNumber>::max();
+
+    //! Geometric albedo assumed for sizes, as the MPC does for objects of unknown type
+    static constexpr double DefaultAlbedo = 0.15;
+
+    /*! Osculating elements referred to the J2000 ecliptic. Angles are in
+     *  degrees, the semi-major axis in AU and the epoch is a Julian date.
+     */
+    struct Elements
+    {
+        double epoch;
+        double meanAnomaly;
+        double argOfPericenter;
+        double ascendingNode;
+        double inclination;
+        double eccentricity;
+        double semiMajorAxis;
+        float absMag{ std::numeric_limits<float>::quiet_NaN() };
+        float slopeParameter{ 0.15f };
+    };
+
+    explicit MinorBodyCatalog(Star* primary);
+    ~MinorBodyCatalog() = default;
+
+    MinorBodyCatalog(const MinorBodyCatalog&) = delete;
+    MinorBodyCatalog& operator=(const MinorBodyCatalog&) = delete;
+
+    Star* getPrimary() const { return primary; }
+    std::size_t size() const { return epochs.size(); }
+
+    //! Add an entry; number is the minor planet number or 0 if unnumbered
+    IndexNumber add(std::string_view name, std::uint32_t number, const Elements& elements);
+
+    //! Build the name index; must be called once all entries are added.
+    void finish();
+
+    //! Find an entry by name, or by name prefixed with its number
+    IndexNumber find(std::string_view name) const;
+
+    std::string_view getName(IndexNumber index) const;
+    std::uint32_t getNumber(IndexNumber index) const { return numbers[index]; }
+    Elements getElements(IndexNumber index) const;
+
+    //! Orbital period in days
+    double getPeriod(IndexNumber index) const;
+
+    /*! Radius in km estimated from the absolute magnitude, assuming the
+     *  default albedo. Returns 0 for entries without a magnitude.
+     */
+    float getRadius(IndexNumber index) const;
+
+    //! Position in km relative to the primary in Celestia's ecliptic frame
+    Eigen::Vector3d getPosition(IndexNumber index, double tjd) const;
+
+    Body* getBody(IndexNumber index) const;
+    void setBody(IndexNumber index, Body* body);
+    //! Number of entries with a body
+    std::size_t getBodyCount() const { return promoted.size(); }
+
+ private:
+    Star* primary;
+
+    std::vector<double> epochs;
+    std::vector<double> meanAnomalies;
+    std::vector<double> argsOfPericenter;
+    std::vector<double> ascendingNodes;
+    std::vector<double> inclinations;
+    std::vector<double> eccentricities;
+    std::vector<double> semiMajorAxes;
+    std::vector<float> absMags;
+    std::vector<float> slopeParameters;
+    std::vector<std::uint32_t> numbers;
+
+    // Names are packed into one buffer; entry i spans
+    // [nameOffsets[i], nameOffsets[i + 1]).
+    std::string names;
+    std::vector<std::uint32_t> nameOffsets{ 0 };
+    // Entries sorted by name, ignoring case
+    std::vector<IndexNumber> nameIndex;
+
+    std::unordered_map<IndexNumber, Body*> promoted;
+};
+
+/*! Read an orbital element file in the fixed-width format of the Minor
+ *  Planet Center's MPCORB.DAT. Header lines and lines that can't be parsed
+ *  are skipped. Returns the number of entries added.
+ */
+std::size_t LoadMPCOrbitElements(std::istream& in, MinorBodyCatalog& catalog);
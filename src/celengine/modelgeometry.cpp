@@ -15,6 +15,7 @@
 #include <celrender/gl/vertexobject.h>
 #include <celutil/gettext.h>
 #include <celutil/logger.h>
+#include <celutil/memoryusage.h>
 #include "glsupport.h"
 #include "modelgeometry.h"
 #include "rendcontext.h"
@@ -76,6 +77,22 @@ convert(cmod::VertexAttributeSemantic semantic)
     }
 }
 
+// Vertex and index data of the meshes of a model
+std::size_t
+modelDataSize(const cmod::Model& model)
+{
+    std::size_t size = 0;
+    for (unsigned int i = 0; i < model.getMeshCount(); ++i)
+    {
+        const cmod::Mesh* mesh = model.getMesh(i);
+        size += mesh->getVertexCount() * mesh->getVertexStrideWords() * sizeof(cmod::VWord);
+        for (unsigned int j = 0; j < mesh->getGroupCount(); ++j)
+            size += mesh->getGroup(j)->indices.size() * sizeof(cmod::Index32);
+    }
+
+    return size;
+}
+
 void
 setVertexArrays(gl::VertexObject &vao, const gl::Buffer &vbo, const cmod::VertexDescription& desc)
 {
@@ -112,7 +129,8 @@ public:
   */
 ModelGeometry::ModelGeometry(std::unique_ptr<cmod::Model>&& model) :
     m_model(std::move(model)),
-    m_glData(std::make_unique<ModelOpenGLData>())
+    m_glData(std::make_unique<ModelOpenGLData>()),
+    m_memory(util::MemoryCategory::Models, modelDataSize(*m_model))
 {
 }
 
@@ -246,3 +264,22 @@ ModelGeometry::loadTextures()
     }
 #endif
 }
+
+
+void
+ModelGeometry::getTextureHandles(std::vector<ResourceHandle>& handles) const
+{
+    for (unsigned int i = 0; i < m_model->getMaterialCount(); ++i)
+    {
+        const cmod::Material* material = m_model->getMaterial(i);
+        for (int j = 0; j < static_cast<int>(cmod::TextureSemantic::TextureSemanticMax); ++j)
+        {
+            ResourceHandle handle = material->getMap(static_cast<cmod::TextureSemantic>(j));
+            if (handle != InvalidResource &&
+                std::find(handles.begin(), handles.end(), handle) == handles.end())
+            {
+                handles.push_back(handle);
+            }
+        }
+    }
+}
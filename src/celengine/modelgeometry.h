@@ -15,6 +15,7 @@
 #include <Eigen/Geometry>
 
 #include <celmodel/model.h>
+#include <celutil/memoryusage.h>
 #include "geometry.h"
 
 
@@ -42,9 +43,11 @@ public:
     bool isNormalized() const override;
 
     void loadTextures() override;
+    void getTextureHandles(std::vector<ResourceHandle>& handles) const override;
 
 private:
     std::unique_ptr<cmod::Model> m_model;
     std::unique_ptr<ModelOpenGLData> m_glData;
+    celestia::util::MemoryTracker m_memory;
     bool m_vbInitialized{ false };
 };
@@ -6,6 +6,21 @@
 #include <celutil/utf8.h>
 #include "name.h"
 
+namespace
+{
+
+// Estimated size of an entry of one of the indexes: the tree node, its key
+// and value, and the characters of the name
+template<typename Index>
+std::size_t
+entrySize(const std::string& name)
+{
+    return sizeof(typename Index::value_type) + 4 * sizeof(void*) + name.size();
+}
+
+} // end unnamed namespace
+
+
 std::uint32_t NameDatabase::getNameCount() const
 {
     return nameIndex.size();
@@ -24,16 +39,21 @@ void NameDatabase::add(const AstroCatalog::IndexNumber catalogNumber, const std:
         //nameIndex.insert(NameIndex::value_type(name, catalogNumber));
         std::string fname = ReplaceGreekLetterAbbr(name);
 
-        nameIndex[fname] = catalogNumber;
+        if (nameIndex.insert_or_assign(fname, catalogNumber).second)
+            memory.add(entrySize<NameIndex>(fname));
         std::string lname = D_(fname.c_str());
-        if (lname != fname)
-            localizedNameIndex[lname] = catalogNumber;
+        if (lname != fname && localizedNameIndex.insert_or_assign(lname, catalogNumber).second)
+            memory.add(entrySize<NameIndex>(lname));
         numberIndex.insert(NumberIndex::value_type(catalogNumber, fname));
+        memory.add(entrySize<NumberIndex>(fname));
     }
 }
 void NameDatabase::erase(const AstroCatalog::IndexNumber catalogNumber)
 {
-    numberIndex.erase(catalogNumber);
+    auto [first, last] = numberIndex.equal_range(catalogNumber);
+    for (auto iter = first; iter != last; ++iter)
+        memory.remove(entrySize<NumberIndex>(iter->second));
+    numberIndex.erase(first, last);
 }
 
 AstroCatalog::IndexNumber NameDatabase::getCatalogNumberByName(std::string_view name, bool i18n) const
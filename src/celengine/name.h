@@ -19,6 +19,7 @@
 #include <vector>
 
 #include <celengine/astroobj.h>
+#include <celutil/memoryusage.h>
 #include <celutil/stringutils.h>
 
 // TODO: this can be "detemplatized" by creating e.g. a global-scope enum InvalidCatalogNumber since there
@@ -52,4 +53,5 @@ class NameDatabase
     NameIndex   nameIndex;
     NameIndex   localizedNameIndex;
     NumberIndex numberIndex;
+    celestia::util::MemoryTracker memory{ celestia::util::MemoryCategory::Names };
 };
@@ -13,6 +13,7 @@
 #include <Eigen/Core>
 #include "octree.h"
 
+class CategoryFilter;
 class Observer;
 class Renderer;
 
@@ -26,6 +27,8 @@ template <class OBJ, class PREC> class ObjectRenderer : public OctreeProcessor<O
 
     const Observer* observer    { nullptr };
     Renderer*  renderer         { nullptr };
+    // Null unless the renderer has a category filter with rules
+    const CategoryFilter* categoryFilter { nullptr };
 
     float fov                   { 0.0f };
     float pixelSize             { 0.0f };
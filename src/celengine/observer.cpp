@@ -282,6 +282,30 @@ double Observer::getArrivalTime() const
 }
 
 
+/*! Return the object the observer is travelling to, or an empty selection
+ *  when not on a goto journey.
+ */
+Selection Observer::getJourneyDestination() const
+{
+    if (observerMode != Travelling)
+        return Selection();
+
+    return journey.destination;
+}
+
+
+/*! Return the position in universal coordinates where the current journey
+ *  ends, as of the current time.
+ */
+UniversalCoord Observer::getJourneyEndPosition() const
+{
+    if (observerMode != Travelling)
+        return positionUniv;
+
+    return frame->convertToUniversal(journey.to, getTime());
+}
+
+
 /*! Tick the simulation by dt seconds. Update the observer position
  *  and orientation due to an active goto command or non-zero velocity
  *  or angular velocity.
@@ -584,6 +608,7 @@ void Observer::computeGotoParameters(const Selection& destination,
     jparams.traj = Linear;
     jparams.duration = gotoTime;
     jparams.startTime = realTime;
+    jparams.destination = destination;
 
     // Right where we are now . . .
     jparams.from = getPosition();
@@ -647,6 +672,7 @@ void Observer::computeGotoParametersGC(const Selection& destination,
     jparams.traj = GreatCircle;
     jparams.duration = gotoTime;
     jparams.startTime = realTime;
+    jparams.destination = destination;
 
     jparams.centerObject = centerObj;
 
@@ -699,6 +725,7 @@ void Observer::computeCenterParameters(const Selection& destination,
     jparams.duration = centerTime;
     jparams.startTime = realTime;
     jparams.traj = Linear;
+    jparams.destination = Selection();
 
     // Don't move through space, just rotate the camera
     jparams.from = getPosition();
@@ -730,6 +757,7 @@ void Observer::computeCenterCOParameters(const Selection& destination,
     jparams.duration = centerTime;
     jparams.startTime = realTime;
     jparams.traj = CircularOrbit;
+    jparams.destination = Selection();
 
     jparams.centerObject = frame->getRefObject();
     jparams.expFactor = 0.5;
@@ -1244,6 +1272,7 @@ void Observer::gotoLocation(const UniversalCoord& toPosition,
 {
     journey.startTime = realTime;
     journey.duration = duration;
+    journey.destination = Selection();
 
     journey.from = position;
     journey.initialOrientation = transformedOrientation;
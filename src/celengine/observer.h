@@ -215,6 +215,8 @@ public:
     const ObserverFrame::SharedConstPtr &getFrame() const;
 
     double getArrivalTime() const;
+    Selection getJourneyDestination() const;
+    UniversalCoord getJourneyEndPosition() const;
 
     double getTime() const;
     double getRealTime() const;
@@ -251,6 +253,8 @@ public:
         Eigen::Quaterniond rotation1; // rotation on the CircularOrbit around centerObject
 
         Selection centerObject;
+        // Object travelled to by a goto, empty for other journeys
+        Selection destination;
 
         TrajectoryType traj;
     };
@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <vector>
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <celengine/astro.h>
 #include <celengine/observer.h>
-#include <vector>
 
 // The DynamicOctree and StaticOctree template arguments are:
 // OBJ:  object hanging from the node,
@@ -31,6 +36,53 @@ struct OctreeProcStats
     size_t objects { 0 };
 };
 
+// Summary of the objects in the children of an octree node, used to draw
+// them as a single object where they're too faint or too close together to
+// be drawn one by one.
+template <class PREC> struct OctreeAggregate
+{
+    // Luminosity weighted mean and RMS distance from it of the positions
+    Eigen::Matrix<PREC, 3, 1> center;
+    PREC  radius;
+    // Of the total luminosity
+    float absMag;
+    // Luminosity weighted mean, 0 if the objects don't have one
+    float temperature;
+};
+
+
+// A body hiding part of the sky from the observer, such as the planet the
+// observer stands on: everything farther than its center and within angle
+// of its direction is behind it.
+template <class PREC> struct OctreeOccluder
+{
+    // Unit vector from the observer towards the center of the body
+    Eigen::Matrix<PREC, 3, 1> axis;
+    PREC distance;
+    // Cosine of the angular radius of the body
+    PREC cosAngle;
+
+    // Check whether a sphere at offset from the observer is entirely hidden.
+    bool hides(const Eigen::Matrix<PREC, 3, 1>& offset, PREC radius) const
+    {
+        PREC offsetDistance = offset.norm();
+        if (offsetDistance - radius <= distance)
+            return false;
+
+        // The sphere is hidden if the angle to its center plus its angular
+        // radius is less than the angle of the body.
+        PREC cosCenter = offset.dot(axis) / offsetDistance;
+        if (cosCenter <= cosAngle)
+            return false;
+
+        PREC sinCenter = std::sqrt(std::max(PREC(1) - cosCenter * cosCenter, PREC(0)));
+        PREC sinSphere = radius / offsetDistance;
+        PREC cosSphere = std::sqrt(PREC(1) - sinSphere * sinSphere);
+        return cosCenter * cosSphere - sinCenter * sinSphere > cosAngle;
+    }
+};
+
+
 template <class OBJ, class PREC> class OctreeProcessor
 {
  public:
@@ -38,9 +90,100 @@ template <class OBJ, class PREC> class OctreeProcessor
     virtual ~OctreeProcessor() {};
 
     virtual void process(const OBJ& obj, PREC distance, float appMag) = 0;
+
+    // Called for the children of a node instead of traversing them, when
+    // none of them is bright enough to be processed or when they fit within
+    // aggregateAngle and none can be brighter than aggregateMag.
+    virtual void processAggregate(const OctreeAggregate<PREC>& /*aggregate*/, PREC /*distance*/, float /*appMag*/) {};
+
+    // Angle in radians below which children are aggregated; 0 never
+    // aggregates objects bright enough to be processed.
+    float aggregateAngle { 0.0f };
+    float aggregateMag   { 0.0f };
+
+    // Nodes hidden by the occluder are skipped along with their children.
+    std::optional<OctreeOccluder<PREC>> occluder;
+};
+
+
+// Records the objects reported by an octree traversal, so that they can be
+// passed to one or more processors later without repeating the traversal.
+template <class OBJ, class PREC> class OctreeObjectCollector : public OctreeProcessor<OBJ, PREC>
+{
+ public:
+    struct Entry
+    {
+        const OBJ* obj;
+        PREC distance;
+        float appMag;
+    };
+
+    struct AggregateEntry
+    {
+        const OctreeAggregate<PREC>* aggregate;
+        PREC distance;
+        float appMag;
+    };
+
+    void process(const OBJ& obj, PREC distance, float appMag) override
+    {
+        entries.push_back({ &obj, distance, appMag });
+    }
+
+    void processAggregate(const OctreeAggregate<PREC>& aggregate, PREC distance, float appMag) override
+    {
+        aggregates.push_back({ &aggregate, distance, appMag });
+    }
+
+    void replay(OctreeProcessor<OBJ, PREC>& processor) const
+    {
+        for (const auto& entry : entries)
+            processor.process(*entry.obj, entry.distance, entry.appMag);
+        for (const auto& entry : aggregates)
+            processor.processAggregate(*entry.aggregate, entry.distance, entry.appMag);
+    }
+
+    void clear()
+    {
+        entries.clear();
+        aggregates.clear();
+    }
+
+    std::vector<Entry> entries;
+    std::vector<AggregateEntry> aggregates;
 };
 
 
+// Light of an object for the aggregates of an octree, specialized for each
+// type of object: get() returns false for objects that shouldn't be part
+// of the aggregates.
+template <class OBJ, class PREC> struct OctreeObjectLight;
+
+
+// Linear motion of the objects of a StaticOctree. Rather than being rebuilt
+// when objects leave their cells, a tree with moving objects is used as a
+// loose octree: each node is expanded by a bound of the distance its
+// objects can be outside of it. Positions and velocities are indexed like
+// the sorted objects, starting at firstObject.
+template <class OBJ, class PREC> struct OctreeMotion
+{
+    typedef Eigen::Matrix<PREC, 3, 1> PointType;
+
+    const OBJ*       firstObject;
+    const PointType* positions;
+    const PointType* velocities;
+    // Time since the epoch of the positions
+    PREC dt;
+    // Time since the epoch the node bounds were computed for
+    PREC boundsDt;
+
+    PointType position(const OBJ& obj) const
+    {
+        auto i = &obj - firstObject;
+        return positions[i] + velocities[i] * dt;
+    }
+};
+
 
 struct OctreeLevelStatistics
 {
@@ -134,19 +277,83 @@ template <class OBJ, class PREC> class StaticOctree
                                const Eigen::Hyperplane<PREC, 3>* frustumPlanes,
                                float                             limitingFactor,
                                PREC                              scale,
-                               OctreeProcStats * = nullptr) const;
+                               OctreeProcStats * = nullptr,
+                               const OctreeMotion<OBJ, PREC>*    motion = nullptr) const;
+
+    // Like processVisibleObjects(), but the subtrees a few levels below this
+    // node are traversed as tasks of the engine's task scheduler. The
+    // processor is only called on this thread, with the same objects in the
+    // same order.
+    void processVisibleObjectsParallel(OctreeProcessor<OBJ, PREC>&       processor,
+                                       const PointType&                  obsPosition,
+                                       const Eigen::Hyperplane<PREC, 3>* frustumPlanes,
+                                       float                             limitingFactor,
+                                       PREC                              scale,
+                                       const OctreeMotion<OBJ, PREC>*    motion = nullptr) const;
 
     void processCloseObjects(OctreeProcessor<OBJ, PREC>&        processor,
                              const PointType&                   obsPosition,
                              PREC                               boundingRadius,
-                             PREC                               scale) const;
+                             PREC                               scale,
+                             const OctreeMotion<OBJ, PREC>*     motion = nullptr) const;
 
     int countChildren() const;
     int countObjects()  const;
+    // Bytes used by the nodes of the subtree, not including the objects
+    std::size_t memoryUsage() const;
 
     void computeStatistics(std::vector<OctreeLevelStatistics>& stats, unsigned int level = 0);
 
+    // Summarize the objects of the children of every node
+    void computeAggregates();
+
+    // Set up the node bounds for moving objects, valid at the epoch of the
+    // positions.
+    void initMotion(const OctreeMotion<OBJ, PREC>& motion);
+
+    // Compute the node bounds for the objects at time motion.dt, in depth
+    // first order, without modifying the tree; setBounds() then makes them
+    // valid from that time on.
+    void computeBounds(const OctreeMotion<OBJ, PREC>& motion, PREC scale, std::vector<PREC>& bounds) const;
+    void setBounds(typename std::vector<PREC>::const_iterator& bounds);
+
  private:
+    // Process the visible objects of this node only, returning whether its
+    // children may contain visible objects.
+    bool processVisibleNode(OctreeProcessor<OBJ, PREC>&       processor,
+                            const PointType&                  obsPosition,
+                            const Eigen::Hyperplane<PREC, 3>* frustumPlanes,
+                            float                             limitingFactor,
+                            PREC                              scale,
+                            OctreeProcStats*                  stats,
+                            const OctreeMotion<OBJ, PREC>*    motion) const;
+
+    // Distance by which the cell of this node is expanded at the time of
+    // motion, 0 if the objects don't move.
+    PREC expansion(const OctreeMotion<OBJ, PREC>* motion) const
+    {
+        return motion == nullptr ? PREC(0) : slack + maxSpeed * std::abs(motion->boundsDt);
+    }
+
+    // Check whether the children of this node can be aggregated rather than
+    // traversed, and pass the aggregate to processor if so. nodeRadius is
+    // the radius of the node (expanded for moving objects) and
+    // childrenAppMag the magnitude of the brightest possible child.
+    bool processAggregate(OctreeProcessor<OBJ, PREC>& processor,
+                          const PointType&            obsPosition,
+                          PREC                        minDistance,
+                          PREC                        nodeRadius,
+                          float                       childrenAppMag,
+                          float                       limitingFactor) const;
+
+    struct LightSums;
+    LightSums computeSubtreeAggregates();
+
+    PREC updateMaxSpeed(const OctreeMotion<OBJ, PREC>& motion);
+    Eigen::AlignedBox<PREC, 3> computeSubtreeBounds(const OctreeMotion<OBJ, PREC>& motion,
+                                                    PREC scale,
+                                                    std::vector<PREC>& bounds) const;
+
     static const PREC SQRT3;
 
  private:
@@ -155,6 +362,16 @@ template <class OBJ, class PREC> class StaticOctree
     float          exclusionFactor;
     OBJ*           _firstObject;
     unsigned int   nObjects;
+
+    // Bounds for moving objects, see OctreeMotion: at the time the bounds
+    // were computed for, the objects of this node and its children were
+    // no further than slack outside of its cell (in each coordinate), and
+    // none moves faster than maxSpeed.
+    PREC           slack{ 0 };
+    PREC           maxSpeed{ 0 };
+
+    // Summary of the children, nullptr for leaves or if none has light
+    std::unique_ptr<OctreeAggregate<PREC>> aggregate;
 };
 
 
@@ -370,6 +587,24 @@ inline int StaticOctree<OBJ, PREC>::countChildren() const
 }
 
 
+template <class OBJ, class PREC>
+std::size_t StaticOctree<OBJ, PREC>::memoryUsage() const
+{
+    std::size_t size = sizeof(*this);
+    if (aggregate != nullptr)
+        size += sizeof(OctreeAggregate<PREC>);
+
+    if (_children != nullptr)
+    {
+        size += 8 * sizeof(StaticOctree*);
+        for (int i = 0; i < 8; ++i)
+            size += _children[i]->memoryUsage();
+    }
+
+    return size;
+}
+
+
 template <class OBJ, class PREC>
 inline int StaticOctree<OBJ, PREC>::countObjects() const
 {
@@ -408,3 +643,181 @@ void StaticOctree<OBJ, PREC>::computeStatistics(std::vector<OctreeLevelStatistic
             _children[i]->computeStatistics(stats, level + 1);
     }
 }
+
+
+template <class OBJ, class PREC>
+void StaticOctree<OBJ, PREC>::initMotion(const OctreeMotion<OBJ, PREC>& motion)
+{
+    updateMaxSpeed(motion);
+}
+
+
+template <class OBJ, class PREC>
+PREC StaticOctree<OBJ, PREC>::updateMaxSpeed(const OctreeMotion<OBJ, PREC>& motion)
+{
+    const PointType* velocities = motion.velocities + (_firstObject - motion.firstObject);
+
+    slack    = 0;
+    maxSpeed = 0;
+    for (unsigned int i = 0; i < nObjects; ++i)
+        maxSpeed = std::max(maxSpeed, velocities[i].cwiseAbs().maxCoeff());
+
+    if (_children != nullptr)
+    {
+        for (int i = 0; i < 8; ++i)
+            maxSpeed = std::max(maxSpeed, _children[i]->updateMaxSpeed(motion));
+    }
+
+    return maxSpeed;
+}
+
+
+template <class OBJ, class PREC>
+void StaticOctree<OBJ, PREC>::computeBounds(const OctreeMotion<OBJ, PREC>& motion,
+                                            PREC scale,
+                                            std::vector<PREC>& bounds) const
+{
+    bounds.clear();
+    computeSubtreeBounds(motion, scale, bounds);
+}
+
+
+// Returns the box containing the objects of this subtree, from which the
+// slack of this node follows.
+template <class OBJ, class PREC>
+Eigen::AlignedBox<PREC, 3> StaticOctree<OBJ, PREC>::computeSubtreeBounds(const OctreeMotion<OBJ, PREC>& motion,
+                                                                         PREC scale,
+                                                                         std::vector<PREC>& bounds) const
+{
+    std::size_t index = bounds.size();
+    bounds.push_back(0);
+
+    Eigen::AlignedBox<PREC, 3> box;
+    for (unsigned int i = 0; i < nObjects; ++i)
+        box.extend(motion.position(_firstObject[i]));
+
+    if (_children != nullptr)
+    {
+        for (int i = 0; i < 8; ++i)
+            box.extend(_children[i]->computeSubtreeBounds(motion, scale * (PREC) 0.5, bounds));
+    }
+
+    if (!box.isEmpty())
+    {
+        PointType outside = (box.max() - cellCenterPos).cwiseMax(cellCenterPos - box.min()).array() - scale;
+        bounds[index] = std::max(outside.maxCoeff(), PREC(0));
+    }
+
+    return box;
+}
+
+
+template <class OBJ, class PREC>
+void StaticOctree<OBJ, PREC>::setBounds(typename std::vector<PREC>::const_iterator& bounds)
+{
+    slack = *bounds++;
+
+    if (_children != nullptr)
+    {
+        for (int i = 0; i < 8; ++i)
+            _children[i]->setBounds(bounds);
+    }
+}
+
+
+template <class OBJ, class PREC>
+struct StaticOctree<OBJ, PREC>::LightSums
+{
+    double luminosity{ 0.0 };
+    Eigen::Vector3d position{ Eigen::Vector3d::Zero() };
+    double squaredNorm{ 0.0 };
+    double temperature{ 0.0 };
+
+    void add(const LightSums& other)
+    {
+        luminosity  += other.luminosity;
+        position    += other.position;
+        squaredNorm += other.squaredNorm;
+        temperature += other.temperature;
+    }
+};
+
+
+template <class OBJ, class PREC>
+void StaticOctree<OBJ, PREC>::computeAggregates()
+{
+    computeSubtreeAggregates();
+}
+
+
+// Returns the luminosity weighted sums over the objects of this subtree,
+// where those of the children give the aggregate of this node.
+template <class OBJ, class PREC>
+typename StaticOctree<OBJ, PREC>::LightSums StaticOctree<OBJ, PREC>::computeSubtreeAggregates()
+{
+    LightSums children;
+    if (_children != nullptr)
+    {
+        for (int i = 0; i < 8; ++i)
+            children.add(_children[i]->computeSubtreeAggregates());
+    }
+
+    aggregate = nullptr;
+    if (children.luminosity > 0.0)
+    {
+        Eigen::Vector3d center = children.position / children.luminosity;
+        double variance = children.squaredNorm / children.luminosity - center.squaredNorm();
+
+        aggregate = std::make_unique<OctreeAggregate<PREC>>();
+        aggregate->center      = center.cast<PREC>();
+        aggregate->radius      = static_cast<PREC>(std::sqrt(std::max(variance, 0.0)));
+        aggregate->absMag      = astro::lumToAbsMag(static_cast<float>(children.luminosity));
+        aggregate->temperature = static_cast<float>(children.temperature / children.luminosity);
+    }
+
+    LightSums sums = children;
+    for (unsigned int i = 0; i < nObjects; ++i)
+    {
+        PointType position;
+        float absMag;
+        float temperature;
+        if (!OctreeObjectLight<OBJ, PREC>::get(_firstObject[i], position, absMag, temperature))
+            continue;
+
+        double luminosity = astro::absMagToLum(absMag);
+        Eigen::Vector3d p = position.template cast<double>();
+        sums.luminosity  += luminosity;
+        sums.position    += p * luminosity;
+        sums.squaredNorm += p.squaredNorm() * luminosity;
+        sums.temperature += temperature * luminosity;
+    }
+
+    return sums;
+}
+
+
+template <class OBJ, class PREC>
+bool StaticOctree<OBJ, PREC>::processAggregate(OctreeProcessor<OBJ, PREC>& processor,
+                                               const PointType&            obsPosition,
+                                               PREC                        minDistance,
+                                               PREC                        nodeRadius,
+                                               float                       childrenAppMag,
+                                               float                       limitingFactor) const
+{
+    if (aggregate == nullptr || minDistance <= 0)
+        return false;
+
+    // Children too faint to be seen one by one are still drawn together,
+    // while visible ones are only aggregated when they'd fall on the same
+    // pixel anyway.
+    if (childrenAppMag <= limitingFactor &&
+        (nodeRadius >= processor.aggregateAngle * minDistance || childrenAppMag <= processor.aggregateMag))
+    {
+        return false;
+    }
+
+    PREC distance = (obsPosition - aggregate->center).norm();
+    float appMag = astro::absToAppMag(aggregate->absMag, static_cast<float>(distance));
+    processor.processAggregate(*aggregate, distance, appMag);
+    return true;
+}
@@ -400,7 +400,10 @@ ParseStringList(const Hash* table,
  *
  *  The Kernel property specifies one or more SPK files that must be loaded. Any
  *  already loaded kernels will also be used if they contain trajectories for
- *  the target or origin.
+ *  the target or origin. Kernels are loaded in the background the first time
+ *  the orbit is evaluated. Until then, or if they fail to load, the next orbit
+ *  definition of the object is used, or the target stays at the origin if
+ *  there's none. Missing kernel files make the SPICE orbit invalid.
  *  Target and origin are strings that give NAIF IDs for the target and origin
  *  objects. Either names or integer IDs are valid, but integer IDs still must
  *  be quoted.
@@ -516,12 +519,11 @@ CreateSpiceOrbit(const Hash* orbitData,
                                                               boundingRadius);
     }
 
-    if (!orbit->init(path, kernelList.cbegin(), kernelList.cend()))
-    {
-        // Error using SPICE library; destroy the orbit; hopefully a
-        // fallback is defined in the SSC file.
-        orbit = nullptr;
-    }
+    // Kernels are loaded when the orbit is first evaluated, so errors in
+    // them are only reported then. Missing kernels are caught now, and the
+    // orbit is dropped in favor of a fallback defined in the SSC file.
+    if (!orbit->addKernels(path, kernelList.cbegin(), kernelList.cend()))
+        return nullptr;
 
     return orbit;
 }
@@ -641,11 +643,8 @@ CreateSpiceRotation(const Hash* rotationData,
                                                                     period);
     }
 
-    if (!rotation->init(path, kernelList.cbegin(), kernelList.cend()))
-    {
-        // Error using SPICE library; destroy the rotation.
-        rotation = nullptr;
-    }
+    if (!rotation->addKernels(path, kernelList.cbegin(), kernelList.cend()))
+        return nullptr;
 
     return rotation;
 }
@@ -680,41 +679,16 @@ CreateScriptedOrbit(const Hash* orbitData,
 }
 
 
-celestia::ephem::Orbit*
-CreateOrbit(const Selection& centralObject,
-            const Hash* planetData,
-            const fs::path& path,
-            bool usePlanetUnits)
+/*! Create an orbit from the definitions that follow SpiceOrbit in order of
+ *  precedence. These are also used by a SPICE orbit until its kernels are
+ *  loaded, or if they fail to load.
+ */
+static celestia::ephem::Orbit*
+CreateFallbackOrbit(const Selection& centralObject,
+                    const Hash* planetData,
+                    const fs::path& path,
+                    bool usePlanetUnits)
 {
-    if (const std::string* customOrbitName = planetData->getString("CustomOrbit"); customOrbitName != nullptr)
-    {
-        if (auto orbit = celephem::GetCustomOrbit(*customOrbitName); orbit != nullptr)
-            return orbit.release();
-        GetLogger()->error("Could not find custom orbit named '{}'\n", *customOrbitName);
-    }
-
-#ifdef USE_SPICE
-    if (const Value* spiceOrbitDataValue = planetData->getValue("SpiceOrbit"); spiceOrbitDataValue != nullptr)
-    {
-        const Hash* spiceOrbitData = spiceOrbitDataValue->getHash();
-        if (spiceOrbitData == nullptr)
-        {
-            GetLogger()->error("Object has incorrect spice orbit syntax.\n");
-            return nullptr;
-        }
-        else
-        {
-            auto orbit = CreateSpiceOrbit(spiceOrbitData, path, usePlanetUnits);
-            if (orbit != nullptr)
-            {
-                return orbit.release();
-            }
-            GetLogger()->error("Bad spice orbit\n");
-            GetLogger()->error("Could not load SPICE orbit\n");
-        }
-    }
-#endif
-
     // Trajectory calculated by Lua script
     if (const Value* scriptedOrbitValue = planetData->getValue("ScriptedOrbit"); scriptedOrbitValue != nullptr)
     {
@@ -830,6 +804,47 @@ CreateOrbit(const Selection& centralObject,
 }
 
 
+celestia::ephem::Orbit*
+CreateOrbit(const Selection& centralObject,
+            const Hash* planetData,
+            const fs::path& path,
+            bool usePlanetUnits)
+{
+    if (const std::string* customOrbitName = planetData->getString("CustomOrbit"); customOrbitName != nullptr)
+    {
+        if (auto orbit = celephem::GetCustomOrbit(*customOrbitName); orbit != nullptr)
+            return orbit.release();
+        GetLogger()->error("Could not find custom orbit named '{}'\n", *customOrbitName);
+    }
+
+#ifdef USE_SPICE
+    if (const Value* spiceOrbitDataValue = planetData->getValue("SpiceOrbit"); spiceOrbitDataValue != nullptr)
+    {
+        const Hash* spiceOrbitData = spiceOrbitDataValue->getHash();
+        if (spiceOrbitData == nullptr)
+        {
+            GetLogger()->error("Object has incorrect spice orbit syntax.\n");
+            return nullptr;
+        }
+        else
+        {
+            auto orbit = CreateSpiceOrbit(spiceOrbitData, path, usePlanetUnits);
+            if (orbit != nullptr)
+            {
+                // The rest of the definition stands in while the kernels load
+                orbit->setFallback(CreateFallbackOrbit(centralObject, planetData, path, usePlanetUnits));
+                return orbit.release();
+            }
+            GetLogger()->error("Bad spice orbit\n");
+            GetLogger()->error("Could not load SPICE orbit\n");
+        }
+    }
+#endif
+
+    return CreateFallbackOrbit(centralObject, planetData, path, usePlanetUnits);
+}
+
+
 static std::unique_ptr<celestia::ephem::ConstantOrientation>
 CreateFixedRotationModel(double offset,
                          double inclination,
@@ -975,56 +990,15 @@ CreateScriptedRotation(const Hash* rotationData,
 }
 
 
-/**
- * Parse rotation information. Unfortunately, Celestia didn't originally have
- * RotationModel objects, so information about the rotation of the object isn't
- * grouped into a single subobject--the ssc fields relevant for rotation just
- * appear in the top level structure.
+/*! Create a rotation model from the definitions that follow SpiceRotation in
+ *  order of precedence. These are also used by a SPICE rotation model until
+ *  its kernels are loaded, or if they fail to load.
  */
-celestia::ephem::RotationModel*
-CreateRotationModel(const Hash* planetData,
-                    const fs::path& path,
-                    double syncRotationPeriod)
+static celestia::ephem::RotationModel*
+CreateFallbackRotationModel(const Hash* planetData,
+                            const fs::path& path,
+                            double syncRotationPeriod)
 {
-    // If more than one rotation model is specified, the following precedence
-    // is used to determine which one should be used:
-    //   CustomRotation
-    //   SPICE C-Kernel
-    //   SampledOrientation
-    //   PrecessingRotation
-    //   UniformRotation
-    //   legacy rotation parameters
-    if (const std::string* customRotationModelName = planetData->getString("CustomRotation"); customRotationModelName != nullptr)
-    {
-        if (auto rotationModel = celestia::ephem::GetCustomRotationModel(*customRotationModelName);
-            rotationModel != nullptr)
-        {
-            return rotationModel;
-        }
-        GetLogger()->error("Could not find custom rotation model named '{}'\n",
-                           *customRotationModelName);
-    }
-
-#ifdef USE_SPICE
-    if (const Value* spiceRotationDataValue = planetData->getValue("SpiceRotation"); spiceRotationDataValue != nullptr)
-    {
-        const Hash* spiceRotationData = spiceRotationDataValue->getHash();
-        if (spiceRotationData == nullptr)
-        {
-            GetLogger()->error("Object has incorrect spice rotation syntax.\n");
-            return nullptr;
-        }
-        else
-        {
-            if (auto rotationModel = CreateSpiceRotation(spiceRotationData, path); rotationModel != nullptr)
-            {
-                return rotationModel.release();
-            }
-            GetLogger()->error("Bad spice rotation model\nCould not load SPICE rotation model\n");
-        }
-    }
-#endif
-
     if (const Value* scriptedRotationValue = planetData->getValue("ScriptedRotation"); scriptedRotationValue != nullptr)
     {
         const Hash* scriptedRotationData = scriptedRotationValue->getHash();
@@ -1185,6 +1159,62 @@ CreateRotationModel(const Hash* planetData,
 }
 
 
+/**
+ * Parse rotation information. Unfortunately, Celestia didn't originally have
+ * RotationModel objects, so information about the rotation of the object isn't
+ * grouped into a single subobject--the ssc fields relevant for rotation just
+ * appear in the top level structure.
+ */
+celestia::ephem::RotationModel*
+CreateRotationModel(const Hash* planetData,
+                    const fs::path& path,
+                    double syncRotationPeriod)
+{
+    // If more than one rotation model is specified, the following precedence
+    // is used to determine which one should be used:
+    //   CustomRotation
+    //   SPICE C-Kernel
+    //   SampledOrientation
+    //   PrecessingRotation
+    //   UniformRotation
+    //   legacy rotation parameters
+    if (const std::string* customRotationModelName = planetData->getString("CustomRotation"); customRotationModelName != nullptr)
+    {
+        if (auto rotationModel = celestia::ephem::GetCustomRotationModel(*customRotationModelName);
+            rotationModel != nullptr)
+        {
+            return rotationModel;
+        }
+        GetLogger()->error("Could not find custom rotation model named '{}'\n",
+                           *customRotationModelName);
+    }
+
+#ifdef USE_SPICE
+    if (const Value* spiceRotationDataValue = planetData->getValue("SpiceRotation"); spiceRotationDataValue != nullptr)
+    {
+        const Hash* spiceRotationData = spiceRotationDataValue->getHash();
+        if (spiceRotationData == nullptr)
+        {
+            GetLogger()->error("Object has incorrect spice rotation syntax.\n");
+            return nullptr;
+        }
+        else
+        {
+            if (auto rotationModel = CreateSpiceRotation(spiceRotationData, path); rotationModel != nullptr)
+            {
+                // The rest of the definition stands in while the kernels load
+                rotationModel->setFallback(CreateFallbackRotationModel(planetData, path, syncRotationPeriod));
+                return rotationModel.release();
+            }
+            GetLogger()->error("Bad spice rotation model\nCould not load SPICE rotation model\n");
+        }
+    }
+#endif
+
+    return CreateFallbackRotationModel(planetData, path, syncRotationPeriod);
+}
+
+
 celestia::ephem::RotationModel*
 CreateDefaultRotationModel(double syncRotationPeriod)
 {
@@ -79,6 +79,11 @@ float PerspectiveProjectionMode::getNormalizedDeviceZ(float nearZ, float farZ, f
     return d1 - d2 / z;
 }
 
+bool PerspectiveProjectionMode::isPerspective() const
+{
+    return true;
+}
+
 Eigen::Vector3f PerspectiveProjectionMode::getPickRay(float x, float y, float zoom) const
 {
     float s = 2.0f * std::tan(getFOV(zoom) / 2.0f);
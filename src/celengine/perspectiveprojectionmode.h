@@ -36,6 +36,7 @@ public:
     double getViewConeAngleMax(float zoom) const override;
 
     float getNormalizedDeviceZ(float nearZ, float farZ, float z) const override;
+    bool isPerspective() const override;
 
     Eigen::Vector3f getPickRay(float x, float y, float zoom) const override;
 
@@ -8,6 +8,7 @@
 // as published by the Free Software Foundation; either version 2
 // of the License, or (at your option) any later version.
 
+#include <celengine/categoryfilter.h>
 #include <celengine/starcolors.h>
 #include <celengine/star.h>
 #include <celengine/univcoord.h>
@@ -18,15 +19,6 @@
 using namespace std;
 using namespace Eigen;
 
-// Convert a position in the universal coordinate system to astrocentric
-// coordinates, taking into account possible orbital motion of the star.
-static Vector3d astrocentricPosition(const UniversalCoord& pos,
-                                     const Star& star,
-                                     double t)
-{
-    return pos.offsetFromKm(star.getPosition(t));
-}
-
 PointStarRenderer::PointStarRenderer() :
     ObjectRenderer<Star, float>(StarDistanceLimit)
 {
@@ -37,6 +29,18 @@ void PointStarRenderer::process(const Star& star, float distance, float appMag)
     if (distance > distanceLimit)
         return;
 
+    bool categoryLabeled = false;
+    const Color* categoryColor = nullptr;
+    if (categoryFilter != nullptr)
+    {
+        UserCategoryMask categoryMask = star.getCategoryMask();
+        if (!categoryFilter->isVisible(categoryMask))
+            return;
+        categoryLabeled = categoryFilter->isLabeled(categoryMask);
+        categoryColor = categoryFilter->getColor(categoryMask);
+    }
+    const Color& labelColor = categoryColor == nullptr ? Renderer::StarLabelColor : *categoryColor;
+
     Vector3f starPos = star.getPosition();
 
     // Calculate the difference at double precision *before* converting to float.
@@ -76,9 +80,7 @@ void PointStarRenderer::process(const Star& star, float distance, float appMag)
             // This is a much more accurate (and expensive) distance
             // calculation than the previous one which used the observer's
             // position rounded off to floats.
-            Vector3d hPos = astrocentricPosition(observer->getPosition(),
-                                                 star,
-                                                 observer->getTime());
+            Vector3d hPos = -observerOrigin.offsetKm(star.getPosition(observer->getTime()));
             relPos = hPos.cast<float>() * -astro::kilometersToLightYears(1.0f);
             distance = relPos.norm();
 
@@ -93,6 +95,9 @@ void PointStarRenderer::process(const Star& star, float distance, float appMag)
         // planets.
         if (distance > SolarSystemMaxDistance)
         {
+            if (occluder && occluder->hides(relPos, 0.0f))
+                return;
+
             float pointSize, alpha, glareSize, glareAlpha;
             float size = BaseStarDiscSize * static_cast<float>(renderer->getScreenDpi()) / 96.0f;
             renderer->calculatePointSize(appMag,
@@ -108,15 +113,18 @@ void PointStarRenderer::process(const Star& star, float distance, float appMag)
                 starVertexBuffer->addStar(relPos, Color(starColor, alpha), pointSize);
 
             // Place labels for stars brighter than the specified label threshold brightness
-            if (((labelMode & Renderer::StarLabels) != 0) && appMag < labelThresholdMag)
+            // and for those in a category the filter labels
+            if ((((labelMode & Renderer::StarLabels) != 0) && appMag < labelThresholdMag) || categoryLabeled)
             {
                 Vector3f starDir = relPos.normalized();
                 if (starDir.dot(viewNormal) > cosFOV)
                 {
-                    float distr = min(1.0f, 3.5f * (labelThresholdMag - appMag)/labelThresholdMag);
-                    Color color = Color(Renderer::StarLabelColor, distr * Renderer::StarLabelColor.alpha());
+                    float distr = categoryLabeled
+                        ? 1.0f
+                        : min(1.0f, 3.5f * (labelThresholdMag - appMag)/labelThresholdMag);
+                    Color color = Color(labelColor, distr * labelColor.alpha());
                     renderer->addBackgroundAnnotation(nullptr,
-                                                      starDB->getStarName(star, true),
+                                                      starDB->getStarDisplayName(star),
                                                       color,
                                                       relPos);
                 }
@@ -144,7 +152,7 @@ void PointStarRenderer::process(const Star& star, float distance, float appMag)
             rle.isOpaque = true;
             renderList->push_back(rle);
 
-            if ((labelMode & Renderer::StarLabels) != 0)
+            if ((labelMode & Renderer::StarLabels) != 0 || categoryLabeled)
             {
                 // Position the label slightly in front of the object along a line from
                 // object center to viewer.
@@ -152,10 +160,39 @@ void PointStarRenderer::process(const Star& star, float distance, float appMag)
                 pos = pos * (1.0f - star.getRadius() * 1.01f / pos.norm());
 
                 renderer->addSortedAnnotation(nullptr,
-                                              starDB->getStarName(star, true),
-                                              Renderer::StarLabelColor,
+                                              starDB->getStarDisplayName(star),
+                                              labelColor,
                                               pos);
             }
         }
     }
 }
+
+
+// Draw the stars of an octree node as one point, spreading their light
+// over the apparent size of the group.
+void PointStarRenderer::processAggregate(const OctreeAggregate<float>& aggregate, float distance, float appMag)
+{
+    if (appMag > faintestMag || distance > distanceLimit)
+        return;
+
+    Vector3f relPos = (aggregate.center.cast<double>() - obsPos).cast<float>();
+    if (relPos.dot(viewNormal) <= 0.0f || (occluder && occluder->hides(relPos, aggregate.radius)))
+        return;
+
+    float pointSize, alpha, glareSize, glareAlpha;
+    float size = BaseStarDiscSize * static_cast<float>(renderer->getScreenDpi()) / 96.0f;
+    renderer->calculatePointSize(appMag, size, pointSize, alpha, glareSize, glareAlpha);
+    if (pointSize == 0.0f)
+        return;
+
+    float extent = 2.0f * aggregate.radius / (distance * pixelSize);
+    if (extent > pointSize)
+    {
+        alpha *= (pointSize / extent) * (pointSize / extent);
+        pointSize = min(extent, MaxAggregateSize);
+    }
+
+    Color color = colorTemp->lookupColor(aggregate.temperature);
+    starVertexBuffer->addStar(relPos, Color(color, alpha), pointSize);
+}
@@ -14,6 +14,7 @@
 #include <vector>
 #include "objectrenderer.h"
 #include "renderlistentry.h"
+#include "univcoord.h"
 
 class ColorTemperatureTable;
 class PointStarVertexBuffer;
@@ -27,6 +28,8 @@ constexpr inline float StarDistanceLimit     = 1.0e6f;
 constexpr inline float BaseStarDiscSize      = 5.0f;
 constexpr inline float MaxScaledDiscStarSize = 8.0f;
 constexpr inline float GlareOpacity          = 0.65f;
+// Largest size in pixels of the points drawn for aggregated stars
+constexpr inline float MaxAggregateSize      = 64.0f;
 
 class PointStarRenderer : public ObjectRenderer<Star, float>
 {
@@ -41,8 +44,10 @@ class PointStarRenderer : public ObjectRenderer<Star, float>
 
     PointStarRenderer();
     void process(const Star &star, float distance, float appMag) override;
+    void processAggregate(const OctreeAggregate<float>& aggregate, float distance, float appMag) override;
 
     Eigen::Vector3d obsPos;
+    UniversalCoordOrigin observerOrigin;
     Eigen::Vector3f viewNormal;
     std::vector<RenderListEntry>* renderList    { nullptr };
     PointStarVertexBuffer* starVertexBuffer     { nullptr };
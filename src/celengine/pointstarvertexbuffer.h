@@ -12,8 +12,8 @@
 
 #include <memory>
 #include <Eigen/Core>
+#include <celutil/color.h>
 
-class Color;
 class Renderer;
 class Texture;
 class CelestiaGLProgram;
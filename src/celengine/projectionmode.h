@@ -44,6 +44,10 @@ public:
 
     virtual float getNormalizedDeviceZ(float nearZ, float farZ, float z) const = 0;
 
+    // True if depth is produced by an ordinary perspective divide, which
+    // alternative depth buffer encodings rely on.
+    virtual bool isPerspective() const = 0;
+
     virtual Eigen::Vector3f getPickRay(float x, float y, float zoom) const = 0;
     virtual void configureShaderManager(ShaderManager *) const = 0;
     virtual bool project(const Eigen::Vector3f& pos, const Eigen::Matrix4f existingModelViewMatrix, const Eigen::Matrix4f existingProjectionMatrix, const Eigen::Matrix4f existingMVPMatrix, const int viewport[4], Eigen::Vector3f& result) const = 0;
@@ -48,7 +48,9 @@
 #include "orbitsampler.h"
 #include "rendcontext.h"
 #include "textlayout.h"
+#include <celcompat/numbers.h>
 #include <celengine/observer.h>
+#include <celephem/cachebypass.h>
 #include <celmath/frustum.h>
 #include <celmath/distance.h>
 #include <celmath/intersect.h>
@@ -61,6 +63,7 @@
 #include <celrender/eclipticlinerenderer.h>
 #include <celrender/largestarrenderer.h>
 #include <celrender/linerenderer.h>
+#include <celrender/minorbodyrenderer.h>
 #include <celrender/galaxyrenderer.h>
 #include <celrender/globularrenderer.h>
 #include <celrender/nebularenderer.h>
@@ -69,11 +72,13 @@
 #include <celrender/gl/vertexobject.h>
 #include <celutil/arrayvector.h>
 #include <celutil/logger.h>
+#include <celutil/taskscheduler.h>
 #include <celutil/utf8.h>
 #include <celutil/timer.h>
 #include <celttf/truetypefont.h>
 #include "glsupport.h"
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <cassert>
 #include <sstream>
@@ -120,6 +125,16 @@ static const float MaxFarNearRatio      = 2000000.0f;
 
 static const float MinRelativeOccluderRadius = 0.005f;
 
+// Views in renderViews() that together span a cone wider than this (in
+// degrees) share scene state built without view cone culling.
+static const double MaxSharedViewConeAngle = 80.0;
+
+// Bodies smaller than this angular radius (in radians) don't cull the stars
+// and deep sky objects behind them, and the angle of those that do is
+// reduced by the margin to stay clear of the limb.
+static const double MinSkyOccluderAngle = 0.01;
+static const double SkyOccluderAngleMargin = 0.001;
+
 // The minimum apparent size of an objects orbit in pixels before we display
 // a label for it.  This minimizes label clutter.
 static const float MinOrbitSizeForLabel = 20.0f;
@@ -154,6 +169,11 @@ static const float CoronaHeight = 0.2f;
 static const unsigned int OrbitCacheCullThreshold = 200;
 // Age in frames at which unused orbit paths may be eliminated from the cache
 static const uint32_t OrbitCacheRetireAge = 16;
+// Extra size of the internal sample cache of periodic orbits, in periods
+static const double OrbitWindowSlack = 0.2;
+// Limit of the extra samples cached ahead of the orbit window when time runs
+// fast, in periods
+static const double MaxOrbitWindowLead = 2.0;
 
 Color Renderer::StarLabelColor          (0.471f, 0.356f, 0.682f);
 Color Renderer::PlanetLabelColor        (0.407f, 0.333f, 0.964f);
@@ -261,6 +281,7 @@ Renderer::Renderer() :
     m_globularRenderer(std::make_unique<GlobularRenderer>(*this)),
     m_largeStarRenderer(std::make_unique<LargeStarRenderer>(*this)),
     m_hollowMarkerRenderer(std::make_unique<LineRenderer>(*this, 1.0f, LineRenderer::PrimType::Lines, LineRenderer::StorageType::Static)),
+    m_minorBodyRenderer(std::make_unique<MinorBodyRenderer>(*this)),
     m_nebulaRenderer(std::make_unique<NebulaRenderer>(*this)),
     m_openClusterRenderer(std::make_unique<OpenClusterRenderer>(*this))
 
@@ -556,6 +577,14 @@ bool Renderer::init(int winWidth, int winHeight, const DetailOptions& _detailOpt
     // LEQUAL rather than LESS required for multipass rendering
     glDepthFunc(GL_LEQUAL);
 
+    // The shaders are generated on demand, so log depth has to be chosen
+    // before the first one is built. In automatic mode it is used unless
+    // the framebuffer bound now can take reverse-Z.
+    requestedDepthMode = detailOptions.depthBufferMode;
+    bool logDepth = requestedDepthMode == DepthBufferMode::Logarithmic ||
+                    (requestedDepthMode == DepthBufferMode::Automatic && !hasFloatDepthBuffer());
+    shaderManager->setLogDepthEnabled(logDepth);
+
     resize(winWidth, winHeight);
 
     return true;
@@ -566,6 +595,8 @@ void Renderer::resize(int width, int height)
 {
     windowWidth = width;
     windowHeight = height;
+    // The frontend may have recreated its framebuffer
+    depthFormatFramebuffer = -1;
     projectionMode->setSize(static_cast<float>(windowWidth), static_cast<float>(windowHeight));
     // glViewport(windowWidth, windowHeight);
     m_orthoProjMatrix = Ortho2D(0.0f, (float)windowWidth, 0.0f, (float)windowHeight);
@@ -709,6 +740,18 @@ void Renderer::setLabelMode(int _labelMode)
     markSettingsChanged();
 }
 
+const CategoryFilter& Renderer::getCategoryFilter() const
+{
+    return categoryFilter;
+}
+
+void Renderer::setCategoryFilter(CategoryFilter&& filter)
+{
+    categoryFilter = std::move(filter);
+    activeCategoryFilter = categoryFilter.isEmpty() ? nullptr : &categoryFilter;
+    markSettingsChanged();
+}
+
 shared_ptr<celestia::engine::ProjectionMode> Renderer::getProjectionMode() const
 {
     return projectionMode;
@@ -862,7 +905,7 @@ void Renderer::getLabelAlignmentInfo(const Annotation &annotation, const Texture
 
 void Renderer::addAnnotation(vector<Annotation>& annotations,
                              const celestia::MarkerRepresentation* markerRep,
-                             const string& labelText,
+                             std::string_view labelText,
                              Color color,
                              const Vector3f& pos,
                              LabelHorizontalAlignment halign,
@@ -886,22 +929,23 @@ void Renderer::addAnnotation(vector<Annotation>& annotations,
         if (abs(x - win.x()) < 0.001) win.x() = x;
         if (abs(y - win.y()) < 0.001) win.y() = y;
 
-        Annotation a;
+        // Constructed in place; most names fit in the short string buffer
+        // and aren't allocated at all.
+        Annotation& a = annotations.emplace_back();
         if (!special || markerRep == nullptr)
-             a.labelText = labelText;
+             a.labelText.assign(labelText);
         a.markerRep = markerRep;
         a.color = color;
         a.position = win;
         a.halign = halign;
         a.valign = valign;
         a.size = size;
-        annotations.push_back(a);
     }
 }
 
 
 void Renderer::addForegroundAnnotation(const celestia::MarkerRepresentation* markerRep,
-                                       const string& labelText,
+                                       std::string_view labelText,
                                        Color color,
                                        const Vector3f& pos,
                                        LabelHorizontalAlignment halign,
@@ -913,7 +957,7 @@ void Renderer::addForegroundAnnotation(const celestia::MarkerRepresentation* mar
 
 
 void Renderer::addBackgroundAnnotation(const celestia::MarkerRepresentation* markerRep,
-                                       const string& labelText,
+                                       std::string_view labelText,
                                        Color color,
                                        const Vector3f& pos,
                                        LabelHorizontalAlignment halign,
@@ -925,7 +969,7 @@ void Renderer::addBackgroundAnnotation(const celestia::MarkerRepresentation* mar
 
 
 void Renderer::addSortedAnnotation(const celestia::MarkerRepresentation* markerRep,
-                                   const string& labelText,
+                                   std::string_view labelText,
                                    Color color,
                                    const Vector3f& pos,
                                    LabelHorizontalAlignment halign,
@@ -1002,7 +1046,7 @@ void Renderer::endObjectAnnotations()
 
 
 void Renderer::addObjectAnnotation(const celestia::MarkerRepresentation* markerRep,
-                                   const string& labelText,
+                                   std::string_view labelText,
                                    Color color,
                                    const Vector3f& pos,
                                    LabelHorizontalAlignment halign,
@@ -1015,15 +1059,23 @@ void Renderer::addObjectAnnotation(const celestia::MarkerRepresentation* markerR
     }
 }
 
-Vector4f renderOrbitColor(const Body *body, bool selected, float opacity)
+Vector4f renderOrbitColor(const Body *body, bool selected, float opacity,
+                          const CategoryFilter* categoryFilter)
 {
     Color orbitColor;
+    const Color* categoryColor = body != nullptr && categoryFilter != nullptr
+        ? categoryFilter->getColor(body->getCategoryMask())
+        : nullptr;
 
     if (selected)
     {
         // Highlight the orbit of the selected object in red
         orbitColor = Renderer::SelectionOrbitColor;
     }
+    else if (categoryColor != nullptr)
+    {
+        orbitColor = *categoryColor;
+    }
     else if (body != nullptr && body->isOrbitColorOverridden())
     {
         orbitColor = body->getOrbitColor();
@@ -1065,6 +1117,226 @@ Vector4f renderOrbitColor(const Body *body, bool selected, float opacity)
     return Vector4f(orbitColor.red(), orbitColor.green(), orbitColor.blue(), opacity * orbitColor.alpha());
 }
 
+namespace
+{
+
+// Start of the time span covered by the samples of a newly cached orbit
+double
+orbitSampleStartTime(const celestia::ephem::Orbit* orbit, double t)
+{
+    double startTime = t;
+
+    // Aperiodic orbits aren't true orbits, but sampled trajectories,
+    // generally of spacecraft; they're sampled from the start of their
+    // valid range.
+    if (!orbit->isPeriodic())
+    {
+        double begin = 0.0, end = 0.0;
+        orbit->getValidRange(begin, end);
+
+        if (begin != end)
+            startTime = begin;
+    }
+    else
+    {
+        startTime = t - orbit->getPeriod();
+    }
+
+    return startTime;
+}
+
+} // end unnamed namespace
+
+
+// Range of times to sample to keep the cached samples of a periodic orbit
+// around its window, and the range of samples to keep.
+struct Renderer::OrbitWindowUpdate
+{
+    double sampleStart;
+    double sampleEnd;
+    double windowStart;
+    double windowEnd;
+    bool backward;
+
+    void apply(CurvePlot* plot, OrbitSampler& sampler) const;
+};
+
+
+void Renderer::OrbitWindowUpdate::apply(CurvePlot* plot, OrbitSampler& sampler) const
+{
+    if (backward)
+    {
+        // Remove samples at the end of the time window
+        plot->removeSamplesAfter(windowEnd);
+
+        // Trim the first sample (because it will be duplicated when we sample the orbit.)
+        plot->removeSamplesBefore(plot->startTime() * (1.0 + 1.0e-15));
+
+        // Add the new samples
+        sampler.insertBackward(plot);
+    }
+    else
+    {
+        // Remove samples at the beginning of the time window
+        plot->removeSamplesBefore(windowStart);
+
+        // Trim the last sample (because it will be duplicated when we sample the orbit.)
+        plot->removeSamplesAfter(plot->endTime() * (1.0 - 1.0e-15));
+
+        // Add the new samples
+        sampler.insertForward(plot);
+    }
+#if DEBUG_ORBIT_CACHE
+    clog << "new sample count: " << plot->sampleCount() << endl;
+#endif
+}
+
+
+/*! Check whether the samples cached for a periodic orbit cover its window at
+ *  time t and, when the window moves lookahead days further, at that time too.
+ *  If not, fill in update and return true.
+ *
+ *  When simulation time runs fast, the window would leave the cache after a
+ *  frame or two, and the orbit would be resampled all the time. The cache
+ *  is extended ahead of the window, in the direction time is moving, by the
+ *  distance covered in orbitLookaheadFrames frames.
+ */
+bool Renderer::planOrbitWindow(const celestia::ephem::Orbit* orbit,
+                               const CurvePlot* plot,
+                               double t,
+                               double lookahead,
+                               OrbitWindowUpdate& update) const
+{
+    double period = orbit->getPeriod();
+    double endTime = t + period * detailOptions.orbitWindowEnd;
+    double startTime = endTime - period * detailOptions.orbitPeriodsShown;
+
+    double lead = std::min(std::abs(simTimeStep) * detailOptions.orbitLookaheadFrames,
+                           period * MaxOrbitWindowLead);
+    update.windowStart = startTime - period * OrbitWindowSlack - (simTimeStep < 0.0 ? lead : 0.0);
+    update.windowEnd = endTime + period * OrbitWindowSlack + (simTimeStep > 0.0 ? lead : 0.0);
+
+    double currentWindowStart = plot->startTime();
+    double currentWindowEnd = plot->endTime();
+
+    if (std::min(startTime, startTime + lookahead) < currentWindowStart)
+    {
+        update.backward = true;
+        update.sampleStart = update.windowStart;
+        update.sampleEnd = std::min(currentWindowStart, update.windowEnd);
+        return true;
+    }
+
+    if (std::max(endTime, endTime + lookahead) > currentWindowEnd)
+    {
+        update.backward = false;
+        update.sampleStart = std::max(currentWindowEnd, update.windowStart);
+        update.sampleEnd = update.windowEnd;
+        return true;
+    }
+
+    return false;
+}
+
+
+void Renderer::sampleOrbits(double t)
+{
+    auto& scheduler = celestia::util::GetTaskScheduler();
+    if (scheduler.isSerial())
+        return;
+
+    // Orbits about to be drawn for the first time are sampled here in
+    // parallel, so that renderOrbit() finds them in the cache. So are the
+    // windows of periodic orbits that would run out of samples by the next
+    // frame, which happens every few frames for all of them when time runs
+    // fast. Orbits that can't be evaluated away from this thread are left to
+    // renderOrbit().
+    struct OrbitSamples
+    {
+        const celestia::ephem::Orbit* orbit;
+        CurvePlot* plot;
+        OrbitWindowUpdate update;
+        OrbitSampler sampler;
+    };
+
+    std::vector<OrbitSamples> orbits;
+    for (const auto& path : orbitPathList)
+    {
+        const auto* orbit = path.body != nullptr ? path.body->getOrbit(t) : path.star->getOrbit();
+        if (!orbit->isThreadSafe())
+            continue;
+        if (std::any_of(orbits.begin(), orbits.end(), [orbit](const OrbitSamples& o) { return o.orbit == orbit; }))
+            continue;
+
+        auto cached = orbitCache.find(orbit);
+        if (cached == orbitCache.end())
+        {
+            double startTime = orbitSampleStartTime(orbit, t);
+            OrbitWindowUpdate update{ startTime, startTime + orbit->getPeriod(), 0.0, 0.0, false };
+            orbits.push_back({ orbit, nullptr, update, {} });
+            continue;
+        }
+
+        OrbitWindowUpdate update;
+        if (orbit->isPeriodic() && planOrbitWindow(orbit, cached->second, t, simTimeStep, update))
+            orbits.push_back({ orbit, cached->second, update, {} });
+    }
+
+    if (orbits.size() < 2)
+        return;
+
+    scheduler.parallelFor(0, orbits.size(), 1, [&orbits](std::size_t begin, std::size_t end)
+    {
+        celestia::ephem::CacheBypass bypass;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            auto& o = orbits[i];
+            o.orbit->sample(o.update.sampleStart, o.update.sampleEnd, o.sampler);
+        }
+    }, "orbit sampling");
+
+    for (auto& o : orbits)
+    {
+        if (o.plot != nullptr)
+        {
+            o.plot->setLastUsed(frameCount);
+            o.update.apply(o.plot, o.sampler);
+            continue;
+        }
+
+        auto* plot = new CurvePlot(*this);
+        plot->setLastUsed(frameCount);
+        o.sampler.insertForward(plot);
+        addToOrbitCache(o.orbit, plot);
+    }
+}
+
+
+void Renderer::addToOrbitCache(const celestia::ephem::Orbit* orbit, CurvePlot* plot)
+{
+    // If the orbit cache is full, first try and eliminate some old orbits
+    if (orbitCache.size() > OrbitCacheCullThreshold)
+    {
+        // Check for old orbits at most once per frame
+        if (lastOrbitCacheFlush != frameCount)
+        {
+            for (auto iter = orbitCache.begin(); iter != orbitCache.end();)
+            {
+                // Tricky code to eliminate a node in the orbit cache without screwing
+                // up the iterator. Should work in all STL implementations.
+                if (frameCount - iter->second->lastUsed() > OrbitCacheRetireAge)
+                    orbitCache.erase(iter++);
+                else
+                    ++iter;
+            }
+            lastOrbitCacheFlush = frameCount;
+        }
+    }
+
+    orbitCache[orbit] = plot;
+}
+
+
 void Renderer::renderOrbit(const OrbitPathListEntry& orbitPath,
                            double t,
                            const Quaterniond& cameraOrientation,
@@ -1089,44 +1361,7 @@ void Renderer::renderOrbit(const OrbitPathListEntry& orbitPath,
     // If it's not in the cache already
     if (cachedOrbit == nullptr)
     {
-        double startTime = t;
-#if 0
-        int nSamples = detailOptions.orbitPathSamplePoints;
-#endif
-
-        // Adjust the number of samples used for aperiodic orbits--these aren't
-        // true orbits, but are sampled trajectories, generally of spacecraft.
-        // Better control is really needed--some sort of adaptive sampling would
-        // be ideal.
-        if (!orbit->isPeriodic())
-        {
-            double begin = 0.0, end = 0.0;
-            orbit->getValidRange(begin, end);
-
-            if (begin != end)
-            {
-                startTime = begin;
-#if 0
-                nSamples = (int) (orbit->getPeriod() * 100.0);
-                nSamples = std::clamp(nSamples, 100, 1000);
-#endif
-            }
-#if 0
-            else
-            {
-                // If the orbit is aperiodic and doesn't have a
-                // finite duration, we don't render it. A compromise
-                // would be to pick some time window centered at the
-                // current time, but we'd have to pick some arbitrary
-                // duration.
-                nSamples = 0;
-            }
-#endif
-        }
-        else
-        {
-            startTime = t - orbit->getPeriod();
-        }
+        double startTime = orbitSampleStartTime(orbit, t);
 
         cachedOrbit = new CurvePlot(*this);
         cachedOrbit->setLastUsed(frameCount);
@@ -1136,32 +1371,17 @@ void Renderer::renderOrbit(const OrbitPathListEntry& orbitPath,
                       startTime + orbit->getPeriod(),
                       sampler);
         sampler.insertForward(cachedOrbit);
-
-        // If the orbit cache is full, first try and eliminate some old orbits
-        if (orbitCache.size() > OrbitCacheCullThreshold)
+        if (cachedOrbit->empty())
         {
-            // Check for old orbits at most once per frame
-            if (lastOrbitCacheFlush != frameCount)
-            {
-                for (auto iter = orbitCache.begin(); iter != orbitCache.end();)
-                {
-                    // Tricky code to eliminate a node in the orbit cache without screwing
-                    // up the iterator. Should work in all STL implementations.
-                    if (frameCount - iter->second->lastUsed() > OrbitCacheRetireAge)
-                        orbitCache.erase(iter++);
-                    else
-                        ++iter;
-                }
-                lastOrbitCacheFlush = frameCount;
-            }
+            // Nothing to show yet, e.g. while SPICE kernels are loading, so
+            // sample again next time instead of caching the empty plot.
+            delete cachedOrbit;
+            return;
         }
 
-        orbitCache[orbit] = cachedOrbit;
+        addToOrbitCache(orbit, cachedOrbit);
     }
 
-    if (cachedOrbit->empty())
-        return;
-
     //*** Orbit rendering parameters
 
     // The 'window' is the interval of time for which the orbit will be drawn.
@@ -1181,57 +1401,17 @@ void Renderer::renderOrbit(const OrbitPathListEntry& orbitPath,
     // The default value is 0.0.
     const double LinearFadeFraction = detailOptions.linearFadeFraction;
 
-    // Extra size of the internal sample cache.
-    const double WindowSlack        = 0.2;
-
     //***
 
     // 'Periodic' orbits are generally not strictly periodic because of perturbations
     // from other bodies. Here we update the trajectory samples to make sure that the
     // orbit covers a time range centered at the current time and covering a full revolution.
-    if (orbit->isPeriodic())
+    OrbitWindowUpdate update;
+    if (orbit->isPeriodic() && planOrbitWindow(orbit, cachedOrbit, t, 0.0, update))
     {
-        double period = orbit->getPeriod();
-        double endTime = t + period * OrbitWindowEnd;
-        double startTime = endTime - period * OrbitPeriodsShown;
-
-        double currentWindowStart = cachedOrbit->startTime();
-        double currentWindowEnd = cachedOrbit->endTime();
-        double newWindowStart = startTime - period * WindowSlack;
-        double newWindowEnd = endTime + period * WindowSlack;
-
-        if (startTime < currentWindowStart)
-        {
-            // Remove samples at the end of the time window
-            cachedOrbit->removeSamplesAfter(newWindowEnd);
-
-            // Trim the first sample (because it will be duplicated when we sample the orbit.)
-            cachedOrbit->removeSamplesBefore(cachedOrbit->startTime() * (1.0 + 1.0e-15));
-
-            // Add the new samples
-            OrbitSampler sampler;
-            orbit->sample(newWindowStart, min(currentWindowStart, newWindowEnd), sampler);
-            sampler.insertBackward(cachedOrbit);
-#if DEBUG_ORBIT_CACHE
-            clog << "new sample count: " << cachedOrbit->sampleCount() << endl;
-#endif
-        }
-        else if (endTime > currentWindowEnd)
-        {
-            // Remove samples at the beginning of the time window
-            cachedOrbit->removeSamplesBefore(newWindowStart);
-
-            // Trim the last sample (because it will be duplicated when we sample the orbit.)
-            cachedOrbit->removeSamplesAfter(cachedOrbit->endTime() * (1.0 - 1.0e-15));
-
-            // Add the new samples
-            OrbitSampler sampler;
-            orbit->sample(max(currentWindowEnd, newWindowStart), newWindowEnd, sampler);
-            sampler.insertForward(cachedOrbit);
-#if DEBUG_ORBIT_CACHE
-            clog << "new sample count: " << cachedOrbit->sampleCount() << endl;
-#endif
-        }
+        OrbitSampler sampler;
+        orbit->sample(update.sampleStart, update.sampleEnd, sampler);
+        update.apply(cachedOrbit, sampler);
     }
 
     // We perform vertex tranformations on the CPU because double precision is necessary to
@@ -1244,7 +1424,7 @@ void Renderer::renderOrbit(const OrbitPathListEntry& orbitPath,
     }
 
     bool highlight = body != nullptr ? highlightObject.body() == body : highlightObject.star() == orbitPath.star;
-    Vector4f orbitColor = renderOrbitColor(body, highlight, orbitPath.opacity);
+    Vector4f orbitColor = renderOrbitColor(body, highlight, orbitPath.opacity, activeCategoryFilter);
 
 #ifdef STIPPLED_LINES
     glLineStipple(3, 0x5555);
@@ -1366,7 +1546,7 @@ static Color legacyTintColor(float temp)
 // coordinates.
 static void
 setupLightSources(const vector<const Star*>& nearStars,
-                  const UniversalCoord& observerPos,
+                  const UniversalCoordOrigin& observerOrigin,
                   double t,
                   vector<LightSource>& lightSources,
                   float tintSaturation,
@@ -1384,7 +1564,7 @@ setupLightSources(const vector<const Star*>& nearStars,
     {
         if (star->getVisibility())
         {
-            Vector3d v = star->getPosition(t).offsetFromKm(observerPos);
+            Vector3d v = observerOrigin.offsetKm(star->getPosition(t));
             LightSource ls;
             ls.position = v;
             ls.luminosity = star->getLuminosity();
@@ -1507,19 +1687,189 @@ void Renderer::draw(const Observer& observer,
                     float faintestMagNight,
                     const Selection& sel)
 {
-    // Get the observer's time
-    double now = observer.getTime();
+    beginFrame(observer, sel);
+
+    // Get the view frustum used for culling in camera space.
+    Frustum frustum = setupView(observer);
+
+    // Get the transformed frustum, used for culling in the astrocentric coordinate
+    // system.
+    Frustum xfrustum(frustum);
+    xfrustum.transform(getCameraOrientationf().conjugate().toRotationMatrix());
+
+    buildScene(universe, observer, xfrustum, faintestMagNight);
+    drawScene(universe, observer, sel, frustum, xfrustum);
+}
+
+std::vector<MinorBodyCatalog::IndexNumber>
+Renderer::takeMinorBodyPromotions()
+{
+    return m_minorBodyRenderer->takePromotions();
+}
+
+void Renderer::renderViews(const Observer& observer,
+                           const Universe& universe,
+                           float faintestMagNight,
+                           const Selection& sel,
+                           util::array_view<ViewSpec> views)
+{
+    if (views.empty())
+        return;
+
+    Matrix3d savedCameraTransform = m_cameraTransform;
+    std::array<int, 4> savedViewport = m_viewport;
+    int savedWidth = windowWidth;
+    int savedHeight = windowHeight;
+
+    beginFrame(observer, sel);
+
+    // Find a cone enclosing the frusta of all views. The shared pass is done
+    // at the resolution of the tallest view: it has the smallest pixels, so
+    // nothing that is visible in any view is culled as being too small.
+    float zoom = observer.getZoom();
+    Quaterniond observerOrientation = observer.getOrientation();
+    Vector3d axis = Vector3d::Zero();
+    const ViewSpec* sharedView = &views.front();
+    for (const auto& view : views)
+    {
+        axis += (Quaterniond(view.cameraTransform) * observerOrientation).conjugate() * -Vector3d::UnitZ();
+        if (view.viewport[3] > sharedView->viewport[3])
+            sharedView = &view;
+    }
+
+    double halfAngle = numbers::pi;
+    if (axis.norm() > 1.0e-6)
+    {
+        axis.normalize();
+        halfAngle = 0.0;
+        for (const auto& view : views)
+        {
+            resize(view.viewport[2], view.viewport[3]);
+            Vector3d direction = (Quaterniond(view.cameraTransform) * observerOrientation).conjugate() * -Vector3d::UnitZ();
+            double offAxis = std::acos(std::clamp(axis.dot(direction), -1.0, 1.0));
+            double halfDiagonal = std::acos(projectionMode->getViewConeAngleMax(zoom));
+            halfAngle = std::max(halfAngle, offAxis + halfDiagonal);
+        }
+    }
+
+    // Orient the shared camera along the cone axis.
+    Quaterniond sharedOrientation = Quaterniond::FromTwoVectors(-Vector3d::UnitZ(), axis).conjugate();
+    m_cameraTransform = (sharedOrientation * observerOrientation.conjugate()).toRotationMatrix();
+    resize(sharedView->viewport[2], sharedView->viewport[3]);
+    Frustum frustum = setupView(observer);
+
+    allSkyCulling = halfAngle >= degToRad(MaxSharedViewConeAngle);
+    if (!allSkyCulling)
+    {
+        // A square frustum with a half-angle equal to the cone's contains the
+        // cone.
+        frustum = Frustum(static_cast<float>(2.0 * halfAngle), 1.0f, MinNearPlaneDistance);
+        cosViewConeAngle = std::cos(halfAngle);
+    }
+
+    Frustum xfrustum(frustum);
+    xfrustum.transform(getCameraOrientationf().conjugate().toRotationMatrix());
+
+    buildScene(universe, observer, xfrustum, faintestMagNight);
+
+    sharedRenderList = renderList;
+    sharedOrbitPathList = orbitPathList;
+
+    sharedStars.clear();
+    if ((renderFlags & ShowStars) != 0 && universe.getStarCatalog() != nullptr)
+    {
+        setupStarTraversal(sharedStars);
+        Vector3f obsPos = observer.getPosition().toLy().cast<float>();
+        if (allSkyCulling)
+            universe.getStarCatalog()->findVisibleStars(sharedStars, obsPos, faintestMag);
+        else
+            universe.getStarCatalog()->findVisibleStars(sharedStars,
+                                                        obsPos,
+                                                        getCameraOrientationf(),
+                                                        static_cast<float>(2.0 * halfAngle),
+                                                        1.0f,
+                                                        faintestMag);
+    }
+
+    sharedDSOs.clear();
+    if ((renderFlags & ShowDeepSpaceObjects) != 0 && universe.getDSOCatalog() != nullptr)
+    {
+        setupDSOTraversal(sharedDSOs);
+        Vector3d obsPos = observer.getPosition().toLy();
+        if (allSkyCulling)
+            universe.getDSOCatalog()->findVisibleDSOs(sharedDSOs, obsPos, 2 * faintestMag);
+        else
+            universe.getDSOCatalog()->findVisibleDSOs(sharedDSOs,
+                                                      obsPos,
+                                                      getCameraOrientationf(),
+                                                      static_cast<float>(2.0 * halfAngle),
+                                                      1.0f,
+                                                      2 * faintestMag);
+    }
+
+    allSkyCulling = false;
+    useSharedScene = true;
+
+    for (const auto& view : views)
+    {
+        m_cameraTransform = view.cameraTransform;
+        setRenderRegion(view.viewport[0], view.viewport[1], view.viewport[2], view.viewport[3]);
+
+        Frustum viewFrustum = setupView(observer);
+        Frustum viewXFrustum(viewFrustum);
+        viewXFrustum.transform(getCameraOrientationf().conjugate().toRotationMatrix());
+
+        // Only the depths of the shared entries depend on the view direction.
+        renderList = sharedRenderList;
+        orbitPathList = sharedOrbitPathList;
+
+        Vector3f viewMatZ = getCameraOrientationf().toRotationMatrix().row(2);
+        for (auto& rle : renderList)
+            rle.centerZ = rle.position.dot(viewMatZ);
+
+        Vector3d viewMatZd = getCameraOrientation().toRotationMatrix().row(2);
+        for (auto& path : orbitPathList)
+            path.centerZ = static_cast<float>(path.origin.dot(viewMatZd));
+
+        drawScene(universe, observer, sel, viewFrustum, viewXFrustum);
+    }
+
+    useSharedScene = false;
+
+    m_cameraTransform = savedCameraTransform;
+    removeScissor();
+    setViewport(savedViewport);
+    resize(savedWidth, savedHeight);
+}
+
+void Renderer::beginFrame(const Observer& observer, const Selection& sel)
+{
+    // Resolve the category names again if a category has been destroyed,
+    // as its bit may now belong to another one. A filter naming a category
+    // that no longer exists is dropped.
+    if (!categoryFilter.isCurrent())
+    {
+        auto filter = CategoryFilter::parse(categoryFilter.getExpression());
+        setCategoryFilter(filter.has_value() ? *std::move(filter) : CategoryFilter());
+    }
+
     realTime = observer.getRealTime();
+    observerOrigin = UniversalCoordOrigin(observer.getPosition());
+
+    // Track how far simulation time moves per frame. A single large step,
+    // e.g. after setting the date, isn't taken for a rate.
+    double now = observer.getTime();
+    double step = now - lastFrameTime;
+    if (step * lastFrameStep > 0.0)
+        simTimeStep = std::copysign(std::min(std::abs(step), std::abs(lastFrameStep)), step);
+    else
+        simTimeStep = 0.0;
+    lastFrameTime = now;
+    lastFrameStep = step;
 
     frameCount++;
     settingsChanged = false;
 
-    // Compute the size of a pixel
-    float zoom = observer.getZoom();
-    setFieldOfView(radToDeg(getProjectionMode()->getFOV(zoom)));
-    cosViewConeAngle = projectionMode->getViewConeAngleMax(zoom);
-    pixelSize = getProjectionMode()->getPixelSize(zoom);
-
     // Get the displayed surface texture set to use from the observer
     displayedSurface = observer.getDisplayedSurface();
 
@@ -1527,27 +1877,34 @@ void Renderer::draw(const Observer& observer,
 
     // Highlight the selected object
     highlightObject = sel;
+}
 
-    m_cameraOrientation = Quaterniond(m_cameraTransform) * observer.getOrientation();
-
-    // Get the view frustum used for culling in camera space.
-    auto frustum = projectionMode->getFrustum(MinNearPlaneDistance, std::numeric_limits<float>::infinity(), zoom);
+Frustum Renderer::setupView(const Observer& observer)
+{
+    // Compute the size of a pixel
+    float zoom = observer.getZoom();
+    setFieldOfView(radToDeg(getProjectionMode()->getFOV(zoom)));
+    cosViewConeAngle = projectionMode->getViewConeAngleMax(zoom);
+    pixelSize = getProjectionMode()->getPixelSize(zoom);
 
-    // Get the transformed frustum, used for culling in the astrocentric coordinate
-    // system.
-    Frustum xfrustum(frustum);
-    xfrustum.transform(getCameraOrientationf().conjugate().toRotationMatrix());
+    m_cameraOrientation = Quaterniond(m_cameraTransform) * observer.getOrientation();
 
     // Set up the projection and modelview matrices.
     // We'll usethem for positioning star and planet labels.
-    buildProjectionMatrix(m_projMatrix, NEAR_DIST, FAR_DIST, observer.getZoom());
+    buildProjectionMatrix(m_projMatrix, NEAR_DIST, FAR_DIST, zoom);
     m_modelMatrix = Affine3f(getCameraOrientationf()).matrix();
     m_MVPMatrix = m_projMatrix * m_modelMatrix;
 
-    depthSortedAnnotations.clear();
-    foregroundAnnotations.clear();
-    backgroundAnnotations.clear();
-    objectAnnotations.clear();
+    return projectionMode->getFrustum(MinNearPlaneDistance, std::numeric_limits<float>::infinity(), zoom);
+}
+
+void Renderer::buildScene(const Universe& universe,
+                          const Observer& observer,
+                          const Frustum& xfrustum,
+                          float faintestMagNight)
+{
+    // Get the observer's time
+    double now = observer.getTime();
 
     // Put all solar system bodies into the render list.  Stars close and
     // large enough to have discernible surface detail are also placed in
@@ -1561,7 +1918,7 @@ void Renderer::draw(const Observer& observer,
     // See if we want to use AutoMag.
     if ((renderFlags & ShowAutoMag) != 0)
     {
-        autoMag(faintestMag, zoom);
+        autoMag(faintestMag, observer.getZoom());
     }
     else
     {
@@ -1586,6 +1943,8 @@ void Renderer::draw(const Observer& observer,
         adjustMagnitudeInsideAtmosphere(faintestMag, saturationMag, now);
     }
 
+    findSkyOccluder();
+
     // Now we need to determine how to scale the brightness of stars.  The
     // brightness will be proportional to the apparent magnitude, i.e.
     // a logarithmic function of the stars apparent brightness.  This mimics
@@ -1606,6 +1965,25 @@ void Renderer::draw(const Observer& observer,
     satPoint = faintestMag - (1.0f - brightnessBias) / brightnessScale;
 
     ambientColor = Color(ambientLightLevel, ambientLightLevel, ambientLightLevel);
+}
+
+void Renderer::drawScene(const Universe& universe,
+                         const Observer& observer,
+                         const Selection& sel,
+                         const Frustum& frustum,
+                         const Frustum& xfrustum)
+{
+    double now = observer.getTime();
+
+    depthSortedAnnotations.clear();
+    foregroundAnnotations.clear();
+    backgroundAnnotations.clear();
+    objectAnnotations.clear();
+
+    if ((labelMode & BodyLabelMask) != 0)
+        buildLabelLists(xfrustum, now);
+
+    depthBufferMode = selectDepthBufferMode();
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -1625,6 +2003,12 @@ void Renderer::draw(const Observer& observer,
         renderPointStars(*universe.getStarCatalog(), faintestMag, observer);
     }
 
+    // Render the minor body population not promoted to bodies
+    if ((renderFlags & ShowAsteroids) != 0 && universe.getMinorBodyCatalog() != nullptr)
+    {
+        renderMinorBodies(universe, observer);
+    }
+
     // Translate the camera before rendering the asterisms and boundaries
     // Set up the camera for star rendering; the units of this phase
     // are light years.
@@ -1678,6 +2062,8 @@ void Renderer::draw(const Observer& observer,
 #endif
 
     int nIntervals = buildDepthPartitions();
+    if (depthBufferMode != DepthBufferMode::Partitioned)
+        nIntervals = mergeDepthPartitions(nIntervals);
     renderSolarSystemObjects(observer, nIntervals, now);
 
     renderForegroundAnnotations(FontNormal);
@@ -2540,8 +2926,9 @@ void Renderer::renderObject(const Vector3f& pos,
             // the viewer.
             if (distance > radius * 1.1f)
             {
+                float offset = isReverseDepthActive() ? 1.0f : -1.0f;
                 glEnable(GL_POLYGON_OFFSET_FILL);
-                glPolygonOffset(-1.0f, -1.0f);
+                glPolygonOffset(offset, offset);
             }
 
             if (lit)
@@ -2988,7 +3375,7 @@ void Renderer::renderPlanet(Body& body,
 
             // We need a double precision body-relative position of the
             // observer, otherwise location labels will tend to jitter.
-            Vector3d posd = body.getPosition(observer.getTime()).offsetFromKm(observer.getPosition());
+            Vector3d posd = observerOrigin.offsetKm(body.getPosition(observer.getTime()));
             locationsToAnnotations(body, posd, q);
         }
     }
@@ -3314,6 +3701,9 @@ void Renderer::buildRenderLists(const Vector3d& astrocentricObserverPos,
     double invCosViewAngle = 1.0 / cosViewConeAngle;
     double sinViewAngle = sqrt(1.0 - square(cosViewConeAngle));
 
+    // Find the positions of all active children first, so that their
+    // magnitudes and disc sizes can be evaluated in one batch.
+    std::size_t first = renderCandidates.size();
     unsigned int nChildren = tree != nullptr ? tree->childCount() : 0;
     for (unsigned int i = 0; i < nChildren; i++)
     {
@@ -3325,18 +3715,35 @@ void Renderer::buildRenderLists(const Vector3d& astrocentricObserverPos,
 
         Body* body = phase->body();
 
-        // pos_s: sun-relative position of object
-        // pos_v: viewer-relative position of object
-
         // Get the position of the body relative to the sun.
         Vector3d p = phase->orbit()->positionAtTime(now);
         auto frame = phase->orbitFrame();
         Vector3d pos_s = frameCenter + frame->getOrientation(now).conjugate() * p;
 
+        renderCandidates.emplace_back(body, pos_s);
+        candidatePhotometry.add(pos_s - astrocentricObserverPos, *body);
+    }
+
+    // Instead of summing the reflected light from all nearby stars, the
+    // apparent magnitude considers just the one with the highest apparent
+    // brightness.
+    candidatePhotometry.evaluate(first, BodyPhotometry::Model::Lambertian, lightSourceList, pixelSize);
+
+    std::size_t last = renderCandidates.size();
+    for (std::size_t i = first; i < last; i++)
+    {
+        // Copied, as the subtree traversal below appends to renderCandidates
+        Body* body = renderCandidates[i].first;
+
+        // pos_s: sun-relative position of object
+        // pos_v: viewer-relative position of object
+        Vector3d pos_s = renderCandidates[i].second;
+
         // We now have the positions of the observer and the planet relative
         // to the sun.  From these, compute the position of the body
         // relative to the observer.
         Vector3d pos_v = pos_s - astrocentricObserverPos;
+        double dist_v = candidatePhotometry.distance(i);
 
         // dist_vn: distance along view normal from the viewer to the
         // projection of the object's center.
@@ -3354,13 +3761,13 @@ void Renderer::buildRenderLists(const Vector3d& astrocentricObserverPos,
         if (body->isSecondaryIlluminator())
         {
             float influenceRadius = body->getBoundingRadius() + (body->getRadius() * PLANETSHINE_DISTANCE_LIMIT_FACTOR);
-            if (dist_vn > -influenceRadius)
+            if (allSkyCulling || dist_vn > -influenceRadius)
             {
                 double maxPerpDist = (influenceRadius + dist_vn * sinViewAngle) * invCosViewAngle;
                 double perpDistSq = toViewNormal.squaredNorm();
-                if (perpDistSq < maxPerpDist * maxPerpDist)
+                if (allSkyCulling || perpDistSq < maxPerpDist * maxPerpDist)
                 {
-                    if ((body->getRadius() / (float) pos_v.norm()) / pixelSize > PLANETSHINE_PIXEL_SIZE_LIMIT)
+                    if ((body->getRadius() / (float) dist_v) / pixelSize > PLANETSHINE_PIXEL_SIZE_LIMIT)
                     {
                         // add to planetshine list if larger than 1/10 pixel
 #if DEBUG_SECONDARY_ILLUMINATION
@@ -3385,8 +3792,8 @@ void Renderer::buildRenderLists(const Vector3d& astrocentricObserverPos,
             }
         }
 
-        bool insideViewCone = false;
-        if (!viewConeTestFailed)
+        bool insideViewCone = allSkyCulling;
+        if (!viewConeTestFailed && !insideViewCone)
         {
             float radius = body->getCullingRadius();
             if (dist_vn > -radius)
@@ -3399,26 +3806,21 @@ void Renderer::buildRenderLists(const Vector3d& astrocentricObserverPos,
 
         if (insideViewCone)
         {
-            // Calculate the distance to the viewer
-            double dist_v = pos_v.norm();
-
-            // Calculate the size of the planet/moon disc in pixels
-            float discSize = (body->getCullingRadius() / (float) dist_v) / pixelSize;
-
-            // Compute the apparent magnitude; instead of summing the reflected
-            // light from all nearby stars, we just consider the one with the
-            // highest apparent brightness.
-            float appMag = 100.0f;
-            for (unsigned int li = 0; li < lightSourceList.size(); li++)
-            {
-                Vector3d sunPos = pos_v - lightSourceList[li].position;
-                appMag = min(appMag, body->getApparentMagnitude(lightSourceList[li].luminosity, sunPos, pos_v));
-            }
+            // Size of the planet/moon disc in pixels
+            float discSize = candidatePhotometry.discSize(i);
+            float appMag = candidatePhotometry.appMag(i);
 
             bool visibleAsPoint = appMag < faintestPlanetMag && body->isVisibleAsPoint();
             bool isLabeled = (body->getOrbitClassification() & labelClassMask) != 0;
+            bool categoryVisible = true;
+            if (activeCategoryFilter != nullptr)
+            {
+                UserCategoryMask categoryMask = body->getCategoryMask();
+                categoryVisible = activeCategoryFilter->isVisible(categoryMask);
+                isLabeled = isLabeled || activeCategoryFilter->isLabeled(categoryMask);
+            }
 
-            if ((discSize > 1 || visibleAsPoint || isLabeled) && isBodyVisible(body, bodyVisibilityMask))
+            if ((discSize > 1 || visibleAsPoint || isLabeled) && categoryVisible && isBodyVisible(body, bodyVisibilityMask))
             {
                 RenderListEntry rle;
 
@@ -3441,7 +3843,6 @@ void Renderer::buildRenderLists(const Vector3d& astrocentricObserverPos,
         const FrameTree* subtree = body->getFrameTree();
         if (subtree != nullptr)
         {
-            double dist_v = pos_v.norm();
             bool traverseSubtree = false;
 
             // There are two different tests available to determine whether we can reject
@@ -3485,7 +3886,8 @@ void Renderer::buildRenderLists(const Vector3d& astrocentricObserverPos,
             if (brightestPossible < faintestPlanetMag || largestPossible > 1.0f)
             {
                 // See if the object or any of its children are within the view frustum
-                if (viewFrustum.testSphere(pos_v.cast<float>(), (float) subtree->boundingSphereRadius()) != Frustum::Outside)
+                if (allSkyCulling ||
+                    viewFrustum.testSphere(pos_v.cast<float>(), (float) subtree->boundingSphereRadius()) != Frustum::Outside)
                 {
                     traverseSubtree = true;
                 }
@@ -3522,6 +3924,9 @@ void Renderer::buildRenderLists(const Vector3d& astrocentricObserverPos,
             }
         } // end subtree traverse
     }
+
+    renderCandidates.resize(first);
+    candidatePhotometry.truncate(first);
 }
 
 
@@ -3560,6 +3965,7 @@ void Renderer::buildOrbitLists(const Vector3d& astrocentricObserverPos,
         Body::VisibilityPolicy orbitVis = body->getOrbitVisibility();
 
         if (body->isVisible() &&
+            (activeCategoryFilter == nullptr || activeCategoryFilter->isVisible(body->getCategoryMask())) &&
             (body == highlightObject.body() ||
              orbitVis == Body::AlwaysVisible ||
              (orbitVis == Body::UseClassVisibility && (body->getOrbitClassification() & orbitMask) != 0)))
@@ -3618,7 +4024,8 @@ void Renderer::buildOrbitLists(const Vector3d& astrocentricObserverPos,
             if (traverseSubtree)
             {
                 // See if the object or any of its children are within the view frustum
-                if (viewFrustum.testSphere(pos_v.cast<float>(), (float) subtree->boundingSphereRadius()) != Frustum::Outside)
+                if (allSkyCulling ||
+                    viewFrustum.testSphere(pos_v.cast<float>(), (float) subtree->boundingSphereRadius()) != Frustum::Outside)
                 {
                     buildOrbitLists(astrocentricObserverPos,
                                     observerOrientation,
@@ -3667,7 +4074,8 @@ void Renderer::buildLabelLists(const Frustum& viewFrustum,
         if (ri.renderableType != RenderListEntry::RenderableBody)
             continue;
 
-        if ((ri.body->getOrbitClassification() & labelClassMask) == 0)
+        if ((ri.body->getOrbitClassification() & labelClassMask) == 0 &&
+            (activeCategoryFilter == nullptr || !activeCategoryFilter->isLabeled(ri.body->getCategoryMask())))
             continue;
 
         if (viewFrustum.testSphere(ri.position, ri.radius) == Frustum::Outside)
@@ -3761,7 +4169,12 @@ void Renderer::buildLabelLists(const Frustum& viewFrustum,
             }
         }
 
-        Color labelColor = getBodyLabelColor(ri.body->getOrbitClassification());
+        const Color* categoryColor = activeCategoryFilter == nullptr
+            ? nullptr
+            : activeCategoryFilter->getColor(body->getCategoryMask());
+        Color labelColor = categoryColor == nullptr
+            ? getBodyLabelColor(ri.body->getOrbitClassification())
+            : *categoryColor;
         float opacity = sizeFade(boundingRadiusSize, minOrbitSize, 2.0f);
         labelColor.alpha(opacity * labelColor.alpha());
         addSortedAnnotation(nullptr, body->getName(true), labelColor, pos);
@@ -3819,6 +4232,37 @@ static double calcMaxFOV(double fovY_degrees, double aspectRatio)
 }
 
 
+float Renderer::getStarLabelThreshold() const
+{
+    // = 1.0 at startup
+    float effDistanceToScreen = mmToInches((float) REF_DISTANCE_TO_SCREEN) * pixelSize * getScreenDpi();
+    return 1.2f * max(1.0f, (faintestMag - 4.0f) * (1.0f - 0.5f * (float) log10(effDistanceToScreen)));
+}
+
+
+// Octree nodes drawn as one point can't leave out or label single objects
+bool Renderer::aggregatesAllowed() const
+{
+    return activeCategoryFilter == nullptr ||
+           !(activeCategoryFilter->hidesObjects() || activeCategoryFilter->labelsObjects());
+}
+
+
+void Renderer::setupStarTraversal(OctreeProcessor<Star, float>& processor) const
+{
+    processor.aggregateAngle = aggregatesAllowed() ? pixelSize : 0.0f;
+    processor.aggregateMag = (labelMode & StarLabels) != 0 ? getStarLabelThreshold() : -std::numeric_limits<float>::infinity();
+
+    processor.occluder.reset();
+    if (skyOccluder)
+    {
+        processor.occluder = OctreeOccluder<float>{ skyOccluder->axis.cast<float>(),
+                                                    static_cast<float>(skyOccluder->distance),
+                                                    static_cast<float>(skyOccluder->cosAngle) };
+    }
+}
+
+
 void Renderer::renderPointStars(const StarDatabase& starDB,
                                 float faintestMagNight,
                                 const Observer& observer)
@@ -3835,9 +4279,11 @@ void Renderer::renderPointStars(const StarDatabase& starDB,
     PointStarRenderer starRenderer;
 
     starRenderer.renderer          = this;
+    starRenderer.categoryFilter    = activeCategoryFilter;
     starRenderer.starDB            = &starDB;
     starRenderer.observer          = &observer;
     starRenderer.obsPos            = obsPos;
+    starRenderer.observerOrigin    = observerOrigin;
     starRenderer.viewNormal        = getCameraOrientationf().conjugate() * -Vector3f::UnitZ();
     starRenderer.renderList        = &renderList;
     starRenderer.starVertexBuffer  = pointStarVertexBuffer;
@@ -3851,9 +4297,8 @@ void Renderer::renderPointStars(const StarDatabase& starDB,
     starRenderer.labelMode         = labelMode;
     starRenderer.SolarSystemMaxDistance = SolarSystemMaxDistance;
 
-    // = 1.0 at startup
-    float effDistanceToScreen = mmToInches((float) REF_DISTANCE_TO_SCREEN) * pixelSize * getScreenDpi();
-    starRenderer.labelThresholdMag = 1.2f * max(1.0f, (faintestMag - 4.0f) * (1.0f - 0.5f * (float) log10(effDistanceToScreen)));
+    starRenderer.labelThresholdMag = getStarLabelThreshold();
+    setupStarTraversal(starRenderer);
 
     starRenderer.colorTemp = &starColors;
 
@@ -3880,17 +4325,24 @@ void Renderer::renderPointStars(const StarDatabase& starDB,
     m_starProcStats.height = 0;
     m_starProcStats.objects = 0;
 #endif
-    starDB.findVisibleStars(starRenderer,
-                            obsPos.cast<float>(),
-                            getCameraOrientationf(),
-                            degToRad(fov),
-                            getAspectRatio(),
-                            faintestMagNight,
+    if (useSharedScene)
+    {
+        sharedStars.replay(starRenderer);
+    }
+    else
+    {
+        starDB.findVisibleStars(starRenderer,
+                                obsPos.cast<float>(),
+                                getCameraOrientationf(),
+                                degToRad(fov),
+                                getAspectRatio(),
+                                faintestMagNight,
 #ifdef OCTREE_DEBUG
-                            &m_starProcStats);
+                                &m_starProcStats);
 #else
-                            nullptr);
+                                nullptr);
 #endif
+    }
 
     starRenderer.starVertexBuffer->finish();
     starRenderer.glareVertexBuffer->finish();
@@ -3902,6 +4354,59 @@ void Renderer::renderPointStars(const StarDatabase& starDB,
 #endif
 }
 
+
+void Renderer::renderMinorBodies(const Universe& universe,
+                                 const Observer& observer)
+{
+    // Catalog entries aren't in any category
+    if (activeCategoryFilter != nullptr && !activeCategoryFilter->isVisible(0))
+        return;
+
+    gaussianDiscTex->bind();
+    pointStarVertexBuffer->setTexture(gaussianDiscTex);
+    pointStarVertexBuffer->setPointScale(screenDpi / 96.0f);
+
+    PointStarVertexBuffer::enable();
+    if (starStyle == PointStars)
+        pointStarVertexBuffer->startBasicPoints();
+    else
+        pointStarVertexBuffer->startSprites();
+
+    Renderer::PipelineState ps;
+    ps.blending = true;
+    ps.blendFunc = {GL_SRC_ALPHA, GL_ONE};
+    setPipelineState(ps);
+
+    float cosFOV = (float) cos(degToRad(calcMaxFOV(fov, getAspectRatio())) / 2.0f);
+    m_minorBodyRenderer->render(universe,
+                                observer,
+                                *pointStarVertexBuffer,
+                                pixelSize,
+                                cosFOV,
+                                faintestPlanetMag,
+                                (labelMode & AsteroidLabels) != 0);
+
+    pointStarVertexBuffer->finish();
+    PointStarVertexBuffer::disable();
+}
+
+float Renderer::getDSOLabelThreshold() const
+{
+    // Use pixelSize * screenDpi instead of FoV, to eliminate windowHeight dependence.
+    // = 1.0 at startup
+    float effDistanceToScreen = mmToInches((float) REF_DISTANCE_TO_SCREEN) * pixelSize * getScreenDpi();
+    return 2.0f * max(1.0f, (faintestMag - 4.0f) * (1.0f - 0.5f * log10(effDistanceToScreen)));
+}
+
+
+void Renderer::setupDSOTraversal(OctreeProcessor<DeepSkyObject*, double>& processor) const
+{
+    processor.aggregateAngle = aggregatesAllowed() ? pixelSize : 0.0f;
+    processor.aggregateMag = (labelMode & GalaxyLabels) != 0 ? getDSOLabelThreshold() : -std::numeric_limits<float>::infinity();
+    processor.occluder = skyOccluder;
+}
+
+
 void Renderer::renderDeepSkyObjects(const Universe& universe,
                                     const Observer& observer,
                                     const float     faintestMagNight)
@@ -3927,6 +4432,7 @@ void Renderer::renderDeepSkyObjects(const Universe& universe,
     DSODatabase* dsoDB  = universe.getDSOCatalog();
 
     dsoRenderer.renderer         = this;
+    dsoRenderer.categoryFilter   = activeCategoryFilter;
     dsoRenderer.dsoDB            = dsoDB;
     dsoRenderer.orientationMatrixT = cameraOrientation.toRotationMatrix();
     dsoRenderer.observer         = &observer;
@@ -3940,11 +4446,8 @@ void Renderer::renderDeepSkyObjects(const Universe& universe,
     dsoRenderer.labelMode        = labelMode;
 
     dsoRenderer.frustum = projectionMode->getFrustum(MinNearPlaneDistance, std::numeric_limits<float>::infinity(), observer.getZoom());
-    // Use pixelSize * screenDpi instead of FoV, to eliminate windowHeight dependence.
-    // = 1.0 at startup
-    float effDistanceToScreen = mmToInches((float) REF_DISTANCE_TO_SCREEN) * pixelSize * getScreenDpi();
-
-    dsoRenderer.labelThresholdMag = 2.0f * max(1.0f, (faintestMag - 4.0f) * (1.0f - 0.5f * log10(effDistanceToScreen)));
+    dsoRenderer.labelThresholdMag = getDSOLabelThreshold();
+    setupDSOTraversal(dsoRenderer);
 
     using namespace celestia;
     galaxyRep      = MarkerRepresentation(MarkerRepresentation::Triangle, 8.0f, GalaxyLabelColor);
@@ -3958,23 +4461,49 @@ void Renderer::renderDeepSkyObjects(const Universe& universe,
     m_dsoProcStats.height = 0;
 #endif
 
-    dsoDB->findVisibleDSOs(dsoRenderer,
-                           obsPos,
-                           cameraOrientation,
-                           degToRad(fov),
-                           getAspectRatio(),
-                           2 * faintestMagNight,
+    if (useSharedScene)
+    {
+        sharedDSOs.replay(dsoRenderer);
+    }
+    else
+    {
+        dsoDB->findVisibleDSOs(dsoRenderer,
+                               obsPos,
+                               cameraOrientation,
+                               degToRad(fov),
+                               getAspectRatio(),
+                               2 * faintestMagNight,
 #ifdef OCTREE_DEBUG
-                           &m_dsoProcStats);
+                               &m_dsoProcStats);
 #else
-                            nullptr);
+                               nullptr);
 #endif
+    }
 
     m_galaxyRenderer->render();
     m_globularRenderer->render();
     m_nebulaRenderer->render();
     m_openClusterRenderer->render();
 
+    if (!dsoRenderer.aggregatePoints.empty())
+    {
+        gaussianDiscTex->bind();
+        pointStarVertexBuffer->setTexture(gaussianDiscTex);
+        pointStarVertexBuffer->setPointScale(screenDpi / 96.0f);
+
+        Renderer::PipelineState ps;
+        ps.blending = true;
+        ps.blendFunc = {GL_SRC_ALPHA, GL_ONE};
+        setPipelineState(ps);
+
+        PointStarVertexBuffer::enable();
+        pointStarVertexBuffer->startSprites();
+        for (const auto& point : dsoRenderer.aggregatePoints)
+            pointStarVertexBuffer->addStar(point.position, point.color, point.size);
+        pointStarVertexBuffer->finish();
+        PointStarVertexBuffer::disable();
+    }
+
     // clog << "DSOs processed: " << dsoRenderer.dsosProcessed << endl;
 }
 
@@ -4289,7 +4818,7 @@ Renderer::renderAnnotations(vector<Annotation>::iterator startIter,
     for (; iter != endIter && iter->position.z() > nearDist; ++iter)
     {
         // Compute normalized device z
-        float z = getProjectionMode()->getNormalizedDeviceZ(nearDist, farDist, iter->position.z());
+        float z = getAnnotationDepth(nearDist, farDist, iter->position.z());
         float ndc_z = std::clamp(z, -1.0f, 1.0f);
 
         if (iter->markerRep != nullptr)
@@ -4318,13 +4847,12 @@ void Renderer::markersToAnnotations(const celestia::MarkerList& markers,
                                     const Observer& observer,
                                     double jd)
 {
-    const UniversalCoord& cameraPosition = observer.getPosition();
     const Quaterniond& cameraOrientation = getCameraOrientation();
     Vector3d viewVector = cameraOrientation.conjugate() * -Vector3d::UnitZ();
 
     for (const auto& marker : markers)
     {
-        Vector3d offset = marker.position(jd).offsetFromKm(cameraPosition);
+        Vector3d offset = observerOrigin.offsetKm(marker.position(jd));
 
         double distance = offset.norm();
         // Only render those markers that lie withing the field of view.
@@ -5035,6 +5563,38 @@ Renderer::selectionToAnnotation(const Selection &sel,
     return true;
 }
 
+// Find the body hiding the largest part of the sky, usually the planet the
+// observer is on or orbiting. Only ellipsoids are considered, with their
+// smallest semi-axis as radius.
+void
+Renderer::findSkyOccluder()
+{
+    skyOccluder.reset();
+
+    double maxAngle = MinSkyOccluderAngle;
+    for (const auto& ri : renderList)
+    {
+        if (ri.renderableType != RenderListEntry::RenderableBody || !ri.body->isEllipsoid())
+            continue;
+
+        Vector3d position = ri.position.cast<double>();
+        double distance = position.norm();
+        double radius = ri.body->getSemiAxes().minCoeff();
+        if (distance <= radius)
+            continue;
+
+        double angle = std::asin(radius / distance) - SkyOccluderAngleMargin;
+        if (angle <= maxAngle)
+            continue;
+
+        maxAngle = angle;
+        skyOccluder = OctreeOccluder<double>{ position / distance,
+                                              astro::kilometersToLightYears(distance),
+                                              std::cos(angle) };
+    }
+}
+
+
 void
 Renderer::adjustMagnitudeInsideAtmosphere(float &faintestMag,
                                           float &saturationMag,
@@ -5098,7 +5658,7 @@ Renderer::buildNearSystemsLists(const Universe &universe,
     // Skip if only star orbits to be shown
     if ((renderFlags & ShowSolarSystemObjects) != 0)
         setupLightSources(nearStars,
-                          observerPos,
+                          observerOrigin,
                           now,
                           lightSourceList,
                           tintSaturation,
@@ -5142,8 +5702,6 @@ Renderer::buildNearSystemsLists(const Universe &universe,
         }
     }
 
-    if ((labelMode & BodyLabelMask) != 0)
-        buildLabelLists(xfrustum, now);
 }
 
 int
@@ -5289,11 +5847,170 @@ Renderer::buildDepthPartitions()
     return nIntervals;
 }
 
+int
+Renderer::mergeDepthPartitions(int nIntervals)
+{
+    // Logarithmic and reverse-Z depth have enough precision to cover the
+    // whole solar system at once, so everything goes in a single interval
+    // spanning from the nearest to the farthest partition.
+    if (nIntervals <= 1)
+        return nIntervals;
+
+    DepthBufferPartition partition;
+    partition.index = 0;
+    partition.nearZ = depthPartitions[nIntervals - 1].nearZ;
+    partition.farZ = depthPartitions[0].farZ;
+    depthPartitions.clear();
+    depthPartitions.push_back(partition);
+
+    return 1;
+}
+
+Renderer::DepthBufferMode
+Renderer::selectDepthBufferMode()
+{
+    // Depth partitioning works everywhere, and is the only option for
+    // projections that don't end in a perspective divide.
+    if (!projectionMode->isPerspective())
+        return DepthBufferMode::Partitioned;
+
+    switch (requestedDepthMode)
+    {
+    case DepthBufferMode::Logarithmic:
+        return shaderManager->isLogDepthEnabled() ? DepthBufferMode::Logarithmic : DepthBufferMode::Partitioned;
+    case DepthBufferMode::Automatic:
+        // Prefer a single pass. The shaders were built for log depth
+        // unless init() found a floating point depth buffer.
+        if (shaderManager->isLogDepthEnabled())
+            return DepthBufferMode::Logarithmic;
+        if (hasFloatDepthBuffer())
+            return DepthBufferMode::ReverseZ;
+        return DepthBufferMode::Partitioned;
+    case DepthBufferMode::ReverseZ:
+        // Reversing a fixed point depth buffer gains nothing, so the
+        // target framebuffer has to have a floating point depth component.
+        if (hasFloatDepthBuffer())
+            return DepthBufferMode::ReverseZ;
+        return DepthBufferMode::Partitioned;
+    default:
+        return DepthBufferMode::Partitioned;
+    }
+}
+
+bool
+Renderer::hasFloatDepthBuffer()
+{
+    // Window system framebuffers, as used by the bundled frontends, have
+    // fixed point depth; only framebuffer objects of an embedding
+    // application may have a floating point depth attachment.
+#ifdef GL_ES
+    return false;
+#else
+    if (!gl::ARB_clip_control)
+        return false;
+
+    GLint fbo = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &fbo);
+    if (fbo != depthFormatFramebuffer)
+    {
+        GLint type = GL_NONE;
+        glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER,
+                                              fbo == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT,
+                                              GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE,
+                                              &type);
+        depthFormatFramebuffer = fbo;
+        floatDepthBuffer = type == GL_FLOAT;
+    }
+    return floatDepthBuffer;
+#endif
+}
+
+void
+Renderer::beginReverseDepth()
+{
+#ifndef GL_ES
+    reverseDepthActive = true;
+    resumeReverseDepth();
+
+    // Whatever was drawn before used the conventional depth encoding
+    if (!m_pipelineState.depthMask)
+        glDepthMask(GL_TRUE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    if (!m_pipelineState.depthMask)
+        glDepthMask(GL_FALSE);
+#endif
+}
+
+void
+Renderer::endReverseDepth()
+{
+#ifndef GL_ES
+    suspendReverseDepth();
+    reverseDepthActive = false;
+#endif
+}
+
+void
+Renderer::suspendReverseDepth() const
+{
+#ifndef GL_ES
+    if (!reverseDepthActive)
+        return;
+    glClipControl(GL_LOWER_LEFT, GL_NEGATIVE_ONE_TO_ONE);
+    glDepthFunc(GL_LEQUAL);
+    glClearDepth(1.0);
+#endif
+}
+
+void
+Renderer::resumeReverseDepth() const
+{
+#ifndef GL_ES
+    if (!reverseDepthActive)
+        return;
+    // Clip space depth from 0 to 1 keeps the near plane at 1.0 exactly
+    // instead of letting the remap from [-1, 1] round it away.
+    glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+    glDepthFunc(GL_GEQUAL);
+    glClearDepth(0.0);
+#endif
+}
+
+Renderer::DepthBufferMode
+Renderer::getDepthBufferMode() const
+{
+    return depthBufferMode;
+}
+
+bool
+Renderer::isReverseDepthActive() const
+{
+    return reverseDepthActive;
+}
+
+float
+Renderer::getAnnotationDepth(float nearZ, float farZ, float z) const
+{
+    // Annotations are drawn with an orthographic projection, so compute the
+    // depth the current encoding would give a point at distance z. Like
+    // getNormalizedDeviceZ(), the result is negated for use as eye z.
+    if (reverseDepthActive)
+        return -nearZ * (farZ - z) / (z * (farZ - nearZ));
+    if (depthBufferMode == DepthBufferMode::Logarithmic)
+        return 1.0f - std::log2(1.0f + z) * ShaderManager::LogDepthFactor;
+    return projectionMode->getNormalizedDeviceZ(nearZ, farZ, z);
+}
+
 void
 Renderer::renderSolarSystemObjects(const Observer &observer,
                                    int nIntervals,
                                    double now)
 {
+    if (depthBufferMode == DepthBufferMode::ReverseZ)
+        beginReverseDepth();
+
+    sampleOrbits(now);
+
     // Render everything that wasn't culled.
     auto annotation = depthSortedAnnotations.begin();
     float intervalSize = 1.0f / static_cast<float>(max(1, nIntervals));
@@ -5400,6 +6117,9 @@ Renderer::renderSolarSystemObjects(const Observer &observer,
     // reset the depth range
     glDepthRange(0, 1);
     setDefaultProjectionMatrix();
+
+    if (reverseDepthActive)
+        endReverseDepth();
 }
 
 void
@@ -5446,4 +6166,12 @@ Renderer::setPipelineState(const Renderer::PipelineState &ps) noexcept
 void Renderer::buildProjectionMatrix(Eigen::Matrix4f &mat, float nearZ, float farZ, float zoom) const
 {
     mat = projectionMode->getProjectionMatrix(nearZ, farZ, zoom);
+    if (reverseDepthActive)
+    {
+        // Map the near plane to 1 and the far plane to 0. The depth row is
+        // built directly rather than derived from the conventional one to
+        // avoid cancellation when the planes are far apart.
+        float d = farZ - nearZ;
+        mat.row(2) << 0.0f, 0.0f, nearZ / d, nearZ * farZ / d;
+    }
 }
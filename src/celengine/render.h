@@ -10,13 +10,18 @@
 
 #pragma once
 
+#include <array>
 #include <list>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <Eigen/Core>
 
+#include <celengine/bodyphotometry.h>
+#include <celengine/categoryfilter.h>
 #include <celengine/lightenv.h>
 #include <celengine/universe.h>
 #include <celengine/selection.h>
@@ -105,6 +110,16 @@ class Renderer
         } blendFunc;
     };
 
+    // How hidden surface removal copes with the huge depth range of a
+    // solar system scene.
+    enum class DepthBufferMode
+    {
+        Automatic,   // reverse-Z with a float depth buffer, else logarithmic
+        Partitioned, // split the depth range into intervals drawn in turn
+        Logarithmic, // logarithmic depth generated by the vertex shaders
+        ReverseZ,    // reversed floating point depth, needs clip control
+    };
+
     struct DetailOptions
     {
         DetailOptions();
@@ -114,6 +129,8 @@ class Renderer
         double orbitWindowEnd{ 0.5 };
         double orbitPeriodsShown{ 1.0 };
         double linearFadeFraction{ 0.0 };
+        unsigned int orbitLookaheadFrames{ 30 };
+        DepthBufferMode depthBufferMode{ DepthBufferMode::Automatic };
 #ifndef GL_ES
         bool useMesaPackInvert{ true };
 #endif
@@ -140,6 +157,30 @@ class Renderer
               float faintestVisible,
               const Selection& sel);
 
+    // One view of a multi-view frame (cube map face, stereo eye, ...). The
+    // camera transform is applied on top of the observer orientation in the
+    // same way as setCameraTransform(); the viewport is in window pixels.
+    struct ViewSpec
+    {
+        Eigen::Matrix3d cameraTransform{ Eigen::Matrix3d::Identity() };
+        std::array<int, 4> viewport{ 0, 0, 0, 0 };
+    };
+
+    // Render several views of the same scene. Body states, render and orbit
+    // lists, light sources and the visible star and DSO sets are computed
+    // once for the union of the view frusta; only projection, labeling and
+    // drawing are repeated for every view.
+    void renderViews(const Observer&,
+                     const Universe&,
+                     float faintestVisible,
+                     const Selection& sel,
+                     celestia::util::array_view<ViewSpec> views);
+
+    // Minor body catalog entries that rendering asked to promote to bodies
+    // since the last call, brightest first. Rendering only reads the
+    // universe, so the caller promotes them.
+    std::vector<MinorBodyCatalog::IndexNumber> takeMinorBodyPromotions();
+
     bool getInfo(std::map<std::string, std::string>& info) const;
 
     enum
@@ -243,6 +284,8 @@ class Renderer
     void setRenderFlags(uint64_t);
     int getLabelMode() const;
     void setLabelMode(int);
+    const CategoryFilter& getCategoryFilter() const;
+    void setCategoryFilter(CategoryFilter&&);
     std::shared_ptr<celestia::engine::ProjectionMode> getProjectionMode() const;
     void setProjectionMode(std::shared_ptr<celestia::engine::ProjectionMode>);
     float getAmbientLightLevel() const;
@@ -351,6 +394,13 @@ class Renderer
 
     void buildProjectionMatrix(Eigen::Matrix4f &mat, float nearZ, float farZ, float zoom) const;
 
+    DepthBufferMode getDepthBufferMode() const;
+    bool isReverseDepthActive() const;
+    // Offscreen passes such as shadow maps use the conventional depth
+    // setup; bracket them with these while reverse-Z is active.
+    void suspendReverseDepth() const;
+    void resumeReverseDepth() const;
+
     void setStarStyle(StarStyle);
     StarStyle getStarStyle() const;
     void setResolution(unsigned int resolution);
@@ -389,21 +439,21 @@ class Renderer
     };
 
     void addForegroundAnnotation(const celestia::MarkerRepresentation* markerRep,
-                                 const std::string& labelText,
+                                 std::string_view labelText,
                                  Color color,
                                  const Eigen::Vector3f& position,
                                  LabelHorizontalAlignment halign = LabelHorizontalAlignment::Start,
                                  LabelVerticalAlignment valign = LabelVerticalAlignment::Bottom,
                                  float size = 0.0f);
     void addBackgroundAnnotation(const celestia::MarkerRepresentation* markerRep,
-                                 const std::string& labelText,
+                                 std::string_view labelText,
                                  Color color,
                                  const Eigen::Vector3f& position,
                                  LabelHorizontalAlignment halign = LabelHorizontalAlignment::Start,
                                  LabelVerticalAlignment valign = LabelVerticalAlignment::Bottom,
                                  float size = 0.0f);
     void addSortedAnnotation(const celestia::MarkerRepresentation* markerRep,
-                             const std::string& labelText,
+                             std::string_view labelText,
                              Color color,
                              const Eigen::Vector3f& position,
                              LabelHorizontalAlignment halign = LabelHorizontalAlignment::Start,
@@ -415,7 +465,7 @@ class Renderer
     // Callbacks for renderables; these belong in a special renderer interface
     // only visible in object's render methods.
     void beginObjectAnnotations();
-    void addObjectAnnotation(const celestia::MarkerRepresentation* markerRep, const std::string& labelText, Color, const Eigen::Vector3f&, LabelHorizontalAlignment halign, LabelVerticalAlignment valign);
+    void addObjectAnnotation(const celestia::MarkerRepresentation* markerRep, std::string_view labelText, Color, const Eigen::Vector3f&, LabelHorizontalAlignment halign, LabelVerticalAlignment valign);
     void endObjectAnnotations();
     Eigen::Quaternionf getCameraOrientationf() const;
     Eigen::Quaterniond getCameraOrientation() const;
@@ -485,12 +535,35 @@ class Renderer
 
  private:
     void setFieldOfView(float);
+
+    void beginFrame(const Observer&, const Selection&);
+    celmath::Frustum setupView(const Observer&);
+    void buildScene(const Universe&,
+                    const Observer&,
+                    const celmath::Frustum& xfrustum,
+                    float faintestMagNight);
+    void drawScene(const Universe&,
+                   const Observer&,
+                   const Selection&,
+                   const celmath::Frustum& frustum,
+                   const celmath::Frustum& xfrustum);
+
     void renderPointStars(const StarDatabase& starDB,
                           float faintestVisible,
                           const Observer& observer);
+    float getStarLabelThreshold() const;
+    // False if the category filter hides or labels single objects
+    bool aggregatesAllowed() const;
+    // Let the star octree draw stars that would fall on the same pixel as
+    // one, as long as they don't need labels
+    void setupStarTraversal(OctreeProcessor<Star, float>&) const;
+    void renderMinorBodies(const Universe&,
+                           const Observer&);
     void renderDeepSkyObjects(const Universe&,
                               const Observer&,
                               float faintestMagNight);
+    float getDSOLabelThreshold() const;
+    void setupDSOTraversal(OctreeProcessor<DeepSkyObject*, double>&) const;
     void renderSkyGrids(const Observer& observer);
     void renderSelectionPointer(const Observer& observer,
                                 double now,
@@ -521,6 +594,12 @@ class Renderer
     void buildLabelLists(const celmath::Frustum& viewFrustum,
                          double now);
     int buildDepthPartitions();
+    int mergeDepthPartitions(int nIntervals);
+    DepthBufferMode selectDepthBufferMode();
+    bool hasFloatDepthBuffer();
+    void beginReverseDepth();
+    void endReverseDepth();
+    float getAnnotationDepth(float nearZ, float farZ, float z) const;
 
 
     void addRenderListEntries(RenderListEntry& rle,
@@ -612,7 +691,7 @@ class Renderer
 
     void addAnnotation(std::vector<Annotation>&,
                        const celestia::MarkerRepresentation*,
-                       const std::string& labelText,
+                       std::string_view labelText,
                        Color color,
                        const Eigen::Vector3f& position,
                        LabelHorizontalAlignment halign = LabelHorizontalAlignment::Start,
@@ -652,10 +731,20 @@ class Renderer
                                const celmath::Frustum &xfrustum,
                                double now);
 
+    void findSkyOccluder();
     void adjustMagnitudeInsideAtmosphere(float &faintestMag,
                                          float &saturationMag,
                                          double now);
 
+    struct OrbitWindowUpdate;
+
+    void sampleOrbits(double now);
+    bool planOrbitWindow(const celestia::ephem::Orbit* orbit,
+                         const CurvePlot* plot,
+                         double now,
+                         double lookahead,
+                         OrbitWindowUpdate& update) const;
+    void addToOrbitCache(const celestia::ephem::Orbit* orbit, CurvePlot* plot);
     void renderOrbit(const OrbitPathListEntry&,
                      double now,
                      const Eigen::Quaterniond& cameraOrientation,
@@ -687,6 +776,9 @@ class Renderer
     std::shared_ptr<celestia::engine::ProjectionMode> projectionMode{ nullptr };
     int renderMode;
     int labelMode;
+    CategoryFilter categoryFilter;
+    // Points to categoryFilter unless it has no rules
+    const CategoryFilter* activeCategoryFilter{ nullptr };
     bool rtl{ false };
     bool showSelectionPointer{ true };
     uint64_t renderFlags;
@@ -712,12 +804,33 @@ class Renderer
     PointStarVertexBuffer* glareVertexBuffer;
     std::vector<RenderListEntry> renderList;
     std::vector<SecondaryIlluminator> secondaryIlluminators;
+    // Bodies visited by buildRenderLists() with their sun-relative
+    // positions; each level of the frame tree appends after its parent.
+    std::vector<std::pair<Body*, Eigen::Vector3d>> renderCandidates;
+    BodyPhotometry candidatePhotometry;
     std::vector<DepthBufferPartition> depthPartitions;
+    DepthBufferMode requestedDepthMode{ DepthBufferMode::Automatic };
+    DepthBufferMode depthBufferMode{ DepthBufferMode::Partitioned };
+    bool reverseDepthActive{ false };
+    // Draw framebuffer whose depth format was last queried
+    GLint depthFormatFramebuffer{ -1 };
+    bool floatDepthBuffer{ false };
     std::vector<Annotation> backgroundAnnotations;
     std::vector<Annotation> foregroundAnnotations;
     std::vector<Annotation> depthSortedAnnotations;
     std::vector<Annotation> objectAnnotations;
     std::vector<OrbitPathListEntry> orbitPathList;
+    // Scene state shared by all views in renderViews()
+    std::vector<RenderListEntry> sharedRenderList;
+    std::vector<OrbitPathListEntry> sharedOrbitPathList;
+    OctreeObjectCollector<Star, float> sharedStars;
+    OctreeObjectCollector<DeepSkyObject*, double> sharedDSOs;
+    // Body hiding part of the sky from the observer, in light years
+    std::optional<OctreeOccluder<double>> skyOccluder;
+    bool useSharedScene{ false };
+    // Disable view cone culling while building the shared scene state for
+    // views that together cover most of the sky.
+    bool allSkyCulling{ false };
     LightingState::EclipseShadowVector eclipseShadows[MaxLights];
     std::vector<const Star*> nearStars;
 
@@ -746,6 +859,16 @@ class Renderer
     OrbitCache orbitCache;
     uint32_t lastOrbitCacheFlush;
 
+    // Simulation time elapsed per frame, used to look ahead when time runs
+    // fast; zero when it isn't moving steadily.
+    double simTimeStep{ 0.0 };
+    double lastFrameTime{ 0.0 };
+    double lastFrameStep{ 0.0 };
+
+    // Observer position for the frame, from which per-object positions are
+    // converted to offsets
+    UniversalCoordOrigin observerOrigin;
+
     float minOrbitSize;
     float distanceLimit;
     float minFeatureSize;
@@ -788,6 +911,7 @@ class Renderer
     std::unique_ptr<celestia::render::GlobularRenderer> m_globularRenderer;
     std::unique_ptr<celestia::render::LargeStarRenderer> m_largeStarRenderer;
     std::unique_ptr<celestia::render::LineRenderer> m_hollowMarkerRenderer;
+    std::unique_ptr<celestia::render::MinorBodyRenderer> m_minorBodyRenderer;
     std::unique_ptr<celestia::render::NebulaRenderer> m_nebulaRenderer;
     std::unique_ptr<celestia::render::OpenClusterRenderer> m_openClusterRenderer;
 
@@ -849,6 +973,8 @@ class Renderer
     static Color SelectionCursorColor;
 
     friend class PointStarRenderer;
+    friend class DSORenderer;
+    friend class celestia::render::MinorBodyRenderer;
 };
 
 
@@ -480,8 +480,10 @@ void renderGeometry_GLSL(Geometry* geometry,
         fmt::printf("bias: %f bits: %f clear: %f range: %f - %f, scale:%f\n", bias, bits, clear, range[0], range[1], scale);
 #endif
 
+        renderer->suspendReverseDepth();
         renderGeometryShadow_GLSL(geometry, shadowBuffer, ls, 0,
                                   tsec, renderer, &lightMatrix);
+        renderer->resumeReverseDepth();
         renderer->setViewport(viewport);
 #ifdef DEPTH_BUFFER_DEBUG
         glDisable(GL_DEPTH_TEST);
@@ -0,0 +1,415 @@
+// routepreloader.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Background loading of the textures and models needed at the end of a
+// journey.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include "routepreloader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include <celengine/atmosphere.h>
+#include <celengine/body.h>
+#include <celengine/geometry.h>
+#include <celengine/meshmanager.h>
+#include <celengine/multitexture.h>
+#include <celengine/render.h>
+#include <celengine/texmanager.h>
+#include <celengine/virtualtex.h>
+#include <celmath/mathlib.h>
+#include <celutil/gettext.h>
+#include <celutil/logger.h>
+
+using celestia::util::GetLogger;
+
+namespace
+{
+
+// Time per frame spent creating preloaded resources on the main thread
+constexpr double FrameBudget = 0.004;
+
+// Bodies other than the target are preloaded when their disc will be at
+// least this many pixels across on arrival.
+constexpr float MinDiscSize = 8.0f;
+
+// Upper limit on the virtual texture tiles preloaded for one texture
+constexpr int MaxPreloadTiles = 512;
+
+// Routes are dropped if they haven't finished this long after arrival
+constexpr double MaxOverrun = 30.0;
+
+std::chrono::steady_clock::duration
+toDuration(double seconds)
+{
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(std::max(seconds, 0.0)));
+}
+
+// Level of detail of a virtual texture at which a disc of the given size
+// shows about one texel per pixel.
+int
+tileLevel(float discSize)
+{
+    if (discSize <= 0.0f)
+        return -1;
+    return static_cast<int>(std::ceil(std::log2(std::max(discSize * celestia::numbers::pi_v<float>, 1.0f))));
+}
+
+} // end unnamed namespace
+
+
+RoutePreloader::RoutePreloader(const Renderer& _renderer) :
+    renderer(_renderer)
+{
+}
+
+
+RoutePreloader::~RoutePreloader() = default;
+
+
+void
+RoutePreloader::preload(const Selection& target,
+                        const UniversalCoord& viewpoint,
+                        double tdb,
+                        double secondsToArrival,
+                        float fov)
+{
+    // Stars and deep sky objects have no per-object resources
+    Body* body = target.body();
+    if (body == nullptr || (target == lastTarget && Clock::now() < lastDeadline))
+        return;
+
+    auto route = std::make_unique<Route>();
+    route->target = target;
+    route->name = target.getName(true);
+
+    float pixelSize = 2.0f * std::tan(fov * 0.5f) / static_cast<float>(std::max(renderer.getWindowHeight(), 1));
+    auto discSize = [&](const Body* b)
+    {
+        double distance = viewpoint.offsetFromKm(b->getPosition(tdb)).norm();
+        if (distance <= b->getRadius())
+            return std::numeric_limits<float>::max();
+        return static_cast<float>(2.0 * b->getRadius() / distance) / pixelSize;
+    };
+
+    auto addSystem = [&](const PlanetarySystem* system)
+    {
+        if (system == nullptr)
+            return;
+        for (int i = 0; i < system->getSystemSize(); ++i)
+        {
+            Body* satellite = system->getBody(i);
+            if (satellite == body)
+                continue;
+            if (float size = discSize(satellite); size >= MinDiscSize)
+                addBody(*route, satellite, size);
+        }
+    };
+
+    addBody(*route, body, discSize(body));
+    addSystem(body->getSatellites());
+    if (const PlanetarySystem* system = body->getSystem(); system != nullptr)
+    {
+        if (Body* primary = system->getPrimaryBody(); primary != nullptr)
+        {
+            if (float size = discSize(primary); size >= MinDiscSize)
+                addBody(*route, primary, size);
+        }
+        addSystem(system);
+    }
+
+    lastTarget = target;
+    lastDeadline = Clock::now() + toDuration(secondsToArrival);
+    startRoute(std::move(route), lastDeadline);
+}
+
+
+void
+RoutePreloader::preload(Body* body)
+{
+    if (body == nullptr)
+        return;
+
+    auto route = std::make_unique<Route>();
+    route->target = Selection(body);
+    route->name = body->getName(true);
+    addBody(*route, body, 0.0f);
+    startRoute(std::move(route), Clock::time_point::max());
+}
+
+
+void
+RoutePreloader::startRoute(std::unique_ptr<Route>&& route, Clock::time_point deadline)
+{
+    route->start = Clock::now();
+    route->deadline = deadline;
+    routes.push_back(std::move(route));
+
+    // Start the background work now rather than on the next frame
+    updateRoute(*routes.back());
+}
+
+
+void
+RoutePreloader::addBody(Route& route, Body* body, float discSize) const
+{
+    Surface& surface = body->getSurface();
+    std::uint64_t renderFlags = renderer.getRenderFlags();
+    int tileLOD = tileLevel(discSize);
+
+    addTexture(route, surface.baseTexture, tileLOD);
+    if ((surface.appearanceFlags & Surface::ApplyBumpMap) != 0)
+        addTexture(route, surface.bumpTexture, tileLOD);
+    if ((surface.appearanceFlags & Surface::ApplyNightMap) != 0 &&
+        (renderFlags & Renderer::ShowNightMaps) != 0)
+    {
+        addTexture(route, surface.nightTexture, tileLOD);
+    }
+    if ((surface.appearanceFlags & Surface::SeparateSpecularMap) != 0)
+        addTexture(route, surface.specularTexture, tileLOD);
+    if ((surface.appearanceFlags & Surface::ApplyOverlay) != 0)
+        addTexture(route, surface.overlayTexture, tileLOD);
+
+    if (const Atmosphere* atmosphere = body->getAtmosphere();
+        atmosphere != nullptr && (renderFlags & Renderer::ShowCloudMaps) != 0)
+    {
+        addTexture(route, atmosphere->cloudTexture, tileLOD);
+    }
+
+    if (const RingSystem* rings = body->getRings(); rings != nullptr)
+        addTexture(route, rings->texture, -1);
+
+    if (ResourceHandle geometry = body->getGeometry(); geometry != InvalidResource)
+    {
+        auto iter = std::find_if(route.geometries.begin(), route.geometries.end(),
+                                 [geometry](const GeometryRequest& r) { return r.handle == geometry; });
+        if (iter == route.geometries.end())
+            route.geometries.push_back({ geometry, tileLOD });
+    }
+}
+
+
+void
+RoutePreloader::addTexture(Route& route, const MultiResTexture& texture, int tileLOD) const
+{
+    // The same fallbacks as MultiResTexture::find()
+    static constexpr unsigned int fallbacks[TEXTURE_RESOLUTION][TEXTURE_RESOLUTION] =
+    {
+        { lores, medres, hires },
+        { medres, lores, hires },
+        { hires, medres, lores },
+    };
+
+    unsigned int resolution = std::min(renderer.getResolution(), static_cast<unsigned int>(hires));
+    if (texture.tex[resolution] == InvalidResource)
+        return;
+
+    TextureRequest request;
+    request.choices.fill(InvalidResource);
+    for (unsigned int i = 0; i < TEXTURE_RESOLUTION; ++i)
+        request.choices[i] = texture.tex[fallbacks[resolution][i]];
+    request.tileLOD = tileLOD;
+
+    for (auto& r : route.textures)
+    {
+        if (r.choices == request.choices)
+        {
+            r.tileLOD = std::max(r.tileLOD, tileLOD);
+            return;
+        }
+    }
+
+    route.textures.push_back(request);
+}
+
+
+void
+RoutePreloader::addTexture(Route& route, ResourceHandle handle, int tileLOD) const
+{
+    TextureRequest request;
+    request.choices.fill(InvalidResource);
+    request.choices[0] = handle;
+    request.tileLOD = tileLOD;
+
+    for (auto& r : route.textures)
+    {
+        if (r.choices == request.choices)
+        {
+            r.tileLOD = std::max(r.tileLOD, tileLOD);
+            return;
+        }
+    }
+
+    route.textures.push_back(request);
+}
+
+
+// Advance the requests of a route; returns true when all have completed.
+bool
+RoutePreloader::updateRoute(Route& route)
+{
+    TextureManager* textureManager = GetTextureManager();
+    GeometryManager* geometryManager = GetGeometryManager();
+    bool complete = true;
+
+    // Geometries first, as loading them adds the textures of their materials
+    for (std::size_t i = 0; i < route.geometries.size(); ++i)
+    {
+        GeometryRequest& request = route.geometries[i];
+        switch (geometryManager->getState(request.handle))
+        {
+        case ResourceState::NotLoaded:
+            geometryManager->preload(request.handle);
+            complete = false;
+            break;
+        case ResourceState::Preloading:
+            complete = false;
+            break;
+        case ResourceState::Loaded:
+            if (!request.texturesAdded)
+            {
+                request.texturesAdded = true;
+                if (const Geometry* geometry = geometryManager->find(request.handle); geometry != nullptr)
+                {
+                    std::vector<ResourceHandle> handles;
+                    geometry->getTextureHandles(handles);
+                    int tileLOD = request.tileLOD;
+                    for (ResourceHandle handle : handles)
+                        addTexture(route, handle, tileLOD);
+                }
+            }
+            break;
+        case ResourceState::LoadingFailed:
+            break;
+        }
+    }
+
+    for (auto& request : route.textures)
+    {
+        ResourceHandle handle = request.choices[request.choice];
+        if (handle == InvalidResource)
+            continue;
+
+        switch (textureManager->getState(handle))
+        {
+        case ResourceState::NotLoaded:
+            textureManager->preload(handle);
+            complete = false;
+            break;
+        case ResourceState::Preloading:
+            complete = false;
+            break;
+        case ResourceState::Loaded:
+            if (request.tileLOD >= 0)
+            {
+                auto* tex = dynamic_cast<VirtualTexture*>(textureManager->find(handle));
+                if (tex == nullptr)
+                    break;
+
+                if (!request.tilesQueued)
+                {
+                    request.tilesQueued = true;
+                    int lod = std::clamp(request.tileLOD - tileLevel(static_cast<float>(tex->getWidth()) / celestia::numbers::pi_v<float>),
+                                         0, tex->getLODCount() - 1);
+                    while (lod > 0 && tex->getUTileCount(lod) * tex->getVTileCount(lod) > MaxPreloadTiles)
+                        --lod;
+                    tex->preloadTiles(lod);
+                }
+
+                if (tex->getPendingTileCount() > 0)
+                    complete = false;
+            }
+            break;
+        case ResourceState::LoadingFailed:
+            if (request.choice + 1 < request.choices.size())
+            {
+                ++request.choice;
+                complete = false;
+            }
+            break;
+        }
+    }
+
+    return complete;
+}
+
+
+void
+RoutePreloader::update()
+{
+    if (routes.empty())
+        return;
+
+    GetGeometryManager()->finishPreloads(FrameBudget * 0.5);
+    GetTextureManager()->finishPreloads(FrameBudget * 0.5);
+
+    auto now = Clock::now();
+    auto iter = routes.begin();
+    while (iter != routes.end())
+    {
+        Route& route = **iter;
+        bool complete = updateRoute(route);
+        bool hasDeadline = route.deadline != Clock::time_point::max();
+        double remaining = hasDeadline
+            ? std::chrono::duration<double>(route.deadline - now).count()
+            : 0.0;
+
+        if (!complete && remaining < 0.0 && !route.reportedLate)
+        {
+            route.reportedLate = true;
+            GetLogger()->warn(_("Resources for {} weren't loaded on arrival\n"), route.name);
+        }
+
+        if (!complete && remaining > -MaxOverrun)
+        {
+            ++iter;
+            continue;
+        }
+
+        status = Status();
+        status.name = route.name;
+        for (const auto& request : route.textures)
+        {
+            ++status.requested;
+            ResourceHandle handle = request.choices[request.choice];
+            if (GetTextureManager()->getState(handle) == ResourceState::Loaded)
+                ++status.completed;
+            else if (handle == InvalidResource || GetTextureManager()->getState(handle) == ResourceState::LoadingFailed)
+                ++status.failed;
+        }
+        for (const auto& request : route.geometries)
+        {
+            ++status.requested;
+            ResourceState state = GetGeometryManager()->getState(request.handle);
+            if (state == ResourceState::Loaded)
+                ++status.completed;
+            else if (state == ResourceState::LoadingFailed)
+                ++status.failed;
+        }
+        status.finished = complete;
+        status.finishedInTime = complete && remaining >= 0.0;
+        status.loadTime = std::chrono::duration<double>(now - route.start).count();
+
+        if (!hasDeadline)
+        {
+            GetLogger()->verbose(_("Preloaded {} resources for {} in {:.1f} s\n"),
+                                 status.completed, route.name, status.loadTime);
+        }
+        else if (status.finishedInTime)
+        {
+            GetLogger()->verbose(_("Preloaded {} resources for {}, {:.1f} s before arrival\n"),
+                                 status.completed, route.name, remaining);
+        }
+
+        iter = routes.erase(iter);
+    }
+}
@@ -0,0 +1,129 @@
+// routepreloader.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Background loading of the textures and models needed at the end of a
+// journey.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <celengine/selection.h>
+#include <celengine/univcoord.h>
+#include <celutil/reshandle.h>
+
+class Body;
+class MultiResTexture;
+class Renderer;
+
+/*! Loads the resources of the bodies that will be visible at the end of a
+ *  goto ahead of arrival. Images and models are decoded by the texture and
+ *  geometry managers on background tasks; update() creates them on the
+ *  main thread a few at a time and follows the textures and tiles they
+ *  lead to.
+ *
+ *  Each request is a route, usually with a deadline. When all of its
+ *  resources are ready, or the deadline passes first, the outcome is logged
+ *  and kept as the preloader's status.
+ */
+class RoutePreloader
+{
+ public:
+    struct Status
+    {
+        std::string name;
+        std::size_t requested{ 0 };
+        std::size_t completed{ 0 };
+        std::size_t failed{ 0 };
+        //! True once all resources are loaded or have failed
+        bool finished{ false };
+        //! True if the route finished before its deadline
+        bool finishedInTime{ false };
+        //! Seconds from the request until the route finished
+        double loadTime{ 0.0 };
+    };
+
+    explicit RoutePreloader(const Renderer& renderer);
+    ~RoutePreloader();
+
+    RoutePreloader(const RoutePreloader&) = delete;
+    RoutePreloader& operator=(const RoutePreloader&) = delete;
+
+    /*! Preload what is needed to show target as seen from viewpoint: the
+     *  target and the bodies of its system that will appear larger than a
+     *  few pixels, at the renderer's texture resolution and with virtual
+     *  texture tiles down to the level of detail the view will need.
+     *  Repeated requests for the same target before its arrival time are
+     *  ignored, so this may be called every frame of a journey.
+     */
+    void preload(const Selection& target,
+                 const UniversalCoord& viewpoint,
+                 double tdb,
+                 double secondsToArrival,
+                 float fov);
+
+    //! Preload all textures and the model of a single body, without a
+    //! deadline: the route is kept until everything is loaded or failed
+    void preload(Body* body);
+
+    //! Create resources decoded by background tasks; call once per frame
+    void update();
+
+    bool isBusy() const { return !routes.empty(); }
+    const Status& getStatus() const { return status; }
+
+ private:
+    using Clock = std::chrono::steady_clock;
+
+    struct TextureRequest
+    {
+        //! Handles to try in order, ending with InvalidResource
+        std::array<ResourceHandle, 4> choices;
+        std::size_t choice{ 0 };
+        //! Level of detail to preload for virtual textures, -1 for none
+        int tileLOD{ -1 };
+        bool tilesQueued{ false };
+    };
+
+    struct GeometryRequest
+    {
+        ResourceHandle handle;
+        int tileLOD;
+        bool texturesAdded{ false };
+    };
+
+    struct Route
+    {
+        Selection target;
+        std::string name;
+        Clock::time_point start;
+        //! Clock::time_point::max() for routes without a deadline
+        Clock::time_point deadline;
+        std::vector<TextureRequest> textures;
+        std::vector<GeometryRequest> geometries;
+        bool reportedLate{ false };
+    };
+
+    void addBody(Route& route, Body* body, float discSize) const;
+    void addTexture(Route& route, const MultiResTexture& texture, int tileLOD) const;
+    void addTexture(Route& route, ResourceHandle handle, int tileLOD) const;
+    bool updateRoute(Route& route);
+    void startRoute(std::unique_ptr<Route>&& route, Clock::time_point deadline);
+
+    const Renderer& renderer;
+    std::vector<std::unique_ptr<Route>> routes;
+    Selection lastTarget;
+    Clock::time_point lastDeadline;
+    Status status;
+};
@@ -132,10 +132,30 @@ void set_vp(vec4 in_Position)
 }
 )glsl"sv;
 
+// Replaces the depth of perspective projections with log2(1 + w), scaled
+// by ShaderManager::LogDepthFactor so that the far limit maps to +1.
+// Orthographic projections (2D overlays, shadow maps) are left alone.
+constexpr std::string_view VPFunctionLogDepth = R"glsl(
+const float LogDepthFactor = 0.02006866;
+vec4 calc_vp(vec4 in_Position)
+{
+    vec4 p = MVPMatrix * in_Position;
+    if (ProjectionMatrix[3][3] == 0.0)
+        p.z = (log2(max(1.0e-6, 1.0 + p.w)) * LogDepthFactor - 1.0) * p.w;
+    return p;
+}
+void set_vp(vec4 in_Position)
+{
+    gl_Position = calc_vp(in_Position);
+}
+)glsl"sv;
+
 constexpr std::string_view
-VPFunction(bool enabled)
+VPFunction(bool fisheyeEnabled, bool logDepthEnabled)
 {
-    return enabled ? VPFunctionFishEye : VPFunctionUsual;
+    if (fisheyeEnabled)
+        return VPFunctionFishEye;
+    return logDepthEnabled ? VPFunctionLogDepth : VPFunctionUsual;
 }
 
 constexpr std::string_view NormalVertexPosition = R"glsl(
@@ -1534,9 +1554,9 @@ ReadShaderFile(const fs::path &path)
 }
 
 GLShaderStatus
-CreateErrorShader(GLProgram **prog, bool fisheyeEnabled)
+CreateErrorShader(GLProgram **prog, bool fisheyeEnabled, bool logDepthEnabled)
 {
-    std::string _vs = fmt::format("{}{}{}{}{}\n", VersionHeader, CommonHeader, VertexHeader, VPFunction(fisheyeEnabled), errorVertexShaderSource);
+    std::string _vs = fmt::format("{}{}{}{}{}\n", VersionHeader, CommonHeader, VertexHeader, VPFunction(fisheyeEnabled, logDepthEnabled), errorVertexShaderSource);
     std::string _fs = fmt::format("{}{}{}{}\n", VersionHeader, CommonHeader, FragmentHeader, errorFragmentShaderSource);
 
     auto status = GLShaderLoader::CreateProgram(_vs, _fs, prog);
@@ -2023,7 +2043,7 @@ R"glsl(
     if (props.texUsage & ShaderProperties::LineAsTriangles)
         source += LineDeclaration();
 
-    source += VPFunction(props.fishEyeOverride != ShaderProperties::FisheyeOverrideModeDisabled && fisheyeEnabled);
+    source += VPFunction(props.fishEyeOverride != ShaderProperties::FisheyeOverrideModeDisabled && fisheyeEnabled, logDepthEnabled);
 
     // Begin main() function
     source += "\nvoid main(void)\n{\n";
@@ -2713,7 +2733,7 @@ ShaderManager::buildRingsVertexShader(const ShaderProperties& props)
     if (props.texUsage & ShaderProperties::LineAsTriangles)
         source += LineDeclaration();
 
-    source += VPFunction(props.fishEyeOverride != ShaderProperties::FisheyeOverrideModeDisabled && fisheyeEnabled);
+    source += VPFunction(props.fishEyeOverride != ShaderProperties::FisheyeOverrideModeDisabled && fisheyeEnabled, logDepthEnabled);
 
     source += "\nvoid main(void)\n{\n";
 
@@ -2862,7 +2882,7 @@ ShaderManager::buildAtmosphereVertexShader(const ShaderProperties& props)
     source += DeclareOutput("position", Shader_Vector3);
     source += DeclareOutput("normal", Shader_Vector3);
 
-    source += VPFunction(props.fishEyeOverride != ShaderProperties::FisheyeOverrideModeDisabled && fisheyeEnabled);
+    source += VPFunction(props.fishEyeOverride != ShaderProperties::FisheyeOverrideModeDisabled && fisheyeEnabled, logDepthEnabled);
 
     // Begin main() function
     source += "\nvoid main(void)\n{\n";
@@ -2964,7 +2984,7 @@ ShaderManager::buildEmissiveVertexShader(const ShaderProperties& props)
     source += DeclareOutput("v_Color", Shader_Vector4);
     source += DeclareOutput("v_TexCoord0", Shader_Vector2);
 
-    source += VPFunction(props.fishEyeOverride != ShaderProperties::FisheyeOverrideModeDisabled && fisheyeEnabled);
+    source += VPFunction(props.fishEyeOverride != ShaderProperties::FisheyeOverrideModeDisabled && fisheyeEnabled, logDepthEnabled);
 
     // Begin main() function
     source += "\nvoid main(void)\n{\n";
@@ -3080,7 +3100,7 @@ ShaderManager::buildParticleVertexShader(const ShaderProperties& props)
     if (props.usesShadows())
         source << DeclareOutput("position", Shader_Vector3);
 
-    source << VPFunction(props.fishEyeOverride != ShaderProperties::FisheyeOverrideModeDisabled && fisheyeEnabled);
+    source << VPFunction(props.fishEyeOverride != ShaderProperties::FisheyeOverrideModeDisabled && fisheyeEnabled, logDepthEnabled);
 
     // Begin main() function
     source << "\nvoid main(void)\n{\n";
@@ -3236,7 +3256,7 @@ ShaderManager::buildProgram(const ShaderProperties& props)
     {
         // If the shader creation failed for some reason, substitute the
         // error shader.
-        if (CreateErrorShader(&prog, fisheyeEnabled) != ShaderStatus_OK)
+        if (CreateErrorShader(&prog, fisheyeEnabled, logDepthEnabled) != ShaderStatus_OK)
             return nullptr;
     }
 
@@ -3248,7 +3268,7 @@ ShaderManager::buildProgram(std::string_view vs, std::string_view fs)
 {
     GLProgram* prog = nullptr;
     GLShaderStatus status;
-    std::string _vs = fmt::format("{}{}{}{}{}\n", VersionHeader, CommonHeader, VertexHeader, VPFunction(fisheyeEnabled), vs);
+    std::string _vs = fmt::format("{}{}{}{}{}\n", VersionHeader, CommonHeader, VertexHeader, VPFunction(fisheyeEnabled, logDepthEnabled), vs);
     std::string _fs = fmt::format("{}{}{}{}\n", VersionHeader, CommonHeader, FragmentHeader, fs);
 
     DumpVSSource(_vs);
@@ -3265,7 +3285,7 @@ ShaderManager::buildProgram(std::string_view vs, std::string_view fs)
     {
         // If the shader creation failed for some reason, substitute the
         // error shader.
-        if (CreateErrorShader(&prog, fisheyeEnabled) != ShaderStatus_OK)
+        if (CreateErrorShader(&prog, fisheyeEnabled, logDepthEnabled) != ShaderStatus_OK)
             return nullptr;
     }
 
@@ -3277,7 +3297,7 @@ ShaderManager::buildProgramGL3(std::string_view vs, std::string_view fs)
 {
     GLProgram* prog = nullptr;
     GLShaderStatus status;
-    std::string _vs = fmt::format("{}{}{}{}{}\n", VersionHeaderGL3, CommonHeader, VertexHeader, VPFunction(fisheyeEnabled), vs);
+    std::string _vs = fmt::format("{}{}{}{}{}\n", VersionHeaderGL3, CommonHeader, VertexHeader, VPFunction(fisheyeEnabled, logDepthEnabled), vs);
     std::string _fs = fmt::format("{}{}{}{}\n", VersionHeaderGL3, CommonHeader, FragmentHeader, fs);
 
     DumpVSSource(_vs);
@@ -3294,7 +3314,7 @@ ShaderManager::buildProgramGL3(std::string_view vs, std::string_view fs)
     {
         // If the shader creation failed for some reason, substitute the
         // error shader.
-        if (CreateErrorShader(&prog, fisheyeEnabled) != ShaderStatus_OK)
+        if (CreateErrorShader(&prog, fisheyeEnabled, logDepthEnabled) != ShaderStatus_OK)
             return nullptr;
     }
 
@@ -3317,7 +3337,7 @@ ShaderManager::buildProgramGL3(std::string_view vs, std::string_view gs, std::st
     GLProgram* prog = nullptr;
     GLShaderStatus status;
     auto _vs = fmt::format("{}{}{}{}\n", VersionHeaderGL3, CommonHeader, VertexHeader, vs);
-    auto _gs = fmt::format("{}{}{}{}{}{}\n", VersionHeaderGL3, CommonHeader, layout, GeomHeaderGL3, VPFunction(fisheyeEnabled), gs);
+    auto _gs = fmt::format("{}{}{}{}{}{}\n", VersionHeaderGL3, CommonHeader, layout, GeomHeaderGL3, VPFunction(fisheyeEnabled, logDepthEnabled), gs);
     auto _fs = fmt::format("{}{}{}{}\n", VersionHeaderGL3, CommonHeader, FragmentHeader, fs);
 
     DumpVSSource(_vs);
@@ -3335,7 +3355,7 @@ ShaderManager::buildProgramGL3(std::string_view vs, std::string_view gs, std::st
     {
         // If the shader creation failed for some reason, substitute the
         // error shader.
-        if (CreateErrorShader(&prog, fisheyeEnabled) != ShaderStatus_OK)
+        if (CreateErrorShader(&prog, fisheyeEnabled, logDepthEnabled) != ShaderStatus_OK)
             return nullptr;
     }
 
@@ -3347,6 +3367,16 @@ void ShaderManager::setFisheyeEnabled(bool enabled)
     fisheyeEnabled = enabled;
 }
 
+void ShaderManager::setLogDepthEnabled(bool enabled)
+{
+    logDepthEnabled = enabled;
+}
+
+bool ShaderManager::isLogDepthEnabled() const
+{
+    return logDepthEnabled;
+}
+
 CelestiaGLProgram::CelestiaGLProgram(GLProgram& _program,
                                      const ShaderProperties& _props) :
     program(&_program),
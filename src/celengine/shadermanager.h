@@ -327,6 +327,14 @@ class ShaderManager
 
     void setFisheyeEnabled(bool enabled);
 
+    // Logarithmic depth must be selected before any shader is built.
+    void setLogDepthEnabled(bool enabled);
+    bool isLogDepthEnabled() const;
+
+    // 2 / log2(LogDepthFar + 1), must match the value in the vertex shaders
+    static constexpr float LogDepthFactor = 0.02006866f;
+    static constexpr float LogDepthFar = 1.0e30f;
+
  private:
     CelestiaGLProgram* buildProgram(const ShaderProperties&);
     CelestiaGLProgram* buildProgram(std::string_view, std::string_view);
@@ -352,4 +360,5 @@ class ShaderManager
     std::map<std::string_view, CelestiaGLProgram*> staticShaders;
 
     bool fisheyeEnabled { false };
+    bool logDepthEnabled { false };
 };
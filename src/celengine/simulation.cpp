@@ -19,6 +19,7 @@
 #include "body.h"
 #include "location.h"
 #include "render.h"
+#include "stardb.h"
 
 
 namespace celutil = celestia::util;
@@ -51,6 +52,7 @@ void Simulation::render(Renderer& renderer)
                     *universe,
                     faintestVisible,
                     selection);
+    promoteMinorBodies(renderer);
 }
 
 void Simulation::draw(Renderer& renderer)
@@ -59,6 +61,7 @@ void Simulation::draw(Renderer& renderer)
                   *universe,
                   faintestVisible,
                   selection);
+    promoteMinorBodies(renderer);
 }
 
 
@@ -68,6 +71,16 @@ void Simulation::render(Renderer& renderer, Observer& observer)
                     *universe,
                     faintestVisible,
                     selection);
+    promoteMinorBodies(renderer);
+}
+
+
+// Catalog entries that became large or bright enough in the frame just
+// drawn are turned into bodies, which are drawn from the next frame on.
+void Simulation::promoteMinorBodies(Renderer& renderer)
+{
+    for (auto index : renderer.takeMinorBodyPromotions())
+        universe->promoteMinorBody(index);
 }
 
 
@@ -123,6 +136,10 @@ void Simulation::update(double dt)
         observer->update(dt, timeScale);
     }
 
+    // Stars with proper motion are placed at the simulation time
+    if (StarDatabase* stars = universe->getStarCatalog(); stars != nullptr)
+        stars->setEpoch(getTime());
+
     // Reset nearest solar system
     closestSolarSystem = std::nullopt;
 }
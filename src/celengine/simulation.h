@@ -126,6 +126,8 @@ class Simulation
     const ObserverFrame::SharedConstPtr& getFrame() const;
 
  private:
+    void promoteMinorBodies(Renderer&);
+
     double realTime{ 0.0 };
     double timeScale{ 1.0 };
     double storedTimeScale{ 1.0 };
@@ -11,6 +11,7 @@
 // of the License, or (at your option) any later version.
 
 #include <cassert>
+#include <cmath>
 #include <istream>
 #include <limits>
 #include <memory>
@@ -34,6 +35,7 @@
 #include "frametree.h"
 #include "location.h"
 #include "meshmanager.h"
+#include "minorbodies.h"
 #include "parseobject.h"
 #include "parser.h"
 #include "solarsys.h"
@@ -265,7 +267,7 @@ Selection GetParentObject(PlanetarySystem* system)
 
 
 TimelinePhase::SharedConstPtr CreateTimelinePhase(Body* body,
-                                                  Universe& universe,
+                                                  const Universe& universe,
                                                   const Hash* phaseData,
                                                   const fs::path& path,
                                                   const ReferenceFrame::SharedConstPtr& defaultOrbitFrame,
@@ -368,7 +370,7 @@ TimelinePhase::SharedConstPtr CreateTimelinePhase(Body* body,
 
 
 Timeline* CreateTimelineFromArray(Body* body,
-                                  Universe& universe,
+                                  const Universe& universe,
                                   const ValueArray* timelineArray,
                                   const fs::path& path,
                                   const ReferenceFrame::SharedConstPtr& defaultOrbitFrame,
@@ -420,7 +422,7 @@ Timeline* CreateTimelineFromArray(Body* body,
 
 bool CreateTimeline(Body* body,
                     PlanetarySystem* system,
-                    Universe& universe,
+                    const Universe& universe,
                     const Hash* planetData,
                     const fs::path& path,
                     DataDisposition disposition,
@@ -669,7 +671,7 @@ bool CreateTimeline(Body* body,
 // semi-major axis are in years and AU rather than days and kilometers.
 Body* CreateBody(const std::string& name,
                  PlanetarySystem* system,
-                 Universe& universe,
+                 const Universe& universe,
                  Body* existingBody,
                  const Hash* planetData,
                  const fs::path& path,
@@ -1030,7 +1032,7 @@ Body* CreateBody(const std::string& name,
 // Create a barycenter object using the values from a hash
 Body* CreateReferencePoint(const std::string& name,
                            PlanetarySystem* system,
-                           Universe& universe,
+                           const Universe& universe,
                            Body* existingBody,
                            const Hash* refPointData,
                            const fs::path& path,
@@ -1084,8 +1086,74 @@ Body* CreateReferencePoint(const std::string& name,
 
     return body;
 }
+
+// Find the catalog entry of an object defined under any of its names
+MinorBodyCatalog::IndexNumber
+FindMinorBodyEntry(const MinorBodyCatalog& catalog, const std::vector<std::string>& names)
+{
+    for (const auto& name : names)
+    {
+        if (name.empty())
+            continue;
+        if (auto index = catalog.find(name); index != MinorBodyCatalog::InvalidIndex)
+            return index;
+    }
+
+    return MinorBodyCatalog::InvalidIndex;
+}
+
 } // end unnamed namespace
 
+
+/*! Create a Body for an entry of a minor body catalog, the same one that an
+ *  ssc definition with its elements would create, and register it with the
+ *  catalog. If the entry was promoted before, that body is returned.
+ */
+Body* CreateMinorBody(MinorBodyCatalog& catalog,
+                      MinorBodyCatalog::IndexNumber index,
+                      const Universe& universe)
+{
+    if (Body* body = catalog.getBody(index); body != nullptr)
+        return body;
+
+    SolarSystem* solarSystem = universe.getSolarSystem(catalog.getPrimary());
+    if (solarSystem == nullptr)
+        solarSystem = universe.createSolarSystem(catalog.getPrimary());
+
+    // Bodies orbiting a star use AU and years by default
+    MinorBodyCatalog::Elements elements = catalog.getElements(index);
+    auto orbitData = std::make_unique<Hash>();
+    orbitData->addValue("Epoch", Value(elements.epoch));
+    orbitData->addValue("Period", Value(catalog.getPeriod(index) / 365.25));
+    orbitData->addValue("SemiMajorAxis", Value(elements.semiMajorAxis));
+    orbitData->addValue("Eccentricity", Value(elements.eccentricity));
+    orbitData->addValue("Inclination", Value(elements.inclination));
+    orbitData->addValue("AscendingNode", Value(elements.ascendingNode));
+    orbitData->addValue("ArgOfPericenter", Value(elements.argOfPericenter));
+    orbitData->addValue("MeanAnomaly", Value(elements.meanAnomaly));
+
+    Hash bodyData;
+    bodyData.addValue("Class", Value("asteroid"));
+    bodyData.addValue("EllipticalOrbit", Value(std::move(orbitData)));
+    if (float radius = catalog.getRadius(index); radius > 0.0f)
+    {
+        bodyData.addValue("Radius", Value(static_cast<double>(radius)));
+        bodyData.addValue("GeomAlbedo", Value(MinorBodyCatalog::DefaultAlbedo));
+    }
+
+    std::string name(catalog.getName(index));
+    Body* body = CreateBody(name, solarSystem->getPlanets(), universe, nullptr,
+                            &bodyData, fs::path(), DataDisposition::Add, NormalBody);
+    if (body == nullptr)
+        return nullptr;
+
+    if (std::uint32_t number = catalog.getNumber(index); number != 0)
+        body->addAlias(fmt::format("{} {}", number, name));
+
+    catalog.setBody(index, body);
+    return body;
+}
+
 bool LoadSolarSystemObjects(std::istream& in,
                             Universe& universe,
                             const fs::path& directory)
@@ -1234,6 +1302,22 @@ bool LoadSolarSystemObjects(std::istream& in,
             if (parentSystem != nullptr)
             {
                 Body* existingBody = parentSystem->find(primaryName);
+
+                MinorBodyCatalog* minorBodies = universe.getMinorBodyCatalog();
+                auto minorBodyIndex = MinorBodyCatalog::InvalidIndex;
+                if (existingBody == nullptr &&
+                    minorBodies != nullptr &&
+                    parentSystem->getPrimaryBody() == nullptr &&
+                    minorBodies->getPrimary() == parentSystem->getStar())
+                {
+                    minorBodyIndex = FindMinorBodyEntry(*minorBodies, names);
+
+                    // Modifying or replacing an object of the minor body
+                    // catalog turns it into a full body first.
+                    if (minorBodyIndex != MinorBodyCatalog::InvalidIndex && disposition != DataDisposition::Add)
+                        existingBody = CreateMinorBody(*minorBodies, minorBodyIndex, universe);
+                }
+
                 if (existingBody)
                 {
                     if (disposition == DataDisposition::Add)
@@ -1258,6 +1342,11 @@ bool LoadSolarSystemObjects(std::istream& in,
                     if (disposition == DataDisposition::Add)
                         for (const auto& name : names)
                             body->addAlias(name);
+
+                    // A new definition of a catalog object stands in for its
+                    // entry, which is then neither drawn nor promoted.
+                    if (minorBodyIndex != MinorBodyCatalog::InvalidIndex && minorBodies->getBody(minorBodyIndex) == nullptr)
+                        minorBodies->setBody(minorBodyIndex, body);
                 }
             }
         }
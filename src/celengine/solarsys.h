@@ -16,8 +16,10 @@
 #include <Eigen/Core>
 
 #include <celcompat/filesystem.h>
+#include <celengine/minorbodies.h>
 
 
+class Body;
 class FrameTree;
 class PlanetarySystem;
 class Star;
@@ -45,3 +47,7 @@ using SolarSystemCatalog = std::map<std::uint32_t, SolarSystem*>;
 bool LoadSolarSystemObjects(std::istream& in,
                             Universe& universe,
                             const fs::path& dir = fs::path());
+
+Body* CreateMinorBody(MinorBodyCatalog& catalog,
+                      MinorBodyCatalog::IndexNumber index,
+                      const Universe& universe);
@@ -292,6 +292,9 @@ public:
     AstroCatalog::IndexNumber getIndex() const { return indexNumber; }
     void setIndex(AstroCatalog::IndexNumber idx) { indexNumber = idx; }
 
+    UserCategoryMask getCategoryMask() const { return categoryMask; }
+    void setCategoryMask(UserCategoryMask mask) { categoryMask = mask; }
+
     // Accessor methods that delegate to StarDetails
     float getRadius() const;
     float getTemperature() const;
@@ -315,6 +318,7 @@ private:
     Eigen::Vector3f position{ Eigen::Vector3f::Zero() };
     float absMag{ 4.83f };
     float extinction{ 0.0f };
+    UserCategoryMask categoryMask{ 0 };
     celestia::util::IntrusivePtr<StarDetails> details{ nullptr };
 };
 
@@ -29,7 +29,7 @@ struct CloserStarPredicate
 struct BrighterStarPredicate
 {
     Vector3f pos;
-    UniversalCoord ucPos;
+    UniversalCoordOrigin origin;
     bool operator()(const Star* star0, const Star* star1) const
     {
         float d0 = (pos - star0->getPosition()).norm();
@@ -38,9 +38,9 @@ struct BrighterStarPredicate
         // If the stars are closer than one light year, use
         // a more precise distance estimate.
         if (d0 < 1.0f)
-            d0 = ucPos.offsetFromLy(star0->getPosition()).norm();
+            d0 = static_cast<float>(origin.offsetLy(star0->getPosition().cast<double>()).norm());
         if (d1 < 1.0f)
-            d1 = ucPos.offsetFromLy(star1->getPosition()).norm();
+            d1 = static_cast<float>(origin.offsetLy(star1->getPosition().cast<double>()).norm());
 
         return star0->getApparentMagnitude(d0) < star1->getApparentMagnitude(d1);
     }
@@ -149,7 +149,7 @@ StarBrowser::listStars(unsigned int nStars)
         {
             BrighterStarPredicate brighterPred;
             brighterPred.pos = pos;
-            brighterPred.ucPos = ucPos;
+            brighterPred.origin = UniversalCoordOrigin(ucPos);
             return findStars(*(univ->getStarCatalog()), brighterPred, nStars);
         }
         break;
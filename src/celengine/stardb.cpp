@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
@@ -32,6 +33,7 @@
 #include <celutil/timer.h>
 #include <celutil/tokenizer.h>
 #include <celutil/stringutils.h>
+#include <celutil/taskscheduler.h>
 #include "meshmanager.h"
 #include "parser.h"
 #include "value.h"
@@ -150,6 +152,44 @@ static_assert(std::is_standard_layout_v<CrossIndexRecord>);
 
 #pragma pack(pop)
 
+// Contents of a stars.dat record converted to native types
+struct DecodedStarRecord
+{
+    AstroCatalog::IndexNumber catNo;
+    float x;
+    float y;
+    float z;
+    float absMag;
+    StellarClass sc;
+    bool valid;
+};
+
+void
+decodeStarsDatRecord(const char* ptr, DecodedStarRecord& record)
+{
+    std::memcpy(&record.catNo, ptr + offsetof(StarsDatRecord, catNo), sizeof(record.catNo));
+    LE_TO_CPU_INT32(record.catNo, record.catNo);
+
+    std::memcpy(&record.x, ptr + offsetof(StarsDatRecord, x), sizeof(record.x));
+    LE_TO_CPU_FLOAT(record.x, record.x);
+
+    std::memcpy(&record.y, ptr + offsetof(StarsDatRecord, y), sizeof(record.y));
+    LE_TO_CPU_FLOAT(record.y, record.y);
+
+    std::memcpy(&record.z, ptr + offsetof(StarsDatRecord, z), sizeof(record.z));
+    LE_TO_CPU_FLOAT(record.z, record.z);
+
+    std::int16_t absMag;
+    std::memcpy(&absMag, ptr + offsetof(StarsDatRecord, absMag), sizeof(absMag));
+    LE_TO_CPU_INT16(absMag, absMag);
+    record.absMag = static_cast<float>(absMag) / 256.0f;
+
+    std::uint16_t spectralType;
+    std::memcpy(&spectralType, ptr + offsetof(StarsDatRecord, spectralType), sizeof(spectralType));
+    LE_TO_CPU_INT16(spectralType, spectralType);
+    record.valid = record.sc.unpackV1(spectralType);
+}
+
 bool parseSimpleCatalogNumber(std::string_view name,
                               std::string_view prefix,
                               AstroCatalog::IndexNumber& catalogNumber)
@@ -354,11 +394,50 @@ parseCustomStarDetails(const Hash* starData,
     return customDetails;
 }
 
+
+// Velocity in ly/day of a star at pos with a proper motion in mas/yr, where
+// the component in right ascension includes the factor cos(dec), and a
+// radial velocity in km/s.
+Eigen::Vector3f
+starVelocity(const Eigen::Vector3f& pos, double pmRA, double pmDec, double radialVelocity)
+{
+    Eigen::Vector3d radial = pos.cast<double>();
+    double distance = radial.norm();
+    if (distance == 0.0)
+        return Eigen::Vector3f::Zero();
+    radial /= distance;
+
+    // Directions of increasing right ascension and declination; a star at
+    // a celestial pole has no defined direction of right ascension.
+    Eigen::Vector3d pole = astro::equatorialToCelestialCart(0.0, 90.0, 1.0);
+    Eigen::Vector3d east = pole.cross(radial);
+    if (east.squaredNorm() < 1.0e-12)
+        return (radial * astro::kilometersToLightYears(radialVelocity * SECONDS_PER_DAY)).cast<float>();
+    east.normalize();
+    Eigen::Vector3d north = radial.cross(east);
+
+    // Proper motion in radians per day
+    double masPerDay = celmath::degToRad(1.0 / 3600000.0) / DAYS_PER_YEAR;
+    Eigen::Vector3d velocity = (east * pmRA + north * pmDec) * (masPerDay * distance) +
+                               radial * astro::kilometersToLightYears(radialVelocity * SECONDS_PER_DAY);
+    return velocity.cast<float>();
+}
+
 } // end unnamed namespace
 
 
+struct StarDatabase::MotionBounds
+{
+    double epoch;
+    std::vector<float> slack;
+    std::atomic<bool> ready{ false };
+};
+
 
-StarDatabase::StarDatabase()
+
+StarDatabase::StarDatabase() :
+    epoch(astro::J2000),
+    boundsEpoch(astro::J2000)
 {
     crossIndexes.resize(static_cast<std::size_t>(StarCatalog::MaxCatalog));
 }
@@ -366,6 +445,8 @@ StarDatabase::StarDatabase()
 
 StarDatabase::~StarDatabase()
 {
+    // Wait for the background computation of the node bounds
+    motionTasks.reset();
     delete [] stars;
 }
 
@@ -533,6 +614,23 @@ std::string StarDatabase::getStarName(const Star& star, bool i18n) const
 }
 
 
+std::string_view StarDatabase::getStarDisplayName(const Star& star) const
+{
+    auto i = static_cast<std::size_t>(&star - stars);
+    assert(i < nStars);
+
+    if (displayNames.size() != nStars)
+        displayNames.reset(nStars);
+    return displayNames.get(i, [&] { return getStarName(star, true); });
+}
+
+
+void StarDatabase::invalidateDisplayNames() const
+{
+    displayNames.reset(0);
+}
+
+
 std::string StarDatabase::getStarNameList(const Star& star, const unsigned int maxNames) const
 {
     std::string starNames;
@@ -628,12 +726,50 @@ void StarDatabase::findVisibleStars(StarHandler& starHandler,
         frustumPlanes[i] = Eigen::Hyperplane<float, 3>(planeNormals[i], position);
     }
 
-    octreeRoot->processVisibleObjects(starHandler,
-                                      position,
-                                      frustumPlanes,
-                                      limitingMag,
-                                      STAR_OCTREE_ROOT_SIZE,
-                                      stats);
+    if (stats == nullptr)
+        octreeRoot->processVisibleObjectsParallel(starHandler,
+                                                  position,
+                                                  frustumPlanes,
+                                                  limitingMag,
+                                                  STAR_OCTREE_ROOT_SIZE,
+                                                  getMotion());
+    else
+        octreeRoot->processVisibleObjects(starHandler,
+                                          position,
+                                          frustumPlanes,
+                                          limitingMag,
+                                          STAR_OCTREE_ROOT_SIZE,
+                                          stats,
+                                          getMotion());
+}
+
+
+void StarDatabase::findVisibleStars(StarHandler& starHandler,
+                                    const Eigen::Vector3f& position,
+                                    float limitingMag,
+                                    OctreeProcStats *stats) const
+{
+    // Planes with a zero normal never reject an octree node, so only the
+    // magnitude limit is applied.
+    Eigen::Hyperplane<float, 3> frustumPlanes[5];
+    for (auto& plane : frustumPlanes)
+        plane = Eigen::Hyperplane<float, 3>(Eigen::Vector3f::Zero(), 0.0f);
+
+    if (stats == nullptr)
+        octreeRoot->processVisibleObjectsParallel(starHandler,
+                                                  position,
+                                                  frustumPlanes,
+                                                  limitingMag,
+                                                  STAR_OCTREE_ROOT_SIZE,
+                                                  getMotion());
+    else
+        octreeRoot->processVisibleObjects(starHandler,
+                                          position,
+                                          frustumPlanes,
+                                          limitingMag,
+                                          STAR_OCTREE_ROOT_SIZE,
+                                          stats,
+                                          getMotion());
 }
 
 
@@ -644,7 +780,77 @@ void StarDatabase::findCloseStars(StarHandler& starHandler,
     octreeRoot->processCloseObjects(starHandler,
                                     position,
                                     radius,
-                                    STAR_OCTREE_ROOT_SIZE);
+                                    STAR_OCTREE_ROOT_SIZE,
+                                    getMotion());
+}
+
+
+bool StarDatabase::hasMotion() const
+{
+    return !velocities.empty();
+}
+
+
+const StarOctreeMotion* StarDatabase::getMotion() const
+{
+    return velocities.empty() ? nullptr : &motion;
+}
+
+
+void StarDatabase::setEpoch(double tdb)
+{
+    epoch = tdb;
+    if (velocities.empty())
+        return;
+
+    if (pendingBounds != nullptr && pendingBounds->ready.load(std::memory_order_acquire))
+    {
+        auto slack = pendingBounds->slack.cbegin();
+        octreeRoot->setBounds(slack);
+        boundsEpoch = pendingBounds->epoch;
+        pendingBounds = nullptr;
+    }
+
+    if (float dt = static_cast<float>(tdb - astro::J2000); dt != motion.dt)
+    {
+        motion.dt = dt;
+        for (std::uint32_t i : movingStars)
+            stars[i].setPosition(catalogPositions[i] + velocities[i] * dt);
+    }
+    motion.boundsDt = static_cast<float>(tdb - boundsEpoch);
+
+    // The tree stays valid, but once the epoch is far from the one the
+    // bounds were computed for, tighter bounds make searches faster.
+    if (pendingBounds != nullptr || std::abs(tdb - boundsEpoch) <= motionWindow)
+        return;
+
+    GetLogger()->verbose("Recomputing star octree bounds for JD {:.1f}\n", tdb);
+    if (motionTasks == nullptr)
+        motionTasks = std::make_unique<celutil::TaskGroup>(celutil::GetTaskScheduler(),
+                                                           celutil::TaskPriority::Background,
+                                                           "star motion bounds");
+
+    pendingBounds = std::make_shared<MotionBounds>();
+    pendingBounds->epoch = tdb;
+    motionTasks->run([this, bounds = pendingBounds, boundsMotion = motion]
+    {
+        // Only reads the tree structure and the catalog positions and
+        // velocities, which don't change
+        octreeRoot->computeBounds(boundsMotion, STAR_OCTREE_ROOT_SIZE, bounds->slack);
+        bounds->ready.store(true, std::memory_order_release);
+    });
+}
+
+
+double StarDatabase::getEpoch() const
+{
+    return epoch;
+}
+
+
+void StarDatabase::setMotionWindow(double days)
+{
+    motionWindow = days;
 }
 
 
@@ -676,49 +882,37 @@ bool StarDatabaseBuilder::loadBinary(std::istream& in)
         LE_TO_CPU_INT32(nStarsInFile, nStarsInFile);
     }
 
-    constexpr std::uint32_t BUFFER_RECORDS = UINT32_C(4096) / sizeof(StarsDatRecord);
-    std::vector<char> buffer(sizeof(StarsDatRecord) * BUFFER_RECORDS);
+    // Records are decoded in parallel, a batch at a time. The stars are
+    // created on this thread, as they share their details through a cache
+    // and reference counts that aren't thread-safe.
+    auto& scheduler = celutil::GetTaskScheduler();
+    constexpr std::uint32_t BUFFER_RECORDS = UINT32_C(65536);
+    std::uint32_t bufferRecords = std::min(BUFFER_RECORDS, nStarsInFile);
+    std::vector<char> buffer(sizeof(StarsDatRecord) * bufferRecords);
+    std::vector<DecodedStarRecord> records(bufferRecords);
     std::uint32_t nStarsRemaining = nStarsInFile;
     while (nStarsRemaining > 0)
     {
         std::uint32_t recordsToRead = std::min(BUFFER_RECORDS, nStarsRemaining);
         if (!in.read(buffer.data(), sizeof(StarsDatRecord) * recordsToRead).good()) { return false; }
 
-        const char* ptr = buffer.data();
-        for (std::uint32_t i = 0; i < recordsToRead; ++i)
+        scheduler.parallelFor(0, recordsToRead, 4096, [&](std::size_t begin, std::size_t end)
         {
-            AstroCatalog::IndexNumber catNo;
-            std::memcpy(&catNo, ptr + offsetof(StarsDatRecord, catNo), sizeof(catNo));
-            LE_TO_CPU_INT32(catNo, catNo);
-
-            float x;
-            std::memcpy(&x, ptr + offsetof(StarsDatRecord, x), sizeof(x));
-            LE_TO_CPU_FLOAT(x, x);
-
-            float y;
-            std::memcpy(&y, ptr + offsetof(StarsDatRecord, y), sizeof(y));
-            LE_TO_CPU_FLOAT(y, y);
-
-            float z;
-            std::memcpy(&z, ptr + offsetof(StarsDatRecord, z), sizeof(z));
-            LE_TO_CPU_FLOAT(z, z);
-
-            std::int16_t absMag;
-            std::memcpy(&absMag, ptr + offsetof(StarsDatRecord, absMag), sizeof(absMag));
-            LE_TO_CPU_INT16(absMag, absMag);
+            for (std::size_t i = begin; i < end; ++i)
+                decodeStarsDatRecord(buffer.data() + i * sizeof(StarsDatRecord), records[i]);
+        }, "decode stars");
 
-            std::uint16_t spectralType;
-            std::memcpy(&spectralType, ptr + offsetof(StarsDatRecord, spectralType), sizeof(spectralType));
-            LE_TO_CPU_INT16(spectralType, spectralType);
+        for (std::uint32_t i = 0; i < recordsToRead; ++i)
+        {
+            const DecodedStarRecord& record = records[i];
 
             Star star;
-            star.setPosition(x, y, z);
-            star.setAbsoluteMagnitude(static_cast<float>(absMag) / 256.0f);
+            star.setPosition(record.x, record.y, record.z);
+            star.setAbsoluteMagnitude(record.absMag);
 
             IntrusivePtr<StarDetails> details = nullptr;
-            StellarClass sc;
-            if (sc.unpackV1(spectralType))
-                details = StarDetails::GetStarDetails(sc);
+            if (record.valid)
+                details = StarDetails::GetStarDetails(record.sc);
 
             if (details == nullptr)
             {
@@ -727,10 +921,9 @@ bool StarDatabaseBuilder::loadBinary(std::istream& in)
             }
 
             star.setDetails(std::move(details));
-            star.setIndex(catNo);
+            star.setIndex(record.catNo);
             unsortedStars.add(star);
 
-            ptr += sizeof(StarsDatRecord);
             ++starDB->nStars;
         }
 
@@ -757,8 +950,8 @@ bool StarDatabaseBuilder::loadBinary(std::istream& in)
             binFileCatalogNumberIndex[i] = &unsortedStars[i];
         }
 
-        std::sort(binFileCatalogNumberIndex.begin(), binFileCatalogNumberIndex.end(),
-                  [](const Star* star0, const Star* star1) { return star0->getIndex() < star1->getIndex(); });
+        celutil::ParallelSort(scheduler, binFileCatalogNumberIndex.begin(), binFileCatalogNumberIndex.end(),
+                              [](const Star* star0, const Star* star1) { return star0->getIndex() < star1->getIndex(); });
     }
 
     return true;
@@ -1142,6 +1335,18 @@ StarDatabaseBuilder::finish()
         UserCategory::addObject(star, category);
     }
 
+    buildMotion();
+
+    std::size_t crossIndexSize = 0;
+    for (const auto& crossIndex : starDB->crossIndexes)
+        crossIndexSize += crossIndex.capacity() * sizeof(StarDatabase::CrossIndexEntry);
+    starDB->memory.set(starDB->nStars * sizeof(Star) +
+                       starDB->catalogNumberIndex.capacity() * sizeof(Star*) +
+                       starDB->octreeRoot->memoryUsage() +
+                       (starDB->catalogPositions.capacity() + starDB->velocities.capacity()) * sizeof(Eigen::Vector3f) +
+                       starDB->movingStars.capacity() * sizeof(std::uint32_t) +
+                       crossIndexSize);
+
     return std::move(starDB);
 }
 
@@ -1257,6 +1462,27 @@ StarDatabaseBuilder::createStar(Star* star,
         }
     }
 
+    // Proper motion and radial velocity. Stars in orbits move with their
+    // barycenter instead.
+    if (disposition != DataDisposition::Modify)
+        starVelocities.erase(catalogNumber);
+
+    auto pmRA = starData->getNumber<double>("ProperMotionRA");
+    auto pmDec = starData->getNumber<double>("ProperMotionDec");
+    auto radialVelocity = starData->getNumber<double>("RadialVelocity");
+    if (!barycenterPosition.has_value() &&
+        (pmRA.has_value() || pmDec.has_value() || radialVelocity.has_value()))
+    {
+        Eigen::Vector3f velocity = starVelocity(star->getPosition(),
+                                                pmRA.value_or(0.0),
+                                                pmDec.value_or(0.0),
+                                                radialVelocity.value_or(0.0));
+        if (velocity != Eigen::Vector3f::Zero())
+            starVelocities[catalogNumber] = velocity;
+        else
+            starVelocities.erase(catalogNumber);
+    }
+
     if (isBarycenter)
     {
         star->setAbsoluteMagnitude(30.0f);
@@ -1623,6 +1849,7 @@ void StarDatabaseBuilder::buildOctree()
     Star* sortedStars    = new Star[starDB->nStars];
     Star* firstStar      = sortedStars;
     root->rebuildAndSort(starDB->octreeRoot, firstStar);
+    starDB->octreeRoot->computeAggregates();
 
     // ASSERT((int) (firstStar - sortedStars) == nStars);
     GetLogger()->debug("{} stars total\nOctree has {} nodes and {} stars.\n",
@@ -1653,6 +1880,51 @@ void StarDatabaseBuilder::buildOctree()
 }
 
 
+void StarDatabaseBuilder::buildMotion()
+{
+    if (starVelocities.empty())
+        return;
+
+    GetLogger()->info(_("Stars with proper motion: {}\n"), starVelocities.size());
+
+    std::uint32_t nStars = starDB->nStars;
+    const Star* stars = starDB->stars;
+    starDB->catalogPositions.resize(nStars);
+    starDB->velocities.assign(nStars, Eigen::Vector3f::Zero());
+    for (std::uint32_t i = 0; i < nStars; ++i)
+    {
+        starDB->catalogPositions[i] = stars[i].getPosition();
+        if (auto iter = starVelocities.find(stars[i].getIndex()); iter != starVelocities.end())
+            starDB->velocities[i] = iter->second;
+    }
+
+    // Stars in orbits are placed at their root barycenter and move with it
+    for (std::uint32_t i = 0; i < nStars; ++i)
+    {
+        const Star* barycenter = stars[i].getOrbitBarycenter();
+        if (barycenter == nullptr)
+            continue;
+        while (barycenter->getOrbitBarycenter() != nullptr)
+            barycenter = barycenter->getOrbitBarycenter();
+        starDB->velocities[i] = starDB->velocities[barycenter - stars];
+    }
+
+    for (std::uint32_t i = 0; i < nStars; ++i)
+    {
+        if (starDB->velocities[i] != Eigen::Vector3f::Zero())
+            starDB->movingStars.push_back(i);
+    }
+
+    starDB->motion.firstObject = stars;
+    starDB->motion.positions = starDB->catalogPositions.data();
+    starDB->motion.velocities = starDB->velocities.data();
+    starDB->octreeRoot->initMotion(starDB->motion);
+    starDB->setEpoch(starDB->epoch);
+
+    starVelocities.clear();
+}
+
+
 void StarDatabaseBuilder::buildIndexes()
 {
     // This should only be called once for the database
@@ -1665,6 +1937,7 @@ void StarDatabaseBuilder::buildIndexes()
     for (std::uint32_t i = 0; i < starDB->nStars; ++i)
         starDB->catalogNumberIndex.push_back(&starDB->stars[i]);
 
-    std::sort(starDB->catalogNumberIndex.begin(), starDB->catalogNumberIndex.end(),
-              [](const Star* star0, const Star* star1) { return star0->getIndex() < star1->getIndex(); });
+    celutil::ParallelSort(celutil::GetTaskScheduler(),
+                          starDB->catalogNumberIndex.begin(), starDB->catalogNumberIndex.end(),
+                          [](const Star* star0, const Star* star1) { return star0->getIndex() < star1->getIndex(); });
 }
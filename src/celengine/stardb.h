@@ -13,6 +13,7 @@
 #include <cstdint>
 #include <iosfwd>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -25,7 +26,9 @@
 #include <celengine/category.h>
 #include <celengine/parseobject.h>
 #include <celutil/blockarray.h>
+#include <celutil/memoryusage.h>
 #include "astroobj.h"
+#include "displaynames.h"
 #include "hash.h"
 #include "staroctree.h"
 #include "starname.h"
@@ -34,6 +37,11 @@
 class StarNameDatabase;
 class UserCategory;
 
+namespace celestia::util
+{
+class TaskGroup;
+}
+
 
 constexpr inline unsigned int MAX_STAR_NAMES = 10;
 
@@ -71,13 +79,40 @@ class StarDatabase
                           float limitingMag,
                           OctreeProcStats * = nullptr) const;
 
+    // Find stars brighter than limitingMag in all directions.
+    void findVisibleStars(StarHandler& starHandler,
+                          const Eigen::Vector3f& obsPosition,
+                          float limitingMag,
+                          OctreeProcStats * = nullptr) const;
+
     void findCloseStars(StarHandler& starHandler,
                         const Eigen::Vector3f& obsPosition,
                         float radius) const;
 
+    // Stars with a proper motion or radial velocity move in a straight line
+    // from their catalog positions at J2000. setEpoch() moves them to their
+    // positions at the epoch in a single pass, so Star::getPosition() is the
+    // position at the epoch and the searches above only read the stars.
+    bool hasMotion() const;
+    void setEpoch(double tdb);
+    double getEpoch() const;
+
+    // Time in days after which the octree node bounds for moving stars are
+    // recomputed in the background. Searches stay correct in between, but
+    // the nodes grow with the time since the bounds were computed.
+    void setMotionWindow(double days);
+
+    static constexpr double DefaultMotionWindow = 1000.0 * 365.25;
+
     std::string getStarName(const Star&, bool i18n = false) const;
     std::string getStarNameList(const Star&, const unsigned int maxNames = MAX_STAR_NAMES) const;
 
+    // Localized name of a star of this database for labels. Names are
+    // computed once and the view stays valid until the display names are
+    // invalidated, e.g. after a translation domain is rebound.
+    std::string_view getStarDisplayName(const Star&) const;
+    void invalidateDisplayNames() const;
+
     StarNameDatabase* getNameDatabase() const;
 
     // Not exact, but any star with a catalog number greater than this is assumed to not be
@@ -97,6 +132,10 @@ class StarDatabase
     AstroCatalog::IndexNumber crossIndex(StarCatalog, AstroCatalog::IndexNumber number) const;
 
 private:
+    struct MotionBounds;
+
+    const StarOctreeMotion* getMotion() const;
+
     std::uint32_t nStars{ 0 };
 
     Star*                             stars{ nullptr };
@@ -106,6 +145,24 @@ private:
 
     std::vector<CrossIndex> crossIndexes;
 
+    mutable DisplayNameTable displayNames;
+
+    // Positions at J2000 and velocities in ly/day of the sorted stars, empty
+    // if no star moves
+    std::vector<Eigen::Vector3f> catalogPositions;
+    std::vector<Eigen::Vector3f> velocities;
+    // Indexes of the stars with a non-zero velocity
+    std::vector<std::uint32_t> movingStars;
+    StarOctreeMotion motion{ };
+    double epoch{ 0.0 };
+    double boundsEpoch{ 0.0 };
+    double motionWindow{ DefaultMotionWindow };
+    std::shared_ptr<MotionBounds> pendingBounds;
+    std::unique_ptr<celestia::util::TaskGroup> motionTasks;
+
+    // The stars, their indexes and the octree
+    celestia::util::MemoryTracker memory{ celestia::util::MemoryCategory::Stars };
+
     friend class StarDatabaseBuilder;
 };
 
@@ -189,6 +246,7 @@ class StarDatabaseBuilder
 
     void buildOctree();
     void buildIndexes();
+    void buildMotion();
     Star* findWhileLoading(AstroCatalog::IndexNumber catalogNumber) const;
 
     std::unique_ptr<StarDatabase> starDB{ std::make_unique<StarDatabase>() };
@@ -197,9 +255,11 @@ class StarDatabaseBuilder
 
     BlockArray<Star> unsortedStars{ };
     // List of stars loaded from binary file, sorted by catalog number
-    std::vector<Star*> binFileCatalogNumberIndex{ nullptr };
+    std::vector<Star*> binFileCatalogNumberIndex{ };
     // Catalog number -> star mapping for stars loaded from stc files
     std::map<AstroCatalog::IndexNumber, Star*> stcFileCatalogNumberIndex{};
     std::vector<BarycenterUsage> barycenters{};
     std::multimap<AstroCatalog::IndexNumber, UserCategoryId> categories{};
+    // Velocities in ly/day of the stars with proper motion
+    std::map<AstroCatalog::IndexNumber, Eigen::Vector3f> starVelocities{};
 };
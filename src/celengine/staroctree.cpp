@@ -12,6 +12,10 @@
 
 #include <celengine/staroctree.h>
 
+#include <deque>
+
+#include <celutil/taskscheduler.h>
+
 using namespace Eigen;
 
 // Maximum permitted orbital radius for stars, in light years. Orbital
@@ -24,6 +28,11 @@ using namespace Eigen;
 // render stars with orbits that are closer than MAX_STAR_ORBIT_RADIUS.
 static const float MAX_STAR_ORBIT_RADIUS = 1.0f;
 
+// Depth below which processVisibleObjectsParallel() hands subtrees to the
+// task scheduler; the 64 nodes at depth 2 give enough tasks to balance the
+// uneven density of stars around the observer.
+static const unsigned int PARALLEL_SPLIT_DEPTH = 2;
+
 
 // The octree node into which a star is placed is dependent on two properties:
 // its obsPosition and its luminosity--the fainter the star, the deeper the node
@@ -85,21 +94,17 @@ template<> DynamicStarOctree::ExclusionFactorDecayFunction*
 
 // total specialization of the StaticOctree template process*() methods for stars:
 template<>
-void StarOctree::processVisibleObjects(StarHandler&    processor,
-                                       const Vector3f& obsPosition,
-                                       const Hyperplane<float, 3>*   frustumPlanes,
-                                       float           limitingFactor,
-                                       float           scale,
-                                       OctreeProcStats *stats) const
+bool StarOctree::processVisibleNode(StarHandler&    processor,
+                                    const Vector3f& obsPosition,
+                                    const Hyperplane<float, 3>*   frustumPlanes,
+                                    float           limitingFactor,
+                                    float           scale,
+                                    [[maybe_unused]] OctreeProcStats *stats,
+                                    const StarOctreeMotion* motion) const
 {
-#ifdef OCTREE_DEBUG
-    size_t h;
-    if (stats != nullptr)
-    {
-        h = stats->height + 1;
-        stats->nodes++;
-    }
-#endif
+    // Moving stars may have left the cell of the node
+    scale += expansion(motion);
+
     // See if this node lies within the view frustum
 
     // Test the cubic octree node against each one of the five
@@ -109,9 +114,12 @@ void StarOctree::processVisibleObjects(StarHandler&    processor,
         const Hyperplane<float, 3>& plane = frustumPlanes[i];
         float r = scale * plane.normal().cwiseAbs().sum();
         if (plane.signedDistance(cellCenterPos) < -r)
-            return;
+            return false;
     }
 
+    if (processor.occluder && processor.occluder->hides(cellCenterPos - obsPosition, scale * StarOctree::SQRT3))
+        return false;
+
     // Compute the distance to node; this is equal to the distance to
     // the cellCenterPos of the node minus the boundingRadius of the node, scale * SQRT3.
     float minDistance = (obsPosition - cellCenterPos).norm() - scale * StarOctree::SQRT3;
@@ -137,45 +145,135 @@ void StarOctree::processVisibleObjects(StarHandler&    processor,
         }
     }
 
+    if (minDistance <= 0)
+        return true;
+
     // See if any of the objects in child nodes are potentially included
-    // that we need to recurse deeper.
-    if (minDistance <= 0 || astro::absToAppMag(exclusionFactor, minDistance) <= limitingFactor)
+    // that we need to recurse deeper. Children that are too faint or too
+    // close together may be drawn as one instead; stars near the viewer are
+    // always processed on their own, see MAX_STAR_ORBIT_RADIUS.
+    float childrenAppMag = astro::absToAppMag(exclusionFactor, minDistance);
+    if (minDistance > MAX_STAR_ORBIT_RADIUS &&
+        processAggregate(processor, obsPosition, minDistance, scale * StarOctree::SQRT3, childrenAppMag, limitingFactor))
     {
-        // Recurse into the child nodes
-        if (_children != nullptr)
-        {
-            for (int i=0; i<8; ++i)
-            {
-                _children[i]->processVisibleObjects(processor,
-                                                    obsPosition,
-                                                    frustumPlanes,
-                                                    limitingFactor,
-                                                    scale * 0.5f,
-                                                    stats
-                                                   );
+        return false;
+    }
+
+    return childrenAppMag <= limitingFactor;
+}
+
+
+template<>
+void StarOctree::processVisibleObjects(StarHandler&    processor,
+                                       const Vector3f& obsPosition,
+                                       const Hyperplane<float, 3>*   frustumPlanes,
+                                       float           limitingFactor,
+                                       float           scale,
+                                       OctreeProcStats *stats,
+                                       const StarOctreeMotion* motion) const
+{
 #ifdef OCTREE_DEBUG
-                if (stats != nullptr && stats->height > h)
-                    h = stats->height;
+    size_t h;
+    if (stats != nullptr)
+    {
+        h = stats->height + 1;
+        stats->nodes++;
+    }
 #endif
-            }
+
+    if (!processVisibleNode(processor, obsPosition, frustumPlanes, limitingFactor, scale, stats, motion))
+        return;
+
+    // Recurse into the child nodes
+    if (_children != nullptr)
+    {
+        for (int i=0; i<8; ++i)
+        {
+            _children[i]->processVisibleObjects(processor,
+                                                obsPosition,
+                                                frustumPlanes,
+                                                limitingFactor,
+                                                scale * 0.5f,
+                                                stats,
+                                                motion
+                                               );
 #ifdef OCTREE_DEBUG
-            if (stats != nullptr)
-                stats->height = h;
+            if (stats != nullptr && stats->height > h)
+                h = stats->height;
 #endif
         }
+#ifdef OCTREE_DEBUG
+        if (stats != nullptr)
+            stats->height = h;
+#endif
     }
 }
 
 
+template<>
+void StarOctree::processVisibleObjectsParallel(StarHandler&    processor,
+                                               const Vector3f& obsPosition,
+                                               const Hyperplane<float, 3>*   frustumPlanes,
+                                               float           limitingFactor,
+                                               float           scale,
+                                               const StarOctreeMotion* motion) const
+{
+    auto& scheduler = celestia::util::GetTaskScheduler();
+    if (scheduler.isSerial())
+    {
+        processVisibleObjects(processor, obsPosition, frustumPlanes, limitingFactor, scale, nullptr, motion);
+        return;
+    }
+
+    // The nodes above PARALLEL_SPLIT_DEPTH are visited here and the subtrees
+    // below become tasks. Every node or subtree reports to a collector of
+    // its own; replaying them in the order they were created gives the
+    // order of processVisibleObjects().
+    std::deque<OctreeObjectCollector<Star, float>> collectors;
+    celestia::util::TaskGroup group(scheduler, celestia::util::TaskPriority::Frame, "star octree");
+
+    auto visit = [&](const StarOctree* node, float nodeScale, unsigned int depth, auto& visitChildren) -> void
+    {
+        auto& collector = collectors.emplace_back();
+        collector.aggregateAngle = processor.aggregateAngle;
+        collector.aggregateMag = processor.aggregateMag;
+        collector.occluder = processor.occluder;
+        if (depth == PARALLEL_SPLIT_DEPTH)
+        {
+            group.run([&, node, nodeScale]
+            {
+                node->processVisibleObjects(collector, obsPosition, frustumPlanes, limitingFactor, nodeScale, nullptr, motion);
+            });
+            return;
+        }
+
+        if (!node->processVisibleNode(collector, obsPosition, frustumPlanes, limitingFactor, nodeScale, nullptr, motion) ||
+            node->_children == nullptr)
+        {
+            return;
+        }
+
+        for (int i = 0; i < 8; ++i)
+            visitChildren(node->_children[i], nodeScale * 0.5f, depth + 1, visitChildren);
+    };
+    visit(this, scale, 0, visit);
+
+    group.wait();
+    for (const auto& collector : collectors)
+        collector.replay(processor);
+}
+
+
 template<>
 void StarOctree::processCloseObjects(StarHandler&    processor,
                                      const Vector3f& obsPosition,
                                      float           boundingRadius,
-                                     float           scale) const
+                                     float           scale,
+                                     const StarOctreeMotion* motion) const
 {
     // Compute the distance to node; this is equal to the distance to
     // the cellCenterPos of the node minus the boundingRadius of the node, scale * SQRT3.
-    float nodeDistance    = (obsPosition - cellCenterPos).norm() - scale * StarOctree::SQRT3;
+    float nodeDistance    = (obsPosition - cellCenterPos).norm() - (scale + expansion(motion)) * StarOctree::SQRT3;
 
     if (nodeDistance > boundingRadius)
         return;
@@ -190,7 +288,7 @@ void StarOctree::processCloseObjects(StarHandler&    processor,
     // Check all the objects in the node.
     for (unsigned int i = 0; i < nObjects; ++i)
     {
-        Star& obj = _firstObject[i];
+        const Star& obj = _firstObject[i];
 
         if ((obsPosition - obj.getPosition()).squaredNorm() < radiusSquared)
         {
@@ -209,7 +307,8 @@ void StarOctree::processCloseObjects(StarHandler&    processor,
             _children[i]->processCloseObjects(processor,
                                               obsPosition,
                                               boundingRadius,
-                                              scale * 0.5f);
+                                              scale * 0.5f,
+                                              motion);
         }
     }
 }
@@ -19,3 +19,19 @@
 typedef DynamicOctree  <Star, float> DynamicStarOctree;
 typedef StaticOctree   <Star, float> StarOctree;
 typedef OctreeProcessor<Star, float> StarHandler;
+typedef OctreeMotion   <Star, float> StarOctreeMotion;
+
+
+template<> struct OctreeObjectLight<Star, float>
+{
+    static bool get(const Star& star, Eigen::Vector3f& position, float& absMag, float& temperature)
+    {
+        if (!star.getVisibility())
+            return false;
+
+        position    = star.getPosition();
+        absMag      = star.getAbsoluteMagnitude();
+        temperature = star.getTemperature();
+        return true;
+    }
+};
@@ -15,8 +15,11 @@
 #include <fstream>
 #include <string_view>
 
+#include <celutil/filetype.h>
 #include <celutil/fsutils.h>
 #include <celutil/logger.h>
+#include "glupload.h"
+#include "virtualtex.h"
 
 using namespace std::string_view_literals;
 using celestia::util::GetLogger;
@@ -90,30 +93,77 @@ TextureInfo::resolve(const fs::path& baseDir) const
 }
 
 
+Texture::AddressMode
+TextureInfo::addressMode() const
+{
+    if (flags & WrapTexture)
+        return Texture::Wrap;
+    if (flags & BorderClamp)
+        return Texture::BorderClamp;
+    return Texture::EdgeClamp;
+}
+
+
 std::unique_ptr<Texture>
 TextureInfo::load(const fs::path& name) const
 {
-    Texture::AddressMode addressMode = Texture::EdgeClamp;
-    Texture::MipMapMode  mipMode     = Texture::DefaultMipMaps;
-    Texture::Colorspace  colorspace  = Texture::DefaultColorspace;
+    // Only decoding the image stalls the caller, the GL uploader creates
+    // the texture over the following frames.
+    if (DetermineFileType(name) != ContentType::CelestiaTexture)
+    {
+        std::unique_ptr<Image> img = prepare(name);
+        return img == nullptr ? nullptr : load(name, std::move(img));
+    }
 
-    if (flags & WrapTexture)
-        addressMode = Texture::Wrap;
-    else if (flags & BorderClamp)
-        addressMode = Texture::BorderClamp;
+    GetLogger()->debug("Loading virtual texture: {}\n", name);
+    return LoadVirtualTexture(name);
+}
 
-    if (flags & NoMipMaps)
-        mipMode = Texture::NoMipMaps;
 
-    if (flags & LinearColorspace)
-        colorspace = Texture::LinearColorspace;
+std::unique_ptr<Image>
+TextureInfo::prepare(const fs::path& name) const
+{
+    if (DetermineFileType(name) == ContentType::CelestiaTexture)
+        return nullptr;
 
-    if (bumpHeight == 0.0f)
+    GetLogger()->debug("Loading texture: {}\n", name);
+    std::unique_ptr<Image> img = LoadImageFromFile(name);
+    if (img == nullptr)
+        return nullptr;
+
+    if (bumpHeight != 0.0f)
     {
-        GetLogger()->debug("Loading texture: {}\n", name);
-        return LoadTextureFromFile(name, addressMode, mipMode, colorspace);
+        // Height maps are converted to normal maps here as well, which is
+        // most of the cost of loading them.
+        img->forceLinear();
+        return img->computeNormalMap(bumpHeight, addressMode() == Texture::Wrap);
     }
 
-    GetLogger()->debug("Loading bump map: {}\n", name);
-    return LoadHeightMapFromFile(name, bumpHeight, addressMode);
+    if (flags & LinearColorspace)
+        img->forceLinear();
+    return img;
+}
+
+
+std::unique_ptr<Texture>
+TextureInfo::load(const fs::path& name, std::unique_ptr<Image>&& img) const
+{
+    if (img == nullptr)
+        return load(name);
+
+    auto& uploader = celestia::engine::GetGLUploader();
+    if (bumpHeight != 0.0f)
+        return CreateTextureFromImage(std::move(img), addressMode(), Texture::DefaultMipMaps, uploader);
+
+    // As in LoadTextureFromFile(), only the extension tells dxt5 normal
+    // maps from other dxt5 textures.
+    bool dxt5NormalMap = DetermineFileType(name) == ContentType::DXT5NormalMap &&
+                         img->getFormat() == celestia::PixelFormat::DXT5;
+
+    auto mipMode = (flags & NoMipMaps) ? Texture::NoMipMaps : Texture::DefaultMipMaps;
+    std::unique_ptr<Texture> tex = CreateTextureFromImage(std::move(img), addressMode(), mipMode, uploader);
+    if (tex != nullptr && dxt5NormalMap)
+        tex->setFormatOptions(Texture::DXT5NormalMap);
+
+    return tex;
 }
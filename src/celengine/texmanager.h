@@ -14,6 +14,7 @@
 #include <tuple>
 
 #include <celcompat/filesystem.h>
+#include <celimage/image.h>
 #include <celutil/resmanager.h>
 #include "multitexture.h"
 #include "texture.h"
@@ -27,11 +28,14 @@ private:
     float bumpHeight;
     unsigned int resolution;
 
+    Texture::AddressMode addressMode() const;
+
     friend bool operator<(const TextureInfo&, const TextureInfo&);
 
 public:
     using ResourceType = Texture;
     using ResourceKey = fs::path;
+    using PreparedType = Image;
 
     enum
     {
@@ -76,6 +80,11 @@ public:
 
     fs::path resolve(const fs::path&) const;
     std::unique_ptr<Texture> load(const fs::path&) const;
+
+    // Decode the image of a texture without creating it, on any thread.
+    // Returns nullptr for virtual textures, which are loaded by load().
+    std::unique_ptr<Image> prepare(const fs::path&) const;
+    std::unique_ptr<Texture> load(const fs::path&, std::unique_ptr<Image>&&) const;
 };
 
 inline bool operator<(const TextureInfo& ti0, const TextureInfo& ti1)
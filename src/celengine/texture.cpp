@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstddef>
 #include <cstdlib>
 #include <cmath>
 
@@ -20,16 +21,22 @@
 #include <celutil/gettext.h>
 #include <celutil/logger.h>
 #include "framebuffer.h"
+#include "glupload.h"
 #include "texture.h"
 #include "virtualtex.h"
 
 
 using namespace celestia;
+using celestia::engine::GLUploader;
+using celestia::engine::UploadJob;
 using celestia::util::GetLogger;
 
 namespace
 {
 
+// Uncompressed mip levels larger than this are uploaded in bands of rows
+constexpr std::size_t UploadChunkSize = 4 * 1024 * 1024;
+
 struct TextureCaps
 {
     GLint preferredAnisotropy;
@@ -311,6 +318,80 @@ CalcMipLevelCount(int w, int h)
     return std::max(ilog2(w), ilog2(h)) + 1;
 }
 
+// Add the steps uploading a mip level of img to the texture name. Unless
+// the level is compressed or small, it's allocated first and filled in
+// bands, so that no step uploads much more than UploadChunkSize.
+void
+AddMipLevelSteps(UploadJob& job, GLuint name, const Image& img, int mip, bool banded)
+{
+    auto size = static_cast<std::size_t>(img.getMipLevelSize(mip));
+    if (img.isCompressed() || !banded || size <= UploadChunkSize)
+    {
+        job.addStep(size, [name, &img, mip]
+        {
+            glBindTexture(GL_TEXTURE_2D, name);
+            int mipWidth  = std::max(img.getWidth() >> mip, 1);
+            int mipHeight = std::max(img.getHeight() >> mip, 1);
+            if (img.isCompressed())
+            {
+                glCompressedTexImage2D(GL_TEXTURE_2D, mip,
+                                       getInternalFormat(img.getFormat()),
+                                       mipWidth, mipHeight, 0,
+                                       img.getMipLevelSize(mip),
+                                       img.getMipLevel(mip));
+            }
+            else
+            {
+                glTexImage2D(GL_TEXTURE_2D, mip,
+                             getInternalFormat(img.getFormat()),
+                             mipWidth, mipHeight, 0,
+                             getExternalFormat(img.getFormat()),
+                             GL_UNSIGNED_BYTE,
+                             img.getMipLevel(mip));
+            }
+        });
+        return;
+    }
+
+    int mipWidth  = std::max(img.getWidth() >> mip, 1);
+    int mipHeight = std::max(img.getHeight() >> mip, 1);
+    job.addStep(0, [name, &img, mip, mipWidth, mipHeight]
+    {
+        glBindTexture(GL_TEXTURE_2D, name);
+        glTexImage2D(GL_TEXTURE_2D, mip,
+                     getInternalFormat(img.getFormat()),
+                     mipWidth, mipHeight, 0,
+                     getExternalFormat(img.getFormat()),
+                     GL_UNSIGNED_BYTE,
+                     nullptr);
+    });
+
+    // Rows are padded as GL_UNPACK_ALIGNMENT expects by default
+    std::size_t pitch = size / static_cast<std::size_t>(mipHeight);
+    int bandRows = static_cast<int>(std::max(UploadChunkSize / pitch, std::size_t(1)));
+    for (int y = 0; y < mipHeight; y += bandRows)
+    {
+        int rows = std::min(bandRows, mipHeight - y);
+        job.addStep(rows * pitch, [name, &img, mip, mipWidth, y, rows, pitch]
+        {
+            glBindTexture(GL_TEXTURE_2D, name);
+            glTexSubImage2D(GL_TEXTURE_2D, mip, 0, y, mipWidth, rows,
+                            getExternalFormat(img.getFormat()),
+                            GL_UNSIGNED_BYTE,
+                            img.getMipLevel(mip) + y * pitch);
+        });
+    }
+}
+
+// Video memory used by a texture loaded from img, assuming the driver keeps
+// the pixel format; a full set of mipmaps adds about a third.
+std::size_t
+EstimateTextureSize(const Image& img, bool mipmap)
+{
+    auto size = static_cast<std::size_t>(img.getMipLevelSize(0));
+    return mipmap ? size + size / 3 : size;
+}
+
 // Helper function for CreateProceduralCubeMap; return the normalized
 // vector pointing to (s, t) on the specified face.
 Eigen::Vector3f
@@ -345,6 +426,9 @@ cubeVector(int face, float s, float t)
     return v.normalized();
 }
 
+} // end unnamed namespace
+
+
 std::unique_ptr<Texture>
 CreateTextureFromImage(const Image& img,
                        Texture::AddressMode addressMode,
@@ -372,8 +456,29 @@ CreateTextureFromImage(const Image& img,
     return tex;
 }
 
+
+std::unique_ptr<Texture>
+CreateTextureFromImage(std::shared_ptr<const Image> img,
+                       Texture::AddressMode addressMode,
+                       Texture::MipMapMode mipMode,
+                       GLUploader& uploader)
+{
+    const int maxDim = gl::maxTextureSize;
+    if ((img->getWidth() > maxDim || img->getHeight() > maxDim))
+    {
+        int uSplit = std::max(1, img->getWidth() / maxDim);
+        int vSplit = std::max(1, img->getHeight() / maxDim);
+        GetLogger()->info(_("Creating tiled texture. Width={}, max={}\n"),
+                          img->getWidth(), maxDim);
+        return std::make_unique<TiledTexture>(std::move(img), uSplit, vSplit, mipMode, uploader);
+    }
+
+    GetLogger()->info(_("Creating ordinary texture: {}x{}\n"),
+                      img->getWidth(), img->getHeight());
+    return std::make_unique<ImageTexture>(std::move(img), addressMode, mipMode, uploader);
 }
 
+
 Texture::Texture(int w, int h, int d) :
     width(w),
     height(h),
@@ -441,14 +546,51 @@ void Texture::setFormatOptions(unsigned int opts)
 }
 
 
+bool Texture::isReady() const
+{
+    return upload == nullptr || upload->isReady();
+}
+
+
+void Texture::cancelUpload()
+{
+    if (upload != nullptr && !upload->isReady())
+        engine::GetGLUploader().cancel(upload);
+}
+
+
 ImageTexture::ImageTexture(const Image& img,
                            AddressMode addressMode,
                            MipMapMode mipMapMode) :
     Texture(img.getWidth(), img.getHeight()),
     glName(0)
+{
+    UploadJob job;
+    planUpload(img, addressMode, mipMapMode, job);
+    job.run();
+}
+
+
+ImageTexture::ImageTexture(std::shared_ptr<const Image> img,
+                           AddressMode addressMode,
+                           MipMapMode mipMapMode,
+                           GLUploader& uploader) :
+    Texture(img->getWidth(), img->getHeight()),
+    glName(0)
+{
+    upload = std::make_shared<UploadJob>();
+    planUpload(*img, addressMode, mipMapMode, *upload);
+    upload->keepAlive(std::move(img));
+    uploader.submit(upload);
+}
+
+
+void ImageTexture::planUpload(const Image& img,
+                              AddressMode addressMode,
+                              MipMapMode mipMapMode,
+                              UploadJob& job)
 {
     glGenTextures(1, &glName);
-    glBindTexture(GL_TEXTURE_2D, glName);
 
     bool mipmap = mipMapMode != NoMipMaps;
     bool precomputedMipMaps = false;
@@ -469,54 +611,67 @@ ImageTexture::ImageTexture(const Image& img,
     }
 
     GLenum texAddress = GetGLTexAddressMode(addressMode);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texAddress);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texAddress);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                    mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
-
-    if (gl::EXT_texture_filter_anisotropic && GetTextureCaps().preferredAnisotropy > 1)
-    {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, GetTextureCaps().preferredAnisotropy);
-    }
-
     bool genMipmaps = mipmap && !precomputedMipMaps;
-#ifndef GL_ES
-    if (genMipmaps && !FramebufferObject::isSupported())
-        glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
-#endif
+    bool fboMipmaps = FramebufferObject::isSupported();
 
-    if (mipmap)
+    int maxLevel = 0;
+    if (precomputedMipMaps)
+        maxLevel = mipLevelCount - 1;
+    else if (mipmap)
+        maxLevel = expectedCount - 1;
+
+    GLuint name = glName;
+    job.addStep(0, [name, texAddress, mipmap, genMipmaps, fboMipmaps, maxLevel]
     {
-        if (precomputedMipMaps)
+        glBindTexture(GL_TEXTURE_2D, name);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texAddress);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texAddress);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                        mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+
+        if (gl::EXT_texture_filter_anisotropic && GetTextureCaps().preferredAnisotropy > 1)
         {
-            LoadMipmapSet(img, GL_TEXTURE_2D);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, GetTextureCaps().preferredAnisotropy);
         }
-        else if (mipMapMode == DefaultMipMaps)
-        {
-            LoadMiplessTexture(img, GL_TEXTURE_2D);
+
 #ifndef GL_ES
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, expectedCount-1);
+        if (genMipmaps && !fboMipmaps)
+            glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
 #endif
-        }
+    });
+
+    // Legacy mipmap generation would run again for every band
+    bool banded = !genMipmaps || fboMipmaps;
+    if (precomputedMipMaps)
+    {
+        for (int mip = 0; mip < mipLevelCount; mip++)
+            AddMipLevelSteps(job, name, img, mip, banded);
     }
     else
     {
-        LoadMiplessTexture(img, GL_TEXTURE_2D);
-#ifndef GL_ES
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
-#endif
+        AddMipLevelSteps(job, name, img, 0, banded);
+    }
+
+    if (genMipmaps && fboMipmaps)
+    {
+        job.addStep(static_cast<std::size_t>(img.getMipLevelSize(0)) / 3, [name]
+        {
+            glBindTexture(GL_TEXTURE_2D, name);
+            glGenerateMipmap(GL_TEXTURE_2D);
+        });
     }
-    if (genMipmaps && FramebufferObject::isSupported())
-        glGenerateMipmap(GL_TEXTURE_2D);
 
     alpha = img.hasAlpha();
     compressed = img.isCompressed();
+    videoMemory.set(EstimateTextureSize(img, mipmap));
 }
 
 
 ImageTexture::~ImageTexture()
 {
+    cancelUpload();
     if (glName != 0)
         glDeleteTextures(1, &glName);
 }
@@ -530,7 +685,7 @@ void ImageTexture::bind()
 
 TextureTile ImageTexture::getTile(int lod, int u, int v)
 {
-    if (lod != 0 || u != 0 || v != 0)
+    if (lod != 0 || u != 0 || v != 0 || !isReady())
         return TextureTile(0);
 
     return TextureTile(glName);
@@ -557,12 +712,37 @@ TiledTexture::TiledTexture(const Image& img,
     uSplit(std::max(1, _uSplit)),
     vSplit(std::max(1, _vSplit)),
     glNames(nullptr)
+{
+    UploadJob job;
+    planUpload(img, mipMapMode, job);
+    job.run();
+}
+
+
+TiledTexture::TiledTexture(std::shared_ptr<const Image> img,
+                           int _uSplit, int _vSplit,
+                           MipMapMode mipMapMode,
+                           GLUploader& uploader) :
+    Texture(img->getWidth(), img->getHeight()),
+    uSplit(std::max(1, _uSplit)),
+    vSplit(std::max(1, _vSplit)),
+    glNames(nullptr)
+{
+    upload = std::make_shared<UploadJob>();
+    planUpload(*img, mipMapMode, *upload);
+    upload->keepAlive(std::move(img));
+    uploader.submit(upload);
+}
+
+
+// Each tile is uploaded by a step of its own, so that a huge image can be
+// spread over several frames.
+void TiledTexture::planUpload(const Image& img,
+                              MipMapMode mipMapMode,
+                              UploadJob& job)
 {
     glNames = new unsigned int[uSplit * vSplit];
-    {
-        for (int i = 0; i < uSplit * vSplit; i++)
-            glNames[i] = 0;
-    }
+    glGenTextures(uSplit * vSplit, glNames);
 
     alpha = img.hasAlpha();
     compressed = img.isCompressed();
@@ -587,133 +767,137 @@ TiledTexture::TiledTexture(const Image& img,
     GLenum texAddress = GetGLTexAddressMode(EdgeClamp);
     int components = img.getComponents();
 
-    // Create a temporary image which we'll use for the tile texels
     int tileWidth = img.getWidth() / uSplit;
     int tileHeight = img.getHeight() / vSplit;
     int tileMipLevelCount = CalcMipLevelCount(tileWidth, tileHeight);
-    Image* tile = new Image(img.getFormat(),
-                            tileWidth, tileHeight,
-                            tileMipLevelCount);
+    auto tileSize = static_cast<std::size_t>(img.getMipLevelSize(0)) / (uSplit * vSplit);
 
     for (int v = 0; v < vSplit; v++)
     {
         for (int u = 0; u < uSplit; u++)
         {
-            // Create the texture and set up sampling and addressing
-            glGenTextures(1, &glNames[v * uSplit + u]);
-            glBindTexture(GL_TEXTURE_2D, glNames[v * uSplit + u]);
-
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texAddress);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texAddress);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                            mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
-
-            if (gl::EXT_texture_filter_anisotropic && GetTextureCaps().preferredAnisotropy > 1)
+            GLuint name = glNames[v * uSplit + u];
+            job.addStep(tileSize, [=, &img]
             {
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, GetTextureCaps().preferredAnisotropy);
-            }
+                // Create a temporary image which we'll use for the tile texels
+                Image tile(img.getFormat(), tileWidth, tileHeight, tileMipLevelCount);
 
-            // Copy texels from the subtexture area to the pixel buffer.  This
-            // is straightforward for normal textures, but an immense headache
-            // for compressed textures with prebuilt mipmaps.
-            if (precomputedMipMaps)
-            {
-                if (img.isCompressed())
-                {
-                    for (int mip = 0; mip < tileMipLevelCount; mip++)
-                    {
-                        int blockSize = getCompressedBlockSize(img.getFormat());
-                        int mipWidth  = std::max(img.getWidth() >> mip, 1);
-                        int tileMipWidth  = std::max(tile->getWidth() >> mip, 1);
-                        int tileMipHeight = std::max(tile->getHeight() >> mip, 1);
-                        int uBlocks = std::max(tileMipWidth / 4, 1);
-                        int vBlocks = std::max(tileMipHeight / 4, 1);
-                        int destBytesPerRow = uBlocks * blockSize;
-                        int srcBytesPerRow = std::max(mipWidth / 4, 1) * blockSize;
-                        int srcU = u * tileMipWidth / 4;
-                        int srcV = v * tileMipHeight / 4;
-                        int tileOffset = srcV * srcBytesPerRow + srcU * blockSize;
+                // Set up sampling and addressing
+                glBindTexture(GL_TEXTURE_2D, name);
 
-                        const std::uint8_t *imgMip = img.getMipLevel(std::min(mip, mipLevelCount));
-                        std::uint8_t *tileMip = tile->getMipLevel(mip);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texAddress);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texAddress);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                                mipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 
-                        for (int y = 0; y < vBlocks; y++)
-                        {
-                            std::memcpy(tileMip + y * destBytesPerRow,
-                                        imgMip + tileOffset + y * srcBytesPerRow,
-                                        destBytesPerRow);
-                        }
-                    }
-                }
-                else
+                if (gl::EXT_texture_filter_anisotropic && GetTextureCaps().preferredAnisotropy > 1)
                 {
-                    // TODO: Handle uncompressed textures with prebuilt mipmaps
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, GetTextureCaps().preferredAnisotropy);
                 }
 
-                LoadMipmapSet(*tile, GL_TEXTURE_2D);
-            }
-            else
-            {
-                if (img.isCompressed())
+                // Copy texels from the subtexture area to the pixel buffer.  This
+                // is straightforward for normal textures, but an immense headache
+                // for compressed textures with prebuilt mipmaps.
+                if (precomputedMipMaps)
                 {
-                    int blockSize = getCompressedBlockSize(img.getFormat());
-                    int uBlocks = std::max(tileWidth / 4, 1);
-                    int vBlocks = std::max(tileHeight / 4, 1);
-                    int destBytesPerRow = uBlocks * blockSize;
-                    int srcBytesPerRow = std::max(img.getWidth() / 4, 1) * blockSize;
-                    int srcU = u * tileWidth / 4;
-                    int srcV = v * tileHeight / 4;
-                    int tileOffset = srcV * srcBytesPerRow + srcU * blockSize;
-
-                    for (int y = 0; y < vBlocks; y++)
+                    if (img.isCompressed())
                     {
-                        memcpy(tile->getPixels() + y * destBytesPerRow,
-                               img.getPixels() + tileOffset + y * srcBytesPerRow,
-                               destBytesPerRow);
+                        for (int mip = 0; mip < tileMipLevelCount; mip++)
+                        {
+                            int blockSize = getCompressedBlockSize(img.getFormat());
+                            int mipWidth  = std::max(img.getWidth() >> mip, 1);
+                            int tileMipWidth  = std::max(tile.getWidth() >> mip, 1);
+                            int tileMipHeight = std::max(tile.getHeight() >> mip, 1);
+                            int uBlocks = std::max(tileMipWidth / 4, 1);
+                            int vBlocks = std::max(tileMipHeight / 4, 1);
+                            int destBytesPerRow = uBlocks * blockSize;
+                            int srcBytesPerRow = std::max(mipWidth / 4, 1) * blockSize;
+                            int srcU = u * tileMipWidth / 4;
+                            int srcV = v * tileMipHeight / 4;
+                            int tileOffset = srcV * srcBytesPerRow + srcU * blockSize;
+
+                            const std::uint8_t *imgMip = img.getMipLevel(std::min(mip, mipLevelCount));
+                            std::uint8_t *tileMip = tile.getMipLevel(mip);
+
+                            for (int y = 0; y < vBlocks; y++)
+                            {
+                                std::memcpy(tileMip + y * destBytesPerRow,
+                                            imgMip + tileOffset + y * srcBytesPerRow,
+                                            destBytesPerRow);
+                            }
+                        }
                     }
+                    else
+                    {
+                        // TODO: Handle uncompressed textures with prebuilt mipmaps
+                    }
+
+                    LoadMipmapSet(tile, GL_TEXTURE_2D);
                 }
                 else
                 {
-                    const std::uint8_t* tilePixels = img.getPixels() +
-                        (v * tileHeight * img.getWidth() + u * tileWidth) * components;
-                    for (int y = 0; y < tileHeight; y++)
+                    if (img.isCompressed())
                     {
-                        memcpy(tile->getPixels() + y * tileWidth * components,
-                               tilePixels + y * img.getWidth() * components,
-                               tileWidth * components);
-                    }
-                }
+                        int blockSize = getCompressedBlockSize(img.getFormat());
+                        int uBlocks = std::max(tileWidth / 4, 1);
+                        int vBlocks = std::max(tileHeight / 4, 1);
+                        int destBytesPerRow = uBlocks * blockSize;
+                        int srcBytesPerRow = std::max(img.getWidth() / 4, 1) * blockSize;
+                        int srcU = u * tileWidth / 4;
+                        int srcV = v * tileHeight / 4;
+                        int tileOffset = srcV * srcBytesPerRow + srcU * blockSize;
 
-                if (mipmap)
-                {
-                    if (FramebufferObject::isSupported())
+                        for (int y = 0; y < vBlocks; y++)
+                        {
+                            memcpy(tile.getPixels() + y * destBytesPerRow,
+                                   img.getPixels() + tileOffset + y * srcBytesPerRow,
+                                   destBytesPerRow);
+                        }
+                    }
+                    else
                     {
-                        LoadMiplessTexture(*tile, GL_TEXTURE_2D);
-                        glGenerateMipmap(GL_TEXTURE_2D);
+                        const std::uint8_t* tilePixels = img.getPixels() +
+                            (v * tileHeight * img.getWidth() + u * tileWidth) * components;
+                        for (int y = 0; y < tileHeight; y++)
+                        {
+                            memcpy(tile.getPixels() + y * tileWidth * components,
+                                   tilePixels + y * img.getWidth() * components,
+                                   tileWidth * components);
+                        }
                     }
+
+                    if (mipmap)
+                    {
+                        if (FramebufferObject::isSupported())
+                        {
+                            LoadMiplessTexture(tile, GL_TEXTURE_2D);
+                            glGenerateMipmap(GL_TEXTURE_2D);
+                        }
 #ifndef GL_ES
+                        else
+                        {
+                            glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+                            LoadMiplessTexture(tile, GL_TEXTURE_2D);
+                        }
+#endif
+                    }
                     else
                     {
-                        glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
-                        LoadMiplessTexture(*tile, GL_TEXTURE_2D);
+                        LoadMiplessTexture(tile, GL_TEXTURE_2D);
                     }
-#endif
                 }
-                else
-                {
-                    LoadMiplessTexture(*tile, GL_TEXTURE_2D);
-                }
-            }
+            });
         }
     }
 
-    delete tile;
+    videoMemory.set(EstimateTextureSize(img, mipmap));
 }
 
 
 TiledTexture::~TiledTexture()
 {
+    cancelUpload();
     if (glNames != nullptr)
     {
         for (int i = 0; i < uSplit * vSplit; i++)
@@ -758,7 +942,7 @@ int TiledTexture::getVTileCount(int /*lod*/) const
 
 TextureTile TiledTexture::getTile(int lod, int u, int v)
 {
-    if (lod != 0 || u >= uSplit || u < 0 || v >= vSplit || v < 0)
+    if (lod != 0 || u >= uSplit || u < 0 || v >= vSplit || v < 0 || !isReady())
         return TextureTile(0);
 
     return TextureTile(glNames[v * uSplit + u]);
@@ -830,6 +1014,8 @@ CubeMap::CubeMap(celestia::util::array_view<const Image*> faces) :
     }
     if (genMipmaps && FramebufferObject::isSupported())
         glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+
+    videoMemory.set(EstimateTextureSize(*faces[0], mipmap) * 6);
 }
 
 
@@ -18,6 +18,13 @@
 #include <celimage/image.h>
 #include <celutil/array_view.h>
 #include <celutil/color.h>
+#include <celutil/memoryusage.h>
+
+namespace celestia::engine
+{
+class GLUploader;
+class UploadJob;
+}
 
 typedef void (*ProceduralTexEval)(float, float, float, std::uint8_t*);
 
@@ -76,6 +83,9 @@ class Texture
     bool hasAlpha() const { return alpha; }
     bool isCompressed() const { return compressed; }
 
+    //! False until a texture created through a GLUploader is uploaded
+    bool isReady() const;
+
     /*! Identical formats may need to be treated in slightly different
      *  fashions. One (and currently the only) example is the DXT5 compressed
      *  normal map format, which is an ordinary DXT5 texture but requires some
@@ -115,6 +125,13 @@ class Texture
  protected:
     bool alpha{ false };
     bool compressed{ false };
+    // Estimated, set by the subclasses once the texture is loaded
+    celestia::util::MemoryTracker videoMemory{ celestia::util::MemoryCategory::Textures };
+
+    // Pending upload of a texture created through a GLUploader; subclasses
+    // cancel it before deleting their GL objects.
+    std::shared_ptr<celestia::engine::UploadJob> upload;
+    void cancelUpload();
 
  private:
     int width;
@@ -129,6 +146,8 @@ class ImageTexture : public Texture
 {
  public:
     ImageTexture(const Image& img, AddressMode, MipMapMode);
+    ImageTexture(std::shared_ptr<const Image> img, AddressMode, MipMapMode,
+                 celestia::engine::GLUploader& uploader);
     ~ImageTexture();
 
     TextureTile getTile(int lod, int u, int v) override;
@@ -138,6 +157,9 @@ class ImageTexture : public Texture
     unsigned int getName() const;
 
  private:
+    void planUpload(const Image& img, AddressMode, MipMapMode,
+                    celestia::engine::UploadJob& job);
+
     unsigned int glName;
 };
 
@@ -146,6 +168,8 @@ class TiledTexture : public Texture
 {
  public:
     TiledTexture(const Image& img, int _uSplit, int _vSplit, MipMapMode);
+    TiledTexture(std::shared_ptr<const Image> img, int _uSplit, int _vSplit, MipMapMode,
+                 celestia::engine::GLUploader& uploader);
     ~TiledTexture();
 
     TextureTile getTile(int lod, int u, int v) override;
@@ -156,6 +180,8 @@ class TiledTexture : public Texture
     int getVTileCount(int lod) const override;
 
  private:
+    void planUpload(const Image& img, MipMapMode, celestia::engine::UploadJob& job);
+
     int uSplit;
     int vSplit;
     unsigned int* glNames;
@@ -195,6 +221,18 @@ std::unique_ptr<Texture>
 CreateProceduralCubeMap(int size, celestia::PixelFormat format,
                         ProceduralTexEval func);
 
+std::unique_ptr<Texture>
+CreateTextureFromImage(const Image& img,
+                       Texture::AddressMode addressMode = Texture::EdgeClamp,
+                       Texture::MipMapMode mipMode = Texture::DefaultMipMaps);
+
+// Create a texture that is uploaded by uploader over the following frames
+std::unique_ptr<Texture>
+CreateTextureFromImage(std::shared_ptr<const Image> img,
+                       Texture::AddressMode addressMode,
+                       Texture::MipMapMode mipMode,
+                       celestia::engine::GLUploader& uploader);
+
 std::unique_ptr<Texture>
 LoadTextureFromFile(const fs::path& filename,
                     Texture::AddressMode addressMode = Texture::EdgeClamp,
@@ -45,7 +45,7 @@ TimelinePhase::TimelinePhase(Body* _body,
 /*! Create a new timeline phase in the specified universe.
  */
 TimelinePhase::SharedConstPtr
-TimelinePhase::CreateTimelinePhase(Universe& universe,
+TimelinePhase::CreateTimelinePhase(const Universe& universe,
                                    Body* body,
                                    double startTime,
                                    double endTime,
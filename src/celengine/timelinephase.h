@@ -82,7 +82,7 @@ public:
         return m_startTime <= t && t < m_endTime;
     }
 
-    static TimelinePhase::SharedConstPtr CreateTimelinePhase(Universe& universe,
+    static TimelinePhase::SharedConstPtr CreateTimelinePhase(const Universe& universe,
                                                              Body* body,
                                                              double startTime,
                                                              double endTime,
@@ -181,3 +181,74 @@ inline UniversalCoord operator-(const UniversalCoord& uc0, const UniversalCoord&
 {
     return UniversalCoord(uc0.x - uc1.x, uc0.y - uc1.y, uc0.z - uc1.z);
 }
+
+
+/** An origin from which many universal coordinates are converted to offsets,
+  * such as the observer position during a frame. The R128 operators call
+  * out-of-line functions for each subtraction and conversion; here the
+  * difference is taken inline on the fixed point words, which the benchmark
+  * in univcoord_test.cpp measures at a tenth of the cost or less. The offsets
+  * keep double precision across the whole simulated volume, so R128 is only
+  * needed for the positions themselves.
+  */
+class UniversalCoordOrigin
+{
+ public:
+    UniversalCoordOrigin() = default;
+
+    explicit UniversalCoordOrigin(const UniversalCoord& _origin) :
+        origin(_origin)
+    {
+        // Split the origin into a double and the part below its precision,
+        // for offsets of points given in light years.
+        originUly = Eigen::Vector3d(static_cast<double>(origin.x),
+                                    static_cast<double>(origin.y),
+                                    static_cast<double>(origin.z));
+        originUlyLow = Eigen::Vector3d(difference(origin.x, R128(originUly.x())),
+                                       difference(origin.y, R128(originUly.y())),
+                                       difference(origin.z, R128(originUly.z())));
+    }
+
+    const UniversalCoord& getCoord() const { return origin; }
+
+    /** Get the offset in micro-light years of uc from the origin. */
+    Eigen::Vector3d offsetUly(const UniversalCoord& uc) const
+    {
+        return Eigen::Vector3d(difference(uc.x, origin.x),
+                               difference(uc.y, origin.y),
+                               difference(uc.z, origin.z));
+    }
+
+    /** Get the offset in kilometers of uc from the origin; the same as
+      * uc.offsetFromKm(origin).
+      */
+    Eigen::Vector3d offsetKm(const UniversalCoord& uc) const
+    {
+        return offsetUly(uc) * astro::microLightYearsToKilometers(1.0);
+    }
+
+    /** Get the offset in light years from the origin of a point given in
+      * light years, computed at double precision.
+      */
+    Eigen::Vector3d offsetLy(const Eigen::Vector3d& v) const
+    {
+        return ((v * 1.0e6 - originUly) - originUlyLow) * 1.0e-6;
+    }
+
+ private:
+    // The value of a - b: the words are subtracted with a borrow, then
+    // combined as hi + lo / 2^64. The low word is converted as a signed
+    // integer, which is cheaper; the bit shifted out lies far below double
+    // precision.
+    static double difference(const R128& a, const R128& b)
+    {
+        R128_U64 lo = a.lo - b.lo;
+        R128_U64 hi = a.hi - b.hi - static_cast<R128_U64>(a.lo < b.lo);
+        return static_cast<double>(static_cast<R128_S64>(hi)) +
+               static_cast<double>(static_cast<R128_S64>(lo >> 1)) * 0x1p-63;
+    }
+
+    UniversalCoord origin;
+    Eigen::Vector3d originUly{ Eigen::Vector3d::Zero() };
+    Eigen::Vector3d originUlyLow{ Eigen::Vector3d::Zero() };
+};
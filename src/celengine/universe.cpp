@@ -346,7 +346,7 @@ public:
     void process(const Star& star, float lowPrecDistance, float appMag) override;
 
 public:
-    UniversalCoord pickOrigin;
+    UniversalCoordOrigin pickOrigin;
     Eigen::Vector3f pickDir;
     double now;
     float maxDistance;
@@ -379,7 +379,7 @@ CloseStarPicker::process(const Star& star,
     if (lowPrecDistance > maxDistance)
         return;
 
-    Eigen::Vector3d hPos = star.getPosition(now).offsetFromKm(pickOrigin);
+    Eigen::Vector3d hPos = pickOrigin.offsetKm(star.getPosition(now));
     Eigen::Vector3f starDir = hPos.cast<float>();
 
     float distance = 0.0f;
@@ -626,6 +626,42 @@ Universe::setSolarSystemCatalog(std::unique_ptr<SolarSystemCatalog>&& catalog)
 }
 
 
+MinorBodyCatalog*
+Universe::getMinorBodyCatalog() const
+{
+    return minorBodyCatalog.get();
+}
+
+void
+Universe::setMinorBodyCatalog(std::unique_ptr<MinorBodyCatalog>&& catalog)
+{
+    minorBodyCatalog = std::move(catalog);
+    if (minorBodyCatalog == nullptr)
+        return;
+
+    // Bodies defined by solar system files before the catalog was loaded
+    // stand in for their catalog entries.
+    const SolarSystem* sys = getSolarSystem(minorBodyCatalog->getPrimary());
+    if (sys == nullptr)
+        return;
+
+    const PlanetarySystem* planets = sys->getPlanets();
+    for (int i = 0; i < planets->getSystemSize(); i++)
+    {
+        Body* body = planets->getBody(i);
+        for (const auto& name : body->getNames())
+        {
+            auto index = minorBodyCatalog->find(name);
+            if (index == MinorBodyCatalog::InvalidIndex)
+                continue;
+            if (minorBodyCatalog->getBody(index) == nullptr)
+                minorBodyCatalog->setBody(index, body);
+            break;
+        }
+    }
+}
+
+
 DSODatabase*
 Universe::getDSOCatalog() const
 {
@@ -995,8 +1031,14 @@ Universe::findChildObject(const Selection& sel,
             {
                 PlanetarySystem* planets = sys->getPlanets();
                 if (planets != nullptr)
-                    return Selection(planets->find(name, false, i18n));
+                {
+                    if (Body* body = planets->find(name, false, i18n); body != nullptr)
+                        return Selection(body);
+                }
             }
+
+            if (Body* body = findMinorBody(sys, name); body != nullptr)
+                return Selection(body);
         }
         break;
 
@@ -1070,6 +1112,9 @@ Universe::findObjectInContext(const Selection& sel,
             if (body != nullptr)
                 return Selection(body);
         }
+
+        if (Body* body = findMinorBody(sys, name); body != nullptr)
+            return Selection(body);
     }
 
     // ...and then locations.
@@ -1084,6 +1129,37 @@ Universe::findObjectInContext(const Selection& sel,
 }
 
 
+// Search the minor body catalog when the solar system is the one of its
+// primary, promoting the matching entry to a full body.
+Body*
+Universe::findMinorBody(const SolarSystem* sys, std::string_view name) const
+{
+    if (minorBodyCatalog == nullptr || sys == nullptr || sys->getStar() != minorBodyCatalog->getPrimary())
+        return nullptr;
+
+    auto index = minorBodyCatalog->find(name);
+    if (index == MinorBodyCatalog::InvalidIndex)
+        return nullptr;
+
+    // Promotion adds a body to the solar system but doesn't change the
+    // contents of the universe as seen by callers, much like the solar
+    // systems created on demand by createSolarSystem().
+    return CreateMinorBody(*minorBodyCatalog, index, *this);
+}
+
+
+// Create the full body for an entry of the minor body catalog, or return
+// the one created before.
+Body*
+Universe::promoteMinorBody(MinorBodyCatalog::IndexNumber index)
+{
+    if (minorBodyCatalog == nullptr || index >= minorBodyCatalog->size())
+        return nullptr;
+
+    return CreateMinorBody(*minorBodyCatalog, index, *this);
+}
+
+
 // Select an object by name, with the following priority:
 //   1. Try to look up the name in the star catalog
 //   2. Search the deep sky catalog for a matching name.
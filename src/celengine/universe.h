@@ -21,6 +21,7 @@
 #include <celengine/stardb.h>
 #include <celengine/dsodb.h>
 #include <celengine/solarsys.h>
+#include <celengine/minorbodies.h>
 #include <celengine/deepskyobj.h>
 #include <celengine/marker.h>
 #include <celengine/selection.h>
@@ -40,6 +41,10 @@ class Universe
     SolarSystemCatalog* getSolarSystemCatalog() const;
     void setSolarSystemCatalog(std::unique_ptr<SolarSystemCatalog>&&);
 
+    MinorBodyCatalog* getMinorBodyCatalog() const;
+    void setMinorBodyCatalog(std::unique_ptr<MinorBodyCatalog>&&);
+    Body* promoteMinorBody(MinorBodyCatalog::IndexNumber index);
+
     DSODatabase* getDSOCatalog() const;
     void setDSOCatalog(std::unique_ptr<DSODatabase>&&);
 
@@ -103,6 +108,7 @@ class Universe
     Selection findObjectInContext(const Selection& sel,
                                   std::string_view name,
                                   bool i18n = false) const;
+    Body* findMinorBody(const SolarSystem* sys, std::string_view name) const;
 
     Selection pickPlanet(const SolarSystem& solarSystem,
                          const UniversalCoord& origin,
@@ -127,6 +133,7 @@ class Universe
     std::unique_ptr<StarDatabase> starCatalog{nullptr};
     std::unique_ptr<DSODatabase> dsoCatalog{nullptr};
     std::unique_ptr<SolarSystemCatalog> solarSystemCatalog{nullptr};
+    std::unique_ptr<MinorBodyCatalog> minorBodyCatalog{nullptr};
     std::unique_ptr<AsterismList> asterisms{nullptr};
     std::unique_ptr<ConstellationBoundaries> boundaries{nullptr};
 
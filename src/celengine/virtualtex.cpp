@@ -7,19 +7,23 @@
 // as published by the Free Software Foundation; either version 2
 // of the License, or (at your option) any later version.
 
+#include <algorithm>
 #include <cmath>
 #include <cassert>
 #include <cmath>
 #include <istream>
 #include <fstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <fmt/format.h>
 #include <celcompat/filesystem.h>
 #include <celutil/filetype.h>
 #include <celutil/logger.h>
+#include <celutil/taskscheduler.h>
 #include <celutil/tokenizer.h>
 #include "glsupport.h"
+#include "glupload.h"
 #include "parser.h"
 #include "virtualtex.h"
 
@@ -98,6 +102,12 @@ TextureTile VirtualTexture::getTile(int lod, int u, int v)
     Tile* tile = node->tile;
     unsigned int tileLOD = 0;
 
+    // The most detailed uploaded tile, used while the chosen one uploads
+    Tile* readyTile = nullptr;
+    unsigned int readyLOD = 0;
+    if (tile != nullptr && tile->tex != nullptr && tile->tex->isReady())
+        readyTile = tile;
+
     for (int n = 0; n < lod; n++)
     {
         unsigned int mask = 1 << (lod - n - 1);
@@ -111,6 +121,11 @@ TextureTile VirtualTexture::getTile(int lod, int u, int v)
         {
             tile = node->tile;
             tileLOD = n + 1;
+            if (tile->tex != nullptr && tile->tex->isReady())
+            {
+                readyTile = tile;
+                readyLOD = tileLOD;
+            }
         }
     }
 
@@ -123,11 +138,17 @@ TextureTile VirtualTexture::getTile(int lod, int u, int v)
     unsigned int tileV = v >> (lod - tileLOD);
     makeResident(tile, tileLOD, tileU, tileV);
 
+    if (tile->tex != nullptr && !tile->tex->isReady() && readyTile != nullptr)
+    {
+        tile = readyTile;
+        tileLOD = readyLOD;
+    }
+
     // It's possible that we failed to make the tile resident, either
     // because the texture file was bad, or there was an unresolvable
     // out of memory situation.  In that case there is nothing else to
     // do but return a texture tile with a null texture name.
-    if (!tile->tex)
+    if (!tile->tex || !tile->tex->isReady())
         return TextureTile(0);
 
     // Set up the texture subrect to be the entire texture
@@ -194,43 +215,84 @@ unsigned int VirtualTexture::tileIndex(unsigned int lod,
 #endif
 
 
-ImageTexture* VirtualTexture::loadTileTexture(unsigned int lod, unsigned int u, unsigned int v)
+fs::path VirtualTexture::getTilePath(unsigned int lod, unsigned int u, unsigned int v) const
 {
     lod >>= baseSplit;
     assert(lod < (unsigned)MaxResolutionLevels);
 
-    auto path = tilePath /
-                fmt::format("level{:d}", lod) /
-                fmt::format("{:s}{:d}_{:d}{:s}", tilePrefix, u, v, tileExt.string());
+    return tilePath /
+           fmt::format("level{:d}", lod) /
+           fmt::format("{:s}{:d}_{:d}{:s}", tilePrefix, u, v, tileExt.string());
+}
+
 
-    std::unique_ptr<Image> img = LoadImageFromFile(path);
+ImageTexture* VirtualTexture::loadTileTexture(unsigned int lod, unsigned int u, unsigned int v)
+{
+    std::unique_ptr<Image> img = LoadImageFromFile(getTilePath(lod, u, v));
     if (img == nullptr)
         return nullptr;
 
+    return createTileTexture(std::move(img), lod);
+}
+
+
+// Tiles are uploaded in the background; getTile() uses the tiles above
+// them in the tree until they are ready.
+ImageTexture* VirtualTexture::createTileTexture(std::unique_ptr<Image>&& img, unsigned int lod)
+{
+    lod >>= baseSplit;
+
     ImageTexture* tex = nullptr;
 
     // Only use mip maps for the LOD 0; for higher LODs, the function of mip
     // mapping is built into the texture.
     MipMapMode mipMapMode = lod == 0 ? DefaultMipMaps : NoMipMaps;
 
-    if (isPow2(img->getWidth()) && isPow2(img->getHeight()))
-        tex = new ImageTexture(*img, EdgeClamp, mipMapMode);
-
     // TODO: Virtual textures can have tiles in different formats, some
     // compressed and some not. The compression flag doesn't make much
     // sense for them.
     compressed = img->isCompressed();
 
+    if (isPow2(img->getWidth()) && isPow2(img->getHeight()))
+    {
+        tex = new ImageTexture(std::shared_ptr<const Image>(std::move(img)), EdgeClamp, mipMapMode,
+                               celestia::engine::GetGLUploader());
+    }
+
     return tex;
 }
 
 
+// Take the image decoded for a tile by preloadTiles(). A preload that
+// hasn't started is abandoned and one that is running is waited for, which
+// is no slower than decoding the image here.
+std::unique_ptr<Image> VirtualTexture::takePreloadedImage(Tile* tile)
+{
+    std::shared_ptr<TilePreload> preload = std::move(tile->preload);
+    if (preload == nullptr)
+        return nullptr;
+
+    int state = TilePreload::Queued;
+    if (preload->state.compare_exchange_strong(state, TilePreload::Abandoned))
+        return nullptr;
+
+    while (preload->state.load(std::memory_order_acquire) != TilePreload::Ready)
+        std::this_thread::yield();
+
+    return std::move(preload->image);
+}
+
+
 void VirtualTexture::makeResident(Tile* tile, unsigned int lod, unsigned int u, unsigned int v)
 {
     if (tile->tex == nullptr && !tile->loadFailed)
     {
         // Potentially evict other tiles in order to make this one fit
-        tile->tex = loadTileTexture(lod, u, v);
+        if (std::unique_ptr<Image> img = takePreloadedImage(tile); img != nullptr)
+            tile->tex = createTileTexture(std::move(img), lod);
+        else
+            tile->tex = loadTileTexture(lod, u, v);
+
         if (tile->tex == nullptr)
         {
             tile->loadFailed = true;
@@ -239,6 +301,73 @@ void VirtualTexture::makeResident(Tile* tile, unsigned int lod, unsigned int u,
 }
 
 
+unsigned int VirtualTexture::preloadTiles(int lod)
+{
+    if (lod < 0)
+        return 0;
+
+    unsigned int maxLOD = std::min(static_cast<unsigned int>(lod) + baseSplit, nResolutionLevels - 1);
+    return preloadNode(tileTree[0], 0, 0, 0, maxLOD) + preloadNode(tileTree[1], 0, 1, 0, maxLOD);
+}
+
+
+unsigned int VirtualTexture::preloadNode(TileQuadtreeNode* node,
+                                         unsigned int lod, unsigned int u, unsigned int v,
+                                         unsigned int maxLOD)
+{
+    if (node == nullptr)
+        return 0;
+
+    unsigned int queued = 0;
+    if (Tile* tile = node->tile;
+        tile != nullptr && tile->tex == nullptr && !tile->loadFailed && tile->preload == nullptr)
+    {
+        auto preload = std::make_shared<TilePreload>();
+        preload->path = getTilePath(lod, u, v);
+        tile->preload = preload;
+        pendingPreloads.push_back(preload);
+        ++queued;
+
+        // Tasks only share the preload, so they outlive neither the tile
+        // nor the texture.
+        celestia::util::GetTaskScheduler().detach([preload]
+        {
+            int state = TilePreload::Queued;
+            if (!preload->state.compare_exchange_strong(state, TilePreload::Running))
+                return;
+            preload->image = LoadImageFromFile(preload->path);
+            preload->state.store(TilePreload::Ready, std::memory_order_release);
+        });
+    }
+
+    if (lod < maxLOD)
+    {
+        // Children are ordered by the low bits of v and u
+        for (unsigned int child = 0; child < 4; ++child)
+        {
+            queued += preloadNode(node->children[child], lod + 1,
+                                  (u << 1) | (child & 1), (v << 1) | (child >> 1),
+                                  maxLOD);
+        }
+    }
+
+    return queued;
+}
+
+
+unsigned int VirtualTexture::getPendingTileCount()
+{
+    pendingPreloads.erase(std::remove_if(pendingPreloads.begin(), pendingPreloads.end(),
+                                         [](const std::shared_ptr<TilePreload>& p)
+                                         {
+                                             int state = p->state.load(std::memory_order_acquire);
+                                             return state == TilePreload::Ready || state == TilePreload::Abandoned;
+                                         }),
+                          pendingPreloads.end());
+    return static_cast<unsigned int>(pendingPreloads.size());
+}
+
+
 void VirtualTexture::populateTileTree()
 {
     // Count the number of resolution levels present
@@ -9,8 +9,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <celcompat/filesystem.h>
 #include <celengine/texture.h>
@@ -35,13 +37,38 @@ class VirtualTexture : public Texture
     void beginUsage() override;
     void endUsage() override;
 
+    /*! Decode the image files of the tiles down to the given level of
+     *  detail on background tasks, so that making them resident only has
+     *  to create the textures. Returns the number of tiles queued.
+     */
+    unsigned int preloadTiles(int lod);
+
+    //! Number of tiles queued by preloadTiles() that aren't decoded yet
+    unsigned int getPendingTileCount();
+
  private:
+    struct TilePreload
+    {
+        enum State
+        {
+            Queued,
+            Running,
+            Ready,
+            Abandoned,
+        };
+
+        fs::path path;
+        std::unique_ptr<Image> image;
+        std::atomic<int> state{ Queued };
+    };
+
     struct Tile
     {
         Tile() = default;
         unsigned int lastUsed{ 0 };
         ImageTexture* tex{ nullptr };
         bool loadFailed{ false };
+        std::shared_ptr<TilePreload> preload;
     };
 
     struct TileQuadtreeNode
@@ -55,6 +82,12 @@ class VirtualTexture : public Texture
     void addTileToTree(Tile* tile, unsigned int lod, unsigned int u, unsigned int v);
     void makeResident(Tile* tile, unsigned int lod, unsigned int u, unsigned int v);
     ImageTexture* loadTileTexture(unsigned int lod, unsigned int u, unsigned int v);
+    ImageTexture* createTileTexture(std::unique_ptr<Image>&& img, unsigned int lod);
+    fs::path getTilePath(unsigned int lod, unsigned int u, unsigned int v) const;
+    std::unique_ptr<Image> takePreloadedImage(Tile* tile);
+    unsigned int preloadNode(TileQuadtreeNode* node,
+                             unsigned int lod, unsigned int u, unsigned int v,
+                             unsigned int maxLOD);
 
     Tile* tiles{ nullptr };
     Tile* findTile(unsigned int lod,
@@ -77,6 +110,8 @@ class VirtualTexture : public Texture
     };
 
     TileQuadtreeNode* tileTree[2];
+
+    std::vector<std::shared_ptr<TilePreload>> pendingPreloads;
 };
 
 
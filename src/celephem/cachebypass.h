@@ -0,0 +1,37 @@
+// cachebypass.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+namespace celestia::ephem
+{
+
+/*! Caching orbits, rotation models and reference frames remember the result
+ *  of their last evaluation in mutable members, which makes them unsafe to
+ *  evaluate from more than one thread. Code that computes ephemerides away
+ *  from the main thread keeps a CacheBypass alive for the duration of the
+ *  work: while one exists on a thread, those objects compute every result
+ *  directly and leave their caches untouched.
+ */
+class CacheBypass
+{
+ public:
+    CacheBypass() { ++depth; }
+    ~CacheBypass() { --depth; }
+
+    CacheBypass(const CacheBypass&) = delete;
+    CacheBypass& operator=(const CacheBypass&) = delete;
+
+    static bool active() { return depth > 0; }
+
+ private:
+    static inline thread_local int depth = 0;
+};
+
+} // end namespace celestia::ephem
@@ -145,14 +145,15 @@ class PlanetOrbitMixin
 protected:
     constexpr PlanetOrbitMixin() noexcept = default;
 
-    static std::array<PlanetElements, 8> gPlanetElements;
+    // Scratch space filled by computePlanetElements, one per thread
+    static thread_local std::array<PlanetElements, 8> gPlanetElements;
     void computePlanetElements(double, const int*, std::size_t) const;
     void computePlanetCoords(int p, double map, double da, double dhl, double dl,
                              double dm, double dml, double dr, double ds,
                              double& eclLong, double& eclLat, double& distance) const;
 };
 
-std::array<PlanetElements, 8> PlanetOrbitMixin::gPlanetElements{ };
+thread_local std::array<PlanetElements, 8> PlanetOrbitMixin::gPlanetElements{ };
 
 void
 PlanetOrbitMixin::computePlanetElements(double t, const int* pList, std::size_t npList) const
@@ -12,11 +12,16 @@
 
 #include "customrotation.h"
 
+#include <array>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <initializer_list>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <Eigen/Geometry>
 
@@ -188,1007 +193,548 @@ public:
 
 
 
-/******* IAU rotation models for the planets *******/
 
+/******* IAU rotation elements *******/
 
-/*! IAUPrecessingRotationModel is a rotation model with uniform rotation about
- *  a pole that precesses linearly in RA and declination.
- */
-class IAUPrecessingRotationModel : public IAURotationModel
-{
-public:
-
-    /*! rotationRate is in degrees per Julian day
-     *  pole precession is in degrees per Julian century
-     */
-    IAUPrecessingRotationModel(double _poleRA,
-                               double _poleRARate,
-                               double _poleDec,
-                               double _poleDecRate,
-                               double _meridianAtEpoch,
-                               double _rotationRate) :
-    IAURotationModel(std::abs(360.0 / _rotationRate)),
-        poleRA(_poleRA),
-        poleRARate(_poleRARate),
-        poleDec(_poleDec),
-        poleDecRate(_poleDecRate),
-        meridianAtEpoch(_meridianAtEpoch),
-        rotationRate(_rotationRate)
-    {
-        if (rotationRate < 0.0)
-            setFlipped(true);
-    }
-
-    void pole(double d, double& ra, double &dec) const override
-    {
-        double T = d / 36525.0;
-        clamp_centuries(T);
-        ra = poleRA + poleRARate * T;
-        dec = poleDec + poleDecRate * T;
-    }
-
-    double meridian(double d) const override
-    {
-        return meridianAtEpoch + rotationRate * d;
-    }
-
-private:
-    double poleRA;
-    double poleRARate;
-    double poleDec;
-    double poleDecRate;
-    double meridianAtEpoch;
-    double rotationRate;
-};
-
-
-class IAUNeptuneRotationModel : public IAURotationModel
-{
-public:
-    IAUNeptuneRotationModel() : IAURotationModel(360.0 / 536.3128492) {}
-
-    void pole(double d, double& ra, double &dec) const override
-    {
-        double T = d / 36525.0;
-        double N = celmath::degToRad(357.85 + 52.316 * T);
-        ra = 299.36 + 0.70 * sin(N);
-        dec = 43.46 - 0.51 * cos(N);
-    }
-
-    double meridian(double d) const override
-    {
-        double T = d / 36525.0;
-        double N = celmath::degToRad(357.85 + 52.316 * T);
-        return 253.18 + 536.3128492 * d - 0.48 * sin(N);
-    }
-};
-
-
-/*! IAU rotation model for the Moon.
- *  From the IAU/IAG Working Group on Cartographic Coordinates and Rotational Elements:
- *  http://astrogeology.usgs.gov/Projects/WGCCRE/constants/iau2000_table2.html
- */
-class IAULunarRotationModel : public IAURotationModel
+// The planetary systems of the IAU rotation elements. Satellites of a planet
+// share the fundamental arguments of their periodic terms (J1..J8 for the
+// Jovian satellites, S3..S9 for the Saturnian ones, etc.), so these are
+// evaluated once per system rather than once per body.
+enum class IAUSystem : std::uint8_t
 {
-public:
-    IAULunarRotationModel() : IAURotationModel(360.0 / 13.17635815) {}
-
-    void calcArgs(double d, double E[14]) const
-    {
-        E[1]  = celmath::degToRad(125.045 -  0.0529921 * d);
-        E[2]  = celmath::degToRad(250.089 -  0.1059842 * d);
-        E[3]  = celmath::degToRad(260.008 + 13.012009 * d);
-        E[4]  = celmath::degToRad(176.625 + 13.3407154 * d);
-        E[5]  = celmath::degToRad(357.529 +  0.9856993 * d);
-        E[6]  = celmath::degToRad(311.589 + 26.4057084 * d);
-        E[7]  = celmath::degToRad(134.963 + 13.0649930 * d);
-        E[8]  = celmath::degToRad(276.617 +  0.3287146 * d);
-        E[9]  = celmath::degToRad( 34.226 +  1.7484877 * d);
-        E[10] = celmath::degToRad( 15.134 -  0.1589763 * d);
-        E[11] = celmath::degToRad(119.743 +  0.0036096 * d);
-        E[12] = celmath::degToRad(239.961 +  0.1643573 * d);
-        E[13] = celmath::degToRad( 25.053 + 12.9590088 * d);
-    }
-
-    void pole(double d, double& ra, double& dec) const override
-    {
-        double T = d / 36525.0;
-        clamp_centuries(T);
-
-        double E[14];
-        calcArgs(d, E);
-
-        ra = 269.9949
-            + 0.0013*T
-            - 3.8787 * std::sin(E[1])
-            - 0.1204 * std::sin(E[2])
-            + 0.0700 * std::sin(E[3])
-            - 0.0172 * std::sin(E[4])
-            + 0.0072 * std::sin(E[6])
-            - 0.0052 * std::sin(E[10])
-            + 0.0043 * std::sin(E[13]);
-
-        dec = 66.5392
-            + 0.0130 * T
-            + 1.5419 * std::cos(E[1])
-            + 0.0239 * std::cos(E[2])
-            - 0.0278 * std::cos(E[3])
-            + 0.0068 * std::cos(E[4])
-            - 0.0029 * std::cos(E[6])
-            + 0.0009 * std::cos(E[7])
-            + 0.0008 * std::cos(E[10])
-            - 0.0009 * std::cos(E[13]);
-
-
-    }
-
-    double meridian(double d) const override
-    {
-        double E[14];
-        calcArgs(d, E);
-
-        // d^2 represents slowing of lunar rotation as the Moon recedes
-        // from the Earth. This may need to be clamped at some very large
-        // time range (1 Gy?)
-
-        return (38.3213
-                + 13.17635815 * d
-                - 1.4e-12 * d * d
-                + 3.5610 * std::sin(E[1])
-                + 0.1208 * std::sin(E[2])
-                - 0.0642 * std::sin(E[3])
-                + 0.0158 * std::sin(E[4])
-                + 0.0252 * std::sin(E[5])
-                - 0.0066 * std::sin(E[6])
-                - 0.0047 * std::sin(E[7])
-                - 0.0046 * std::sin(E[8])
-                + 0.0028 * std::sin(E[9])
-                + 0.0052 * std::sin(E[10])
-                + 0.0040 * std::sin(E[11])
-                + 0.0019 * std::sin(E[12])
-                - 0.0044 * std::sin(E[13]));
-    }
+    Mercury,
+    Venus,
+    Earth,
+    Mars,
+    Jupiter,
+    Saturn,
+    Uranus,
+    Neptune,
+    Pluto,
+    SystemsCount,
 };
 
+// Indices of the fundamental arguments within each system
+enum LunarArgument : std::uint8_t { E1, E2, E3, E4, E5, E6, E7, E8, E9, E10, E11, E12, E13 };
+enum MarsArgument : std::uint8_t { M1, M2, M3 };
+enum JupiterArgument : std::uint8_t { J1, J2, J3, J4, J5, J6, J7, J8 };
+enum SaturnArgument : std::uint8_t { S3, S4, S5, S6, S7, S8, S9 };
+enum UranusArgument : std::uint8_t { U11, U12, U13, U14, U15, U16 };
+enum NeptuneArgument : std::uint8_t { N };
 
-// Rotations of Martian, Jovian, and Uranian satellites from IAU/IAG Working group
-// on Cartographic Coordinates and Rotational Elements (Corrected for known errata
-// as of 17 Feb 2006)
-// See: http://astrogeology.usgs.gov/Projects/WGCCRE/constants/iau2000_table2.html
-
-class IAUPhobosRotationModel : public IAURotationModel
-{
-public:
-    IAUPhobosRotationModel() : IAURotationModel(360.0 / 1128.8445850) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double M1 = celmath::degToRad(169.51 - 0.04357640 * t);
-        clamp_centuries(T);
-        ra  = 317.68 - 0.108 * T + 1.79 * std::sin(M1);
-        dec =  52.90 - 0.061 * T - 1.08 * std::cos(M1);
-    }
-
-    double meridian(double t) const override
-    {
-        // Note: negative coefficient of T^2 term for meridian angle indicates faster
-        // rotation as Phobos's orbit evolves inward toward Mars
-        double T = t / 36525.0;
-        double M1 = celmath::degToRad(169.51 - 0.04357640 * t);
-        double M2 = celmath::degToRad(192.93 + 1128.4096700 * t + 8.864 * T * T);
-        return 35.06 + 1128.8445850 * t + 8.864 * T * T - 1.42 * std::sin(M1) - 0.78 * std::sin(M2);
-    }
-};
-
+constexpr std::size_t MaxIAUArguments = 13;
 
-class IAUDeimosRotationModel : public IAURotationModel
+// A fundamental argument in degrees: constant + rate * T + quadratic * T^2,
+// where T is in Julian centuries from J2000.0.
+struct IAUArgument
 {
-public:
-    IAUDeimosRotationModel() : IAURotationModel(360.0 / 285.1618970) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double M3 = celmath::degToRad(53.47 - 0.0181510 * t);
-        clamp_centuries(T);
-        ra  = 316.65 - 0.108 * T + 2.98 * std::sin(M3);
-        dec =  53.52 - 0.061 * T - 1.78 * std::cos(M3);
-    }
-
-    double meridian(double t) const override
-    {
-        // Note: positive coefficient of T^2 term for meridian angle indicates slowing
-        // rotation as Deimos's orbit evolves outward from Mars
-        double T = t / 36525.0;
-        double M3 = celmath::degToRad(53.47 - 0.0181510 * t);
-        return 79.41 + 285.1618970 * t + 0.520 * T * T - 2.58 * std::sin(M3) + 0.19 * std::cos(M3);
-    }
+    double constant;
+    double rate;
+    double quadratic{ 0.0 };
 };
 
-
-/****** Satellites of Jupiter ******/
-
-class IAUAmaltheaRotationModel : public IAURotationModel
+// Convert a rate in degrees per day to degrees per Julian century
+constexpr double
+perDay(double rate)
 {
-public:
-    IAUAmaltheaRotationModel() : IAURotationModel(360.0 / 722.6314560) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double J1 = celmath::degToRad(73.32 + 91472.9 * T);
-        clamp_centuries(T);
-        ra = 268.05 - 0.009 * T - 0.84 * std::sin(J1) + 0.01 * std::sin(2.0 * J1);
-        dec = 64.49 + 0.003 * T - 0.36 * std::cos(J1);
-    }
-
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double J1 = celmath::degToRad(73.32 + 91472.9 * T);
-        return 231.67 + 722.6314560 * t + 0.76 * std::sin(J1) - 0.01 * std::sin(2.0 * J1);
-    }
-};
-
-
-class IAUThebeRotationModel : public IAURotationModel
-{
-public:
-    IAUThebeRotationModel() : IAURotationModel(360.0 / 533.7004100) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double J2 = celmath::degToRad(24.62 + 45137.2 * T);
-        clamp_centuries(T);
-        ra = 268.05 - 0.009 * T - 2.11 * std::sin(J2) + 0.04 * std::sin(2.0 * J2);
-        dec = 64.49 + 0.003 * T - 0.91 * std::cos(J2) + 0.01 * std::cos(2.0 * J2);
-    }
-
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double J2 = celmath::degToRad(24.62 + 45137.2 * T);
-        return 8.56 + 533.7004100 * t + 1.91 * std::sin(J2) - 0.04 * std::sin(2.0 * J2);
-    }
-};
-
-
-class IAUIoRotationModel : public IAURotationModel
-{
-public:
-    IAUIoRotationModel() : IAURotationModel(360.0 / 203.4889538) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double J3 = celmath::degToRad(283.90 + 4850.7 * T);
-        double J4 = celmath::degToRad(355.80 + 1191.3 * T);
-        clamp_centuries(T);
-        ra = 268.05 - 0.009 * T + 0.094 * std::sin(J3) + 0.024 * std::sin(J4);
-        dec = 64.49 + 0.003 * T + 0.040 * std::cos(J3) + 0.011 * std::cos(J4);
-    }
-
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double J3 = celmath::degToRad(283.90 + 4850.7 * T);
-        double J4 = celmath::degToRad(355.80 + 1191.3 * T);
-        return 200.39 + 203.4889538 * t - 0.085 * std::sin(J3) - 0.022 * std::sin(J4);
-    }
-};
-
-
-class IAUEuropaRotationModel : public IAURotationModel
-{
-public:
-    IAUEuropaRotationModel() : IAURotationModel(360.0 / 101.3747235) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double J4 = celmath::degToRad(355.80 + 1191.3 * T);
-        double J5 = celmath::degToRad(119.90 + 262.1 * T);
-        double J6 = celmath::degToRad(229.80 + 64.3 * T);
-        double J7 = celmath::degToRad(352.35 + 2382.6 * T);
-        clamp_centuries(T);
-        ra = 268.05 - 0.009 * T + 1.086 * std::sin(J4) + 0.060 * std::sin(J5) + 0.015 * std::sin(J6) + 0.009 * std::sin(J7);
-        dec = 64.49 + 0.003 * T + 0.486 * std::cos(J4) + 0.026 * std::cos(J5) + 0.007 * std::cos(J6) + 0.002 * std::cos(J7);
-    }
-
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double J4 = celmath::degToRad(355.80 + 1191.3 * T);
-        double J5 = celmath::degToRad(119.90 + 262.1 * T);
-        double J6 = celmath::degToRad(229.80 + 64.3 * T);
-        double J7 = celmath::degToRad(352.35 + 2382.6 * T);
-        return 36.022 + 101.3747235 * t - 0.980 * std::sin(J4) - 0.054 * std::sin(J5) - 0.014 * std::sin(J6) - 0.008 * std::sin(J7);
-    }
-};
-
-
-class IAUGanymedeRotationModel : public IAURotationModel
-{
-public:
-    IAUGanymedeRotationModel() : IAURotationModel(360.0 / 50.3176081) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double J4 = celmath::degToRad(355.80 + 1191.3 * T);
-        double J5 = celmath::degToRad(119.90 + 262.1 * T);
-        double J6 = celmath::degToRad(229.80 + 64.3 * T);
-        clamp_centuries(T);
-        ra = 268.05 - 0.009 * T - 0.037 * std::sin(J4) + 0.431 * std::sin(J5) + 0.091 * std::sin(J6);
-        dec = 64.49 + 0.003 * T - 0.016 * std::cos(J4) + 0.186 * std::cos(J5) + 0.039 * std::cos(J6);
-    }
-
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double J4 = celmath::degToRad(355.80 + 1191.3 * T);
-        double J5 = celmath::degToRad(119.90 + 262.1 * T);
-        double J6 = celmath::degToRad(229.80 + 64.3 * T);
-        return 44.064 + 50.3176081 * t + 0.033 * std::sin(J4) - 0.389 * std::sin(J5) - 0.082 * std::sin(J6);
-    }
-};
-
-
-class IAUCallistoRotationModel : public IAURotationModel
-{
-public:
-    IAUCallistoRotationModel() : IAURotationModel(360.0 / 21.5710715) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double J5 = celmath::degToRad(119.90 + 262.1 * T);
-        double J6 = celmath::degToRad(229.80 + 64.3 * T);
-        double J8 = celmath::degToRad(113.35 + 6070.0 * T);
-        clamp_centuries(T);
-        ra = 268.05 - 0.009 * T - 0.068 * std::sin(J5) + 0.590 * std::sin(J6) + 0.010 * std::sin(J8);
-        dec = 64.49 + 0.003 * T - 0.029 * std::cos(J5) + 0.254 * std::cos(J6) - 0.004 * std::cos(J8);
-    }
-
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double J5 = celmath::degToRad(119.90 + 262.1 * T);
-        double J6 = celmath::degToRad(229.80 + 64.3 * T);
-        double J8 = celmath::degToRad(113.35 + 6070.0 * T);
-        return 259.51 + 21.5710715 * t + 0.061 * std::sin(J5) - 0.533 * std::sin(J6) - 0.009 * std::sin(J8);
-    }
-};
-
-
-/*
-S1 = 353.32 + 75706.7 * T
-S2 = 28.72 + 75706.7 * T
-S3 = 177.40 - 36505.5 * T
-S4 = 300.00 - 7225.9 * T
-S5 = 53.59 - 8968.6 * T
-S6 = 143.38 - 10553.5 * T
-S7 = 345.20 - 1016.3 * T
-S8 = 29.80 - 52.1 * T
-S9 = 316.45 + 506.2 * T
-*/
-
-// Rotations of Saturnian satellites from Seidelmann, _Explanatory Supplement to the
-// Astronomical Almanac_ (1992).
+    return rate * 36525.0;
+}
 
-class IAUMimasRotationModel : public IAURotationModel
+// From the IAU/IAG Working Group on Cartographic Coordinates and Rotational
+// Elements: http://astrogeology.usgs.gov/Projects/WGCCRE/constants/iau2000_table2.html
+// (Corrected for known errata as of 17 Feb 2006)
+const std::vector<IAUArgument>&
+systemArguments(IAUSystem system)
 {
-public:
-    IAUMimasRotationModel() : IAURotationModel(360.0 / 381.9945550) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double S3 = celmath::degToRad(177.40 - 36505.5 * T);
-        clamp_centuries(T);
-        ra = 40.66 - 0.036 * T + 13.56 * std::sin(S3);
-        dec = 83.52 - 0.004 * T - 1.53 * std::cos(S3);
-    }
-
-    double meridian(double t) const override
+    static const std::array<std::vector<IAUArgument>, static_cast<std::size_t>(IAUSystem::SystemsCount)> arguments
     {
-        double T = t / 36525.0;
-        double S3 = celmath::degToRad(177.40 - 36505.5 * T);
-        double S9 = celmath::degToRad(316.45 + 506.2 * T);
-        return 337.46 + 381.9945550 * t - 13.48 * std::sin(S3) - 44.85 * std::sin(S9);
-    }
-};
-
-
-class IAUEnceladusRotationModel : public IAURotationModel
-{
-public:
-    IAUEnceladusRotationModel() : IAURotationModel(360.0 / 262.7318996) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        clamp_centuries(T);
-        ra = 40.66 - 0.036 * T;
-        dec = 83.52 - 0.004 * T;
-    }
-
-    double meridian(double t) const override
-    {
-        return 2.82 + 262.7318996 * t;
-    }
-};
+        std::vector<IAUArgument>{ }, // Mercury
+        std::vector<IAUArgument>{ }, // Venus
+        std::vector<IAUArgument>     // Earth (E1..E13 for the Moon)
+        {
+            { 125.045, perDay( -0.0529921) },
+            { 250.089, perDay( -0.1059842) },
+            { 260.008, perDay( 13.012009)  },
+            { 176.625, perDay( 13.3407154) },
+            { 357.529, perDay(  0.9856993) },
+            { 311.589, perDay( 26.4057084) },
+            { 134.963, perDay( 13.0649930) },
+            { 276.617, perDay(  0.3287146) },
+            {  34.226, perDay(  1.7484877) },
+            {  15.134, perDay( -0.1589763) },
+            { 119.743, perDay(  0.0036096) },
+            { 239.961, perDay(  0.1643573) },
+            {  25.053, perDay( 12.9590088) },
+        },
+        std::vector<IAUArgument>     // Mars
+        {
+            { 169.51, perDay(  -0.04357640)        },
+            { 192.93, perDay(1128.4096700),  8.864 },
+            {  53.47, perDay(  -0.0181510)         },
+        },
+        std::vector<IAUArgument>     // Jupiter
+        {
+            {  73.32, 91472.9 },
+            {  24.62, 45137.2 },
+            { 283.90,  4850.7 },
+            { 355.80,  1191.3 },
+            { 119.90,   262.1 },
+            { 229.80,    64.3 },
+            { 352.35,  2382.6 },
+            { 113.35,  6070.0 },
+        },
+        std::vector<IAUArgument>     // Saturn; S1 and S2 are not used by any model
+        {
+            { 177.40, -36505.5 },
+            { 300.00,  -7225.9 },
+            {  53.59,  -8968.6 },
+            { 143.38, -10553.5 },
+            { 345.20,  -1016.3 },
+            {  29.80,    -52.1 },
+            { 316.45,    506.2 },
+        },
+        std::vector<IAUArgument>     // Uranus; only U11..U16 are used
+        {
+            { 102.23, -2024.22 },
+            { 316.41,  2863.96 },
+            { 304.01,   -51.94 },
+            { 308.71,   -93.17 },
+            { 340.82,   -75.32 },
+            { 259.14,  -504.81 },
+        },
+        std::vector<IAUArgument>     // Neptune
+        {
+            { 357.85, 52.316 },
+        },
+        std::vector<IAUArgument>{ }, // Pluto
+    };
 
+    return arguments[static_cast<std::size_t>(system)];
+}
 
-class IAUTethysRotationModel : public IAURotationModel
+// A periodic term: amplitude * sin(multiple * argument) for right ascension
+// and meridian, amplitude * cos(multiple * argument) for declination.
+struct IAUPeriodicTerm
 {
-public:
-    IAUTethysRotationModel() : IAURotationModel(360.0 / 190.6979085) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double S4 = celmath::degToRad(300.00 - 7225.9 * T);
-        clamp_centuries(T);
-        ra = 40.66 - 0.036 * T - 9.66 * sin(S4);
-        dec = 83.52 - 0.004 * T - 1.09 * cos(S4);
-    }
-
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double S4 = celmath::degToRad(300.00 - 7225.9 * T);
-        double S9 = celmath::degToRad(316.45 + 506.2 * T);
-        return 10.45 + 190.6979085 * t - 9.60 * std::sin(S4) + 2.23 * std::sin(S9);
-    }
+    std::uint8_t argument;
+    std::uint8_t multiple;
+    double amplitude;
 };
 
-
-class IAUTelestoRotationModel : public IAURotationModel
+/*! Rotation elements of a body in the form used by the WGCCRE reports. Pole
+ *  rates are in degrees per Julian century, the rotation rate in degrees per
+ *  day and the quadratic meridian term in degrees per century squared. The
+ *  secular pole terms are clamped to IAU_SECULAR_TERM_VALID_CENTURIES; the
+ *  arguments of the periodic terms and the meridian are not.
+ */
+struct IAURotationElements
 {
-public:
-    IAUTelestoRotationModel() : IAURotationModel(360.0 / 190.6979330) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        clamp_centuries(T);
-        ra = 50.50 - 0.036 * T;
-        dec = 84.06 - 0.004 * T;
-    }
-
-    double meridian(double t) const override
-    {
-        return 56.88 + 190.6979330 * t;
-    }
+    std::string_view name;
+    IAUSystem system;
+    double poleRA;
+    double poleRARate;
+    double poleDec;
+    double poleDecRate;
+    double meridianAtEpoch;
+    double rotationRate;
+    double meridianQuadratic{ 0.0 };
+    std::vector<IAUPeriodicTerm> raTerms{};
+    std::vector<IAUPeriodicTerm> decTerms{};
+    std::vector<IAUPeriodicTerm> meridianTerms{};
+    // Cosine terms of the meridian; only Deimos has one
+    std::vector<IAUPeriodicTerm> meridianCosineTerms{};
 };
 
-
-class IAUCalypsoRotationModel : public IAURotationModel
+const std::vector<IAURotationElements>&
+iauRotationElements()
 {
-public:
-    IAUCalypsoRotationModel() : IAURotationModel(360.0 / 190.6742373) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double S5 = celmath::degToRad(53.59 - 8968.6 * T);
-        clamp_centuries(T);
-        ra = 40.58 - 0.036 * T - 13.943 * std::sin(S5) - 1.686 * std::sin(2.0 * S5);
-        dec = 83.43 - 0.004 * T - 1.572 * std::cos(S5) + 0.095 * std::cos(2.0 * S5);
-    }
+    static const auto* elements = std::make_unique<std::vector<IAURotationElements>>(
+        std::initializer_list<IAURotationElements>
+        {
+            // Planets
+            { "iau-mercury"sv, IAUSystem::Mercury, 281.01, -0.033, 61.45, -0.005, 329.548, 6.1385025 },
+            { "iau-venus"sv, IAUSystem::Venus, 272.76, 0.0, 67.16, 0.0, 160.20, -1.4813688 },
+            { "iau-earth"sv, IAUSystem::Earth, 0.0, -0.641, 90.0, -0.557, 190.147, 360.9856235 },
+            { "iau-mars"sv, IAUSystem::Mars, 317.68143, -0.1061, 52.88650, -0.0609, 176.630, 350.89198226 },
+            { "iau-jupiter"sv, IAUSystem::Jupiter, 268.05, -0.009, 64.49, -0.003, 284.95, 870.5366420 },
+            { "iau-saturn"sv, IAUSystem::Saturn, 40.589, -0.036, 83.537, -0.004, 38.90, 810.7939024 },
+            { "iau-uranus"sv, IAUSystem::Uranus, 257.311, 0.0, -15.175, 0.0, 203.81, -501.1600928 },
+            {
+                "iau-neptune"sv, IAUSystem::Neptune, 299.36, 0.0, 43.46, 0.0, 253.18, 536.3128492, 0.0,
+                { { N, 1, 0.70 } },
+                { { N, 1, -0.51 } },
+                { { N, 1, -0.48 } },
+            },
+            { "iau-pluto"sv, IAUSystem::Pluto, 313.02, 0.0, 9.09, 0.0, 236.77, -56.3623195 },
+
+            // The Moon. The quadratic meridian term (-1.4e-12 d^2) represents
+            // the slowing of lunar rotation as the Moon recedes from the Earth.
+            // This may need to be clamped at some very large time range (1 Gy?)
+            {
+                "iau-moon"sv, IAUSystem::Earth, 269.9949, 0.0013, 66.5392, 0.0130, 38.3213, 13.17635815,
+                -1.4e-12 * 36525.0 * 36525.0,
+                {
+                    { E1, 1, -3.8787 }, { E2, 1, -0.1204 }, { E3, 1, 0.0700 }, { E4, 1, -0.0172 },
+                    { E6, 1, 0.0072 }, { E10, 1, -0.0052 }, { E13, 1, 0.0043 },
+                },
+                {
+                    { E1, 1, 1.5419 }, { E2, 1, 0.0239 }, { E3, 1, -0.0278 }, { E4, 1, 0.0068 },
+                    { E6, 1, -0.0029 }, { E7, 1, 0.0009 }, { E10, 1, 0.0008 }, { E13, 1, -0.0009 },
+                },
+                {
+                    { E1, 1, 3.5610 }, { E2, 1, 0.1208 }, { E3, 1, -0.0642 }, { E4, 1, 0.0158 },
+                    { E5, 1, 0.0252 }, { E6, 1, -0.0066 }, { E7, 1, -0.0047 }, { E8, 1, -0.0046 },
+                    { E9, 1, 0.0028 }, { E10, 1, 0.0052 }, { E11, 1, 0.0040 }, { E12, 1, 0.0019 },
+                    { E13, 1, -0.0044 },
+                },
+            },
+
+            // Satellites of Mars. The T^2 meridian terms reflect the orbit of
+            // Phobos evolving inward toward Mars (faster rotation) and that of
+            // Deimos evolving outward (slower rotation).
+            {
+                "iau-phobos"sv, IAUSystem::Mars, 317.68, -0.108, 52.90, -0.061, 35.06, 1128.8445850, 8.864,
+                { { M1, 1, 1.79 } },
+                { { M1, 1, -1.08 } },
+                { { M1, 1, -1.42 }, { M2, 1, -0.78 } },
+            },
+            {
+                "iau-deimos"sv, IAUSystem::Mars, 316.65, -0.108, 53.52, -0.061, 79.41, 285.1618970, 0.520,
+                { { M3, 1, 2.98 } },
+                { { M3, 1, -1.78 } },
+                { { M3, 1, -2.58 } },
+                { { M3, 1, 0.19 } },
+            },
+
+            // Satellites of Jupiter
+            { "iau-metis"sv, IAUSystem::Jupiter, 268.05, -0.009, 64.49, 0.003, 346.09, 1221.2547301 },
+            { "iau-adrastea"sv, IAUSystem::Jupiter, 268.05, -0.009, 64.49, 0.003, 33.29, 1206.9986602 },
+            {
+                "iau-amalthea"sv, IAUSystem::Jupiter, 268.05, -0.009, 64.49, 0.003, 231.67, 722.6314560, 0.0,
+                { { J1, 1, -0.84 }, { J1, 2, 0.01 } },
+                { { J1, 1, -0.36 } },
+                { { J1, 1, 0.76 }, { J1, 2, -0.01 } },
+            },
+            {
+                "iau-thebe"sv, IAUSystem::Jupiter, 268.05, -0.009, 64.49, 0.003, 8.56, 533.7004100, 0.0,
+                { { J2, 1, -2.11 }, { J2, 2, 0.04 } },
+                { { J2, 1, -0.91 }, { J2, 2, 0.01 } },
+                { { J2, 1, 1.91 }, { J2, 2, -0.04 } },
+            },
+            {
+                "iau-io"sv, IAUSystem::Jupiter, 268.05, -0.009, 64.49, 0.003, 200.39, 203.4889538, 0.0,
+                { { J3, 1, 0.094 }, { J4, 1, 0.024 } },
+                { { J3, 1, 0.040 }, { J4, 1, 0.011 } },
+                { { J3, 1, -0.085 }, { J4, 1, -0.022 } },
+            },
+            {
+                "iau-europa"sv, IAUSystem::Jupiter, 268.05, -0.009, 64.49, 0.003, 36.022, 101.3747235, 0.0,
+                { { J4, 1, 1.086 }, { J5, 1, 0.060 }, { J6, 1, 0.015 }, { J7, 1, 0.009 } },
+                { { J4, 1, 0.486 }, { J5, 1, 0.026 }, { J6, 1, 0.007 }, { J7, 1, 0.002 } },
+                { { J4, 1, -0.980 }, { J5, 1, -0.054 }, { J6, 1, -0.014 }, { J7, 1, -0.008 } },
+            },
+            {
+                "iau-ganymede"sv, IAUSystem::Jupiter, 268.05, -0.009, 64.49, 0.003, 44.064, 50.3176081, 0.0,
+                { { J4, 1, -0.037 }, { J5, 1, 0.431 }, { J6, 1, 0.091 } },
+                { { J4, 1, -0.016 }, { J5, 1, 0.186 }, { J6, 1, 0.039 } },
+                { { J4, 1, 0.033 }, { J5, 1, -0.389 }, { J6, 1, -0.082 } },
+            },
+            {
+                "iau-callisto"sv, IAUSystem::Jupiter, 268.05, -0.009, 64.49, 0.003, 259.51, 21.5710715, 0.0,
+                { { J5, 1, -0.068 }, { J6, 1, 0.590 }, { J8, 1, 0.010 } },
+                { { J5, 1, -0.029 }, { J6, 1, 0.254 }, { J8, 1, -0.004 } },
+                { { J5, 1, 0.061 }, { J6, 1, -0.533 }, { J8, 1, -0.009 } },
+            },
+
+            // Satellites of Saturn, from Seidelmann, _Explanatory Supplement
+            // to the Astronomical Almanac_ (1992).
+            { "iau-pan"sv, IAUSystem::Saturn, 40.6, -0.036, 83.5, -0.004, 48.8, 626.0440000 },
+            { "iau-atlas"sv, IAUSystem::Saturn, 40.6, -0.036, 83.5, -0.004, 137.88, 598.3060000 },
+            { "iau-prometheus"sv, IAUSystem::Saturn, 40.6, -0.036, 83.5, -0.004, 296.14, 587.289000 },
+            { "iau-pandora"sv, IAUSystem::Saturn, 40.6, -0.036, 83.5, -0.004, 162.92, 572.7891000 },
+            {
+                "iau-mimas"sv, IAUSystem::Saturn, 40.66, -0.036, 83.52, -0.004, 337.46, 381.9945550, 0.0,
+                { { S3, 1, 13.56 } },
+                { { S3, 1, -1.53 } },
+                { { S3, 1, -13.48 }, { S9, 1, -44.85 } },
+            },
+            { "iau-enceladus"sv, IAUSystem::Saturn, 40.66, -0.036, 83.52, -0.004, 2.82, 262.7318996 },
+            {
+                "iau-tethys"sv, IAUSystem::Saturn, 40.66, -0.036, 83.52, -0.004, 10.45, 190.6979085, 0.0,
+                { { S4, 1, -9.66 } },
+                { { S4, 1, -1.09 } },
+                { { S4, 1, -9.60 }, { S9, 1, 2.23 } },
+            },
+            { "iau-telesto"sv, IAUSystem::Saturn, 50.50, -0.036, 84.06, -0.004, 56.88, 190.6979330 },
+            {
+                "iau-calypso"sv, IAUSystem::Saturn, 40.58, -0.036, 83.43, -0.004, 149.36, 190.6742373, 0.0,
+                { { S5, 1, -13.943 }, { S5, 2, -1.686 } },
+                { { S5, 1, -1.572 }, { S5, 2, 0.095 } },
+                { { S5, 1, -13.849 }, { S5, 2, 1.685 } },
+            },
+            { "iau-dione"sv, IAUSystem::Saturn, 40.66, -0.036, 83.52, -0.004, 357.00, 131.5349316 },
+            {
+                "iau-helene"sv, IAUSystem::Saturn, 40.58, -0.036, 83.52, -0.004, 245.39, 131.6174056, 0.0,
+                { { S6, 1, 1.662 }, { S6, 2, 0.024 } },
+                { { S6, 1, -0.187 }, { S6, 2, 0.095 } },
+                { { S6, 1, -1.651 }, { S6, 2, 0.024 } },
+            },
+            {
+                // The -1.651 in the meridian constant is not in the WGCCRE
+                // elements; it is kept for compatibility.
+                "iau-rhea"sv, IAUSystem::Saturn, 40.38, -0.036, 83.55, -0.004, 235.16 - 1.651, 79.6900478, 0.0,
+                { { S7, 1, 3.10 } },
+                { { S7, 1, -0.35 } },
+                { { S7, 1, -3.08 } },
+            },
+            {
+                "iau-titan"sv, IAUSystem::Saturn, 36.41, -0.036, 83.94, -0.004, 189.64, 22.5769768, 0.0,
+                { { S8, 1, 2.66 } },
+                { { S8, 1, -0.30 } },
+                { { S8, 1, -2.64 } },
+            },
+            { "iau-iapetus"sv, IAUSystem::Saturn, 318.16, -3.949, 75.03, -1.142, 350.20, 4.5379572 },
+            { "iau-phoebe"sv, IAUSystem::Saturn, 355.16, 0.0, 68.70, -1.143, 304.70, 930.8338720 },
+
+            // Satellites of Uranus
+            {
+                "iau-miranda"sv, IAUSystem::Uranus, 257.43, 0.0, -15.08, 0.0, 30.70, -254.6906892, 0.0,
+                { { U11, 1, 4.41 }, { U11, 2, -0.04 } },
+                { { U11, 1, 4.25 }, { U11, 2, -0.02 } },
+                { { U12, 1, -1.27 }, { U12, 2, 0.15 }, { U11, 1, 1.15 }, { U11, 2, -0.09 } },
+            },
+            {
+                "iau-ariel"sv, IAUSystem::Uranus, 257.43, 0.0, -15.10, 0.0, 156.22, -142.8356681, 0.0,
+                { { U13, 1, 0.29 } },
+                { { U13, 1, 0.28 } },
+                { { U12, 1, 0.05 }, { U13, 1, 0.08 } },
+            },
+            {
+                "iau-umbriel"sv, IAUSystem::Uranus, 257.43, 0.0, -15.10, 0.0, 108.05, -86.8688923, 0.0,
+                { { U14, 1, 0.21 } },
+                { { U14, 1, 0.20 } },
+                { { U12, 1, -0.09 }, { U14, 1, 0.06 } },
+            },
+            {
+                "iau-titania"sv, IAUSystem::Uranus, 257.43, 0.0, -15.10, 0.0, 77.74, -41.351431, 0.0,
+                { { U15, 1, 0.29 } },
+                { { U15, 1, 0.28 } },
+                { { U15, 1, 0.08 } },
+            },
+            {
+                "iau-oberon"sv, IAUSystem::Uranus, 257.43, 0.0, -15.10, 0.0, 6.77, -26.7394932, 0.0,
+                { { U16, 1, 0.16 } },
+                { { U16, 1, 0.16 } },
+                { { U16, 1, 0.04 } },
+            },
+        }).release();
 
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double S5 = celmath::degToRad(53.59 - 8968.6 * T);
-        return 149.36 + 190.6742373 * t - 13.849 * std::sin(S5) + 1.685 * std::sin(2.0 * S5);
-    }
-};
+    return *elements;
+}
 
 
-class IAUDioneRotationModel : public IAURotationModel
+/*! Sines and cosines of the fundamental arguments of a system (and of twice
+ *  the arguments) at one instant. Each thread keeps the values for the last
+ *  time at which each system was evaluated, so all the bodies of a system
+ *  evaluated at the same time share one computation.
+ */
+class IAUArgumentValues
 {
 public:
-    IAUDioneRotationModel() : IAURotationModel(360.0 / 131.5349316) {}
-
-    void pole(double t, double& ra, double& dec) const override
+    static const IAUArgumentValues& get(IAUSystem system, double d)
     {
-        double T = t / 36525.0;
-        clamp_centuries(T);
-        ra = 40.66 - 0.036 * T;
-        dec = 83.52 - 0.004 * T;
-    }
+        thread_local std::array<IAUArgumentValues, static_cast<std::size_t>(IAUSystem::SystemsCount)> cache;
 
-    double meridian(double t) const override
-    {
-        return 357.00 + 131.5349316 * t;
+        IAUArgumentValues& values = cache[static_cast<std::size_t>(system)];
+        if (values.time != d)
+            values.compute(systemArguments(system), d);
+        return values;
     }
-};
-
-
-class IAUHeleneRotationModel : public IAURotationModel
-{
-public:
-    IAUHeleneRotationModel() : IAURotationModel(360.0 / 131.6174056) {}
 
-    void pole(double t, double& ra, double& dec) const override
+    double sine(const IAUPeriodicTerm& term) const
     {
-        double T = t / 36525.0;
-        double S6 = celmath::degToRad(143.38 - 10553.5 * T);
-        clamp_centuries(T);
-        ra = 40.58 - 0.036 * T + 1.662 * std::sin(S6) + 0.024 * std::sin(2.0 * S6);
-        dec = 83.52 - 0.004 * T - 0.187 * std::cos(S6) + 0.095 * std::cos(2.0 * S6);
+        return term.multiple == 1 ? sin1[term.argument] : sin2[term.argument];
     }
 
-    double meridian(double t) const override
+    double cosine(const IAUPeriodicTerm& term) const
     {
-        double T = t / 36525.0;
-        double S6 = celmath::degToRad(143.38 - 10553.5 * T);
-        return 245.39 + 131.6174056 * t - 1.651 * sin(S6) + 0.024 * sin(2.0 * S6);
+        return term.multiple == 1 ? cos1[term.argument] : cos2[term.argument];
     }
-};
-
 
-class IAURheaRotationModel : public IAURotationModel
-{
-public:
-    IAURheaRotationModel() : IAURotationModel(360.0 / 79.6900478) {}
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double S7 = celmath::degToRad(345.20 - 1016.3 * T);
-        clamp_centuries(T);
-        ra = 40.38 - 0.036 * T + 3.10 * sin(S7);
-        dec = 83.55 - 0.004 * T - 0.35 * cos(S7);
-    }
-
-    double meridian(double t) const override
+private:
+    void compute(const std::vector<IAUArgument>& arguments, double d)
     {
-        double T = t / 36525.0;
-        double S7 = celmath::degToRad(345.20 - 1016.3 * T);
-        return 235.16 + 79.6900478 * t - 1.651 - 3.08 * sin(S7);
-    }
+        double T = d / 36525.0;
+        for (std::size_t i = 0; i < arguments.size(); ++i)
+        {
+            const IAUArgument& arg = arguments[i];
+            double angle = celmath::degToRad(arg.constant + arg.rate * T + arg.quadratic * T * T);
+            celmath::sincos(angle, sin1[i], cos1[i]);
+            sin2[i] = 2.0 * sin1[i] * cos1[i];
+            cos2[i] = (cos1[i] - sin1[i]) * (cos1[i] + sin1[i]);
+        }
+        time = d;
+    }
+
+    double time{ std::numeric_limits<double>::quiet_NaN() };
+    std::array<double, MaxIAUArguments> sin1;
+    std::array<double, MaxIAUArguments> cos1;
+    std::array<double, MaxIAUArguments> sin2;
+    std::array<double, MaxIAUArguments> cos2;
 };
 
 
-class IAUTitanRotationModel : public IAURotationModel
+/*! Rotation model evaluated from a table of IAU rotation elements. A
+ *  negative rotation rate indicates retrograde rotation.
+ */
+class IAUTableRotationModel : public IAURotationModel
 {
 public:
-    IAUTitanRotationModel() : IAURotationModel(360.0 / 22.5769768) {}
-
-    void pole(double t, double& ra, double& dec) const override
+    explicit IAUTableRotationModel(const IAURotationElements& _elements) :
+        IAURotationModel(std::abs(360.0 / _elements.rotationRate)),
+        elements(_elements)
     {
-        double T = t / 36525.0;
-        double S8 = celmath::degToRad(29.80 - 52.1 * T);
-        clamp_centuries(T);
-        ra = 36.41 - 0.036 * T + 2.66 * sin(S8);
-        dec = 83.94 - 0.004 * T - 0.30 * cos(S8);
+        if (elements.rotationRate < 0.0)
+            setFlipped(true);
     }
 
-    double meridian(double t) const override
+    void pole(double d, double& ra, double& dec) const override
     {
-        double T = t / 36525.0;
-        double S8 = celmath::degToRad(29.80 - 52.1 * T);
-        return 189.64 + 22.5769768 * t - 2.64 * sin(S8);
-    }
-};
-
-
-class IAUIapetusRotationModel : public IAURotationModel
-{
-public:
-    IAUIapetusRotationModel() : IAURotationModel(360.0 / 4.5379572) {}
+        const IAUArgumentValues& args = IAUArgumentValues::get(elements.system, d);
 
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
+        double T = d / 36525.0;
         clamp_centuries(T);
-        ra = 318.16 - 3.949 * T;
-        dec = 75.03 - 1.142 * T;
-    }
+        ra = elements.poleRA + elements.poleRARate * T;
+        dec = elements.poleDec + elements.poleDecRate * T;
 
-    double meridian(double t) const override
-    {
-        return 350.20 + 4.5379572 * t;
+        for (const auto& term : elements.raTerms)
+            ra += term.amplitude * args.sine(term);
+        for (const auto& term : elements.decTerms)
+            dec += term.amplitude * args.cosine(term);
     }
-};
-
-
-class IAUPhoebeRotationModel : public IAURotationModel
-{
-public:
-    IAUPhoebeRotationModel() : IAURotationModel(360.0 / 22.5769768) {}
 
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        clamp_centuries(T);
-        ra = 355.16;
-        dec = 68.70 - 1.143 * T;
-    }
-
-    double meridian(double t) const override
+    double meridian(double d) const override
     {
-        return 304.70 + 930.8338720 * t;
-    }
-};
+        const IAUArgumentValues& args = IAUArgumentValues::get(elements.system, d);
 
+        double T = d / 36525.0;
+        double w = elements.meridianAtEpoch + elements.rotationRate * d + elements.meridianQuadratic * T * T;
 
-class IAUMirandaRotationModel : public IAURotationModel
-{
-public:
-    IAUMirandaRotationModel() : IAURotationModel(360.0 / 254.6906892) { setFlipped(true); }
+        for (const auto& term : elements.meridianTerms)
+            w += term.amplitude * args.sine(term);
+        for (const auto& term : elements.meridianCosineTerms)
+            w += term.amplitude * args.cosine(term);
 
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double U11 = celmath::degToRad(102.23 - 2024.22 * T);
-        ra =  257.43 + 4.41 * std::sin(U11) - 0.04 * std::sin(2.0 * U11);
-        dec = -15.08 + 4.25 * std::cos(U11) - 0.02 * std::cos(2.0 * U11);
+        return w;
     }
 
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double U11 = celmath::degToRad(102.23 - 2024.22 * T);
-        double U12 = celmath::degToRad(316.41 + 2863.96 * T);
-        return 30.70 - 254.6906892 * t
-               - 1.27 * std::sin(U12) + 0.15 * std::sin(2.0 * U12)
-               + 1.15 * std::sin(U11) - 0.09 * std::sin(2.0 * U11);
-    }
+private:
+    const IAURotationElements& elements;
 };
 
 
-class IAUArielRotationModel : public IAURotationModel
+class CustomRotationsManager
 {
 public:
-    IAUArielRotationModel() : IAURotationModel(360.0 / 142.8356681) { setFlipped(true); }
-
-    void pole(double t, double& ra, double& dec) const override
+    CustomRotationsManager() :
+        iauModels(iauRotationElements().size())
     {
-        double T = t / 36525.0;
-        double U13 = celmath::degToRad(304.01 - 51.94 * T);
-        ra =  257.43 + 0.29 * std::sin(U13);
-        dec = -15.10 + 0.28 * std::cos(U13);
     }
 
-    double meridian(double t) const override
+    RotationModel* getEarthP03lp()
     {
-        double T = t / 36525.0;
-        double U12 = celmath::degToRad(316.41 + 2863.96 * T);
-        double U13 = celmath::degToRad(304.01 - 51.94 * T);
-        return 156.22 - 142.8356681 * t + 0.05 * std::sin(U12) + 0.08 * std::sin(U13);
+        if (earthP03lp == nullptr)
+            earthP03lp = std::make_unique<EarthRotationModel>();
+        return earthP03lp.get();
     }
-};
-
-
-class IAUUmbrielRotationModel : public IAURotationModel
-{
-public:
-    IAUUmbrielRotationModel() : IAURotationModel(360.0 / 86.8688923) { setFlipped(true); }
 
-    void pole(double t, double& ra, double& dec) const override
+    RotationModel* getIAUModel(std::size_t index)
     {
-        double T = t / 36525.0;
-        double U14 = celmath::degToRad(308.71 - 93.17 * T);
-        ra =  257.43 + 0.21 * std::sin(U14);
-        dec = -15.10 + 0.20 * std::cos(U14);
+        auto& model = iauModels[index];
+        if (model == nullptr)
+            model = std::make_unique<IAUTableRotationModel>(iauRotationElements()[index]);
+        return model.get();
     }
 
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double U12 = celmath::degToRad(316.41 + 2863.96 * T);
-        double U14 = celmath::degToRad(308.71 - 93.17 * T);
-        return 108.05 - 86.8688923 * t - 0.09 * std::sin(U12) + 0.06 * std::sin(U14);
-    }
+private:
+    std::unique_ptr<RotationModel> earthP03lp;
+    std::vector<std::unique_ptr<IAUTableRotationModel>> iauModels;
 };
 
 
-class IAUTitaniaRotationModel : public IAURotationModel
+CustomRotationsManager*
+getManager()
 {
-public:
-    IAUTitaniaRotationModel() : IAURotationModel(360.0 / 41.351431) { setFlipped(true); }
-
-    void pole(double t, double& ra, double& dec) const override
-    {
-        double T = t / 36525.0;
-        double U15 = celmath::degToRad(340.82 - 75.32 * T);
-        ra =  257.43 + 0.29 * std::sin(U15);
-        dec = -15.10 + 0.28 * std::cos(U15);
-    }
+    static CustomRotationsManager* manager = std::make_unique<CustomRotationsManager>().release();
+    return manager;
+}
 
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double U15 = celmath::degToRad(340.82 - 75.32 * T);
-        return 77.74 - 41.351431 * t + 0.08 * std::sin(U15);
-    }
-};
+} // end unnamed namespace
 
 
-class IAUOberonRotationModel : public IAURotationModel
+RotationModel*
+GetCustomRotationModel(std::string_view name)
 {
-public:
-    IAUOberonRotationModel() : IAURotationModel(360.0 / 26.7394932) { setFlipped(true); }
+    if (name == "earth-p03lp"sv)
+        return getManager()->getEarthP03lp();
 
-    void pole(double t, double& ra, double& dec) const override
+    using IAUModelIndexMap = std::map<std::string_view, std::size_t>;
+    static const IAUModelIndexMap* indexMap = []
     {
-        double T = t / 36525.0;
-        double U16 = celmath::degToRad(259.14 - 504.81 * T);
-        ra =  257.43 + 0.16 * std::sin(U16);
-        dec = -15.10 + 0.16 * std::cos(U16);
-    }
+        auto map = std::make_unique<IAUModelIndexMap>();
+        const auto& elements = iauRotationElements();
+        for (std::size_t i = 0; i < elements.size(); ++i)
+            map->try_emplace(elements[i].name, i);
+        return map.release();
+    }();
 
-    double meridian(double t) const override
-    {
-        double T = t / 36525.0;
-        double U16 = celmath::degToRad(259.14 - 504.81 * T);
-        return 6.77 - 26.7394932 * t + 0.04 * std::sin(U16);
-    }
-};
+    auto it = indexMap->find(name);
+    if (it == indexMap->end())
+        return nullptr;
 
+    return getManager()->getIAUModel(it->second);
+}
 
 
-enum class CustomRotationModelType
+bool
+ComputeIAUSystemRotations(std::string_view planet,
+                          double tjd,
+                          std::vector<CustomRotationState>& states)
 {
-    EarthP03lp = 0,
-    IAUMercury,
-    IAUVenus,
-    IAUEarth,
-    IAUMars,
-    IAUJupiter,
-    IAUSaturn,
-    IAUUranus,
-    IAUNeptune,
-    IAUPluto,
-    IAUMoon,
-    IAUPhobos,
-    IAUDeimos,
-    IAUMetis,
-    IAUAdrastea,
-    IAUAmalthea,
-    IAUThebe,
-    IAUIo,
-    IAUEuropa,
-    IAUGanymede,
-    IAUCallisto,
-    IAUPan,
-    IAUAtlas,
-    IAUPrometheus,
-    IAUPandora,
-    IAUMimas,
-    IAUEnceladus,
-    IAUTethys,
-    IAUTelesto,
-    IAUCalypso,
-    IAUDione,
-    IAUHelene,
-    IAURhea,
-    IAUTitan,
-    IAUIapetus,
-    IAUPhoebe,
-    IAUMiranda,
-    IAUAriel,
-    IAUUmbriel,
-    IAUTitania,
-    IAUOberon,
-    RotationModelsCount,
-};
+    using IAUSystemMap = std::map<std::string_view, IAUSystem>;
+    static const IAUSystemMap* systemMap = std::make_unique<IAUSystemMap>(
+        std::initializer_list<IAUSystemMap::value_type>
+        {
+            { "mercury"sv, IAUSystem::Mercury },
+            { "venus"sv,   IAUSystem::Venus   },
+            { "earth"sv,   IAUSystem::Earth   },
+            { "mars"sv,    IAUSystem::Mars    },
+            { "jupiter"sv, IAUSystem::Jupiter },
+            { "saturn"sv,  IAUSystem::Saturn  },
+            { "uranus"sv,  IAUSystem::Uranus  },
+            { "neptune"sv, IAUSystem::Neptune },
+            { "pluto"sv,   IAUSystem::Pluto   },
+        }).release();
 
-class CustomRotationsManager
-{
-private:
-    static constexpr auto ArraySize = static_cast<std::size_t>(CustomRotationModelType::RotationModelsCount);
-    static std::unique_ptr<RotationModel> createModel(CustomRotationModelType);
-    std::array<std::unique_ptr<RotationModel>, ArraySize> models{ nullptr };
+    auto it = systemMap->find(planet);
+    if (it == systemMap->end())
+        return false;
 
-public:
-    RotationModel* getModel(CustomRotationModelType type)
+    // Use temporary models rather than the shared ones so that nothing but
+    // the thread's own argument cache is touched; the arguments are computed
+    // by the first body of the system and reused by the rest.
+    for (const IAURotationElements& elements : iauRotationElements())
     {
-        auto index = static_cast<std::size_t>(type);
-        auto& model = models[index];
-        if (model == nullptr)
-            model = createModel(type);
-        return model.get();
-    }
-};
+        if (elements.system != it->second)
+            continue;
 
-std::unique_ptr<RotationModel>
-CustomRotationsManager::createModel(CustomRotationModelType type)
-{
-    switch (type)
-    {
-    case CustomRotationModelType::EarthP03lp:
-        return std::make_unique<EarthRotationModel>();
-
-    // IAU rotation elements for the planets
-    case CustomRotationModelType::IAUMercury:
-        return std::make_unique<IAUPrecessingRotationModel>(281.01, -0.033,
-                                                            61.45, -0.005,
-                                                            329.548, 6.1385025);
-    case CustomRotationModelType::IAUVenus:
-        return std::make_unique<IAUPrecessingRotationModel>(272.76, 0.0,
-                                                            67.16, 0.0,
-                                                            160.20, -1.4813688);
-    case CustomRotationModelType::IAUEarth:
-        return std::make_unique<IAUPrecessingRotationModel>(0.0, -0.641,
-                                                            90.0, -0.557,
-                                                            190.147, 360.9856235);
-    case CustomRotationModelType::IAUMars:
-        return std::make_unique<IAUPrecessingRotationModel>(317.68143, -0.1061,
-                                                            52.88650, -0.0609,
-                                                            176.630, 350.89198226);
-    case CustomRotationModelType::IAUJupiter:
-        return std::make_unique<IAUPrecessingRotationModel>(268.05, -0.009,
-                                                            64.49, -0.003,
-                                                            284.95, 870.5366420);
-    case CustomRotationModelType::IAUSaturn:
-        return std::make_unique<IAUPrecessingRotationModel>(40.589, -0.036,
-                                                            83.537, -0.004,
-                                                            38.90, 810.7939024);
-    case CustomRotationModelType::IAUUranus:
-        return std::make_unique<IAUPrecessingRotationModel>(257.311, 0.0,
-                                                            -15.175, 0.0,
-                                                            203.81, -501.1600928);
-    case CustomRotationModelType::IAUNeptune:
-        return std::make_unique<IAUNeptuneRotationModel>();
-    case CustomRotationModelType::IAUPluto:
-        return std::make_unique<IAUPrecessingRotationModel>(313.02, 0.0,
-                                                            9.09, 0.0,
-                                                            236.77, -56.3623195);
-
-    // IAU rotation elements for the Moon
-    case CustomRotationModelType::IAUMoon:
-        return std::make_unique<IAULunarRotationModel>();
-
-    // IAU rotation elements for satellites of Mars
-    case CustomRotationModelType::IAUPhobos:
-        return std::make_unique<IAUPhobosRotationModel>();
-    case CustomRotationModelType::IAUDeimos:
-        return std::make_unique<IAUDeimosRotationModel>();
-
-    // IAU rotation elements for satellites of Jupiter
-    case CustomRotationModelType::IAUMetis:
-        return std::make_unique<IAUPrecessingRotationModel>(268.05, -0.009,
-                                                            64.49, 0.003,
-                                                            346.09, 1221.2547301);
-    case CustomRotationModelType::IAUAdrastea:
-        return std::make_unique<IAUPrecessingRotationModel>(268.05, -0.009,
-                                                            64.49, 0.003,
-                                                            33.29, 1206.9986602);
-    case CustomRotationModelType::IAUAmalthea:
-        return std::make_unique<IAUAmaltheaRotationModel>();
-    case CustomRotationModelType::IAUThebe:
-        return std::make_unique<IAUThebeRotationModel>();
-    case CustomRotationModelType::IAUIo:
-        return std::make_unique<IAUIoRotationModel>();
-    case CustomRotationModelType::IAUEuropa:
-        return std::make_unique<IAUEuropaRotationModel>();
-    case CustomRotationModelType::IAUGanymede:
-        return std::make_unique<IAUGanymedeRotationModel>();
-    case CustomRotationModelType::IAUCallisto:
-        return std::make_unique<IAUCallistoRotationModel>();
-
-    // IAU rotation elements for satellites of Saturn
-    case CustomRotationModelType::IAUPan:
-        return std::make_unique<IAUPrecessingRotationModel>(40.6, -0.036,
-                                                            83.5, -0.004,
-                                                            48.8, 626.0440000);
-    case CustomRotationModelType::IAUAtlas:
-        return std::make_unique<IAUPrecessingRotationModel>(40.6, -0.036,
-                                                            83.5, -0.004,
-                                                            137.88, 598.3060000);
-    case CustomRotationModelType::IAUPrometheus:
-        return std::make_unique<IAUPrecessingRotationModel>(40.6, -0.036,
-                                                            83.5, -0.004,
-                                                            296.14, 587.289000);
-    case CustomRotationModelType::IAUPandora:
-        return std::make_unique<IAUPrecessingRotationModel>(40.6, -0.036,
-                                                            83.5, -0.004,
-                                                            162.92, 572.7891000);
-    case CustomRotationModelType::IAUMimas:
-        return std::make_unique<IAUMimasRotationModel>();
-    case CustomRotationModelType::IAUEnceladus:
-        return std::make_unique<IAUEnceladusRotationModel>();
-    case CustomRotationModelType::IAUTethys:
-        return std::make_unique<IAUTethysRotationModel>();
-    case CustomRotationModelType::IAUTelesto:
-        return std::make_unique<IAUTelestoRotationModel>();
-    case CustomRotationModelType::IAUCalypso:
-        return std::make_unique<IAUCalypsoRotationModel>();
-    case CustomRotationModelType::IAUDione:
-        return std::make_unique<IAUDioneRotationModel>();
-    case CustomRotationModelType::IAUHelene:
-        return std::make_unique<IAUHeleneRotationModel>();
-    case CustomRotationModelType::IAURhea:
-        return std::make_unique<IAURheaRotationModel>();
-    case CustomRotationModelType::IAUTitan:
-        return std::make_unique<IAUTitanRotationModel>();
-    case CustomRotationModelType::IAUIapetus:
-        return std::make_unique<IAUIapetusRotationModel>();
-    case CustomRotationModelType::IAUPhoebe:
-        return std::make_unique<IAUPhoebeRotationModel>();
-
-    // IAU rotation elements for satellites of Uranus
-    case CustomRotationModelType::IAUMiranda:
-        return std::make_unique<IAUMirandaRotationModel>();
-    case CustomRotationModelType::IAUAriel:
-        return std::make_unique<IAUArielRotationModel>();
-    case CustomRotationModelType::IAUUmbriel:
-        return std::make_unique<IAUUmbrielRotationModel>();
-    case CustomRotationModelType::IAUTitania:
-        return std::make_unique<IAUTitaniaRotationModel>();
-    case CustomRotationModelType::IAUOberon:
-        return std::make_unique<IAUOberonRotationModel>();
-    default:
-        return nullptr;
+        IAUTableRotationModel model(elements);
+        states.push_back({ elements.name,
+                           model.computeEquatorOrientation(tjd),
+                           model.computeSpin(tjd) });
     }
-}
-
-} // end unnamed namespace
 
-
-RotationModel*
-GetCustomRotationModel(std::string_view name)
-{
-    using CustomRotationTypeMap = std::map<std::string_view, CustomRotationModelType>;
-    static auto typeMap = std::make_unique<CustomRotationTypeMap>(
-        std::initializer_list<CustomRotationTypeMap::value_type>
-        {
-            { "earth-p03lp"sv,    CustomRotationModelType::EarthP03lp    },
-            { "iau-mercury"sv,    CustomRotationModelType::IAUMercury    },
-            { "iau-venus"sv,      CustomRotationModelType::IAUVenus      },
-            { "iau-earth"sv,      CustomRotationModelType::IAUEarth      },
-            { "iau-mars"sv,       CustomRotationModelType::IAUMars       },
-            { "iau-jupiter"sv,    CustomRotationModelType::IAUJupiter    },
-            { "iau-saturn"sv,     CustomRotationModelType::IAUSaturn     },
-            { "iau-uranus"sv,     CustomRotationModelType::IAUUranus     },
-            { "iau-neptune"sv,    CustomRotationModelType::IAUNeptune    },
-            { "iau-pluto"sv,      CustomRotationModelType::IAUPluto      },
-            { "iau-moon"sv,       CustomRotationModelType::IAUMoon       },
-            { "iau-phobos"sv,     CustomRotationModelType::IAUPhobos     },
-            { "iau-deimos"sv,     CustomRotationModelType::IAUDeimos     },
-            { "iau-metis"sv,      CustomRotationModelType::IAUMetis      },
-            { "iau-adrastea"sv,   CustomRotationModelType::IAUAdrastea   },
-            { "iau-amalthea"sv,   CustomRotationModelType::IAUAmalthea   },
-            { "iau-thebe"sv,      CustomRotationModelType::IAUThebe      },
-            { "iau-io"sv,         CustomRotationModelType::IAUIo         },
-            { "iau-europa"sv,     CustomRotationModelType::IAUEuropa     },
-            { "iau-ganymede"sv,   CustomRotationModelType::IAUGanymede   },
-            { "iau-callisto"sv,   CustomRotationModelType::IAUCallisto   },
-            { "iau-pan"sv,        CustomRotationModelType::IAUPan        },
-            { "iau-atlas"sv,      CustomRotationModelType::IAUAtlas      },
-            { "iau-prometheus"sv, CustomRotationModelType::IAUPrometheus },
-            { "iau-pandora"sv,    CustomRotationModelType::IAUPandora    },
-            { "iau-mimas"sv,      CustomRotationModelType::IAUMimas      },
-            { "iau-enceladus"sv,  CustomRotationModelType::IAUEnceladus  },
-            { "iau-tethys"sv,     CustomRotationModelType::IAUTethys     },
-            { "iau-telesto"sv,    CustomRotationModelType::IAUTelesto    },
-            { "iau-calypso"sv,    CustomRotationModelType::IAUCalypso    },
-            { "iau-dione"sv,      CustomRotationModelType::IAUDione      },
-            { "iau-helene"sv,     CustomRotationModelType::IAUHelene     },
-            { "iau-rhea"sv,       CustomRotationModelType::IAURhea       },
-            { "iau-titan"sv,      CustomRotationModelType::IAUTitan      },
-            { "iau-iapetus"sv,    CustomRotationModelType::IAUIapetus    },
-            { "iau-phoebe"sv,     CustomRotationModelType::IAUPhoebe     },
-            { "iau-miranda"sv,    CustomRotationModelType::IAUMiranda    },
-            { "iau-ariel"sv,      CustomRotationModelType::IAUAriel      },
-            { "iau-umbriel"sv,    CustomRotationModelType::IAUUmbriel    },
-            { "iau-titania"sv,    CustomRotationModelType::IAUTitania    },
-            { "iau-oberon"sv,     CustomRotationModelType::IAUOberon     },
-        }).release();
-
-    auto it = typeMap->find(name);
-    if (it == typeMap->end())
-        return nullptr;
-
-    static CustomRotationsManager* manager = std::make_unique<CustomRotationsManager>().release();
-    return manager->getModel(it->second);
+    return true;
 }
 
 } // end namespace celestia::ephem
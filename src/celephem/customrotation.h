@@ -13,7 +13,9 @@
 #pragma once
 
 #include <string_view>
+#include <vector>
 
+#include <Eigen/Geometry>
 
 namespace celestia::ephem
 {
@@ -21,4 +23,22 @@ namespace celestia::ephem
 class RotationModel;
 RotationModel* GetCustomRotationModel(std::string_view name);
 
+// Orientation of a body given by one of the IAU custom rotation models
+struct CustomRotationState
+{
+    std::string_view name;
+    Eigen::Quaterniond equatorOrientation;
+    Eigen::Quaterniond spin;
+};
+
+/*! Evaluate at time tjd the IAU rotation models of a planet and all of its
+ *  satellites, e.g. iau-jupiter, iau-metis, ... iau-callisto for "jupiter".
+ *  The fundamental arguments of the satellites' periodic terms are computed
+ *  once for the whole system. The results are appended to states. Safe to
+ *  call from any thread. Returns false if the planet has no IAU models.
+ */
+bool ComputeIAUSystemRotations(std::string_view planet,
+                               double tjd,
+                               std::vector<CustomRotationState>& states);
+
 }
@@ -0,0 +1,45 @@
+// hermite.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Cubic Hermite interpolation of sampled trajectories.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <Eigen/Core>
+
+namespace celestia::ephem
+{
+
+/*! Interpolate between positions p0 and p1 with tangents v0 and v1, where t
+ *  goes from 0 to 1 over the span. Tangents are velocities multiplied by the
+ *  duration of the span.
+ */
+inline Eigen::Vector3d
+cubicInterpolate(const Eigen::Vector3d& p0, const Eigen::Vector3d& v0,
+                 const Eigen::Vector3d& p1, const Eigen::Vector3d& v1,
+                 double t)
+{
+    return p0 + (((2.0 * (p0 - p1) + v1 + v0) * (t * t * t)) +
+                 ((3.0 * (p1 - p0) - 2.0 * v0 - v1) * (t * t)) +
+                 (v0 * t));
+}
+
+
+//! Derivative of cubicInterpolate() with respect to t
+inline Eigen::Vector3d
+cubicInterpolateVelocity(const Eigen::Vector3d& p0, const Eigen::Vector3d& v0,
+                         const Eigen::Vector3d& p1, const Eigen::Vector3d& v1,
+                         double t)
+{
+    return ((2.0 * (p0 - p1) + v1 + v0) * (3.0 * t * t)) +
+           ((3.0 * (p1 - p0) - 2.0 * v0 - v1) * (2.0 * t)) +
+           v0;
+}
+
+}
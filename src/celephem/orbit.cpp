@@ -21,6 +21,7 @@
 #include <celmath/mathlib.h>
 #include <celmath/solve.h>
 #include <celmath/geomutil.h>
+#include "cachebypass.h"
 
 namespace celestia::ephem
 {
@@ -486,6 +487,9 @@ double EllipticalOrbit::getBoundingRadius() const
 
 Eigen::Vector3d CachingOrbit::positionAtTime(double jd) const
 {
+    if (CacheBypass::active())
+        return computePosition(jd);
+
     if (jd != lastTime)
     {
         lastTime = jd;
@@ -505,6 +509,9 @@ Eigen::Vector3d CachingOrbit::positionAtTime(double jd) const
 
 Eigen::Vector3d CachingOrbit::velocityAtTime(double jd) const
 {
+    if (CacheBypass::active())
+        return computeVelocity(jd);
+
     if (jd != lastTime)
     {
         lastVelocity = computeVelocity(jd);
@@ -602,6 +609,12 @@ double MixedOrbit::getBoundingRadius() const
 }
 
 
+bool MixedOrbit::isThreadSafe() const
+{
+    return primary->isThreadSafe();
+}
+
+
 void MixedOrbit::sample(double startTime, double endTime, OrbitSampleProc& proc) const
 {
     const Orbit* o;
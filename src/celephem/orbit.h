@@ -52,6 +52,10 @@ class Orbit
         end = 0.0;
     };
 
+    // Return true if the orbit may be evaluated concurrently from several
+    // threads, provided they hold a CacheBypass.
+    virtual bool isThreadSafe() const { return true; }
+
 protected:
     struct AdaptiveSamplingParameters
     {
@@ -148,6 +152,7 @@ class MixedOrbit : public Orbit
     double getPeriod() const override;
     double getBoundingRadius() const override;
     void sample(double startTime, double endTime, OrbitSampleProc& proc) const override;
+    bool isThreadSafe() const override;
 
  private:
     std::unique_ptr<Orbit> primary;
@@ -175,6 +180,8 @@ class SynchronousOrbit : public Orbit
     double getPeriod() const override;
     double getBoundingRadius() const override;
     void sample(double, double, OrbitSampleProc& proc) const override;
+    // Depends on the rotation model of another body
+    bool isThreadSafe() const override { return false; }
 
  private:
     const Body& body;
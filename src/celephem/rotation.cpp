@@ -17,6 +17,7 @@
 
 #include <celcompat/numbers.h>
 #include <celmath/geomutil.h>
+#include "cachebypass.h"
 
 namespace celestia::ephem
 {
@@ -72,6 +73,9 @@ CachingRotationModel::CachingRotationModel() :
 Eigen::Quaterniond
 CachingRotationModel::spin(double tjd) const
 {
+    if (CacheBypass::active())
+        return computeSpin(tjd);
+
     if (tjd != lastTime)
     {
         lastTime = tjd;
@@ -93,6 +97,9 @@ CachingRotationModel::spin(double tjd) const
 Eigen::Quaterniond
 CachingRotationModel::equatorOrientationAtTime(double tjd) const
 {
+    if (CacheBypass::active())
+        return computeEquatorOrientation(tjd);
+
     if (tjd != lastTime)
     {
         lastTime = tjd;
@@ -114,6 +121,9 @@ CachingRotationModel::equatorOrientationAtTime(double tjd) const
 Eigen::Vector3d
 CachingRotationModel::angularVelocityAtTime(double tjd) const
 {
+    if (CacheBypass::active())
+        return computeAngularVelocity(tjd);
+
     if (tjd != lastTime)
     {
         lastAngularVelocity = computeAngularVelocity(tjd);
@@ -67,6 +67,10 @@ class RotationModel
         begin = 0.0;
         end = 0.0;
     };
+
+    // Return true if the model may be evaluated concurrently from several
+    // threads, provided they hold a CacheBypass.
+    virtual bool isThreadSafe() const { return true; }
 };
 
 
@@ -32,6 +32,9 @@
 #include <celmath/mathlib.h>
 #include <celutil/gettext.h>
 #include <celutil/logger.h>
+#include <celutil/memoryusage.h>
+#include "cachebypass.h"
+#include "hermite.h"
 #include "orbit.h"
 #include "xyzvbinary.h"
 
@@ -97,6 +100,7 @@ public:
 
 private:
     std::vector<Sample<T>> samples;
+    celestia::util::MemoryTracker memory{ celestia::util::MemoryCategory::OrbitSamples };
     double boundingRadius;
     double period;
     mutable int lastSample;
@@ -128,6 +132,7 @@ template<typename T> void SampledOrbit<T>::addSample(double t, const Eigen::Matr
     Sample<T>& samp = samples.emplace_back();
     samp.position = position;
     samp.t = t;
+    memory.set(samples.capacity() * sizeof(Sample<T>));
 }
 
 template<typename T> double SampledOrbit<T>::getPeriod() const
@@ -155,26 +160,6 @@ template<typename T> double SampledOrbit<T>::getBoundingRadius() const
 }
 
 
-Eigen::Vector3d cubicInterpolate(const Eigen::Vector3d& p0, const Eigen::Vector3d& v0,
-                                 const Eigen::Vector3d& p1, const Eigen::Vector3d& v1,
-                                 double t)
-{
-    return p0 + (((2.0 * (p0 - p1) + v1 + v0) * (t * t * t)) +
-                 ((3.0 * (p1 - p0) - 2.0 * v0 - v1) * (t * t)) +
-                 (v0 * t));
-}
-
-
-Eigen::Vector3d cubicInterpolateVelocity(const Eigen::Vector3d& p0, const Eigen::Vector3d& v0,
-                                         const Eigen::Vector3d& p1, const Eigen::Vector3d& v1,
-                                         double t)
-{
-    return ((2.0 * (p0 - p1) + v1 + v0) * (3.0 * t * t)) +
-           ((3.0 * (p1 - p0) - 2.0 * v0 - v1) * (2.0 * t)) +
-           v0;
-}
-
-
 template <typename T> Eigen::Vector3d SampledOrbit<T>::computePosition(double jd) const
 {
     Eigen::Vector3d pos;
@@ -190,7 +175,9 @@ template <typename T> Eigen::Vector3d SampledOrbit<T>::computePosition(double jd
     {
         Sample<T> samp;
         samp.t = jd;
-        int n = lastSample;
+        // The last sample is only a search hint, skip it off the main thread
+        bool useHint = !CacheBypass::active();
+        int n = useHint ? lastSample : 0;
 
         if (n < 1 || n >= (int) samples.size() || jd < samples[n - 1].t || jd > samples[n].t)
         {
@@ -199,7 +186,8 @@ template <typename T> Eigen::Vector3d SampledOrbit<T>::computePosition(double jd
                 ? samples.size()
                 : iter - samples.begin();
 
-            lastSample = n;
+            if (useHint)
+                lastSample = n;
         }
 
         if (n == 0)
@@ -292,7 +280,8 @@ template<typename T> Eigen::Vector3d SampledOrbit<T>::computeVelocity(double jd)
     {
         Sample<T> samp;
         samp.t = jd;
-        int n = lastSample;
+        bool useHint = !CacheBypass::active();
+        int n = useHint ? lastSample : 0;
 
         if (n < 1 || n >= (int) samples.size() || jd < samples[n - 1].t || jd > samples[n].t)
         {
@@ -300,7 +289,8 @@ template<typename T> Eigen::Vector3d SampledOrbit<T>::computeVelocity(double jd)
             n = iter == samples.end()
                 ? samples.size()
                 : iter - samples.begin();
-            lastSample = n;
+            if (useHint)
+                lastSample = n;
         }
 
         if (n == 0)
@@ -440,6 +430,7 @@ public:
 
 private:
     std::vector<SampleXYZV<T>> samples;
+    celestia::util::MemoryTracker memory{ celestia::util::MemoryCategory::OrbitSamples };
     double boundingRadius;
     double period;
     mutable int lastSample;
@@ -472,6 +463,7 @@ template<typename T> void SampledOrbitXYZV<T>::addSample(double t,
     samp.t = t;
     samp.position = position;
     samp.velocity = velocity;
+    memory.set(samples.capacity() * sizeof(SampleXYZV<T>));
 }
 
 template <typename T> double SampledOrbitXYZV<T>::getPeriod() const
@@ -517,7 +509,8 @@ template <typename T> Eigen::Vector3d SampledOrbitXYZV<T>::computePosition(doubl
     {
         SampleXYZV<T> samp;
         samp.t = jd;
-        int n = lastSample;
+        bool useHint = !CacheBypass::active();
+        int n = useHint ? lastSample : 0;
 
         if (n < 1 || n >= (int) samples.size() || jd < samples[n - 1].t || jd > samples[n].t)
         {
@@ -527,7 +520,8 @@ template <typename T> Eigen::Vector3d SampledOrbitXYZV<T>::computePosition(doubl
             else
                 n = iter - samples.begin();
 
-            lastSample = n;
+            if (useHint)
+                lastSample = n;
         }
 
         if (n == 0)
@@ -586,7 +580,8 @@ template<typename T> Eigen::Vector3d SampledOrbitXYZV<T>::computeVelocity(double
     {
         SampleXYZV<T> samp;
         samp.t = jd;
-        int n = lastSample;
+        bool useHint = !CacheBypass::active();
+        int n = useHint ? lastSample : 0;
 
         if (n < 1 || n >= (int) samples.size() || jd < samples[n - 1].t || jd > samples[n].t)
         {
@@ -596,7 +591,8 @@ template<typename T> Eigen::Vector3d SampledOrbitXYZV<T>::computeVelocity(double
             else
                 n = iter - samples.begin();
 
-            lastSample = n;
+            if (useHint)
+                lastSample = n;
         }
 
         if (n > 0 && n < (int) samples.size())
@@ -21,6 +21,8 @@
 
 #include <celcompat/numbers.h>
 #include <celmath/geomutil.h>
+#include <celutil/memoryusage.h>
+#include "cachebypass.h"
 #include "rotation.h"
 
 namespace celestia::ephem
@@ -96,6 +98,7 @@ private:
 
 private:
     OrientationSampleVector samples;
+    celestia::util::MemoryTracker memory{ celestia::util::MemoryCategory::OrientationSamples };
     mutable int lastSample{0};
 
     enum InterpolationType
@@ -119,6 +122,7 @@ SampledOrientation::addSample(double t, const Eigen::Quaternionf& q)
     OrientationSample& samp = samples.emplace_back();
     samp.t = t;
     samp.q = q * coordSysCorrection;
+    memory.set(samples.capacity() * sizeof(OrientationSample));
 }
 
 
@@ -165,7 +169,8 @@ SampledOrientation::getOrientation(double tjd) const
     {
         OrientationSample samp;
         samp.t = tjd;
-        int n = lastSample;
+        bool useHint = !CacheBypass::active();
+        int n = useHint ? lastSample : 0;
 
         // Do a binary search to find the samples that define the orientation
         // at the current time. Cache the previous sample used and avoid
@@ -180,7 +185,8 @@ SampledOrientation::getOrientation(double tjd) const
             else
                 n = iter - samples.begin();
 
-            lastSample = n;
+            if (useHint)
+                lastSample = n;
         }
 
         if (n == 0)
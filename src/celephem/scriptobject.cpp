@@ -11,13 +11,14 @@
 
 #include <cstddef>
 #include <string_view>
-
-#include <fmt/format.h>
+#include <thread>
+#include <unordered_map>
 
 #include <celengine/value.h>
+#include <celutil/logger.h>
 #include "scriptobject.h"
 
-using namespace std::string_view_literals;
+using celestia::util::GetLogger;
 
 namespace celestia::ephem
 {
@@ -29,61 +30,122 @@ class ScriptObjectState
 {
 private:
     lua_State* context{ nullptr };
-    unsigned int nameIndex{ 1 };
+    std::thread::id contextThread{ };
+    std::function<lua_State*()> workerFactory{ };
+    unsigned int objectIndex{ 1 };
 
 public:
     lua_State* getContext() { return context; }
-    void setContext(lua_State* luaState) { context = luaState; }
-    unsigned int getNameIndex() { return nameIndex++; }
+    void setContext(lua_State* luaState)
+    {
+        context = luaState;
+        contextThread = std::this_thread::get_id();
+    }
+    bool isContextThread() const { return std::this_thread::get_id() == contextThread; }
+
+    void setWorkerFactory(std::function<lua_State*()>&& factory) { workerFactory = std::move(factory); }
+    bool hasWorkerFactory() const { return static_cast<bool>(workerFactory); }
+    lua_State* createWorkerState() const { return workerFactory ? workerFactory() : nullptr; }
+
+    unsigned int getObjectIndex() { return objectIndex++; }
 };
 
 // global script context for scripted orbits and rotations
 
-constexpr std::string_view ScriptedObjectNamePrefix = "cel_script_object_"sv;
-
 ScriptObjectState* getCurrentObjectState()
 {
     static ScriptObjectState* const state = std::make_unique<ScriptObjectState>().release();
     return state;
 }
 
-class HashVisitor
+// Lua state and object references of a worker thread. Objects are keyed by
+// the id of the ScriptedObject they were rebuilt from.
+class WorkerContext
+{
+public:
+    WorkerContext() = default;
+    ~WorkerContext()
+    {
+        if (state != nullptr)
+            lua_close(state);
+    }
+
+    WorkerContext(const WorkerContext&) = delete;
+    WorkerContext& operator=(const WorkerContext&) = delete;
+
+    lua_State* getState()
+    {
+        if (state == nullptr && !failed)
+        {
+            state = getCurrentObjectState()->createWorkerState();
+            failed = state == nullptr;
+        }
+        return state;
+    }
+
+    std::unordered_map<unsigned int, ScriptedObjectReferences> objects;
+
+private:
+    lua_State* state{ nullptr };
+    bool failed{ false };
+};
+
+thread_local WorkerContext workerContext;
+
+// Records the parameters for the factory function, so that it can be
+// called again later in another Lua state. Presently, only number, string,
+// and boolean values are kept.
+template<typename T>
+class ParameterCollector
 {
 private:
-    lua_State* state;
+    std::vector<std::pair<std::string, T>>& parameters;
 
 public:
-    explicit HashVisitor(lua_State* pState) : state{pState} {}
+    explicit ParameterCollector(std::vector<std::pair<std::string, T>>& pParameters) :
+        parameters(pParameters)
+    {}
 
     void operator()(const std::string& key, const Value& value)
     {
-        std::size_t percentPos = key.find('%');
-        if (percentPos == std::string::npos)
+        if (key.find('%') != std::string::npos)
+            return;
+
+        switch (value.getType())
         {
-            switch (value.getType())
-            {
-            case ValueType::NumberType:
-                lua_pushstring(state, key.c_str());
-                lua_pushnumber(state, *value.getNumber());
-                lua_settable(state, -3);
-                break;
-            case ValueType::StringType:
-                lua_pushstring(state, key.c_str());
-                lua_pushstring(state, value.getString()->c_str());
-                lua_settable(state, -3);
-                break;
-            case ValueType::BooleanType:
-                lua_pushstring(state, key.c_str());
-                lua_pushboolean(state, *value.getBoolean());
-                lua_settable(state, -3);
-                break;
-            default:
-                break;
-            }
+        case ValueType::NumberType:
+            parameters.emplace_back(key, *value.getNumber());
+            break;
+        case ValueType::StringType:
+            parameters.emplace_back(key, *value.getString());
+            break;
+        case ValueType::BooleanType:
+            parameters.emplace_back(key, *value.getBoolean());
+            break;
+        default:
+            break;
         }
     }
 };
 
+void
+pushParameter(lua_State* state, double value)
+{
+    lua_pushnumber(state, value);
+}
+
+void
+pushParameter(lua_State* state, const std::string& value)
+{
+    lua_pushstring(state, value.c_str());
+}
+
+void
+pushParameter(lua_State* state, bool value)
+{
+    lua_pushboolean(state, value);
+}
+
 } // end unnamed namespace
 
 /*! Set the script context for ScriptedOrbits and ScriptRotations
@@ -105,15 +167,13 @@ GetScriptedObjectContext()
 }
 
 
-/*! Generate a unique name for this script orbit object so that
- * we can refer to it later.
+/*! Set the function used to create Lua states for evaluating scripted
+ *  orbits and rotations on worker threads.
  */
-std::string
-GenerateScriptObjectName()
+void
+SetScriptedObjectWorkerFactory(std::function<lua_State*()>&& factory)
 {
-    std::string buf;
-    buf = fmt::format("{}{}", ScriptedObjectNamePrefix, getCurrentObjectState()->getNameIndex());
-    return buf;
+    getCurrentObjectState()->setWorkerFactory(std::move(factory));
 }
 
 
@@ -152,15 +212,235 @@ SafeGetLuaNumber(lua_State* state,
 }
 
 
-/*! Convert all the parameters in an AssociativeArray to their equivalent Lua
- *  types and insert them into the table on the top of the stack. Presently,
- *  only number, string, and boolean values are converted.
+ScriptedObject::ScriptedObject(lua_State* pMainState,
+                               std::string_view pKind,
+                               const MethodNames& pMethodNames) :
+    mainState(pMainState),
+    id(getCurrentObjectState()->getObjectIndex()),
+    kind(pKind),
+    methodNames(pMethodNames)
+{
+    mainRefs.object = LUA_NOREF;
+    mainRefs.methods.fill(LUA_NOREF);
+}
+
+
+/*! Load the module (if any), then call the factory function funcName with
+ *  a table built from parameters. The object it returns and the methods
+ *  listed in methodNames are stored as registry references. kind is the
+ *  type of scripted object, used in error messages.
  */
-void
-SetLuaVariables(lua_State* state, const AssociativeArray& parameters)
+std::unique_ptr<ScriptedObject>
+ScriptedObject::create(lua_State* state,
+                       const std::string* moduleName,
+                       const std::string& funcName,
+                       const AssociativeArray& parameters,
+                       const fs::path& path,
+                       std::string_view kind,
+                       const MethodNames& methodNames)
+{
+    std::unique_ptr<ScriptedObject> object(new ScriptedObject(state, kind, methodNames));
+    if (moduleName != nullptr)
+        object->moduleName = *moduleName;
+    object->funcName = funcName;
+
+    ParameterCollector<Parameter> collector(object->parameters);
+    parameters.for_all(collector);
+    // set the addon path
+    object->parameters.emplace_back("AddonPath", path.string());
+
+    if (!object->instantiate(state, object->mainRefs, true))
+        return nullptr;
+
+    return object;
+}
+
+
+bool
+ScriptedObject::instantiate(lua_State* state, References& refs, bool logErrors) const
 {
-    HashVisitor visitor(state);
-    parameters.for_all(visitor);
+    if (!moduleName.empty())
+    {
+        lua_getglobal(state, "require");
+        if (!lua_isfunction(state, -1))
+        {
+            if (logErrors)
+                GetLogger()->error("Cannot load {} package: 'require' function is unavailable\n", kind);
+            lua_pop(state, 1);
+            return false;
+        }
+
+        lua_pushstring(state, moduleName.c_str());
+        if (lua_pcall(state, 1, 1, 0) != 0)
+        {
+            if (logErrors)
+                GetLogger()->error("Failed to load module for {}: {}\n", kind, lua_tostring(state, -1));
+            lua_pop(state, 1);
+            return false;
+        }
+
+        // Discard the value returned by the module
+        lua_pop(state, 1);
+    }
+
+    // Get the generator function
+    lua_getglobal(state, funcName.c_str());
+
+    if (lua_isfunction(state, -1) == 0)
+    {
+        // No function with the requested name; pop whatever value we
+        // did receive.
+        lua_pop(state, 1);
+        if (logErrors)
+            GetLogger()->error("No Lua function named {} found.\n", funcName);
+        return false;
+    }
+
+    // Construct the table that we'll pass to the generator function
+    lua_newtable(state);
+    for (const auto& [key, value] : parameters)
+    {
+        lua_pushstring(state, key.c_str());
+        std::visit([state](const auto& v) { pushParameter(state, v); }, value);
+        lua_settable(state, -3);
+    }
+
+    // Call the generator function
+    if (lua_pcall(state, 1, 1, 0) != 0)
+    {
+        // Some sort of error occurred--the error message is atop the stack
+        if (logErrors)
+        {
+            GetLogger()->error("Error calling {} generator function: {}\n",
+                               kind, lua_tostring(state, -1));
+        }
+        lua_pop(state, 1);
+        return false;
+    }
+
+    if (lua_istable(state, -1) == 0)
+    {
+        // We have an object, but it's not a table. Pop it off the
+        // stack and report failure.
+        if (logErrors)
+            GetLogger()->error("{} generator function returned bad value.\n", kind);
+        lua_pop(state, 1);
+        return false;
+    }
+
+    for (std::size_t i = 0; i < MaxMethods; ++i)
+    {
+        refs.methods[i] = LUA_NOREF;
+        if (methodNames[i] == nullptr)
+            continue;
+
+        lua_pushstring(state, methodNames[i]);
+        lua_gettable(state, -2);
+        if (lua_isfunction(state, -1))
+            refs.methods[i] = luaL_ref(state, LUA_REGISTRYINDEX);
+        else
+            lua_pop(state, 1);
+    }
+
+    // Pops the object; the reference keeps it alive
+    refs.object = luaL_ref(state, LUA_REGISTRYINDEX);
+
+    return true;
+}
+
+
+const ScriptedObject::References*
+ScriptedObject::referencesForThread(lua_State*& state) const
+{
+    if (getCurrentObjectState()->isContextThread())
+    {
+        state = mainState;
+        return &mainRefs;
+    }
+
+    lua_State* workerState = workerContext.getState();
+    if (workerState == nullptr)
+        return nullptr;
+
+    auto it = workerContext.objects.find(id);
+    if (it == workerContext.objects.end())
+    {
+        References refs;
+        if (!instantiate(workerState, refs, false))
+        {
+            refs.object = LUA_NOREF;
+            refs.methods.fill(LUA_NOREF);
+        }
+        it = workerContext.objects.try_emplace(id, refs).first;
+    }
+
+    if (it->second.object == LUA_NOREF)
+        return nullptr;
+
+    state = workerState;
+    return &it->second;
+}
+
+
+lua_State*
+ScriptedObject::pushObject() const
+{
+    lua_State* state = nullptr;
+    const References* refs = referencesForThread(state);
+    if (refs == nullptr)
+        return nullptr;
+
+    lua_rawgeti(state, LUA_REGISTRYINDEX, refs->object);
+    return state;
+}
+
+
+lua_State*
+ScriptedObject::pushMethod(std::size_t method) const
+{
+    lua_State* state = nullptr;
+    const References* refs = referencesForThread(state);
+    if (refs == nullptr || refs->methods[method] == LUA_NOREF)
+        return nullptr;
+
+    lua_rawgeti(state, LUA_REGISTRYINDEX, refs->methods[method]);
+    lua_rawgeti(state, LUA_REGISTRYINDEX, refs->object); // push 'self' on stack
+    return state;
+}
+
+
+bool
+ScriptedObject::hasMethod(std::size_t method) const
+{
+    return mainRefs.methods[method] != LUA_NOREF;
+}
+
+
+bool
+ScriptedObject::isThreadSafe() const
+{
+    ScriptObjectState* objectState = getCurrentObjectState();
+    if (!objectState->hasWorkerFactory())
+        return false;
+
+    // Check once, from the context thread, that the object can be rebuilt
+    // with the same methods in a worker state. Factories that rely on
+    // globals of the main context (rather than a module) fail here.
+    if (workerSupport.load() == WorkerSupport::Unknown && objectState->isContextThread())
+    {
+        bool supported = false;
+        if (lua_State* probe = objectState->createWorkerState(); probe != nullptr)
+        {
+            References refs;
+            supported = instantiate(probe, refs, false);
+            for (std::size_t i = 0; supported && i < MaxMethods; ++i)
+                supported = (refs.methods[i] == LUA_NOREF) == (mainRefs.methods[i] == LUA_NOREF);
+            lua_close(probe);
+        }
+        workerSupport = supported ? WorkerSupport::Supported : WorkerSupport::Unsupported;
+    }
+
+    return workerSupport.load() == WorkerSupport::Supported;
 }
 
 } // end namespace celestia::ephem
@@ -15,10 +15,21 @@
 #define LUA_VER 0x050100
 #endif
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include <lua.hpp>
 
+#include <celcompat/filesystem.h>
+
 class AssociativeArray;
 
 namespace celestia::ephem
@@ -28,7 +39,11 @@ void SetScriptedObjectContext(lua_State* l);
 
 lua_State* GetScriptedObjectContext();
 
-std::string GenerateScriptObjectName();
+/*! Install a function that creates a fresh Lua state for a worker thread.
+ *  Scripted orbits and rotations evaluated away from the thread that owns
+ *  the scripted object context rebuild their objects in such a state.
+ */
+void SetScriptedObjectWorkerFactory(std::function<lua_State*()>&& factory);
 
 void GetLuaTableEntry(lua_State* state,
                       int tableIndex,
@@ -39,6 +54,78 @@ double SafeGetLuaNumber(lua_State* state,
                         const std::string& key,
                         double defaultValue);
 
-void SetLuaVariables(lua_State* state, const AssociativeArray& parameters);
+// Registry references to a scripted object and its methods within one
+// Lua state; LUA_NOREF marks a missing entry.
+struct ScriptedObjectReferences
+{
+    static constexpr std::size_t MaxMethods = 2;
+
+    int object;
+    std::array<int, MaxMethods> methods;
+};
+
+/*! A Lua object produced by the factory function of a scripted orbit or
+ *  rotation. The object and its methods are held as registry references,
+ *  so calling a method involves no lookups by name. The recipe used to
+ *  build the object is kept as well: on a worker thread the object is
+ *  rebuilt on first use in that thread's own Lua state.
+ */
+class ScriptedObject
+{
+ public:
+    static constexpr std::size_t MaxMethods = ScriptedObjectReferences::MaxMethods;
+    using MethodNames = std::array<const char*, MaxMethods>;
+
+    ~ScriptedObject() = default;
+    ScriptedObject(const ScriptedObject&) = delete;
+    ScriptedObject& operator=(const ScriptedObject&) = delete;
+
+    static std::unique_ptr<ScriptedObject> create(lua_State* state,
+                                                  const std::string* moduleName,
+                                                  const std::string& funcName,
+                                                  const AssociativeArray& parameters,
+                                                  const fs::path& path,
+                                                  std::string_view kind,
+                                                  const MethodNames& methodNames);
+
+    // Push the object table onto the stack of the calling thread's Lua
+    // state and return that state, or nullptr if there is no object.
+    lua_State* pushObject() const;
+
+    // Push a method followed by the object (as the self argument) and
+    // return the state, or nullptr if the method isn't defined.
+    lua_State* pushMethod(std::size_t method) const;
+
+    bool hasMethod(std::size_t method) const;
+
+    // Return true if the object can be built and called in worker states.
+    bool isThreadSafe() const;
+
+ private:
+    using Parameter = std::variant<double, std::string, bool>;
+    using References = ScriptedObjectReferences;
+
+    ScriptedObject(lua_State*, std::string_view, const MethodNames&);
+
+    bool instantiate(lua_State* state, References& refs, bool logErrors) const;
+    const References* referencesForThread(lua_State*& state) const;
+
+    lua_State* mainState;
+    unsigned int id;
+    std::string kind;
+    std::string moduleName;
+    std::string funcName;
+    std::vector<std::pair<std::string, Parameter>> parameters;
+    MethodNames methodNames;
+    References mainRefs;
+
+    enum class WorkerSupport
+    {
+        Unknown,
+        Supported,
+        Unsupported,
+    };
+    mutable std::atomic<WorkerSupport> workerSupport{ WorkerSupport::Unknown };
+};
 
 }
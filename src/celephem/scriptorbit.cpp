@@ -11,9 +11,18 @@
 
 #include "scriptorbit.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+
 #include <Eigen/Core>
 #include <lua.hpp>
 
+#include <celmath/chebyshev.h>
 #include <celutil/logger.h>
 #include "orbit.h"
 #include "scriptobject.h"
@@ -26,92 +35,290 @@ namespace celestia::ephem
 namespace
 {
 
+constexpr std::size_t PositionMethod = 0;
+constexpr std::size_t PositionsMethod = 1;
+
+/*! Chebyshev approximations of a scripted trajectory over fixed length
+ *  segments of time. A segment is fitted once it has been queried often
+ *  enough to make fitting pay off; afterwards positions and velocities
+ *  within it are computed without calling into Lua. Segments where the
+ *  series doesn't reproduce the script to within Tolerance at the points
+ *  midway between the nodes are evaluated directly from then on.
+ */
+class ChebyshevCache
+{
+ public:
+    static constexpr std::size_t Degree = 16;
+    // Kilometers
+    static constexpr double Tolerance = 1.0e-3;
+
+    using Coefficients = std::array<Eigen::Vector3d, Degree>;
+
+    explicit ChebyshevCache(double pSegmentLength) : segmentLength(pSegmentLength) {}
+
+    // Compute the position, or the velocity if derivative is true, from
+    // the series covering tjd. Returns false if the caller must call the
+    // script instead. callScript(times, positions, count) calls the script
+    // for a batch of times when a segment is fitted.
+    template<typename F>
+    bool evaluate(double tjd, bool derivative, Eigen::Vector3d& result, F&& callScript) const;
+
+ private:
+    struct Segment
+    {
+        int queries{ 0 };
+        bool fitted{ false };
+        bool usable{ false };
+        Coefficients position;
+        Coefficients velocity;
+    };
+
+    // Segments queried fewer times than this are left to the script
+    static constexpr int FitThreshold = 8;
+    static constexpr std::size_t MaxSegments = 256;
+
+    template<typename F>
+    void fit(std::int64_t index, Segment& segment, F&& callScript) const;
+
+    double segmentLength;
+    mutable std::mutex mutex;
+    mutable std::map<std::int64_t, Segment> segments;
+};
+
+
+template<typename F>
+bool
+ChebyshevCache::evaluate(double tjd, bool derivative, Eigen::Vector3d& result, F&& callScript) const
+{
+    double s = tjd / segmentLength;
+    double base = std::floor(s);
+    auto index = static_cast<std::int64_t>(base);
+    // Map the time onto [-1, 1] within the segment
+    double x = 2.0 * (s - base) - 1.0;
+
+    std::scoped_lock lock(mutex);
+    auto it = segments.find(index);
+    if (it == segments.end())
+    {
+        if (segments.size() >= MaxSegments)
+            segments.clear();
+        it = segments.try_emplace(index).first;
+    }
+
+    Segment& segment = it->second;
+    if (!segment.fitted && ++segment.queries >= FitThreshold)
+        fit(index, segment, callScript);
+
+    if (!segment.usable)
+        return false;
+
+    result = celmath::ChebyshevEvaluate(derivative ? segment.velocity : segment.position, x);
+    return true;
+}
+
+
+template<typename F>
+void
+ChebyshevCache::fit(std::int64_t index, Segment& segment, F&& callScript) const
+{
+    static const auto nodes = celmath::ChebyshevNodes<double, Degree>();
+
+    // Evaluate the nodes and the points between them in a single batch
+    std::array<double, Degree * 2 - 1> times;
+    double start = static_cast<double>(index) * segmentLength;
+    for (std::size_t k = 0; k < Degree; ++k)
+    {
+        times[k] = start + (nodes[k] + 1.0) * 0.5 * segmentLength;
+        if (k > 0)
+        {
+            double midpoint = 0.5 * (nodes[k - 1] + nodes[k]);
+            times[Degree + k - 1] = start + (midpoint + 1.0) * 0.5 * segmentLength;
+        }
+    }
+
+    std::array<Eigen::Vector3d, Degree * 2 - 1> positions;
+    segment.fitted = true;
+    if (!callScript(times.data(), positions.data(), times.size()))
+        return;
+
+    Coefficients values;
+    std::copy(positions.begin(), positions.begin() + Degree, values.begin());
+    segment.position = celmath::ChebyshevFit<Eigen::Vector3d, double>(values);
+
+    for (std::size_t k = 1; k < Degree; ++k)
+    {
+        double midpoint = 0.5 * (nodes[k - 1] + nodes[k]);
+        Eigen::Vector3d p = celmath::ChebyshevEvaluate(segment.position, midpoint);
+        if ((p - positions[Degree + k - 1]).norm() > Tolerance)
+            return;
+    }
+
+    // The derivative is taken with respect to x; convert to km/day
+    segment.velocity = celmath::ChebyshevDerivative<Eigen::Vector3d, double>(segment.position);
+    for (Eigen::Vector3d& c : segment.velocity)
+        c *= 2.0 / segmentLength;
+    segment.usable = true;
+}
+
+
 class ScriptedOrbit : public CachingOrbit
 {
  public:
-    ScriptedOrbit(lua_State*,
-                  std::string&&,
+    ScriptedOrbit(std::unique_ptr<ScriptedObject>&&,
                   double boundingRadius,
                   double period,
                   double validRangeBegin,
-                  double validRangeEnd);
+                  double validRangeEnd,
+                  bool smooth);
     ~ScriptedOrbit() override = default;
 
     Eigen::Vector3d computePosition(double tjd) const override;
+    Eigen::Vector3d computeVelocity(double tjd) const override;
     bool isPeriodic() const override;
     double getPeriod() const override;
     double getBoundingRadius() const override;
     void getValidRange(double& begin, double& end) const override;
+    bool isThreadSafe() const override;
 
  private:
-    lua_State* luaState{ nullptr };
-    std::string luaOrbitObjectName;
+    Eigen::Vector3d callPosition(double tjd) const;
+    bool callPositions(const double* tjd, Eigen::Vector3d* positions, std::size_t count) const;
+
+    std::unique_ptr<ScriptedObject> luaObject;
     double boundingRadius{ 1.0 };
     double period{ 0.0 };
     double validRangeBegin{ 0.0 };
     double validRangeEnd{ 0.0 };
+    std::unique_ptr<ChebyshevCache> cache;
 };
 
 
-ScriptedOrbit::ScriptedOrbit(lua_State* pLuaState,
-                             std::string&& pLuaOrbitObjectName,
+ScriptedOrbit::ScriptedOrbit(std::unique_ptr<ScriptedObject>&& pLuaObject,
                              double pBoundingRadius,
                              double pPeriod,
                              double pValidRangeBegin,
-                             double pValidRangeEnd)
-    : luaState(pLuaState),
-      luaOrbitObjectName(std::move(pLuaOrbitObjectName)),
+                             double pValidRangeEnd,
+                             bool smooth)
+    : luaObject(std::move(pLuaObject)),
       boundingRadius(pBoundingRadius),
       period(pPeriod),
       validRangeBegin(pValidRangeBegin),
       validRangeEnd(pValidRangeEnd)
-{}
+{
+    if (smooth)
+    {
+        // A sixteenth of a revolution, or a day for aperiodic trajectories
+        cache = std::make_unique<ChebyshevCache>(period > 0.0 ? period / 16.0 : 1.0);
+    }
+}
 
 
 // Call the position method of the ScriptedOrbit object
 Eigen::Vector3d
-ScriptedOrbit::computePosition(double tjd) const
+ScriptedOrbit::callPosition(double tjd) const
 {
     Eigen::Vector3d pos(Eigen::Vector3d::Zero());
-    lua_getglobal(luaState, luaOrbitObjectName.c_str());
-    if (lua_istable(luaState, -1))
+    lua_State* luaState = luaObject->pushMethod(PositionMethod);
+    if (luaState != nullptr)
     {
-        lua_pushstring(luaState, "position");
-        lua_gettable(luaState, -2);
-        if (lua_isfunction(luaState, -1))
+        lua_pushnumber(luaState, tjd);
+        if (lua_pcall(luaState, 2, 3, 0) == 0)
         {
-            lua_pushvalue(luaState, -2); // push 'self' on stack
-            lua_pushnumber(luaState, tjd);
-            if (lua_pcall(luaState, 2, 3, 0) == 0)
-            {
-                pos = Eigen::Vector3d(lua_tonumber(luaState, -3),
-                                      lua_tonumber(luaState, -2),
-                                      lua_tonumber(luaState, -1));
-                lua_pop(luaState, 3);
-            }
-            else
-            {
-                // Function call failed for some reason
-                //clog << "ScriptedOrbit failed: " << lua_tostring(luaState, -1) << "\n";
-                lua_pop(luaState, 1);
-            }
+            pos = Eigen::Vector3d(lua_tonumber(luaState, -3),
+                                  lua_tonumber(luaState, -2),
+                                  lua_tonumber(luaState, -1));
+            lua_pop(luaState, 3);
         }
         else
         {
-            // Bad position function
+            // Function call failed for some reason
             lua_pop(luaState, 1);
         }
     }
-    else
+
+    // Convert to Celestia's internal coordinate system
+    return Eigen::Vector3d(pos.x(), pos.z(), -pos.y());
+}
+
+
+// Evaluate several times at once. The optional positions method takes an
+// array of times and returns arrays of x, y and z coordinates; without it,
+// position is called for each time.
+bool
+ScriptedOrbit::callPositions(const double* tjd, Eigen::Vector3d* positions, std::size_t count) const
+{
+    lua_State* luaState = luaObject->pushMethod(PositionsMethod);
+    if (luaState == nullptr)
     {
-        // The script orbit object disappeared. OOPS.
+        for (std::size_t i = 0; i < count; ++i)
+            positions[i] = callPosition(tjd[i]);
+        return true;
     }
 
-    // Pop the script orbit object
-    lua_pop(luaState, 1);
+    lua_createtable(luaState, static_cast<int>(count), 0);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        lua_pushnumber(luaState, tjd[i]);
+        lua_rawseti(luaState, -2, static_cast<int>(i + 1));
+    }
 
-    // Convert to Celestia's internal coordinate system
-    return Eigen::Vector3d(pos.x(), pos.z(), -pos.y());
+    if (lua_pcall(luaState, 2, 3, 0) != 0)
+    {
+        lua_pop(luaState, 1);
+        return false;
+    }
+
+    bool valid = lua_istable(luaState, -3) && lua_istable(luaState, -2) && lua_istable(luaState, -1);
+    for (std::size_t i = 0; valid && i < count; ++i)
+    {
+        auto n = static_cast<int>(i + 1);
+        lua_rawgeti(luaState, -3, n);
+        lua_rawgeti(luaState, -3, n);
+        lua_rawgeti(luaState, -3, n);
+        // Convert to Celestia's internal coordinate system
+        positions[i] = Eigen::Vector3d(lua_tonumber(luaState, -3),
+                                       lua_tonumber(luaState, -1),
+                                       -lua_tonumber(luaState, -2));
+        lua_pop(luaState, 3);
+    }
+
+    lua_pop(luaState, 3);
+    return valid;
+}
+
+
+Eigen::Vector3d
+ScriptedOrbit::computePosition(double tjd) const
+{
+    Eigen::Vector3d pos;
+    if (cache != nullptr &&
+        cache->evaluate(tjd, false, pos, [this](const double* t, Eigen::Vector3d* p, std::size_t n) { return callPositions(t, p, n); }))
+    {
+        return pos;
+    }
+
+    return callPosition(tjd);
+}
+
+
+Eigen::Vector3d
+ScriptedOrbit::computeVelocity(double tjd) const
+{
+    Eigen::Vector3d vel;
+    if (cache != nullptr &&
+        cache->evaluate(tjd, true, vel, [this](const double* t, Eigen::Vector3d* p, std::size_t n) { return callPositions(t, p, n); }))
+    {
+        return vel;
+    }
+
+    return CachingOrbit::computeVelocity(tjd);
+}
+
+
+bool
+ScriptedOrbit::isThreadSafe() const
+{
+    return luaObject->isThreadSafe();
 }
 
 
@@ -171,6 +378,17 @@ ScriptedOrbit::getBoundingRadius() const
  *      position(time) - The position function takes a time value as input
  *         (TDB Julian day) and returns three values which are the x, y, and
  *         z coordinates. Units for the position are kilometers.
+ *      positions(times) - Optional batched form of position. It takes an
+ *         array of times and returns three arrays holding the x, y, and z
+ *         coordinates for each of them.
+ *      smooth - Optional boolean, true by default. Smooth trajectories are
+ *         approximated by Chebyshev series fitted to the position function
+ *         wherever the series agree with it to within a meter; set it to
+ *         false for trajectories with discontinuities.
+ *
+ *  The factory function is called again, in a separate Lua state, for each
+ *  worker thread that evaluates the orbit. This only works for factories
+ *  defined in a module.
  */
 std::unique_ptr<Orbit> CreateScriptedOrbit(const std::string* moduleName,
                                            const std::string& funcName,
@@ -184,82 +402,21 @@ std::unique_ptr<Orbit> CreateScriptedOrbit(const std::string* moduleName,
         return nullptr;
     }
 
-    if (moduleName != nullptr && !moduleName->empty())
-    {
-        lua_getglobal(luaState, "require");
-        if (!lua_isfunction(luaState, -1))
-        {
-            GetLogger()->error("Cannot load ScriptedOrbit package: 'require' function is unavailable\n");
-            lua_pop(luaState, 1);
-            return nullptr;
-        }
-
-        lua_pushstring(luaState, moduleName->c_str());
-        if (lua_pcall(luaState, 1, 1, 0) != 0)
-        {
-            GetLogger()->error("Failed to load module for ScriptedOrbit: {}\n", lua_tostring(luaState, -1));
-            lua_pop(luaState, 1);
-            return nullptr;
-        }
-    }
-
-    // Get the orbit generator function
-    lua_getglobal(luaState, funcName.c_str());
-
-    if (lua_isfunction(luaState, -1) == 0)
-    {
-        // No function with the requested name; pop whatever value we
-        // did receive along with the table of arguments.
-        lua_pop(luaState, 1);
-        GetLogger()->error("No Lua function named {} found.\n", funcName);
-        return nullptr;
-    }
-
-    // Construct the table that we'll pass to the orbit generator function
-    lua_newtable(luaState);
-
-    SetLuaVariables(luaState, parameters);
-    // set the addon path
-    {
-        std::string pathStr = path.string();
-        lua_pushstring(luaState, "AddonPath");
-        lua_pushstring(luaState, pathStr.c_str());
-        lua_settable(luaState, -3);
-    }
-
-    // Call the generator function
-    if (lua_pcall(luaState, 1, 1, 0) != 0)
-    {
-        // Some sort of error occurred--the error message is atop the stack
-        GetLogger()->error("Error calling ScriptedOrbit generator function: {}\n",
-                           lua_tostring(luaState, -1));
-        lua_pop(luaState, 1);
+    auto luaObject = ScriptedObject::create(luaState, moduleName, funcName,
+                                            parameters, path, "ScriptedOrbit",
+                                            { "position", "positions" });
+    if (luaObject == nullptr)
         return nullptr;
-    }
 
-    if (lua_istable(luaState, -1) == 0)
-    {
-        // We have an object, but it's not a table. Pop it off the
-        // stack and report failure.
-        GetLogger()->error("ScriptedOrbit generator function returned bad value.\n");
-        lua_pop(luaState, 1);
-        return nullptr;
-    }
-
-    std::string luaOrbitObjectName = GenerateScriptObjectName();
-
-    // Attach the name to the script orbit
-    lua_pushvalue(luaState, -1); // dup the orbit object on top of stack
-    lua_setglobal(luaState, luaOrbitObjectName.c_str());
-
-    // Now, call orbit object methods to get the bounding radius
-    // and valid time range.
+    // Now, get the bounding radius and valid time range from the orbit
+    // object.
+    luaObject->pushObject();
     lua_pushstring(luaState, "boundingRadius");
     lua_gettable(luaState, -2);
     if (lua_isnumber(luaState, -1) == 0)
     {
         GetLogger()->error("Bad or missing boundingRadius for ScriptedOrbit object\n");
-        lua_pop(luaState, 1);
+        lua_pop(luaState, 2);
         return nullptr;
     }
 
@@ -271,6 +428,10 @@ std::unique_ptr<Orbit> CreateScriptedOrbit(const std::string* moduleName,
     double validRangeBegin = SafeGetLuaNumber(luaState, -1, "beginDate", 0.0);
     double validRangeEnd   = SafeGetLuaNumber(luaState, -1, "endDate", 0.0);
 
+    GetLuaTableEntry(luaState, -1, "smooth");
+    bool smooth = lua_isboolean(luaState, -1) == 0 || lua_toboolean(luaState, -1) != 0;
+    lua_pop(luaState, 1);
+
     // Pop the orbit object off the stack
     lua_pop(luaState, 1);
 
@@ -287,12 +448,12 @@ std::unique_ptr<Orbit> CreateScriptedOrbit(const std::string* moduleName,
         return nullptr;
     }
 
-    return std::make_unique<ScriptedOrbit>(luaState,
-                                           std::move(luaOrbitObjectName),
+    return std::make_unique<ScriptedOrbit>(std::move(luaObject),
                                            boundingRadius,
                                            period,
                                            validRangeBegin,
-                                           validRangeEnd);
+                                           validRangeEnd,
+                                           smooth);
 }
 
 }
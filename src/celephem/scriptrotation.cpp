@@ -17,6 +17,7 @@
 #include <lua.hpp>
 
 #include <celutil/logger.h>
+#include "cachebypass.h"
 #include "rotation.h"
 #include "scriptobject.h"
 
@@ -31,8 +32,7 @@ namespace
 class ScriptedRotation : public RotationModel
 {
  public:
-    ScriptedRotation(lua_State*,
-                     std::string&&,
+    ScriptedRotation(std::unique_ptr<ScriptedObject>&&,
                      double,
                      double,
                      double);
@@ -43,10 +43,10 @@ class ScriptedRotation : public RotationModel
     bool isPeriodic() const override;
     double getPeriod() const override;
     void getValidRange(double& begin, double& end) const override;
+    bool isThreadSafe() const override;
 
  private:
-    lua_State* luaState{ nullptr };
-    std::string luaRotationObjectName;
+    std::unique_ptr<ScriptedObject> luaObject;
     double period{ 0.0 };
     double validRangeBegin{ 0.0 };
     double validRangeEnd{ 0.0 };
@@ -59,66 +59,62 @@ class ScriptedRotation : public RotationModel
 };
 
 
-ScriptedRotation::ScriptedRotation(lua_State* pLuaState,
-                                   std::string&& pLuaRotationObjectName,
+ScriptedRotation::ScriptedRotation(std::unique_ptr<ScriptedObject>&& pLuaObject,
                                    double pPeriod,
                                    double pValidRangeBegin,
                                    double pValidRangeEnd)
-    : luaState(pLuaState),
-      luaRotationObjectName(std::move(pLuaRotationObjectName)),
+    : luaObject(std::move(pLuaObject)),
       period(pPeriod),
       validRangeBegin(pValidRangeBegin),
       validRangeEnd(pValidRangeEnd)
 {}
 
 
-// Call the position method of the ScriptedRotation object
+// Call the orientation method of the ScriptedRotation object
 Eigen::Quaterniond
 ScriptedRotation::spin(double tjd) const
 {
-    if (tjd != lastTime || !cacheable)
+    // The cache is shared between threads, so leave it alone while a
+    // CacheBypass is held.
+    bool useCache = cacheable && !CacheBypass::active();
+    if (useCache && tjd == lastTime)
+        return lastOrientation;
+
+    Eigen::Quaterniond orientation = useCache ? lastOrientation : Eigen::Quaterniond::Identity();
+    lua_State* luaState = luaObject->pushMethod(0);
+    if (luaState != nullptr)
     {
-        lua_getglobal(luaState, luaRotationObjectName.c_str());
-        if (lua_istable(luaState, -1))
+        lua_pushnumber(luaState, tjd);
+        if (lua_pcall(luaState, 2, 4, 0) == 0)
         {
-            lua_pushstring(luaState, "orientation");
-            lua_gettable(luaState, -2);
-            if (lua_isfunction(luaState, -1))
+            orientation = Eigen::Quaterniond(lua_tonumber(luaState, -4),
+                                             lua_tonumber(luaState, -3),
+                                             lua_tonumber(luaState, -2),
+                                             lua_tonumber(luaState, -1));
+            lua_pop(luaState, 4);
+            if (useCache)
             {
-                lua_pushvalue(luaState, -2); // push 'self' on stack
-                lua_pushnumber(luaState, tjd);
-                if (lua_pcall(luaState, 2, 4, 0) == 0)
-                {
-                    lastOrientation = Eigen::Quaterniond(lua_tonumber(luaState, -4),
-                                                         lua_tonumber(luaState, -3),
-                                                         lua_tonumber(luaState, -2),
-                                                         lua_tonumber(luaState, -1));
-                    lua_pop(luaState, 4);
-                    lastTime = tjd;
-                }
-                else
-                {
-                    // Function call failed for some reason
-                    GetLogger()->warn("ScriptedRotation failed: {}\n", lua_tostring(luaState, -1));
-                    lua_pop(luaState, 1);
-                }
-            }
-            else
-            {
-                // Bad orientation function
-                lua_pop(luaState, 1);
+                lastOrientation = orientation;
+                lastTime = tjd;
             }
         }
         else
         {
-            // The script rotation object disappeared. OOPS.
+            // Function call failed for some reason
+            if (!CacheBypass::active())
+                GetLogger()->warn("ScriptedRotation failed: {}\n", lua_tostring(luaState, -1));
+            lua_pop(luaState, 1);
         }
-
-        // Pop the script rotation object
-        lua_pop(luaState, 1);
     }
 
-    return lastOrientation;
+    return orientation;
+}
+
+
+bool
+ScriptedRotation::isThreadSafe() const
+{
+    return luaObject->isThreadSafe();
 }
 
 
@@ -170,6 +166,10 @@ ScriptedRotation::getValidRange(double& begin, double& end) const
  *      orientation(time) - The orientation function takes a time value as
  *         input (TDB Julian day) and returns three values which are the the
  *         quaternion (w, x, y, z).
+ *
+ *  The factory function is called again, in a separate Lua state, for each
+ *  worker thread that evaluates the rotation. This only works for factories
+ *  defined in a module.
  */
 std::unique_ptr<RotationModel>
 CreateScriptedRotation(const std::string* moduleName,
@@ -184,72 +184,13 @@ CreateScriptedRotation(const std::string* moduleName,
         return nullptr;
     }
 
-    if (moduleName != nullptr && !moduleName->empty())
-    {
-        lua_getglobal(luaState, "require");
-        if (!lua_isfunction(luaState, -1))
-        {
-            GetLogger()->error("Cannot load ScriptedRotation package: 'require' function is unavailable\n");
-            lua_pop(luaState, 1);
-            return nullptr;
-        }
-
-        lua_pushstring(luaState, moduleName->c_str());
-        if (lua_pcall(luaState, 1, 1, 0) != 0)
-        {
-            GetLogger()->error("Failed to load module for ScriptedRotation: {}\n", lua_tostring(luaState, -1));
-            lua_pop(luaState, 1);
-            return nullptr;
-        }
-    }
-
-    // Get the rotation generator function
-    lua_getglobal(luaState, funcName.c_str());
-
-    if (lua_isfunction(luaState, -1) == 0)
-    {
-        // No function with the requested name; pop whatever value we
-        // did receive along with the table of arguments.
-        lua_pop(luaState, 1);
-        GetLogger()->error("No Lua function named {} found.\n", funcName);
+    auto luaObject = ScriptedObject::create(luaState, moduleName, funcName,
+                                            parameters, path, "ScriptedRotation",
+                                            { "orientation", nullptr });
+    if (luaObject == nullptr)
         return nullptr;
-    }
-
-    // Construct the table that we'll pass to the rotation generator function
-    lua_newtable(luaState);
-
-    SetLuaVariables(luaState, parameters);
-    // set the addon path
-    {
-        std::string pathStr = path.string();
-        lua_pushstring(luaState, "AddonPath");
-        lua_pushstring(luaState, pathStr.c_str());
-        lua_settable(luaState, -3);
-    }
-
-    // Call the generator function
-    if (lua_pcall(luaState, 1, 1, 0) != 0)
-    {
-        // Some sort of error occurred--the error message is atop the stack
-        GetLogger()->error("Error calling ScriptedRotation generator function: {}\n",
-                           lua_tostring(luaState, -1));
-        lua_pop(luaState, 1);
-        return nullptr;
-    }
-
-    if (lua_istable(luaState, -1) == 0)
-    {
-        // We have an object, but it's not a table. Pop it off the
-        // stack and report failure.
-        GetLogger()->error("ScriptedRotation generator function returned bad value.\n");
-        lua_pop(luaState, 1);
-        return nullptr;
-    }
-    std::string luaRotationObjectName = GenerateScriptObjectName();
 
-    // Attach the name to the script rotation
-    lua_pushvalue(luaState, -1); // dup the rotation object on top of stack
-    lua_setglobal(luaState, luaRotationObjectName.c_str());
+    luaObject->pushObject();
 
     // Get the rest of the rotation parameters; they are all optional.
     double period          = SafeGetLuaNumber(luaState, -1, "period", 0.0);
@@ -266,8 +207,7 @@ CreateScriptedRotation(const std::string* moduleName,
         return nullptr;
     }
 
-    return std::make_unique<ScriptedRotation>(luaState,
-                                              std::move(luaRotationObjectName),
+    return std::make_unique<ScriptedRotation>(std::move(luaObject),
                                               period,
                                               validRangeBegin,
                                               validRangeEnd);
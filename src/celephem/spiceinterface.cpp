@@ -11,11 +11,14 @@
 
 #include "spiceinterface.h"
 
+#include <fstream>
 #include <set>
+#include <utility>
 
 #include <SpiceUsr.h>
 
 #include <celutil/logger.h>
+#include <celutil/taskscheduler.h>
 
 using celestia::util::GetLogger;
 
@@ -36,6 +39,8 @@ ResidentKernelsSet* getResidentKernelsSet()
     return residentKernelsSet;
 }
 
+std::mutex spiceMutex;
+
 } // end unnamed namespace
 
 /*! Perform one-time initialization of SPICE.
@@ -45,12 +50,20 @@ InitializeSpice()
 {
     // Set the error behavior to the RETURN action, so that
     // Celestia do its own handling of SPICE errors.
+    auto lock = LockSpice();
     erract_c("SET", 0, (SpiceChar*)"RETURN");
 
     return true;
 }
 
 
+std::unique_lock<std::mutex>
+LockSpice()
+{
+    return std::unique_lock<std::mutex>(spiceMutex);
+}
+
+
 /*! Convert an object name to a NAIF integer ID. Return true if the name
  *  refers to a known object, false if not. Both names and numeric IDs are
  *  accepted in the string.
@@ -117,4 +130,73 @@ bool LoadSpiceKernel(const fs::path& filepath)
      return true;
 }
 
+
+DeferredSpiceKernels::DeferredSpiceKernels(std::function<bool()>&& init) :
+    m_shared(std::make_shared<Shared>())
+{
+    m_shared->init = std::move(init);
+}
+
+
+DeferredSpiceKernels::~DeferredSpiceKernels()
+{
+    // Waits for a running load, which calls back into the model
+    std::scoped_lock lock(m_shared->mutex);
+    m_shared->init = nullptr;
+}
+
+
+bool
+DeferredSpiceKernels::addKernel(fs::path&& filepath)
+{
+    // Catch missing kernels while the catalog is parsed, so that a fallback
+    // definition can be used instead
+    if (!std::ifstream(filepath, std::ios::in | std::ios::binary).good())
+    {
+        GetLogger()->error("SPICE kernel {} is missing or unreadable\n", filepath);
+        return false;
+    }
+
+    m_shared->kernels.push_back(std::move(filepath));
+    return true;
+}
+
+
+bool
+DeferredSpiceKernels::ready() const
+{
+    State state = m_shared->state.load(std::memory_order_acquire);
+    if (state == State::Ready)
+        return true;
+
+    if (state != State::Pending ||
+        !m_shared->state.compare_exchange_strong(state, State::Loading, std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    util::GetTaskScheduler().detach([shared = m_shared]
+    {
+        auto spiceLock = LockSpice();
+        std::scoped_lock lock(shared->mutex);
+        if (!shared->init)
+            return;
+
+        bool loaded = true;
+        for (const fs::path& kernel : shared->kernels)
+        {
+            if (!LoadSpiceKernel(kernel))
+            {
+                loaded = false;
+                break;
+            }
+        }
+
+        loaded = loaded && shared->init();
+        shared->state.store(loaded ? State::Ready : State::Failed, std::memory_order_release);
+    });
+
+    return false;
+}
+
 } // end namespace celestia::ephem
@@ -11,7 +11,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <celcompat/filesystem.h>
 
@@ -20,9 +25,60 @@ namespace celestia::ephem
 
 bool InitializeSpice();
 
+/*! SPICE keeps its kernel pool and error state in globals, so every call
+ *  into the toolkit must be made while holding this lock. This includes
+ *  the utility functions below.
+ */
+std::unique_lock<std::mutex> LockSpice();
+
 // SPICE utility functions
 
 bool GetNaifId(const std::string& name, int* id);
 bool LoadSpiceKernel(const fs::path& filepath);
 
+/*! Kernels required by a SPICE orbit or rotation model. Parsing a catalog
+ *  only records their paths; the kernels are furnished on a background
+ *  thread the first time the model is evaluated, followed by the init
+ *  function of the model, so that loading large kernels doesn't stall
+ *  catalog loading. Only the presence of the kernel files is checked
+ *  when they are added. The model should return a placeholder until
+ *  ready() is true.
+ */
+class DeferredSpiceKernels
+{
+ public:
+    explicit DeferredSpiceKernels(std::function<bool()>&& init);
+    ~DeferredSpiceKernels();
+
+    DeferredSpiceKernels(const DeferredSpiceKernels&) = delete;
+    DeferredSpiceKernels& operator=(const DeferredSpiceKernels&) = delete;
+
+    //! Record a kernel to load, returning false if the file can't be read
+    bool addKernel(fs::path&& filepath);
+
+    //! Start loading if it hasn't been started yet and return true once
+    //! the kernels are loaded and the model was initialized successfully.
+    bool ready() const;
+
+ private:
+    enum class State
+    {
+        Pending,
+        Loading,
+        Ready,
+        Failed,
+    };
+
+    // Shared with the loading task, which may outlive the model
+    struct Shared
+    {
+        std::mutex mutex;
+        std::function<bool()> init;
+        std::vector<fs::path> kernels;
+        std::atomic<State> state{ State::Pending };
+    };
+
+    std::shared_ptr<Shared> m_shared;
+};
+
 }
@@ -28,6 +28,10 @@ namespace
 
 constexpr double MILLISEC = astro::secsToDays(0.001);
 
+// Valid interval used for the coverage window until it is known
+constexpr double UnboundedBeginning = -1.0e50;
+constexpr double UnboundedEnding    = +1.0e50;
+
 } // end unnamed namespace
 
 /*! Create a new SPICE orbit using with a valid interval specified
@@ -44,9 +48,12 @@ SpiceOrbit::SpiceOrbit(std::string  _targetBodyName,
     period(_period),
     boundingRadius(_boundingRadius),
     spiceErr(false),
+    beginning(_beginning),
+    ending(_ending),
     validIntervalBegin(_beginning),
     validIntervalEnd(_ending),
-    useDefaultTimeInterval(false)
+    useDefaultTimeInterval(false),
+    kernels([this] { return init(); })
 {
 }
 
@@ -67,9 +74,12 @@ SpiceOrbit::SpiceOrbit(std::string  _targetBodyName,
     period(_period),
     boundingRadius(_boundingRadius),
     spiceErr(false),
+    beginning(UnboundedBeginning),
+    ending(UnboundedEnding),
     validIntervalBegin(0.0),
     validIntervalEnd(0.0),
-    useDefaultTimeInterval(true)
+    useDefaultTimeInterval(true),
+    kernels([this] { return init(); })
 {
 }
 
@@ -87,23 +97,16 @@ SpiceOrbit::getPeriod() const
     if (isPeriodic())
         return period;
 
-    return validIntervalEnd - validIntervalBegin;
-}
-
-
-bool
-SpiceOrbit::loadRequiredKernel(const fs::path& path, const std::string& kernel)
-{
-    // Load required kernel file
-    fs::path filepath = path / "data" / kernel;
-    if (LoadSpiceKernel(filepath))
-        return true;
-
-    spiceErr = true;
-    return false;
+    double begin = 0.0;
+    double end = 0.0;
+    getValidRange(begin, end);
+    return end - begin;
 }
 
 
+/*! Find the NAIF IDs and the coverage window of the target. Called on the
+ *  loading thread with the SPICE lock held, after the kernels are loaded.
+ */
 bool
 SpiceOrbit::init()
 {
@@ -170,8 +173,8 @@ SpiceOrbit::init()
     {
         // Set the valid time interval for this orbit to the first interval
         // in the coverage window for the target.
-        SpiceDouble targetBeginning = -1.0e50;
-        SpiceDouble targetEnding    = +1.0e50;
+        SpiceDouble targetBeginning = UnboundedBeginning;
+        SpiceDouble targetEnding    = UnboundedEnding;
 
         if (targetID == 0)
         {
@@ -197,8 +200,8 @@ SpiceOrbit::init()
     else
     {
         // Reduce valid interval by a millisecond at each end.
-        validIntervalBegin += MILLISEC;
-        validIntervalEnd -= MILLISEC;
+        validIntervalBegin = beginning + MILLISEC;
+        validIntervalEnd = ending - MILLISEC;
 
         SpiceDouble beginningSecondsJ2000 = astro::daysToSecs(validIntervalBegin - astro::J2000);
         SpiceDouble endingSecondsJ2000    = astro::daysToSecs(validIntervalEnd - astro::J2000);
@@ -217,10 +220,10 @@ SpiceOrbit::init()
     // relative to the origin. Even if both objects are present and have
     // adequate coverage, it's possible that there might be a missing frame
     // definition or itermediate object.
-    double beginning = astro::daysToSecs(validIntervalBegin - astro::J2000);
+    double beginningSecs = astro::daysToSecs(validIntervalBegin - astro::J2000);
     double position[3];
     double lt = 0.0;
-    spkgps_c(targetID, beginning, "eclipj2000", originID,
+    spkgps_c(targetID, beginningSecs, "eclipj2000", originID,
              position, &lt);
     if (failed_c())
     {
@@ -238,19 +241,42 @@ SpiceOrbit::init()
 
 
 Eigen::Vector3d
-SpiceOrbit::computePosition(double jd) const
+SpiceOrbit::positionAtTime(double jd) const
 {
-    if (jd < validIntervalBegin)
-        jd = validIntervalBegin;
-    else if (jd > validIntervalEnd)
-        jd = validIntervalEnd;
+    // Don't cache the placeholder position
+    if (!kernels.ready())
+        return fallback == nullptr ? Eigen::Vector3d::Zero() : fallback->positionAtTime(jd);
 
-    if (spiceErr)
+    return CachingOrbit::positionAtTime(jd);
+}
+
+
+Eigen::Vector3d
+SpiceOrbit::velocityAtTime(double jd) const
+{
+    if (!kernels.ready())
+        return fallback == nullptr ? Eigen::Vector3d::Zero() : fallback->velocityAtTime(jd);
+
+    return CachingOrbit::velocityAtTime(jd);
+}
+
+
+Eigen::Vector3d
+SpiceOrbit::computePosition(double jd) const
+{
+    if (!kernels.ready())
     {
         return Eigen::Vector3d::Zero();
     }
     else
     {
+        if (jd < validIntervalBegin)
+            jd = validIntervalBegin;
+        else if (jd > validIntervalEnd)
+            jd = validIntervalEnd;
+
+        auto lock = LockSpice();
+
         // Input time for SPICE is seconds after J2000
         double t = astro::daysToSecs(jd - astro::J2000);
         double position[3];
@@ -285,17 +311,19 @@ SpiceOrbit::computePosition(double jd) const
 Eigen::Vector3d
 SpiceOrbit::computeVelocity(double jd) const
 {
-    if (jd < validIntervalBegin)
-        jd = validIntervalBegin;
-    else if (jd > validIntervalEnd)
-        jd = validIntervalEnd;
-
-    if (spiceErr)
+    if (!kernels.ready())
     {
         return Eigen::Vector3d::Zero();
     }
     else
     {
+        if (jd < validIntervalBegin)
+            jd = validIntervalBegin;
+        else if (jd > validIntervalEnd)
+            jd = validIntervalEnd;
+
+        auto lock = LockSpice();
+
         // Input time for SPICE is seconds after J2000
         double t = astro::daysToSecs(jd - astro::J2000);
         double state[6];
@@ -328,10 +356,33 @@ SpiceOrbit::computeVelocity(double jd) const
 }
 
 
+void
+SpiceOrbit::sample(double startTime, double endTime, OrbitSampleProc& proc) const
+{
+    // No path is drawn until the trajectory is loaded, not even that of the
+    // fallback, because the renderer keeps the plot once it has one
+    if (kernels.ready())
+        CachingOrbit::sample(startTime, endTime, proc);
+}
+
+
 void SpiceOrbit::getValidRange(double& begin, double& end) const
 {
-    begin = validIntervalBegin;
-    end = validIntervalEnd;
+    if (kernels.ready())
+    {
+        begin = validIntervalBegin;
+        end = validIntervalEnd;
+    }
+    else if (fallback != nullptr && useDefaultTimeInterval)
+    {
+        // Coverage of the kernels isn't known yet
+        fallback->getValidRange(begin, end);
+    }
+    else
+    {
+        begin = beginning;
+        end = ending;
+    }
 }
 
 }
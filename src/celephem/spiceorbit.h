@@ -17,6 +17,7 @@
 
 #include <celcompat/filesystem.h>
 #include "orbit.h"
+#include "spiceinterface.h"
 
 namespace celestia::ephem
 {
@@ -36,18 +37,27 @@ class SpiceOrbit : public CachingOrbit
                double _boundingRadius);
     ~SpiceOrbit() override = default;
 
+    /*! Record the kernels required by the orbit, relative to the add-on
+     *  path. They are loaded in the background when the orbit is first
+     *  evaluated. Returns false if a kernel file can't be read.
+     */
     template<typename It>
-    bool init(const fs::path& path, It begin, It end)
+    bool addKernels(const fs::path& path, It begin, It end)
     {
-        // Load required kernel files
         while (begin != end)
         {
-            if (!loadRequiredKernel(path, *(begin++)))
+            if (!kernels.addKernel(path / "data" / *(begin++)))
                 return false;
         }
-        return init();
+        return true;
     }
 
+    /*! Set the orbit used until the kernels are loaded, or if they fail to
+     *  load. Without one the target stays at the origin. Like the other
+     *  orbits of a body it isn't owned.
+     */
+    void setFallback(const Orbit* orbit) { fallback = orbit; }
+
     bool isPeriodic() const override;
     double getPeriod() const override;
 
@@ -56,11 +66,17 @@ class SpiceOrbit : public CachingOrbit
         return boundingRadius;
     }
 
+    Eigen::Vector3d positionAtTime(double jd) const override;
+    Eigen::Vector3d velocityAtTime(double jd) const override;
     Eigen::Vector3d computePosition(double jd) const override;
     Eigen::Vector3d computeVelocity(double jd) const override;
+    void sample(double startTime, double endTime, OrbitSampleProc& proc) const override;
 
     void getValidRange(double& begin, double& end) const override;
 
+    // The SPICE toolkit keeps global state and may not be called concurrently
+    bool isThreadSafe() const override { return false; }
+
  private:
     const std::string targetBodyName;
     const std::string originName;
@@ -72,13 +88,19 @@ class SpiceOrbit : public CachingOrbit
     int targetID;
     int originID;
 
+    // Valid interval given in the catalog, also reported while loading
+    double beginning;
+    double ending;
+
     double validIntervalBegin;
     double validIntervalEnd;
 
     bool useDefaultTimeInterval;
 
+    DeferredSpiceKernels kernels;
+    const Orbit* fallback{ nullptr };
+
     bool init();
-    bool loadRequiredKernel(const fs::path&, const std::string&);
 };
 
 }
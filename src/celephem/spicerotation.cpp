@@ -53,7 +53,8 @@ SpiceRotation::SpiceRotation(const std::string& frameName,
     m_spiceErr(false),
     m_validIntervalBegin(beginning),
     m_validIntervalEnd(ending),
-    m_useDefaultTimeInterval(false)
+    m_useDefaultTimeInterval(false),
+    m_kernels([this] { return init(); })
 {
 }
 
@@ -75,7 +76,8 @@ SpiceRotation::SpiceRotation(const std::string& frameName,
     m_spiceErr(false),
     m_validIntervalBegin(-std::numeric_limits<double>::infinity()),
     m_validIntervalEnd(std::numeric_limits<double>::infinity()),
-    m_useDefaultTimeInterval(true)
+    m_useDefaultTimeInterval(true),
+    m_kernels([this] { return init(); })
 {
 }
 
@@ -97,29 +99,15 @@ SpiceRotation::getPeriod() const
 }
 
 
-bool
-SpiceRotation::loadRequiredKernel(const fs::path& path,
-                                  const std::string& kernel)
-{
-    fs::path filepath = path / "data" / kernel;
-    if (LoadSpiceKernel(filepath))
-        return true;
-
-    m_spiceErr = true;
-    return false;
-}
-
-
+/*! Check that the frame is available. Called on the loading thread with the
+ *  SPICE lock held, after the kernels are loaded.
+ */
 bool
 SpiceRotation::init()
 {
-    // Reduce valid interval by a millisecond at each end.
-    m_validIntervalBegin += MILLISEC;
-    m_validIntervalEnd -= MILLISEC;
-
     // Test getting the frame rotation matrix to make sure that there's
     // adequate data in the kernel.
-    double beginning = astro::daysToSecs(m_validIntervalBegin - astro::J2000);
+    double beginning = astro::daysToSecs(m_validIntervalBegin + MILLISEC - astro::J2000);
     double xform[3][3];
     pxform_c(m_frameName.c_str(), m_frameName.c_str(), beginning, xform);
     if (failed_c())
@@ -137,20 +125,54 @@ SpiceRotation::init()
 }
 
 
+Eigen::Quaterniond
+SpiceRotation::spin(double jd) const
+{
+    // Don't cache the placeholder orientation
+    if (!m_kernels.ready())
+        return m_fallback == nullptr ? Eigen::Quaterniond::Identity() : m_fallback->spin(jd);
+
+    return CachingRotationModel::spin(jd);
+}
+
+
+Eigen::Quaterniond
+SpiceRotation::equatorOrientationAtTime(double jd) const
+{
+    if (!m_kernels.ready() && m_fallback != nullptr)
+        return m_fallback->equatorOrientationAtTime(jd);
+
+    return CachingRotationModel::equatorOrientationAtTime(jd);
+}
+
+
+Eigen::Vector3d
+SpiceRotation::angularVelocityAtTime(double jd) const
+{
+    if (!m_kernels.ready())
+        return m_fallback == nullptr ? Eigen::Vector3d::Zero() : m_fallback->angularVelocityAtTime(jd);
+
+    return CachingRotationModel::angularVelocityAtTime(jd);
+}
+
+
 Eigen::Quaterniond
 SpiceRotation::computeSpin(double jd) const
 {
-    if (jd < m_validIntervalBegin)
-        jd = m_validIntervalBegin;
-    else if (jd > m_validIntervalEnd)
-        jd = m_validIntervalEnd;
+    // Reduce valid interval by a millisecond at each end.
+    if (jd < m_validIntervalBegin + MILLISEC)
+        jd = m_validIntervalBegin + MILLISEC;
+    else if (jd > m_validIntervalEnd - MILLISEC)
+        jd = m_validIntervalEnd - MILLISEC;
 
-    if (m_spiceErr)
+    if (!m_kernels.ready())
     {
         return Eigen::Quaterniond::Identity();
     }
     else
     {
+        auto lock = LockSpice();
+
         // Input time for SPICE is seconds after J2000
         double t = astro::daysToSecs(jd - astro::J2000);
         double xform[3][3];
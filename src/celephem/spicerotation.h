@@ -18,6 +18,7 @@
 
 #include <celcompat/filesystem.h>
 #include "rotation.h"
+#include "spiceinterface.h"
 
 namespace celestia::ephem
 {
@@ -35,19 +36,27 @@ class SpiceRotation : public CachingRotationModel
                   double period);
     virtual ~SpiceRotation() = default;
 
+    /*! Record the kernels required by the rotation model, relative to the
+     *  add-on path. They are loaded in the background when the model is
+     *  first evaluated. Returns false if a kernel file can't be read.
+     */
     template<typename It>
-    bool init(const fs::path& path, It begin, It end)
+    bool addKernels(const fs::path& path, It begin, It end)
     {
-        // Load required kernel files
         while (begin != end)
         {
-            if (!loadRequiredKernel(path, *(begin++)))
+            if (!m_kernels.addKernel(path / "data" / *(begin++)))
                 return false;
         }
-
-        return init();
+        return true;
     }
 
+    /*! Set the rotation model used until the kernels are loaded, or if they
+     *  fail to load. Without one the orientation is the identity. Like the
+     *  other rotation models of a body it isn't owned.
+     */
+    void setFallback(const RotationModel* rotationModel) { m_fallback = rotationModel; }
+
     bool isPeriodic() const override;
     double getPeriod() const override;
 
@@ -57,8 +66,14 @@ class SpiceRotation : public CachingRotationModel
         return Eigen::Quaterniond::Identity();
     }
 
+    Eigen::Quaterniond spin(double jd) const override;
+    Eigen::Quaterniond equatorOrientationAtTime(double jd) const override;
+    Eigen::Vector3d angularVelocityAtTime(double jd) const override;
     Eigen::Quaterniond computeSpin(double jd) const override;
 
+    // The SPICE toolkit keeps global state and may not be called concurrently
+    bool isThreadSafe() const override { return false; }
+
  private:
     const std::string m_frameName;
     const std::string m_baseFrameName;
@@ -68,7 +83,9 @@ class SpiceRotation : public CachingRotationModel
     double m_validIntervalEnd;
     bool m_useDefaultTimeInterval;
 
-    bool loadRequiredKernel(const fs::path&, const std::string&);
+    DeferredSpiceKernels m_kernels;
+    const RotationModel* m_fallback{ nullptr };
+
     bool init();
 };
 
@@ -47,6 +47,8 @@
 #include <celutil/formatnum.h>
 #include <celutil/fsutils.h>
 #include <celutil/logger.h>
+#include <celutil/memoryusage.h>
+#include <celutil/taskscheduler.h>
 #include <celutil/gettext.h>
 #include <celutil/utf8.h>
 #include <celcompat/filesystem.h>
@@ -235,6 +237,7 @@ CelestiaCore::CelestiaCore() :
     m_scriptMaps(new ScriptMaps()),
     oldFOV(stdFOV),
     dateFormatter(std::make_unique<celestia::engine::DateFormatter>()),
+    routePreloader(std::make_unique<RoutePreloader>(*renderer)),
     console(new Console(*renderer, 200, 120)),
     m_tee(std::cout, std::cerr)
 {
@@ -259,9 +262,14 @@ CelestiaCore::~CelestiaCore()
     if (movieCapture != nullptr)
         recordEnd();
 
+    // The shared context is destroyed with the frontend's one
+    GetGLUploader().stopThread();
+
     delete timer;
     delete renderer;
 
+    celestia::util::DestroyTaskScheduler();
+
     if (m_logfile.good())
         m_logfile.close();
 
@@ -2129,11 +2137,35 @@ void CelestiaCore::tick(double dt)
         m_scriptHook->call("tick", dt);
 
     sim->update(dt);
+
+    // Load what the view will show at the end of a goto while travelling
+    if (const Observer& observer = sim->getObserver(); !observer.getJourneyDestination().empty())
+    {
+        routePreloader->preload(observer.getJourneyDestination(),
+                                observer.getJourneyEndPosition(),
+                                sim->getTime(),
+                                observer.getArrivalTime() - observer.getRealTime(),
+                                observer.getFOV());
+    }
+
+    if (config->memoryLogInterval > 0.0 && sysTime - memoryLogTime >= config->memoryLogInterval)
+    {
+        memoryLogTime = sysTime;
+        GetLogger()->verbose("Memory usage: {}\n", FormatMemoryUsage());
+    }
 }
 
 
 void CelestiaCore::draw()
 {
+    // Create preloaded resources and continue texture uploads here rather
+    // than in tick(), as the frontends only make the GL context current for
+    // drawing. Each frame makes at least one upload step.
+    routePreloader->update();
+    constexpr float MiB = 1024.0f * 1024.0f;
+    auto uploadBudget = static_cast<std::size_t>(std::max(config->renderDetails.textureUploadBudget * MiB, 1.0f));
+    GetGLUploader().update(uploadBudget);
+
     if (!viewUpdateRequired())
         return;
     viewChanged = false;
@@ -2518,6 +2550,16 @@ Renderer* CelestiaCore::getRenderer() const
     return renderer;
 }
 
+RoutePreloader* CelestiaCore::getRoutePreloader() const
+{
+    return routePreloader.get();
+}
+
+bool CelestiaCore::setSharedGLContext(std::unique_ptr<SharedGLContext>&& context)
+{
+    return GetGLUploader().startThread(std::move(context));
+}
+
 Simulation* CelestiaCore::getSimulation() const
 {
     return sim;
@@ -3788,6 +3830,8 @@ bool CelestiaCore::initSimulation(const fs::path& configFileName,
     if (config->consoleLogRows > 100)
         console->setRowCount(config->consoleLogRows);
 
+    celestia::util::CreateTaskScheduler(config->workerThreads);
+
     if (!config->paths.leapSecondsFile.empty())
         ReadLeapSecondsFile(config->paths.leapSecondsFile, leapSeconds);
 
@@ -3897,9 +3941,40 @@ bool CelestiaCore::initSimulation(const fs::path& configFileName,
 
 
     /***** Load the solar system catalogs *****/
-    // First read the solar system files listed individually in the
-    // config file.
     universe->setSolarSystemCatalog(std::make_unique<SolarSystemCatalog>());
+
+    // Minor body catalogs are read first so that solar system catalogs
+    // can modify their objects.
+    if (!config->paths.minorBodyFiles.empty())
+    {
+        if (Star* sun = universe->find("Sol", {}).star(); sun == nullptr)
+        {
+            GetLogger()->error(_("Sun not found, minor body catalogs not loaded.\n"));
+        }
+        else
+        {
+            auto minorBodies = std::make_unique<MinorBodyCatalog>(sun);
+            for (const auto& file : config->paths.minorBodyFiles)
+            {
+                if (progressNotifier)
+                    progressNotifier->update(file.string());
+
+                std::ifstream minorBodyFile(file, std::ios::in);
+                if (!minorBodyFile.good())
+                {
+                    GetLogger()->error(_("Error opening minor body catalog {}.\n"), file);
+                    continue;
+                }
+
+                std::size_t count = LoadMPCOrbitElements(minorBodyFile, *minorBodies);
+                GetLogger()->info(_("Loaded {} minor bodies from {}\n"), count, file);
+            }
+            minorBodies->finish();
+            universe->setMinorBodyCatalog(std::move(minorBodies));
+        }
+    }
+
+    // Read the solar system files listed individually in the config file.
     for (const auto& file : config->paths.solarSystemFiles)
     {
         if (progressNotifier)
@@ -4110,6 +4185,17 @@ bool CelestiaCore::initRenderer([[maybe_unused]] bool useMesaPackInvert)
     detailOptions.orbitWindowEnd = config->renderDetails.orbitWindowEnd;
     detailOptions.orbitPeriodsShown = config->renderDetails.orbitPeriodsShown;
     detailOptions.linearFadeFraction = config->renderDetails.linearFadeFraction;
+    detailOptions.orbitLookaheadFrames = config->renderDetails.orbitLookaheadFrames;
+
+    const std::string& depthBuffer = config->renderDetails.depthBuffer;
+    if (compareIgnoringCase(depthBuffer, "partitioned") == 0)
+        detailOptions.depthBufferMode = Renderer::DepthBufferMode::Partitioned;
+    else if (compareIgnoringCase(depthBuffer, "logarithmic") == 0)
+        detailOptions.depthBufferMode = Renderer::DepthBufferMode::Logarithmic;
+    else if (compareIgnoringCase(depthBuffer, "reversez") == 0)
+        detailOptions.depthBufferMode = Renderer::DepthBufferMode::ReverseZ;
+    else if (!depthBuffer.empty() && compareIgnoringCase(depthBuffer, "auto") != 0)
+        GetLogger()->warn("Unknown depth buffer mode {}\n", depthBuffer);
 #ifndef GL_ES
     detailOptions.useMesaPackInvert = useMesaPackInvert;
 #endif
@@ -4270,7 +4356,9 @@ bool CelestiaCore::readStars(const CelestiaConfig& cfg,
         }
     }
 
-    universe->setStarCatalog(starDBBuilder.finish());
+    auto starDB = starDBBuilder.finish();
+    starDB->setMotionWindow(cfg.starMotionWindow * DAYS_PER_YEAR);
+    universe->setStarCatalog(std::move(starDB));
     return true;
 }
 
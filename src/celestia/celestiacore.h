@@ -25,6 +25,8 @@
 #include <celengine/texture.h>
 #include <celengine/universe.h>
 #include <celengine/render.h>
+#include <celengine/routepreloader.h>
+#include <celengine/glupload.h>
 #include <celengine/simulation.h>
 #include <celengine/overlayimage.h>
 #include <celengine/viewporteffect.h>
@@ -229,6 +231,12 @@ class CelestiaCore // : public Watchable<CelestiaCore>
                         const std::vector<fs::path>& extrasDirs = {},
                         ProgressNotifier* progressNotifier = nullptr);
     bool initRenderer(bool useMesaPackInvert = true);
+    /*! Upload textures on a thread of their own using a context sharing
+     *  objects with the render context. Frontends call it after
+     *  initRenderer(); without it, uploads are time-sliced on the render
+     *  thread.
+     */
+    bool setSharedGLContext(std::unique_ptr<celestia::engine::SharedGLContext>&& context);
     void start(double t);
     void start();
     void getLightTravelDelay(double distanceKm, int&, int&, float&);
@@ -267,6 +275,7 @@ class CelestiaCore // : public Watchable<CelestiaCore>
 
     Simulation* getSimulation() const;
     Renderer* getRenderer() const;
+    RoutePreloader* getRoutePreloader() const;
     void showText(std::string_view s,
                   int horig = 0, int vorig = 0,
                   int hoff = 0, int voff = 0,
@@ -542,6 +551,7 @@ class CelestiaCore // : public Watchable<CelestiaCore>
 
     double sysTime{ 0.0 };
     double currentTime{ 0.0 };
+    double memoryLogTime{ 0.0 };
 
     bool viewChanged{ true };
 
@@ -566,6 +576,7 @@ class CelestiaCore // : public Watchable<CelestiaCore>
     CursorShape defaultCursorShape{ CelestiaCore::CrossCursor };
     ContextMenuHandler* contextMenuHandler{ nullptr };
     std::unique_ptr<celestia::engine::DateFormatter> dateFormatter;
+    std::unique_ptr<RoutePreloader> routePreloader;
 
     std::vector<Url> history;
     std::vector<Url>::size_type historyCurrent{ 0 };
@@ -135,6 +135,7 @@ applyPaths(CelestiaConfig::Paths& paths, const Hash& hash)
     applyPath(paths.starDatabaseFile, hash, "StarDatabase"sv);
     applyPath(paths.starNamesFile, hash, "StarNameDatabase"sv);
     applyPathArray(paths.solarSystemFiles, hash, "SolarSystemCatalogs"sv);
+    applyPathArray(paths.minorBodyFiles, hash, "MinorBodyCatalogs"sv);
     applyPathArray(paths.starCatalogFiles, hash, "StarCatalogs"sv);
     applyPathArray(paths.dsoCatalogFiles, hash, "DeepSkyCatalogs"sv);
     applyPathArray(paths.extrasDirs, hash, "ExtrasDirectories"sv);
@@ -182,6 +183,7 @@ applyRenderDetails(CelestiaConfig::RenderDetails& renderDetails, const Hash& has
     applyNumber(renderDetails.orbitWindowEnd, hash, "OrbitWindowEnd"sv);
     applyNumber(renderDetails.orbitPeriodsShown, hash, "OrbitPeriodsShown"sv);
     applyNumber(renderDetails.linearFadeFraction, hash, "LinearFadeFraction"sv);
+    applyNumber(renderDetails.orbitLookaheadFrames, hash, "OrbitLookaheadFrames"sv);
     applyNumber(renderDetails.faintestVisible, hash, "FaintestVisibleMagnitude"sv);
     applyNumber(renderDetails.shadowTextureSize, hash, "ShadowTextureSize"sv);
     applyNumber(renderDetails.eclipseTextureSize, hash, "EclipseTextureSize"sv);
@@ -190,6 +192,8 @@ applyRenderDetails(CelestiaConfig::RenderDetails& renderDetails, const Hash& has
     applyNumber(renderDetails.SolarSystemMaxDistance, hash, "SolarSystemMaxDistance"sv);
     renderDetails.SolarSystemMaxDistance = std::clamp(renderDetails.SolarSystemMaxDistance, 1.0f, 10.0f);
     applyNumber(renderDetails.ShadowMapSize, hash, "ShadowMapSize"sv);
+    applyString(renderDetails.depthBuffer, hash, "DepthBuffer"sv);
+    applyNumber(renderDetails.textureUploadBudget, hash, "TextureUploadBudget"sv);
     applyStringArray(renderDetails.ignoreGLExtensions, hash, "IgnoreGLExtensions"sv);
 }
 
@@ -281,6 +285,9 @@ bool ReadCelestiaConfig(const fs::path& filename, CelestiaConfig& config)
     applyString(config.scriptSystemAccessPolicy, *configParams, "ScriptSystemAccessPolicy"sv);
 
     applyNumber(config.consoleLogRows, *configParams, "LogSize"sv);
+    applyNumber(config.workerThreads, *configParams, "WorkerThreads"sv);
+    applyNumber(config.starMotionWindow, *configParams, "StarMotionWindow"sv);
+    applyNumber(config.memoryLogInterval, *configParams, "MemoryLogInterval"sv);
 
 #ifdef CELX
     // Move the value into the config object to retain ownership of the hash
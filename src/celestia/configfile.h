@@ -26,6 +26,7 @@ struct CelestiaConfig
         fs::path starDatabaseFile{ };
         fs::path starNamesFile{ };
         std::vector<fs::path> solarSystemFiles{ };
+        std::vector<fs::path> minorBodyFiles{ };
         std::vector<fs::path> starCatalogFiles{ };
         std::vector<fs::path> dsoCatalogFiles{ };
         std::vector<fs::path> extrasDirs{ };
@@ -67,6 +68,7 @@ struct CelestiaConfig
         double orbitWindowEnd{ 0.5 };
         double orbitPeriodsShown{ 1.0 };
         double linearFadeFraction{ 0.0 };
+        unsigned int orbitLookaheadFrames{ 30 };
         float faintestVisible{ 6.0f };
         unsigned int shadowTextureSize{ 256 };
         unsigned int eclipseTextureSize{ 128 };
@@ -74,6 +76,8 @@ struct CelestiaConfig
         unsigned int aaSamples{ 1 };
         float SolarSystemMaxDistance{ 1.0f };
         unsigned int ShadowMapSize{ 0 };
+        std::string depthBuffer{ };
+        float textureUploadBudget{ 16.0f };
         std::vector<std::string> ignoreGLExtensions{ };
     };
 
@@ -93,6 +97,13 @@ struct CelestiaConfig
     std::string scriptSystemAccessPolicy{ };
 
     unsigned int consoleLogRows{ 200 };
+    // Threads used by the task scheduler; 0 for all hardware threads
+    unsigned int workerThreads{ 0 };
+    // Years of proper motion after which the star octree bounds are
+    // recomputed
+    double starMotionWindow{ 1000.0 };
+    // Seconds between memory usage lines in the verbose log; 0 to disable
+    double memoryLogInterval{ 60.0 };
 
     std::string projectionMode{ };
     std::string viewportEffect{ };
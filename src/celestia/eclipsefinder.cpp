@@ -10,12 +10,15 @@
 // as published by the Free Software Foundation; either version 2
 // of the License, or (at your option) any later version.
 
-#include <cstring>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
 
 #include <Eigen/Geometry>
 
 #include <celengine/body.h>
+#include <celengine/timeline.h>
 #include <celmath/distance.h>
 #include <celmath/ray.h>
 #include "eclipsefinder.h"
@@ -202,23 +205,16 @@ void addEclipse(const Body& receiver, const Body& occulter,
     }
 }
 
-void EclipseFinder::findEclipses(double startDate,
-                                 double endDate,
-                                 int eclipseTypeMask,
-                                 vector<Eclipse>& eclipses)
+vector<Body*> EclipseFinder::getTestBodies() const
 {
-    PlanetarySystem* satellites = body->getSatellites();
+    vector<Body*> testBodies;
 
-    // See if there's anything that could test
+    PlanetarySystem* satellites = body->getSatellites();
     if (satellites == nullptr)
-        return;
-
-    // For each body, we'll need to store the time when the last eclipse ended
-    vector<double> previousEclipseEndTimes;
+        return testBodies;
 
     // Make a list of satellites that we'll actually test for eclipses; ignore
     // spacecraft and very small objects.
-    vector<Body*> testBodies;
     for (int i = 0; i < satellites->getSystemSize(); i++)
     {
         Body* obj = satellites->getBody(i);
@@ -226,16 +222,29 @@ void EclipseFinder::findEclipses(double startDate,
             obj->getRadius() >= body->getRadius() * MinRelativeOccluderRadius)
         {
             testBodies.push_back(obj);
-            previousEclipseEndTimes.push_back(startDate - 1.0);
         }
     }
 
+    return testBodies;
+}
+
+
+void EclipseFinder::findEclipses(double startDate,
+                                 double endDate,
+                                 int eclipseTypeMask,
+                                 vector<Eclipse>& eclipses)
+{
+    // Make a list of satellites that we'll actually test for eclipses
+    vector<Body*> testBodies = getTestBodies();
     if (testBodies.empty())
         return;
 
+    // For each body, we'll need to store the time when the last eclipse ended
+    vector<double> previousEclipseEndTimes(testBodies.size(), startDate - 1.0);
+
     // TODO: Use a fixed step of one hour for now; we should use a binary
     // search instead.
-    double searchStep = 1.0 / 24.0; // one hour
+    double searchStep = SearchStep;
 
     // Precision of eclipse duration calculation
     double durationPrecision = 1.0 / (24.0 * 360.0); // ten seconds
@@ -263,3 +272,129 @@ void EclipseFinder::findEclipses(double startDate,
         }
     }
 }
+
+
+// Return true if the position of the body can be computed from several
+// threads at once over the given time span. This covers the trajectories of
+// the body and of the objects its orbit frames are centered on, together
+// with the rotation of those objects, on which non-inertial frames depend.
+static bool isEphemerisThreadSafe(const Body& body, double startDate, double endDate)
+{
+    const Timeline* timeline = body.getTimeline();
+    for (unsigned int i = 0; i < timeline->phaseCount(); i++)
+    {
+        const auto& phase = timeline->getPhase(i);
+        if (phase->endTime() < startDate || phase->startTime() > endDate)
+            continue;
+
+        if (!phase->orbit()->isThreadSafe())
+            return false;
+
+        const Body* center = phase->orbitFrame()->getCenter().body();
+        if (center == nullptr)
+            continue;
+
+        if (!phase->orbitFrame()->isInertial())
+        {
+            const Timeline* centerTimeline = center->getTimeline();
+            for (unsigned int j = 0; j < centerTimeline->phaseCount(); j++)
+            {
+                if (!centerTimeline->getPhase(j)->rotationModel()->isThreadSafe())
+                    return false;
+            }
+        }
+
+        if (!isEphemerisThreadSafe(*center, startDate, endDate))
+            return false;
+    }
+
+    return true;
+}
+
+
+/*! Return true if findEclipses() may be called for disjoint parts of the
+ *  time range from several threads at once. Each of these threads must hold
+ *  a celestia::ephem::CacheBypass while searching. This is not possible when
+ *  one of the bodies involved has a scripted or SPICE trajectory.
+ */
+bool EclipseFinder::canSearchConcurrently(double startDate, double endDate) const
+{
+    // Eclipse durations are found by stepping past the ends of the range
+    double margin = 1.0;
+    startDate -= margin;
+    endDate += margin;
+
+    if (!isEphemerisThreadSafe(*body, startDate, endDate))
+        return false;
+
+    vector<Body*> testBodies = getTestBodies();
+    return std::all_of(testBodies.begin(), testBodies.end(),
+                       [&](const Body* b) { return isEphemerisThreadSafe(*b, startDate, endDate); });
+}
+
+
+/*! Split a search range into at most maxPartitions spans of at least minSpan
+ *  days each. Every span starts on a multiple of SearchStep from startDate,
+ *  so searching all of them tests the same times as a single search over the
+ *  whole range. The results must be merged with an EclipseMerger.
+ */
+std::vector<std::pair<double, double>>
+EclipseFinder::partitionSearch(double startDate,
+                               double endDate,
+                               double minSpan,
+                               int maxPartitions)
+{
+    std::vector<std::pair<double, double>> partitions;
+    if (endDate < startDate)
+        return partitions;
+
+    auto steps = static_cast<long long>(std::floor((endDate - startDate) / SearchStep)) + 1;
+    auto minSteps = std::max(1LL, static_cast<long long>(std::ceil(minSpan / SearchStep)));
+    long long count = std::clamp(steps / minSteps, 1LL, static_cast<long long>(std::max(maxPartitions, 1)));
+
+    partitions.reserve(static_cast<std::size_t>(count));
+    for (long long i = 0; i < count; i++)
+    {
+        long long first = steps * i / count;
+        long long next = steps * (i + 1) / count;
+
+        // End half a step before the start of the next partition, so that
+        // its first time isn't also tested by this one.
+        double t0 = startDate + static_cast<double>(first) * SearchStep;
+        double t1 = i + 1 == count ? endDate : startDate + (static_cast<double>(next) - 0.5) * SearchStep;
+        partitions.emplace_back(t0, t1);
+    }
+
+    return partitions;
+}
+
+
+EclipseMerger::EclipseMerger(const std::vector<std::pair<double, double>>& partitions)
+{
+    for (std::size_t i = 1; i < partitions.size(); i++)
+        boundaries.push_back(partitions[i].first);
+}
+
+
+/*! Return true if the eclipse hasn't already been added. Eclipses found on
+ *  both sides of a partition boundary cover the boundary, so only those need
+ *  to be compared with each other.
+ */
+bool EclipseMerger::add(const Eclipse& eclipse)
+{
+    auto it = std::lower_bound(boundaries.begin(), boundaries.end(), eclipse.startTime);
+    if (it == boundaries.end() || *it > eclipse.endTime)
+        return true;
+
+    for (const Eclipse& e : boundaryEclipses)
+    {
+        if (e.receiver == eclipse.receiver && e.occulter == eclipse.occulter &&
+            e.startTime <= eclipse.endTime && eclipse.startTime <= e.endTime)
+        {
+            return false;
+        }
+    }
+
+    boundaryEclipses.push_back(eclipse);
+    return true;
+}
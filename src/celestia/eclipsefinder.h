@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <utility>
 #include <vector>
 #include "celestiacore.h"
 
@@ -46,13 +47,42 @@ class EclipseFinderWatcher
 class EclipseFinder
 {
  public:
+    // Interval between the times tested for an eclipse, in days
+    static constexpr double SearchStep = 1.0 / 24.0;
+
     EclipseFinder(Body*, EclipseFinderWatcher* = nullptr);
 
     void findEclipses(double startDate,
                       double endDate,
                       int eclipseTypeMask,
                       std::vector<Eclipse>& eclipses);
+
+    bool canSearchConcurrently(double startDate, double endDate) const;
+
+    static std::vector<std::pair<double, double>> partitionSearch(double startDate,
+                                                                  double endDate,
+                                                                  double minSpan,
+                                                                  int maxPartitions);
+
  private:
+    std::vector<Body*> getTestBodies() const;
+
     Body* body;
     EclipseFinderWatcher* watcher;
 };
+
+/*! Combines the results of a search split by EclipseFinder::partitionSearch.
+ *  An eclipse in progress at the boundary between two partitions is found
+ *  by the searches on both sides of it; add() accepts it only once.
+ */
+class EclipseMerger
+{
+ public:
+    explicit EclipseMerger(const std::vector<std::pair<double, double>>& partitions);
+
+    bool add(const Eclipse&);
+
+ private:
+    std::vector<double> boundaries;
+    std::vector<Eclipse> boundaryEclipses;
+};
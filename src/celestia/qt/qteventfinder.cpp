@@ -12,7 +12,12 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <QRadioButton>
@@ -28,8 +33,15 @@
 #include <QProgressDialog>
 #include <QApplication>
 #include <QMenu>
+#include <QElapsedTimer>
+#include <QHeaderView>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
 
 #include <celengine/body.h>
+#include <celephem/cachebypass.h>
 #include <celestia/celestiacore.h>
 #include <celestia/eclipsefinder.h>
 #include <celmath/distance.h>
@@ -78,7 +90,8 @@ public:
     int columnCount(const QModelIndex& index) const override;
     void sort(int column, Qt::SortOrder order) override;
 
-    void setEclipses(const vector<Eclipse>& _eclipses);
+    void clear();
+    void appendEclipses(const vector<Eclipse>& _eclipses);
 
     const Eclipse* eclipseAtIndex(const QModelIndex& index) const;
 
@@ -197,14 +210,26 @@ void EventTableModel::sort(int column, Qt::SortOrder order)
 }
 
 
-void EventTableModel::setEclipses(const vector<Eclipse>& _eclipses)
+void EventTableModel::clear()
 {
     beginResetModel();
-    eclipses = _eclipses;
+    eclipses.clear();
     endResetModel();
 }
 
 
+void EventTableModel::appendEclipses(const vector<Eclipse>& _eclipses)
+{
+    if (_eclipses.empty())
+        return;
+
+    int first = (int) eclipses.size();
+    beginInsertRows(QModelIndex(), first, first + (int) _eclipses.size() - 1);
+    eclipses.insert(eclipses.end(), _eclipses.begin(), _eclipses.end());
+    endInsertRows();
+}
+
+
 const Eclipse* EventTableModel::eclipseAtIndex(const QModelIndex& index) const
 {
     int row = index.row();
@@ -215,6 +240,176 @@ const Eclipse* EventTableModel::eclipseAtIndex(const QModelIndex& index) const
 }
 
 
+/*! A search in progress. The search range is split into partitions which
+ *  are searched independently, either concurrently on the thread pool or one
+ *  after another on the GUI thread. Eclipses found are queued until the GUI
+ *  thread collects them.
+ */
+class EclipseSearch
+{
+public:
+    EclipseSearch(Body* _body,
+                  int _eclipseTypeMask,
+                  vector<pair<double, double>>&& _partitions,
+                  bool _concurrent);
+
+    void searchPartition(std::size_t index);
+    bool collect(vector<Eclipse>& eclipses);
+    double progress() const;
+
+    Body* body;
+    int eclipseTypeMask;
+    vector<pair<double, double>> partitions;
+    bool concurrent;
+    std::atomic<bool> aborted{ false };
+
+    // Next partition to search on the GUI thread when not concurrent
+    std::size_t nextPartition{ 0 };
+
+private:
+    EclipseMerger merger;
+    std::unique_ptr<std::atomic<double>[]> searchedSpans;
+
+    std::mutex mutex;
+    vector<Eclipse> found;
+    std::size_t finishedPartitions{ 0 };
+};
+
+
+namespace
+{
+
+// Minimum length in days of the partitions searched concurrently
+constexpr double MinPartitionSpan = 30.0;
+// More partitions than threads balance the load and let results arrive sooner
+constexpr int PartitionsPerThread = 4;
+// Length in days of the partitions searched on the GUI thread
+constexpr double SlicePartitionSpan = 10.0;
+
+// Interval in milliseconds at which results are collected, and the time
+// the GUI thread may spend on each slice of a search that isn't concurrent
+constexpr int SearchInterval = 50;
+
+constexpr int ProgressSteps = 1000;
+
+
+class PartitionWatcher : public EclipseFinderWatcher
+{
+public:
+    PartitionWatcher(const std::atomic<bool>& _aborted,
+                     std::atomic<double>& _searchedSpan,
+                     double _startTime) :
+        aborted(_aborted),
+        searchedSpan(_searchedSpan),
+        startTime(_startTime)
+    {
+    }
+
+    Status eclipseFinderProgressUpdate(double t) override
+    {
+        searchedSpan.store(t - startTime, std::memory_order_relaxed);
+        return aborted.load(std::memory_order_relaxed) ? AbortOperation : ContinueOperation;
+    }
+
+private:
+    const std::atomic<bool>& aborted;
+    std::atomic<double>& searchedSpan;
+    double startTime;
+};
+
+
+class PartitionTask : public QRunnable
+{
+public:
+    PartitionTask(std::shared_ptr<EclipseSearch> _search, std::size_t _index) :
+        search(std::move(_search)),
+        index(_index)
+    {
+    }
+
+    void run() override
+    {
+        // Rendering keeps evaluating the same ephemerides on the GUI thread
+        celestia::ephem::CacheBypass bypass;
+        search->searchPartition(index);
+    }
+
+private:
+    std::shared_ptr<EclipseSearch> search;
+    std::size_t index;
+};
+
+} // end unnamed namespace
+
+
+EclipseSearch::EclipseSearch(Body* _body,
+                             int _eclipseTypeMask,
+                             vector<pair<double, double>>&& _partitions,
+                             bool _concurrent) :
+    body(_body),
+    eclipseTypeMask(_eclipseTypeMask),
+    partitions(std::move(_partitions)),
+    concurrent(_concurrent),
+    merger(partitions),
+    searchedSpans(std::make_unique<std::atomic<double>[]>(partitions.size()))
+{
+}
+
+
+// May be called from any thread
+void EclipseSearch::searchPartition(std::size_t index)
+{
+    auto [startTime, endTime] = partitions[index];
+    PartitionWatcher watcher(aborted, searchedSpans[index], startTime);
+
+    vector<Eclipse> eclipses;
+    EclipseFinder finder(body, &watcher);
+    finder.findEclipses(startTime, endTime, eclipseTypeMask, eclipses);
+    searchedSpans[index].store(endTime - startTime, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    found.insert(found.end(), eclipses.begin(), eclipses.end());
+    ++finishedPartitions;
+}
+
+
+/*! Append the eclipses found since the last call, without duplicates, and
+ *  return true when all partitions have been searched.
+ */
+bool EclipseSearch::collect(vector<Eclipse>& eclipses)
+{
+    vector<Eclipse> batch;
+    bool finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch.swap(found);
+        finished = finishedPartitions == partitions.size();
+    }
+
+    for (const Eclipse& eclipse : batch)
+    {
+        if (merger.add(eclipse))
+            eclipses.push_back(eclipse);
+    }
+
+    return finished;
+}
+
+
+double EclipseSearch::progress() const
+{
+    double searched = 0.0;
+    double total = 0.0;
+    for (std::size_t i = 0; i < partitions.size(); i++)
+    {
+        searched += searchedSpans[i].load(std::memory_order_relaxed);
+        total += partitions[i].second - partitions[i].first;
+    }
+
+    return total > 0.0 ? searched / total : 1.0;
+}
+
+
 constexpr std::array planets =
 {
     N_("Earth"),
@@ -287,7 +482,7 @@ EventFinder::EventFinder(CelestiaCore* _appCore,
         planetSelect->addItem(_(planet));
     layout->addWidget(planetSelect);
 
-    QPushButton* findButton = new QPushButton(_("Find eclipses"));
+    findButton = new QPushButton(_("Find eclipses"));
     connect(findButton, SIGNAL(clicked()), this, SLOT(slotFindEclipses()));
     layout->addWidget(findButton);
 
@@ -304,28 +499,23 @@ EventFinder::EventFinder(CelestiaCore* _appCore,
     model = new EventTableModel();
     eventTable->setModel(model);
 
+    // Leave a core for the GUI and rendering
+    threadPool = new QThreadPool(this);
+    threadPool->setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+
+    searchTimer = new QTimer(this);
+    searchTimer->setInterval(SearchInterval);
+    connect(searchTimer, SIGNAL(timeout()), this, SLOT(slotSearchProgress()));
+
     this->setWidget(finderWidget);
 }
 
 
-EclipseFinderWatcher::Status EventFinder::eclipseFinderProgressUpdate(double t)
+EventFinder::~EventFinder()
 {
-    if (progress != nullptr)
-    {
-        // Avoid processing events at every update, otherwise finding eclipse
-        // can take a very long time.
-        //if (t - lastProgressUpdate > searchSpan * 0.01)
-        if (searchTimer.elapsed() >= 100)
-        {
-            searchTimer.start();
-            progress->setValue((int) t);
-            QApplication::processEvents();
-            lastProgressUpdate = t;
-        }
-
-        return progress->wasCanceled() ? AbortOperation : ContinueOperation;
-    }
-    return EclipseFinderWatcher::ContinueOperation;
+    if (search != nullptr)
+        search->aborted = true;
+    threadPool->waitForDone();
 }
 
 
@@ -358,30 +548,99 @@ void EventFinder::slotFindEclipses()
         return;
     }
 
-    EclipseFinder finder(obj.body(), this);
-    searchTimer.start();
+    if (search != nullptr)
+        return;
 
     double startTimeTDB = QDateToTDB(startDate);
     double endTimeTDB = QDateToTDB(endDate);
 
-    // Initialize values used by progress bar
-    searchSpan = endTimeTDB - startTimeTDB;
-    lastProgressUpdate = startTimeTDB;
+    EclipseFinder finder(obj.body());
+    bool concurrent = finder.canSearchConcurrently(startTimeTDB, endTimeTDB);
+    auto partitions = concurrent
+        ? EclipseFinder::partitionSearch(startTimeTDB, endTimeTDB, MinPartitionSpan,
+                                         threadPool->maxThreadCount() * PartitionsPerThread)
+        : EclipseFinder::partitionSearch(startTimeTDB, endTimeTDB, SlicePartitionSpan,
+                                         std::numeric_limits<int>::max());
+    search = std::make_shared<EclipseSearch>(obj.body(), eclipseTypeMask, std::move(partitions), concurrent);
 
-    progress = new QProgressDialog(_("Finding eclipses..."), "Abort", (int) startTimeTDB, (int) endTimeTDB, this);
-    progress->setWindowModality(Qt::WindowModal);
+    model->clear();
+
+    if (concurrent)
+    {
+        for (std::size_t i = 0; i < search->partitions.size(); i++)
+            threadPool->start(new PartitionTask(search, i));
+    }
+
+    progress = new QProgressDialog(_("Finding eclipses..."), "Abort", 0, ProgressSteps, this);
+    progress->setWindowModality(Qt::NonModal);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+    connect(progress, SIGNAL(canceled()), this, SLOT(slotAbortSearch()));
     progress->show();
 
+    findButton->setEnabled(false);
+    searchTimer->start();
+}
+
+
+void EventFinder::slotSearchProgress()
+{
+    if (search == nullptr)
+        return;
+
+    if (!search->concurrent)
+    {
+        QElapsedTimer slice;
+        slice.start();
+        while (search->nextPartition < search->partitions.size() && slice.elapsed() < SearchInterval)
+            search->searchPartition(search->nextPartition++);
+    }
+
+    vector<Eclipse> eclipses;
+    bool finished = search->collect(eclipses);
+    model->appendEclipses(eclipses);
+
+    if (finished)
+        finishSearch();
+    else if (progress != nullptr)
+        progress->setValue((int) (search->progress() * ProgressSteps));
+}
+
+
+void EventFinder::slotAbortSearch()
+{
+    if (search == nullptr)
+        return;
+
+    // Running partitions stop at their next search step
+    search->aborted = true;
+    threadPool->waitForDone();
 
     vector<Eclipse> eclipses;
-    finder.findEclipses(startTimeTDB, endTimeTDB,
-                        eclipseTypeMask,
-                        eclipses);
+    search->collect(eclipses);
+    model->appendEclipses(eclipses);
+
+    finishSearch();
+}
+
 
-    delete progress;
-    progress = nullptr;
+void EventFinder::finishSearch()
+{
+    searchTimer->stop();
+    search.reset();
 
-    model->setEclipses(eclipses);
+    if (progress != nullptr)
+    {
+        // May be called from the dialog's own canceled() signal
+        progress->deleteLater();
+        progress = nullptr;
+    }
+
+    findButton->setEnabled(true);
+
+    // Results arrive in no particular order
+    QHeaderView* header = eventTable->header();
+    eventTable->sortByColumn(header->sortIndicatorSection(), header->sortIndicatorOrder());
 
     eventTable->resizeColumnToContents(EventTableModel::OcculterColumn);
     eventTable->resizeColumnToContents(EventTableModel::ReceiverColumn);
@@ -392,10 +651,12 @@ void EventFinder::slotFindEclipses()
 void EventFinder::slotContextMenu(const QPoint& pos)
 {
     QModelIndex index = eventTable->indexAt(pos);
-    activeEclipse = model->eclipseAtIndex(index);
+    const Eclipse* eclipse = model->eclipseAtIndex(index);
 
-    if (activeEclipse != nullptr)
+    if (eclipse != nullptr)
     {
+        activeEclipse = *eclipse;
+
         if (contextMenu == nullptr)
             contextMenu = new QMenu(this);
         contextMenu->clear();
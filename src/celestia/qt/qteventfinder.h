@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
+
 #include <QDockWidget>
-#include <QElapsedTimer>
 #include <celestia/eclipsefinder.h>
 
 class QTreeView;
@@ -21,22 +23,26 @@ class QRadioButton;
 class QDateEdit;
 class QComboBox;
 class QProgressDialog;
+class QPushButton;
 class QMenu;
+class QThreadPool;
+class QTimer;
 class EventTableModel;
+class EclipseSearch;
 class CelestiaCore;
 
-class EventFinder : public QDockWidget, EclipseFinderWatcher
+class EventFinder : public QDockWidget
 {
     Q_OBJECT
 
  public:
     EventFinder(CelestiaCore* _appCore, const QString& title, QWidget* parent);
-    ~EventFinder() = default;
-
-    EclipseFinderWatcher::Status eclipseFinderProgressUpdate(double t);
+    ~EventFinder();
 
  public slots:
     void slotFindEclipses();
+    void slotSearchProgress();
+    void slotAbortSearch();
     void slotContextMenu(const QPoint&);
 
     void slotSetEclipseTime();
@@ -46,6 +52,8 @@ class EventFinder : public QDockWidget, EclipseFinderWatcher
     void slotViewBehindOccluder();
 
  private:
+    void finishSearch();
+
     CelestiaCore* appCore;
 
     QRadioButton* solarOnlyButton{ nullptr };
@@ -57,15 +65,20 @@ class EventFinder : public QDockWidget, EclipseFinderWatcher
 
     QComboBox* planetSelect{ nullptr };
 
+    QPushButton* findButton{ nullptr };
+
     EventTableModel* model{ nullptr };
     QTreeView* eventTable{ nullptr };
     QMenu* contextMenu{ nullptr };
 
     QProgressDialog* progress{ nullptr };
-    double searchSpan{ 0.0 };
-    double lastProgressUpdate{ 0.0 };
 
-    QElapsedTimer searchTimer;
+    // Searches run on the thread pool, or on the GUI thread in short time
+    // slices when the ephemerides involved can't be shared between threads.
+    QThreadPool* threadPool{ nullptr };
+    QTimer* searchTimer{ nullptr };
+    std::shared_ptr<EclipseSearch> search;
 
-    const Eclipse* activeEclipse{ nullptr };
+    // A copy, as rows may be added by a running search while the menu is open
+    std::optional<Eclipse> activeEclipse;
 };
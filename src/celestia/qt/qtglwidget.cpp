@@ -19,10 +19,13 @@
 
 #include <cassert>
 #include <cmath>
+#include <memory>
 #include <vector>
 
 #include <QCursor>
 #include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
 #include <QPaintDevice>
 #include <QMouseEvent>
 #include <QSettings>
@@ -57,6 +60,39 @@ constexpr float DEFAULT_VISUAL_MAGNITUDE = 8.0f;
 constexpr Renderer::StarStyle DEFAULT_STAR_STYLE = Renderer::FuzzyPointStars;
 constexpr unsigned int DEFAULT_TEXTURE_RESOLUTION = medres;
 
+// A context sharing objects with the widget's one, used by the texture
+// upload thread. The surface has to be created on the GUI thread, while
+// the context is created on the upload thread so that it belongs to it.
+class QtSharedGLContext : public celestia::engine::SharedGLContext
+{
+public:
+    explicit QtSharedGLContext(QOpenGLContext* shareContext) :
+        m_shareContext(shareContext)
+    {
+        m_surface.setFormat(shareContext->format());
+        m_surface.create();
+    }
+
+    bool makeCurrent() override
+    {
+        m_context = std::make_unique<QOpenGLContext>();
+        m_context->setFormat(m_shareContext->format());
+        m_context->setShareContext(m_shareContext);
+        return m_context->create() && m_context->makeCurrent(&m_surface);
+    }
+
+    void doneCurrent() override
+    {
+        m_context->doneCurrent();
+        m_context = nullptr;
+    }
+
+private:
+    QOpenGLContext* m_shareContext;
+    QOffscreenSurface m_surface;
+    std::unique_ptr<QOpenGLContext> m_context;
+};
+
 } // end unnamed namespace
 
 
@@ -123,6 +159,9 @@ void CelestiaGlWidget::initializeGL()
         exit(1);
     }
 
+    if (context()->isValid())
+        appCore->setSharedGLContext(std::make_unique<QtSharedGLContext>(context()));
+
     appCore->tick();
 
     // Read saved settings
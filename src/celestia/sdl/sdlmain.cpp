@@ -46,6 +46,37 @@ class SDL_Alerter : public CelestiaCore::Alerter
     }
 };
 
+#ifndef __EMSCRIPTEN__
+// A context sharing objects with the window's, used by the texture upload
+// thread
+class SDL_SharedContext : public engine::SharedGLContext
+{
+ public:
+    SDL_SharedContext(SDL_Window* window, SDL_GLContext context) :
+        m_window    { window },
+        m_context   { context }
+    {
+    }
+    ~SDL_SharedContext() override
+    {
+        SDL_GL_DeleteContext(m_context);
+    }
+
+    bool makeCurrent() override
+    {
+        return SDL_GL_MakeCurrent(m_window, m_context) == 0;
+    }
+    void doneCurrent() override
+    {
+        SDL_GL_MakeCurrent(m_window, nullptr);
+    }
+
+ private:
+    SDL_Window   *m_window;
+    SDL_GLContext m_context;
+};
+#endif
+
 class SDL_Application
 {
  public:
@@ -101,6 +132,7 @@ class SDL_Application
     void copyURL();
     void pasteURL();
     void configure() const;
+    void createSharedContext() const;
 
     // state variables
     std::string m_appName;
@@ -197,6 +229,20 @@ SDL_Application::initCelestiaCore()
     return true;
 }
 
+void
+SDL_Application::createSharedContext() const
+{
+#ifndef __EMSCRIPTEN__
+    // Creating the context makes it current, so switch back afterwards
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    SDL_GLContext context = SDL_GL_CreateContext(m_mainWindow);
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    SDL_GL_MakeCurrent(m_mainWindow, m_glContext);
+    if (context != nullptr)
+        m_appCore->setSharedGLContext(std::make_unique<SDL_SharedContext>(m_mainWindow, context));
+#endif
+}
+
 void
 SDL_Application::configure() const
 {
@@ -262,6 +308,7 @@ void
 SDL_Application::run()
 {
     m_appCore->initRenderer();
+    createSharedContext();
     configure();
     m_appCore->start();
 
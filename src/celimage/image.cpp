@@ -150,6 +150,7 @@ Image::Image(PixelFormat fmt, int w, int h, int mip) :
 
     pitch = pad(w * components);
     pixels = std::make_unique<std::uint8_t[]>(size);
+    memory.set(size);
 }
 
 bool
@@ -14,6 +14,7 @@
 #include <memory>
 
 #include <celcompat/filesystem.h>
+#include <celutil/memoryusage.h>
 #include "pixelformat.h"
 
 // The image class supports multiple GL formats, including compressed ones.
@@ -64,6 +65,7 @@ class Image
     celestia::PixelFormat format;
     int size;
     std::unique_ptr<std::uint8_t[]> pixels;
+    celestia::util::MemoryTracker memory{ celestia::util::MemoryCategory::Images };
 };
 
 std::unique_ptr<Image> LoadImageFromFile(const fs::path& filename);
@@ -0,0 +1,99 @@
+// chebyshev.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Chebyshev series approximation of smooth functions on an interval.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include <celcompat/numbers.h>
+
+namespace celmath
+{
+
+// Return the N Chebyshev nodes of the first kind on [-1, 1]. A function
+// sampled at these points can be turned into a series by ChebyshevFit().
+template<typename T, std::size_t N>
+std::array<T, N>
+ChebyshevNodes()
+{
+    std::array<T, N> nodes;
+    for (std::size_t k = 0; k < N; ++k)
+        nodes[k] = std::cos(celestia::numbers::pi_v<T> * (static_cast<T>(k) + T(0.5)) / static_cast<T>(N));
+    return nodes;
+}
+
+// Compute the coefficients of the Chebyshev series interpolating values
+// sampled at ChebyshevNodes(). V may be a scalar or a vector type. The
+// constant term is stored already halved, so the series is just the sum
+// of c[j] * T_j(x).
+template<typename V, typename T, std::size_t N>
+std::array<V, N>
+ChebyshevFit(const std::array<V, N>& values)
+{
+    std::array<V, N> coeffs;
+    for (std::size_t j = 0; j < N; ++j)
+    {
+        V sum = values[0] * T(0);
+        for (std::size_t k = 0; k < N; ++k)
+        {
+            T angle = celestia::numbers::pi_v<T> * static_cast<T>(j) * (static_cast<T>(k) + T(0.5)) / static_cast<T>(N);
+            sum += values[k] * std::cos(angle);
+        }
+        coeffs[j] = sum * (T(2) / static_cast<T>(N));
+    }
+    coeffs[0] *= T(0.5);
+    return coeffs;
+}
+
+// Evaluate a Chebyshev series at x in [-1, 1] using Clenshaw's recurrence.
+template<typename V, typename T, std::size_t N>
+V
+ChebyshevEvaluate(const std::array<V, N>& coeffs, T x)
+{
+    V b1 = coeffs[0] * T(0);
+    V b2 = b1;
+    for (std::size_t j = N - 1; j > 0; --j)
+    {
+        V b0 = coeffs[j] + b1 * (T(2) * x) - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    return coeffs[0] + b1 * x - b2;
+}
+
+// Return the coefficients of the derivative with respect to x of a
+// Chebyshev series. The highest order coefficient of the result is zero.
+template<typename V, typename T, std::size_t N>
+std::array<V, N>
+ChebyshevDerivative(const std::array<V, N>& coeffs)
+{
+    std::array<V, N> deriv;
+    deriv[N - 1] = coeffs[0] * T(0);
+    if constexpr (N > 1)
+    {
+        V next = deriv[N - 1];
+        V current = coeffs[N - 1] * (T(2) * static_cast<T>(N - 1));
+        deriv[N - 2] = current;
+        for (std::size_t j = N - 2; j > 0; --j)
+        {
+            V previous = next + coeffs[j] * (T(2) * static_cast<T>(j));
+            deriv[j - 1] = previous;
+            next = current;
+            current = previous;
+        }
+        deriv[0] *= T(0.5);
+    }
+    return deriv;
+}
+
+} // end namespace celmath
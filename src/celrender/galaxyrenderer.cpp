@@ -8,9 +8,11 @@
 // as published by the Free Software Foundation; either version 2
 // of the License, or (at your option) any later version.
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cmath>
+#include <limits>
 
 #include <celengine/galaxy.h>
 #include <celengine/galaxyform.h>
@@ -100,6 +102,15 @@ struct GalaxyRenderer::Object
     float           nearZ;  // if nearZ != & farZ != then use custom projection matrix
     float           farZ;
     const Galaxy   *galaxy;
+
+    // Order by depth range, farthest first; objects without a range of their
+    // own use the global projection and are drawn before the others.
+    static bool depthRangeGreater(const Object &o1, const Object &o2)
+    {
+        if (o1.farZ == 0.0f || o2.farZ == 0.0f)
+            return o1.farZ == 0.0f && o2.farZ != 0.0f;
+        return o1.farZ > o2.farZ || (o1.farZ == o2.farZ && o1.nearZ > o2.nearZ);
+    }
 };
 
 GalaxyRenderer::GalaxyRenderer(Renderer &renderer) :
@@ -132,6 +143,10 @@ GalaxyRenderer::render()
     if (m_objects.empty())
         return;
 
+    // Group galaxies sharing a depth range so that the projection matrix
+    // only has to be changed once per group.
+    std::stable_sort(m_objects.begin(), m_objects.end(), Object::depthRangeGreater);
+
     if (gl::hasGeomShader())
         renderGL3();
     else
@@ -141,7 +156,7 @@ GalaxyRenderer::render()
 }
 
 bool
-GalaxyRenderer::getRenderInfo(const GalaxyRenderer::Object &obj, float &brightness, float &size, float minimumFeatureSize, Eigen::Matrix4f &m, Eigen::Matrix4f &pr, int &nPoints) const
+GalaxyRenderer::getRenderInfo(const GalaxyRenderer::Object &obj, float &brightness, float &size, float minimumFeatureSize, Eigen::Matrix4f &m, int &nPoints) const
 {
     const auto* galacticForm = GalacticFormManager::get()->getForm(obj.galaxy->getFormId());
     if (galacticForm == nullptr)
@@ -165,11 +180,6 @@ GalaxyRenderer::getRenderInfo(const GalaxyRenderer::Object &obj, float &brightne
 
     brightness = obj.galaxy->getBrightnessCorrection(obj.offset) * obj.brightness;
 
-    if (obj.nearZ != 0.0f && obj.farZ != 0.0f)
-        m_renderer.buildProjectionMatrix(pr, obj.nearZ, obj.farZ, m_zoom);
-    else
-        pr = m_renderer.getProjectionMatrix();
-
     const auto &points = galacticForm->blobs;
     auto pointCount = static_cast<int>(static_cast<float>(points.size()) * std::clamp(obj.galaxy->getDetail(), 0.0f, 1.0f));
     // find proper nPoints count
@@ -183,6 +193,24 @@ GalaxyRenderer::getRenderInfo(const GalaxyRenderer::Object &obj, float &brightne
     return true;
 }
 
+void
+GalaxyRenderer::setProjection(CelestiaGLProgram *prog, const GalaxyRenderer::Object &obj, float &nearZ, float &farZ) const
+{
+    if (obj.nearZ == nearZ && obj.farZ == farZ)
+        return;
+
+    nearZ = obj.nearZ;
+    farZ = obj.farZ;
+
+    Eigen::Matrix4f pr;
+    if (nearZ != 0.0f && farZ != 0.0f)
+        m_renderer.buildProjectionMatrix(pr, nearZ, farZ, m_zoom);
+    else
+        pr = m_renderer.getProjectionMatrix();
+
+    prog->setMVPMatrices(pr, m_renderer.getModelViewMatrix());
+}
+
 struct GalaxyRenderer::RenderDataGL2
 {
     RenderDataGL2(gl::Buffer &&bo, gl::Buffer &&io, gl::VertexObject &&vo) :
@@ -218,19 +246,23 @@ GalaxyRenderer::renderGL2()
     ps.smoothLines = true;
     m_renderer.setPipelineState(ps);
 
+    // Depth range of the current projection; NaN forces setting it for the
+    // first galaxy.
+    float nearZ = std::numeric_limits<float>::quiet_NaN();
+    float farZ = std::numeric_limits<float>::quiet_NaN();
+
     for (const auto &obj : m_objects)
     {
         float brightness = 0.0f;
         float size = 0.0f;
         float minimumFeatureSize = 0.0f;
         Eigen::Matrix4f m;
-        Eigen::Matrix4f pr;
         int nPoints = 0;
 
-        if (!getRenderInfo(obj, brightness, size, minimumFeatureSize, m, pr, nPoints))
+        if (!getRenderInfo(obj, brightness, size, minimumFeatureSize, m, nPoints))
             continue;
 
-        prog->setMVPMatrices(pr, m_renderer.getModelViewMatrix());
+        setProjection(prog, obj, nearZ, farZ);
 
         prog->floatParam("size")               = size;
         prog->floatParam("brightness")         = brightness;
@@ -384,19 +416,23 @@ GalaxyRenderer::renderGL3()
     ps.smoothLines = true;
     m_renderer.setPipelineState(ps);
 
+    // Depth range of the current projection; NaN forces setting it for the
+    // first galaxy.
+    float nearZ = std::numeric_limits<float>::quiet_NaN();
+    float farZ = std::numeric_limits<float>::quiet_NaN();
+
     for (const auto &obj : m_objects)
     {
         float brightness = 0.0f;
         float size = 0.0f;
         float minimumFeatureSize = 0.0f;
         Eigen::Matrix4f m;
-        Eigen::Matrix4f pr;
         int nPoints = 0;
 
-        if (!getRenderInfo(obj, brightness, size, minimumFeatureSize, m, pr, nPoints))
+        if (!getRenderInfo(obj, brightness, size, minimumFeatureSize, m, nPoints))
             continue;
 
-        prog->setMVPMatrices(pr, m_renderer.getModelViewMatrix());
+        setProjection(prog, obj, nearZ, farZ);
 
         prog->floatParam("size")               = size;
         prog->floatParam("brightness")         = brightness;
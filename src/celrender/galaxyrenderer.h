@@ -41,7 +41,8 @@ private:
 
     using BlobVector = engine::GalacticForm::BlobVector;
 
-    bool getRenderInfo(const GalaxyRenderer::Object &obj, float &brightness, float &size, float minimumFeatureSize, Eigen::Matrix4f &m, Eigen::Matrix4f &pr, int &nPoints) const;
+    bool getRenderInfo(const GalaxyRenderer::Object &obj, float &brightness, float &size, float minimumFeatureSize, Eigen::Matrix4f &m, int &nPoints) const;
+    void setProjection(CelestiaGLProgram *prog, const GalaxyRenderer::Object &obj, float &nearZ, float &farZ) const;
 
     struct RenderDataGL2;
     std::vector<RenderDataGL2>  m_renderDataGL2;
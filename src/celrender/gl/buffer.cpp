@@ -11,6 +11,8 @@
 
 #include "buffer.h"
 
+#include <celutil/memoryusage.h>
+
 #define GLENUM(p) (static_cast<GLenum>(p))
 
 namespace celestia::gl
@@ -73,6 +75,8 @@ Buffer::clear() noexcept
     if (m_id != 0)
         glDeleteBuffers(1, &m_id);
     m_id = 0;
+    util::RemoveMemoryUsage(util::MemoryCategory::Buffers, static_cast<std::size_t>(m_bufferSize));
+    m_bufferSize = 0;
 }
 
 Buffer&
@@ -97,6 +101,8 @@ Buffer::unbind(Buffer::TargetHint target)
 Buffer&
 Buffer::setData(util::array_view<const void> data, Buffer::BufferUsage usage)
 {
+    util::RemoveMemoryUsage(util::MemoryCategory::Buffers, static_cast<std::size_t>(m_bufferSize));
+    util::AddMemoryUsage(util::MemoryCategory::Buffers, data.size());
     m_bufferSize = data.size();
     m_usage      = usage;
     glBufferData(GLENUM(m_targetHint), m_bufferSize, data.data(), GLENUM(m_usage));
@@ -123,6 +123,7 @@ struct VertexObject::BufferDesc
         std::int16_t  location,
         std::uint8_t  elemSize,
         std::uint8_t  stride,
+        std::uint8_t  divisor,
         bool          normalized) :
         offset(offset),
         bufferId(bufferId),
@@ -130,6 +131,7 @@ struct VertexObject::BufferDesc
         location(location),
         elemSize(elemSize),
         stride(stride),
+        divisor(divisor),
         normalized(normalized)
     {
     }
@@ -139,11 +141,12 @@ struct VertexObject::BufferDesc
     std::int16_t    location;
     std::uint8_t    elemSize;       // 1, 2, 3, 4
     std::uint8_t    stride;         // WebGL allows only 255 bytes max
+    std::uint8_t    divisor;
     bool            normalized;
 };
 
 VertexObject&
-VertexObject::addVertexBuffer(const Buffer &buffer, int location, int elemSize, VertexObject::DataType type, bool normalized, int stride, std::ptrdiff_t offset)
+VertexObject::addVertexBuffer(const Buffer &buffer, int location, int elemSize, VertexObject::DataType type, bool normalized, int stride, std::ptrdiff_t offset, int divisor)
 {
     if (buffer.targetHint() != Buffer::TargetHint::Array)
         return *this;
@@ -155,6 +158,7 @@ VertexObject::addVertexBuffer(const Buffer &buffer, int location, int elemSize,
         static_cast<std::uint16_t>(location),
         static_cast<std::uint8_t>(elemSize),
         static_cast<std::uint8_t>(stride),
+        static_cast<std::uint8_t>(divisor),
         normalized
     );
 
@@ -196,6 +200,29 @@ VertexObject::draw(VertexObject::Primitive primitive, int count, int first)
     return *this;
 }
 
+VertexObject&
+VertexObject::drawInstanced(VertexObject::Primitive primitive, int count, int instanceCount, int first)
+{
+    if (count == 0 || instanceCount == 0)
+        return *this;
+
+    bind();
+
+    if (isIndexed())
+    {
+        auto offset = static_cast<std::ptrdiff_t>(first * (m_indexType == IndexType::UnsignedShort ? sizeof(GLushort) : sizeof(GLuint)));
+        glDrawElementsInstanced(GLENUM(primitive), count, GLENUM(m_indexType), PTR(offset), instanceCount);
+    }
+    else
+    {
+        glDrawArraysInstanced(GLENUM(primitive), first, count, instanceCount);
+    }
+
+    unbind();
+
+    return *this;
+}
+
 VertexObject&
 VertexObject::setIndexBuffer(const Buffer &buffer, std::ptrdiff_t /*offset*/, VertexObject::IndexType type)
 {
@@ -221,6 +248,8 @@ VertexObject::enableAttribArrays()
         }
         glEnableVertexAttribArray(p.location);
         glVertexAttribPointer(p.location, p.elemSize, p.type, p.normalized ? GL_TRUE : GL_FALSE, p.stride, PTR(p.offset));
+        if (p.divisor != 0)
+            glVertexAttribDivisor(p.location, p.divisor);
     }
 
     if (isIndexed())
@@ -231,7 +260,12 @@ void
 VertexObject::disableAttribArrays()
 {
     for (const auto& p : m_bufferDesc)
+    {
         glDisableVertexAttribArray(p.location);
+        // Without a VAO the divisor is global state
+        if (p.divisor != 0)
+            glVertexAttribDivisor(p.location, 0);
+    }
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
@@ -152,6 +152,22 @@ public:
      */
     VertexObject& draw(Primitive primitive, int count, int first = 0);
 
+    /**
+     * @brief Render several instances of VertexObject.
+     *
+     * Attributes added with a non-zero divisor advance once per instance.
+     * Requires OpenGL 3.3, ARB_instanced_arrays or OpenGL ES 3.0.
+     *
+     * @param primitive Primitive.
+     * @param count Number of vertices to draw per instance.
+     * @param instanceCount Number of instances to draw.
+     * @param first First vertex to draw.
+     * @return Reference to self.
+     *
+     * @see @ref addVertexBuffer()
+     */
+    VertexObject& drawInstanced(Primitive primitive, int count, int instanceCount, int first = 0);
+
     /**
      * @brief Set the primitive.
      *
@@ -212,11 +228,13 @@ public:
      * @param stride Offset in bytes between consecutive generic vertex attributes. If stride is 0,
      * the generic vertex attributes are understood to be tightly packed in the array.
      * @param offset Offset of the first component of the first generic vertex attribute in the array.
+     * @param divisor Number of instances drawn per attribute value, 0 to advance per vertex.
+     * See documentation for glVertexAttribDivisor.
      * @return Reference to self.
      *
-     * @see @ref DataType
+     * @see @ref DataType @ref drawInstanced()
      */
-    VertexObject& addVertexBuffer(const Buffer &buffer, int location, int elemSize, DataType type, bool normalized = false, int stride = 0, std::ptrdiff_t offset = 0);
+    VertexObject& addVertexBuffer(const Buffer &buffer, int location, int elemSize, DataType type, bool normalized = false, int stride = 0, std::ptrdiff_t offset = 0, int divisor = 0);
 
     /**
      * @brief Add index buffer.
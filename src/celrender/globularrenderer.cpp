@@ -13,6 +13,7 @@
 #include <cassert>
 #include <cstdint>
 #include <cmath>
+#include <limits>
 #include <memory>
 
 #include <Eigen/Core>
@@ -514,6 +515,15 @@ struct GlobularRenderer::Object
     float           nearZ;  // if nearZ != & farZ != then use custom projection matrix
     float           farZ;
     const Globular *globular;
+
+    // Order by depth range, farthest first; objects without a range of their
+    // own use the global projection and are drawn before the others.
+    static bool depthRangeGreater(const Object &o1, const Object &o2)
+    {
+        if (o1.farZ == 0.0f || o2.farZ == 0.0f)
+            return o1.farZ == 0.0f && o2.farZ != 0.0f;
+        return o1.farZ > o2.farZ || (o1.farZ == o2.farZ && o1.nearZ > o2.nearZ);
+    }
 };
 
 GlobularRenderer::GlobularRenderer(Renderer &renderer) :
@@ -567,8 +577,37 @@ GlobularRenderer::render()
     glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
 #endif
 
+    // Group globulars sharing a depth range so that the matrices only have
+    // to be changed once per group. The shaders add the offset of each
+    // globular, so the model view matrix is the same for all. Farthest
+    // first is also the better order for blending.
+    std::stable_sort(m_objects.begin(), m_objects.end(), Object::depthRangeGreater);
+
+    // Depth range of the current projection; NaN forces setting it for the
+    // first globular.
+    float nearZ = std::numeric_limits<float>::quiet_NaN();
+    float farZ = std::numeric_limits<float>::quiet_NaN();
+    Eigen::Matrix4f pr;
+
     for (const auto &obj : m_objects)
-        renderForm(tidalProg, globProg, obj);
+    {
+        if (obj.nearZ != nearZ || obj.farZ != farZ)
+        {
+            nearZ = obj.nearZ;
+            farZ = obj.farZ;
+            if (nearZ != 0.0f && farZ != 0.0f)
+                m_renderer.buildProjectionMatrix(pr, nearZ, farZ, m_zoom);
+            else
+                pr = m_renderer.getProjectionMatrix();
+
+            tidalProg->use();
+            tidalProg->setMVPMatrices(pr, m_renderer.getModelViewMatrix());
+            globProg->use();
+            globProg->setMVPMatrices(pr, m_renderer.getModelViewMatrix());
+        }
+
+        renderForm(tidalProg, globProg, obj, pr);
+    }
 
     m_objects.clear();
 #ifndef GL_ES
@@ -579,7 +618,7 @@ GlobularRenderer::render()
 }
 
 void
-GlobularRenderer::renderForm(CelestiaGLProgram *tidalProg, CelestiaGLProgram *globProg, const Object &obj) const
+GlobularRenderer::renderForm(CelestiaGLProgram *tidalProg, CelestiaGLProgram *globProg, const Object &obj, const Eigen::Matrix4f &pr) const
 {
     const Globular *globular = obj.globular;
     auto* globularFormManager = GlobularFormManager::get();
@@ -641,15 +680,8 @@ GlobularRenderer::renderForm(CelestiaGLProgram *tidalProg, CelestiaGLProgram *gl
     glActiveTexture(GL_TEXTURE1);
     globularFormManager->getCenterTex(obj.globular->getFormId())->bind();
 
-    Eigen::Matrix4f mv = celmath::translate(m_renderer.getModelViewMatrix(), obj.offset);
-    Eigen::Matrix4f pr;
-    if (obj.nearZ != 0.0f && obj.farZ != 0.0f)
-        m_renderer.buildProjectionMatrix(pr, obj.nearZ, obj.farZ, m_zoom);
-    else
-        pr = m_renderer.getProjectionMatrix();
-
     tidalProg->use();
-    tidalProg->setMVPMatrices(pr, mv);
+    tidalProg->vec3Param("offset")       = obj.offset;
     tidalProg->mat3Param("viewMat")      = m_viewMat;
     tidalProg->floatParam("brightness")  = obj.brightness;
     tidalProg->floatParam("pixelWeight") = pixelWeight;
@@ -670,12 +702,12 @@ GlobularRenderer::renderForm(CelestiaGLProgram *tidalProg, CelestiaGLProgram *gl
 
     Eigen::Matrix3f mx = obj.globular->getOrientation().conjugate().toRotationMatrix() * Eigen::Scaling(tidalSize);
 
+    Eigen::Matrix4f mv = celmath::translate(m_renderer.getModelViewMatrix(), obj.offset);
     int w, h; // NOSONAR
     m_renderer.getViewport(nullptr, nullptr, &w, &h);
     float size = CalculateSpriteSize(w, h, pr, mv, m_viewMat, m_renderer.getProjectionMode().get());
 
     globProg->use();
-    globProg->setMVPMatrices(pr, mv);
     globProg->mat3Param("m")            = mx;
     globProg->vec3Param("offset")       = obj.offset;
     globProg->floatParam("brightness")  = obj.brightness;
@@ -38,7 +38,7 @@ public:
 private:
     struct Object;
 
-    void renderForm(CelestiaGLProgram *tidalProg, CelestiaGLProgram *globProg, const Object &obj) const;
+    void renderForm(CelestiaGLProgram *tidalProg, CelestiaGLProgram *globProg, const Object &obj, const Eigen::Matrix4f &pr) const;
 
     // global state
     std::vector<Object> m_objects;
@@ -0,0 +1,211 @@
+// minorbodyrenderer.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Point sprite rendering of the minor body catalog.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include "minorbodyrenderer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <celengine/astro.h>
+#include <celengine/bodyphotometry.h>
+#include <celengine/minorbodies.h>
+#include <celengine/observer.h>
+#include <celengine/pointstarrenderer.h>
+#include <celengine/pointstarvertexbuffer.h>
+#include <celengine/render.h>
+#include <celengine/star.h>
+#include <celengine/universe.h>
+#include <celutil/color.h>
+#include <celutil/taskscheduler.h>
+
+namespace celestia::render
+{
+
+namespace
+{
+
+// Catalog entries handled by one task
+constexpr std::size_t ChunkSize = 16384;
+
+// Creating a body parses its definition, so promotions are spread over
+// frames when the viewer flies into a dense part of the population.
+constexpr std::size_t MaxPromotionsPerFrame = 8;
+
+// Bodies are never removed once created, so drawing and labeling stop
+// promoting entries when the catalog has this many bodies. Panning over
+// the whole population would otherwise turn it into bodies bit by bit.
+constexpr std::size_t MaxCatalogBodies = 1000;
+
+// With labels enabled, entries at least this much brighter than the
+// faintest visible magnitude are promoted so that they get one.
+constexpr float LabelMagnitudeMargin = 2.0f;
+
+// Beyond this distance from the primary even the largest asteroids are far
+// below the magnitude limit, and the population isn't evaluated at all.
+constexpr double MaxViewerDistance = 1000.0 * KM_PER_AU<double>;
+
+// Sprites are placed on a sphere of this radius about the viewer, in the
+// light year units of the star pass, anywhere between the clip planes.
+constexpr float SpriteDistance = 1.0f;
+
+constexpr Color AsteroidColor(0.75f, 0.72f, 0.68f);
+
+struct Light
+{
+    Eigen::Vector3d position;
+    float luminosity;
+};
+
+} // end unnamed namespace
+
+
+struct MinorBodyRenderer::Chunk
+{
+    struct Sprite
+    {
+        Eigen::Vector3f direction;
+        float appMag;
+    };
+
+    struct Promotion
+    {
+        MinorBodyCatalog::IndexNumber index;
+        float appMag;
+    };
+
+    BodyPhotometry photometry;
+    std::vector<MinorBodyCatalog::IndexNumber> indices;
+    std::vector<Eigen::Vector3f> directions;
+    std::vector<Sprite> sprites;
+    std::vector<Promotion> promotions;
+};
+
+
+MinorBodyRenderer::MinorBodyRenderer(Renderer &renderer) :
+    m_renderer(renderer)
+{
+}
+
+
+MinorBodyRenderer::~MinorBodyRenderer() = default;
+
+
+void
+MinorBodyRenderer::render(const Universe &universe,
+                          const Observer &observer,
+                          PointStarVertexBuffer &vertexBuffer,
+                          float pixelSize,
+                          float cosFOV,
+                          float faintestMag,
+                          bool promoteLabeled)
+{
+    const MinorBodyCatalog *catalog = universe.getMinorBodyCatalog();
+    if (catalog == nullptr || catalog->getPrimary() == nullptr || catalog->size() == 0)
+        return;
+
+    const Star &primary = *catalog->getPrimary();
+    double t = observer.getTime();
+    Eigen::Vector3d observerPos = observer.getPosition().offsetFromKm(primary.getPosition(t));
+    if (observerPos.norm() > MaxViewerDistance)
+        return;
+
+    Eigen::Vector3d viewNormal = m_renderer.getCameraOrientation().conjugate() * -Eigen::Vector3d::UnitZ();
+    std::array<Light, 1> lights{ Light{ -observerPos, primary.getLuminosity() } };
+    float promotionMag = promoteLabeled ? faintestMag - LabelMagnitudeMargin
+                                        : -std::numeric_limits<float>::infinity();
+
+    std::size_t nChunks = (catalog->size() + ChunkSize - 1) / ChunkSize;
+    while (m_chunks.size() < nChunks)
+        m_chunks.push_back(std::make_unique<Chunk>());
+
+    util::GetTaskScheduler().parallelFor(0, nChunks, 1, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t c = begin; c < end; ++c)
+        {
+            Chunk &chunk = *m_chunks[c];
+            chunk.photometry.truncate(0);
+            chunk.indices.clear();
+            chunk.directions.clear();
+            chunk.sprites.clear();
+            chunk.promotions.clear();
+
+            auto last = static_cast<MinorBodyCatalog::IndexNumber>(std::min((c + 1) * ChunkSize, catalog->size()));
+            for (auto i = static_cast<MinorBodyCatalog::IndexNumber>(c * ChunkSize); i < last; ++i)
+            {
+                // Promoted entries are drawn as bodies
+                if (catalog->getBody(i) != nullptr)
+                    continue;
+
+                Eigen::Vector3d relPos = catalog->getPosition(i, t) - observerPos;
+                double distance = relPos.norm();
+                if (relPos.dot(viewNormal) < cosFOV * distance)
+                    continue;
+
+                auto elements = catalog->getElements(i);
+                chunk.photometry.add(relPos, catalog->getRadius(i), elements.absMag, elements.slopeParameter);
+                chunk.indices.push_back(i);
+                chunk.directions.push_back((relPos / distance).cast<float>());
+            }
+
+            chunk.photometry.evaluate(0, BodyPhotometry::Model::HG, lights, pixelSize);
+
+            for (std::size_t j = 0; j < chunk.indices.size(); ++j)
+            {
+                float appMag = chunk.photometry.appMag(j);
+                if (chunk.photometry.discSize(j) > 1.0f || appMag < promotionMag)
+                    chunk.promotions.push_back({ chunk.indices[j], appMag });
+                if (appMag < faintestMag)
+                    chunk.sprites.push_back({ chunk.directions[j], appMag });
+            }
+        }
+    }, "minor bodies");
+
+    // Only the main thread touches the vertex buffer
+    float size = BaseStarDiscSize * static_cast<float>(m_renderer.getScreenDpi()) / 96.0f;
+    std::vector<Chunk::Promotion> promotions;
+    for (std::size_t c = 0; c < nChunks; ++c)
+    {
+        for (const auto &sprite : m_chunks[c]->sprites)
+        {
+            float pointSize, alpha, glareSize, glareAlpha;
+            m_renderer.calculatePointSize(sprite.appMag, size, pointSize, alpha, glareSize, glareAlpha);
+            if (pointSize != 0.0f)
+                vertexBuffer.addStar(sprite.direction * SpriteDistance, Color(AsteroidColor, alpha), pointSize);
+        }
+
+        promotions.insert(promotions.end(), m_chunks[c]->promotions.begin(), m_chunks[c]->promotions.end());
+    }
+
+    // Brightest first
+    std::size_t bodyCount = catalog->getBodyCount() + m_promotions.size();
+    std::size_t nPromotions = std::min({ promotions.size(),
+                                         MaxPromotionsPerFrame,
+                                         MaxCatalogBodies - std::min(bodyCount, MaxCatalogBodies) });
+    std::partial_sort(promotions.begin(), promotions.begin() + nPromotions, promotions.end(),
+                      [](const Chunk::Promotion &a, const Chunk::Promotion &b) { return a.appMag < b.appMag; });
+    for (std::size_t i = 0; i < nPromotions; ++i)
+        m_promotions.push_back(promotions[i].index);
+}
+
+
+std::vector<MinorBodyCatalog::IndexNumber>
+MinorBodyRenderer::takePromotions()
+{
+    return std::exchange(m_promotions, {});
+}
+
+} // namespace celestia::render
@@ -0,0 +1,71 @@
+// minorbodyrenderer.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Point sprite rendering of the minor body catalog.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <celengine/minorbodies.h>
+
+class Observer;
+class PointStarVertexBuffer;
+class Renderer;
+class Universe;
+
+namespace celestia::render
+{
+
+/*! Draws the entries of a minor body catalog as point sprites in the star
+ *  pass, without creating Body objects for them. Positions and magnitudes
+ *  of the whole population are computed in chunks on the task scheduler
+ *  and the visible entries are streamed into a single point vertex buffer.
+ *
+ *  Entries whose disc is larger than a pixel, or which are bright enough
+ *  to be labeled, are queued for promotion to full bodies. The simulation
+ *  promotes them after the frame, and they are drawn by the normal body
+ *  rendering path from then on.
+ */
+class MinorBodyRenderer
+{
+public:
+    explicit MinorBodyRenderer(Renderer &renderer);
+    ~MinorBodyRenderer();
+    MinorBodyRenderer(const MinorBodyRenderer&) = delete;
+    MinorBodyRenderer(MinorBodyRenderer&&) = delete;
+    MinorBodyRenderer& operator=(const MinorBodyRenderer&) = delete;
+    MinorBodyRenderer& operator=(MinorBodyRenderer&&) = delete;
+
+    /*! Add sprites for the catalog of the universe to vertexBuffer, which
+     *  must have been started with the star pass transforms. Entries
+     *  outside a cone of half angle acos(cosFOV) about the view direction
+     *  or fainter than faintestMag are skipped.
+     */
+    void render(const Universe &universe,
+                const Observer &observer,
+                PointStarVertexBuffer &vertexBuffer,
+                float pixelSize,
+                float cosFOV,
+                float faintestMag,
+                bool promoteLabeled);
+
+    //! Return and clear the entries queued for promotion, brightest first
+    std::vector<MinorBodyCatalog::IndexNumber> takePromotions();
+
+private:
+    struct Chunk;
+
+    Renderer                                   &m_renderer;
+    std::vector<std::unique_ptr<Chunk>>         m_chunks;
+    std::vector<MinorBodyCatalog::IndexNumber>  m_promotions;
+};
+
+} // namespace celestia::render
@@ -9,6 +9,7 @@
 // of the License, or (at your option) any later version.
 
 #include <algorithm>
+#include <limits>
 #include <celengine/meshmanager.h>
 #include <celengine/nebula.h>
 #include <celengine/rendcontext.h>
@@ -67,14 +68,35 @@ NebulaRenderer::render()
     std::sort(m_objects.begin(), m_objects.end(),
         [](const auto &o1, const auto &o2){ return o1.offset.squaredNorm() > o2.offset.squaredNorm(); });
 
+    float nearZ = std::numeric_limits<float>::quiet_NaN();
+    float farZ = std::numeric_limits<float>::quiet_NaN();
+    Eigen::Matrix4f pr;
+
+    // Unlike galaxies and globulars, nebulae aren't grouped by depth range:
+    // their meshes are drawn through a render context that sets the matrices
+    // with the transform of each nebula anyway, and they must stay in back
+    // to front order. Nebulae at similar distances share a depth range, so
+    // the projection is only rebuilt when it changes.
     for (const auto &obj : m_objects)
-        renderNebula(obj);
+    {
+        if (obj.nearZ != nearZ || obj.farZ != farZ)
+        {
+            nearZ = obj.nearZ;
+            farZ = obj.farZ;
+            if (nearZ != 0.0f && farZ != 0.0f)
+                m_renderer.buildProjectionMatrix(pr, nearZ, farZ, m_zoom);
+            else
+                pr = m_renderer.getProjectionMatrix();
+        }
+
+        renderNebula(obj, pr);
+    }
 
     m_objects.clear();
 }
 
 void
-NebulaRenderer::renderNebula(const Object &obj) const
+NebulaRenderer::renderNebula(const Object &obj, const Eigen::Matrix4f &pr) const
 {
     Geometry *g = nullptr;
     if (auto geometry = obj.nebula->getGeometry(); geometry != InvalidResource)
@@ -82,12 +104,6 @@ NebulaRenderer::renderNebula(const Object &obj) const
     if (g == nullptr)
         return;
 
-    Eigen::Matrix4f pr;
-    if (obj.nearZ != 0.0f && obj.farZ != 0.0f)
-        m_renderer.buildProjectionMatrix(pr, obj.nearZ, obj.farZ, m_zoom);
-    else
-        pr = m_renderer.getProjectionMatrix();
-
     Renderer::PipelineState ps;
     ps.smoothLines = true;
     m_renderer.setPipelineState(ps);
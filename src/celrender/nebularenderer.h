@@ -35,7 +35,7 @@ public:
 private:
     struct Object;
 
-    void renderNebula(const Object &obj) const;
+    void renderNebula(const Object &obj, const Eigen::Matrix4f &pr) const;
 
     // global state
     std::vector<Object> m_objects;
@@ -11,6 +11,7 @@ class GalaxyRenderer;
 class GlobularRenderer;
 class LargeStarRenderer;
 class LineRenderer;
+class MinorBodyRenderer;
 class NebulaRenderer;
 class OpenClusterRenderer;
 }
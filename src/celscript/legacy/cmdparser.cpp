@@ -1043,6 +1043,7 @@ std::unique_ptr<ParseCommandMap> createParseCommandMap()
             { "play"sv,                    &parsePlayCommand                              },
             { "overlay"sv,                 &parseOverlayCommand                           },
             { "verbosity"sv,               &parseVerbosityCommand                         },
+            { "memoryusage"sv,             &parseParameterlessCommand<CommandMemoryUsage> },
             { "setwindowbordersvisible"sv, &parseSetWindowBordersVisibleCommand           },
             { "setringstexture"sv,         &parseSetRingsTextureCommand                   },
         });
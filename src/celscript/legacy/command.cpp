@@ -33,6 +33,7 @@
 #include <celmath/mathlib.h>
 #include <celutil/filetype.h>
 #include <celutil/logger.h>
+#include <celutil/memoryusage.h>
 #include <celutil/stringutils.h>
 #include "execenv.h"
 
@@ -45,7 +46,28 @@ namespace celestia::scripts
 namespace
 {
 constexpr std::size_t MAX_CONSTELLATIONS = 100;
+
+// Preload the resources needed at the end of a goto to the predicted
+// target, assuming it is approached along the current line of sight.
+void predictGoto(ExecutionEnvironment& env, const RoutePrediction& prediction,
+                 double gotoTime, double distance)
+{
+    RoutePreloader* preloader = env.getCelestiaCore()->getRoutePreloader();
+    if (!prediction.preload || prediction.target.body() == nullptr || preloader == nullptr)
+        return;
+
+    const Observer& observer = env.getSimulation()->getObserver();
+    double tdb = env.getSimulation()->getTime();
+    UniversalCoord targetPos = prediction.target.getPosition(tdb);
+    Eigen::Vector3d direction = observer.getPosition().offsetFromKm(targetPos);
+    if (direction.squaredNorm() == 0.0)
+        direction = Eigen::Vector3d::UnitZ();
+
+    UniversalCoord viewpoint = targetPos.offsetKm(direction.normalized() * prediction.target.radius() * distance);
+    preloader->preload(prediction.target, viewpoint, tdb,
+                       prediction.time + gotoTime, observer.getFOV());
 }
+} // end unnamed namespace
 
 double InstantaneousCommand::getDuration() const
 {
@@ -92,6 +114,11 @@ void CommandSelect::processInstantaneous(ExecutionEnvironment& env)
     env.getSimulation()->setSelection(sel);
 }
 
+void CommandSelect::predictRoute(ExecutionEnvironment& env, RoutePrediction& prediction) const
+{
+    prediction.target = env.getSimulation()->findObjectFromPath(target);
+}
+
 
 
 ////////////////
@@ -116,6 +143,11 @@ void CommandGoto::processInstantaneous(ExecutionEnvironment& env)
                                        up, upFrame);
 }
 
+void CommandGoto::predictRoute(ExecutionEnvironment& env, RoutePrediction& prediction) const
+{
+    predictGoto(env, prediction, gotoTime, distance);
+}
+
 
 ////////////////
 // GotoLongLat command: go to the selected body and hover over
@@ -142,6 +174,11 @@ void CommandGotoLongLat::processInstantaneous(ExecutionEnvironment& env)
                                               up);
 }
 
+void CommandGotoLongLat::predictRoute(ExecutionEnvironment& env, RoutePrediction& prediction) const
+{
+    predictGoto(env, prediction, gotoTime, distance);
+}
+
 
 /////////////////////////////
 // GotoLocation
@@ -665,7 +702,10 @@ void CommandPreloadTextures::processInstantaneous(ExecutionEnvironment& env)
     if (target.body() == nullptr)
         return;
 
-    if (env.getRenderer() != nullptr)
+    // Textures not decoded by the time they are drawn are loaded then
+    if (RoutePreloader* preloader = env.getCelestiaCore()->getRoutePreloader(); preloader != nullptr)
+        preloader->preload(target.body());
+    else if (env.getRenderer() != nullptr)
         env.getRenderer()->loadTextures(target.body());
 }
 
@@ -962,6 +1002,15 @@ void CommandVerbosity::processInstantaneous(ExecutionEnvironment& env)
 }
 
 
+////////////////
+// Memory usage command: write the memory used by each subsystem to the console
+
+void CommandMemoryUsage::processInstantaneous(ExecutionEnvironment& /*unused*/)
+{
+    GetLogger()->info("Memory usage: {}\n", celestia::util::FormatMemoryUsage());
+}
+
+
 ///////////////
 //
 
@@ -33,6 +33,16 @@ namespace celestia::scripts
 
 class ExecutionEnvironment;
 
+// State of a script as it is expected to be after the commands before
+// the one being predicted, and the script time until it starts.
+struct RoutePrediction
+{
+    Selection target;
+    double time{ 0.0 };
+    // False while replaying commands whose resources were already requested
+    bool preload{ false };
+};
+
 class Command
 {
  public:
@@ -41,6 +51,10 @@ class Command
 
     virtual void process(ExecutionEnvironment&, double t, double dt) = 0;
     virtual double getDuration() const = 0;
+
+    // Called ahead of execution so that commands can request the resources
+    // they will need; commands changing the selection update prediction.
+    virtual void predictRoute(ExecutionEnvironment&, RoutePrediction&) const {}
 };
 
 using CommandSequence = std::vector<std::unique_ptr<Command>>;
@@ -89,6 +103,8 @@ class CommandSelect : public InstantaneousCommand
  public:
     CommandSelect(std::string _target);
 
+    void predictRoute(ExecutionEnvironment&, RoutePrediction&) const override;
+
  protected:
     void processInstantaneous(ExecutionEnvironment&) override;
 
@@ -105,6 +121,8 @@ class CommandGoto : public InstantaneousCommand
                 const Eigen::Vector3f &_up,
                 ObserverFrame::CoordinateSystem _upFrame);
 
+    void predictRoute(ExecutionEnvironment&, RoutePrediction&) const override;
+
  protected:
     void processInstantaneous(ExecutionEnvironment&) override;
 
@@ -125,6 +143,8 @@ class CommandGotoLongLat : public InstantaneousCommand
                        float _latitude,
                        const Eigen::Vector3f &_up);
 
+    void predictRoute(ExecutionEnvironment&, RoutePrediction&) const override;
+
  protected:
     void processInstantaneous(ExecutionEnvironment&) override;
 
@@ -778,6 +798,13 @@ class CommandVerbosity : public InstantaneousCommand
 };
 
 
+class CommandMemoryUsage : public InstantaneousCommand
+{
+ protected:
+    void processInstantaneous(ExecutionEnvironment&) override;
+};
+
+
 class CommandSetWindowBordersVisible : public InstantaneousCommand
 {
  public:
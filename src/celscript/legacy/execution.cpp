@@ -9,11 +9,22 @@
 
 #include "execution.h"
 
+#include <algorithm>
 #include <utility>
 
+#include <celengine/simulation.h>
+#include "execenv.h"
+
 namespace celestia::scripts
 {
 
+namespace
+{
+// Script time ahead of the current command searched for gotos
+constexpr double PredictionTime = 30.0;
+}
+
+
 Execution::Execution(CommandSequence&& cmd, ExecutionEnvironment& _env) :
     commandSequence(std::move(cmd)),
     env(_env)
@@ -32,6 +43,8 @@ bool Execution::tick(double dt)
         return false;
     }
 
+    predictRoute();
+
     while (dt > 0.0 && currentCommand < commandSequence.size())
     {
         Command* cmd = commandSequence[currentCommand].get();
@@ -55,4 +68,28 @@ bool Execution::tick(double dt)
     return currentCommand == commandSequence.size();
 }
 
+
+// Let the commands in the next few seconds of the script request what
+// they will need, replaying the ones already seen only to track the
+// selection.
+void Execution::predictRoute()
+{
+    if (predictedCommand >= commandSequence.size())
+        return;
+
+    RoutePrediction prediction;
+    prediction.target = env.getSimulation()->getSelection();
+    prediction.time = -std::max(commandTime, 0.0);
+
+    std::size_t i = currentCommand;
+    for (; i < commandSequence.size() && prediction.time < PredictionTime; ++i)
+    {
+        prediction.preload = i >= predictedCommand;
+        commandSequence[i]->predictRoute(env, prediction);
+        prediction.time += commandSequence[i]->getDuration();
+    }
+
+    predictedCommand = std::max(predictedCommand, i);
 }
+
+} // end namespace celestia::scripts
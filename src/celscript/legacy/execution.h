@@ -26,10 +26,14 @@ class Execution
     bool tick(double);
 
  private:
+    void predictRoute();
+
     CommandSequence commandSequence;
     std::size_t currentCommand{ 0 };
     ExecutionEnvironment& env;
     double commandTime{ -1.0 };
+    // Commands before this one have had their resources requested
+    std::size_t predictedCommand{ 0 };
 };
 
 } // end namespace celestia::scripts
@@ -12,6 +12,7 @@
 
 #include <config.h>
 #include <cassert>
+#include <chrono>
 #include <ctime>
 #include <iostream>
 #include <map>
@@ -41,6 +42,7 @@
 #include "celx_celestia.h"
 #include "celx_gl.h"
 #include "celx_category.h"
+#include "luaprofiler.h"
 
 
 using namespace Eigen;
@@ -71,6 +73,9 @@ const char* CelxLua::ClassNames[] =
 // returning control to celestia
 static const double MaxTimeslice = 5.0;
 
+// Lua instructions between checks of the timeslice
+static const int TimesliceCheckInterval = 1000;
+
 // names of callback-functions in Lua:
 const char* KbdCallback = "celestia_keyboard_callback";
 const char* CleanupCallback = "celestia_cleanup_callback";
@@ -143,12 +148,47 @@ void Celx_CreateClassMetatable(lua_State* l, int id)
     lua_rawset(l, -3);
 }
 
+// Call the method stored in the second upvalue, timing it if the profiler
+// is running. The metatable stays the first upvalue of the closure, as
+// methods expect.
+static int callMethod(lua_State* l)
+{
+    lua_CFunction fn = *static_cast<lua_CFunction*>(lua_touserdata(l, lua_upvalueindex(2)));
+    LuaProfiler* profiler = LuaProfiler::getActive();
+    if (profiler == nullptr)
+        return fn(l);
+
+    // A method raising an error doesn't return here, and its time is
+    // charged to the next sample instead.
+    auto start = std::chrono::steady_clock::now();
+    int nResults = fn(l);
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    profiler->addCall(l, lua_tostring(l, lua_upvalueindex(3)), time);
+    return nResults;
+}
+
 // Register a class 'method' in the metatable (assumed to be on top of the stack)
 void Celx_RegisterMethod(lua_State* l, const char* name, lua_CFunction fn)
 {
+    // Name the method after its class for the profiler, e.g. object:getposition
+    string methodName;
+    lua_pushvalue(l, -1);
+    lua_rawget(l, LUA_REGISTRYINDEX);
+    if (lua_type(l, -1) == LUA_TSTRING)
+    {
+        methodName = lua_tostring(l, -1);
+        if (methodName.compare(0, 6, "class_") == 0)
+            methodName.erase(0, 6);
+        methodName += ':';
+    }
+    methodName += name;
+    lua_pop(l, 1);
+
     lua_pushstring(l, name);
     lua_pushvalue(l, -2);
-    lua_pushcclosure(l, fn, 1);
+    *static_cast<lua_CFunction*>(lua_newuserdata(l, sizeof(lua_CFunction))) = fn;
+    lua_pushstring(l, methodName.c_str());
+    lua_pushcclosure(l, callMethod, 3);
     lua_settable(l, -3);
 }
 
@@ -206,6 +246,9 @@ CelestiaCore* getAppCore(lua_State* l, FatalErrors fatalErrors)
 }
 
 
+static void checkTimeslice(lua_State* l, lua_Debug* /*ar*/);
+
+
 LuaState::LuaState() :
     timeout(MaxTimeslice)
 {
@@ -216,6 +259,8 @@ LuaState::LuaState() :
 
 LuaState::~LuaState()
 {
+    if (profiler != nullptr && LuaProfiler::getActive() == profiler.get())
+        LuaProfiler::setActive(nullptr);
     delete timer;
     if (state != nullptr)
         lua_close(state);
@@ -237,6 +282,47 @@ double LuaState::getTime() const
 }
 
 
+// Allow the script to run for duration seconds from now
+void LuaState::startTimeslice(double duration)
+{
+    timeout = getTime() + duration;
+    if (isProfiling())
+        profiler->enter();
+}
+
+
+void LuaState::startProfiler(int interval)
+{
+    profiler = std::make_unique<LuaProfiler>(interval);
+    LuaProfiler::setActive(profiler.get());
+    if (costate != nullptr)
+        lua_sethook(costate, checkTimeslice, LUA_MASKCOUNT, profiler->getInterval());
+}
+
+
+void LuaState::stopProfiler()
+{
+    if (!isProfiling())
+        return;
+
+    LuaProfiler::setActive(nullptr);
+    if (costate != nullptr)
+        lua_sethook(costate, checkTimeslice, LUA_MASKCOUNT, TimesliceCheckInterval);
+}
+
+
+bool LuaState::isProfiling() const
+{
+    return profiler != nullptr && LuaProfiler::getActive() == profiler.get();
+}
+
+
+LuaProfiler* LuaState::getProfiler() const
+{
+    return profiler.get();
+}
+
+
 // Check if the running script has exceeded its allowed timeslice
 // and terminate it if it has:
 static void checkTimeslice(lua_State* l, lua_Debug* /*ar*/)
@@ -263,6 +349,9 @@ static void checkTimeslice(lua_State* l, lua_Debug* /*ar*/)
         lua_pushstring(l, errormsg);
         lua_error(l);
     }
+
+    if (luastate->isProfiling())
+        luastate->getProfiler()->sample(l);
 }
 
 
@@ -296,7 +385,7 @@ void LuaState::cleanup()
     if (lua_isnil(costate, -1))
         return;
 
-    timeout = getTime() + 1.0;
+    startTimeslice(1.0);
     if (lua_pcall(costate, 0, 0, 0) != 0)
     {
         GetLogger()->error("Error while executing cleanup-callback: {}\n",
@@ -319,7 +408,8 @@ bool LuaState::createThread()
     if (costate == nullptr)
         return false;
 
-    lua_sethook(costate, checkTimeslice, LUA_MASKCOUNT, 1000);
+    lua_sethook(costate, checkTimeslice, LUA_MASKCOUNT,
+                isProfiling() ? profiler->getInterval() : TimesliceCheckInterval);
     lua_pushvalue(state, -2);
     lua_xmove(state, costate, 1);  // move function from L to NL/
     alive = true;
@@ -468,7 +558,7 @@ bool LuaState::charEntered(const char* c_p)
     bool result = true;
     lua_getglobal(costate, KbdCallback);
     lua_pushstring(costate, c_p);
-    timeout = getTime() + 1.0;
+    startTimeslice(1.0);
     if (lua_pcall(costate, 1, 1, 0) != 0)
     {
         GetLogger()->error("Error while executing keyboard-callback: {}\n",
@@ -515,7 +605,7 @@ bool LuaState::handleKeyEvent(const char* key)
         lua_pushstring(costate, key);   // the default key handler accepts the key name as an argument
         lua_settable(costate, -3);
 
-        timeout = getTime() + 1.0;
+        startTimeslice(1.0);
         if (lua_pcall(costate, 1, 1, 0) != 0)
         {
             GetLogger()->error("Error while executing keyboard callback: {}\n",
@@ -569,7 +659,7 @@ bool LuaState::handleMouseButtonEvent(float x, float y, int button, bool down)
         lua_pushnumber(costate, y);
         lua_settable(costate, -3);
 
-        timeout = getTime() + 1.0;
+        startTimeslice(1.0);
         if (lua_pcall(costate, 1, 1, 0) != 0)
         {
             GetLogger()->error("Error while executing keyboard callback: {}\n",
@@ -620,7 +710,7 @@ bool LuaState::handleTickEvent(double dt)
         lua_pushnumber(costate, dt);   // the default key handler accepts the key name as an argument
         lua_settable(costate, -3);
 
-        timeout = getTime() + 1.0;
+        startTimeslice(1.0);
         if (lua_pcall(costate, 1, 1, 0) != 0)
         {
             GetLogger()->error("Error while executing tick callback: {}\n",
@@ -688,7 +778,7 @@ int LuaState::resume()
     if (co != costate)
         return 0;
 
-    timeout = getTime() + MaxTimeslice;
+    startTimeslice(MaxTimeslice);
     int nArgs = resumeLuaThread(state, co, 0);
     if (nArgs < 0)
     {
@@ -1119,6 +1209,33 @@ void LuaState::setLuaPath(const string& s)
     lua_pop(state, 1);
 }
 
+lua_State* CreateScriptedObjectWorkerState(const string& luaPath, bool systemAccess)
+{
+    lua_State* state = luaL_newstate();
+    if (state == nullptr)
+        return nullptr;
+
+    openLuaLibrary(state, "", luaopen_base);
+    openLuaLibrary(state, LUA_MATHLIBNAME, luaopen_math);
+    openLuaLibrary(state, LUA_TABLIBNAME, luaopen_table);
+    openLuaLibrary(state, LUA_STRLIBNAME, luaopen_string);
+    openLuaLibrary(state, LUA_LOADLIBNAME, luaopen_package);
+    if (systemAccess)
+    {
+        openLuaLibrary(state, LUA_IOLIBNAME, luaopen_io);
+        openLuaLibrary(state, LUA_OSLIBNAME, luaopen_os);
+    }
+
+    lua_getglobal(state, "package");
+    lua_pushnil(state);
+    lua_setfield(state, -2, "loadlib");
+    lua_pushstring(state, luaPath.c_str());
+    lua_setfield(state, -2, "path");
+    lua_pop(state, 1);
+
+    return state;
+}
+
 // ==================== Load Libraries ================================================
 
 static void loadLuaLibs(lua_State* state)
@@ -1197,7 +1314,7 @@ bool LuaState::callLuaHook(void* obj, const char* method)
         lua_pushvalue(costate, -2);          // push the Lua object the stack
         lua_remove(costate, -3);        // remove the Lua object from the stack
 
-        timeout = getTime() + 1.0;
+        startTimeslice(1.0);
         if (lua_pcall(costate, 1, 1, 0) != 0)
         {
             GetLogger()->error("Error while executing Lua Hook: {}\n",
@@ -1241,7 +1358,7 @@ bool LuaState::callLuaHook(void* obj, const char* method, const char* keyName)
 
         lua_pushstring(costate, keyName);    // push the char onto the stack
 
-        timeout = getTime() + 1.0;
+        startTimeslice(1.0);
         if (lua_pcall(costate, 2, 1, 0) != 0)
         {
             GetLogger()->error("Error while executing Lua Hook: {}\n",
@@ -1286,7 +1403,7 @@ bool LuaState::callLuaHook(void* obj, const char* method, float x, float y)
         lua_pushnumber(costate, x);          // push x onto the stack
         lua_pushnumber(costate, y);          // push y onto the stack
 
-        timeout = getTime() + 1.0;
+        startTimeslice(1.0);
         if (lua_pcall(costate, 3, 1, 0) != 0)
         {
             GetLogger()->error("Error while executing Lua Hook: {}\n",
@@ -1332,7 +1449,7 @@ bool LuaState::callLuaHook(void* obj, const char* method, float x, float y, int
         lua_pushnumber(costate, y);          // push y onto the stack
         lua_pushnumber(costate, b);          // push b onto the stack
 
-        timeout = getTime() + 1.0;
+        startTimeslice(1.0);
         if (lua_pcall(costate, 4, 1, 0) != 0)
         {
             GetLogger()->error("Error while executing Lua Hook: {}\n",
@@ -1375,7 +1492,7 @@ bool LuaState::callLuaHook(void* obj, const char* method, double dt)
         lua_remove(costate, -3);             // remove the Lua object from the stack
         lua_pushnumber(costate, dt);
 
-        timeout = getTime() + 1.0;
+        startTimeslice(1.0);
         if (lua_pcall(costate, 2, 1, 0) != 0)
         {
             GetLogger()->error("Error while executing Lua Hook: {}\n",
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <iosfwd>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -30,6 +31,7 @@ int lua_isinteger(lua_State *L, int index);
 #endif
 
 class CelestiaCore;
+class LuaProfiler;
 class View;
 
 class LuaState
@@ -75,6 +77,13 @@ public:
     bool callLuaHook(void* obj, const char* method, float x, float y, int b);
     bool callLuaHook(void* obj, const char* method, double dt);
 
+    // Sampling profiler; starting it discards earlier samples, stopping
+    // it keeps them for getProfiler()->write().
+    void startProfiler(int interval);
+    void stopProfiler();
+    bool isProfiling() const;
+    LuaProfiler* getProfiler() const;
+
     enum class IOMode
     {
         NotDetermined  = 1,
@@ -84,6 +93,8 @@ public:
     };
 
 private:
+    void startTimeslice(double duration);
+
     lua_State* state;
     lua_State* costate{ nullptr }; // coroutine stack
     bool alive{ false };
@@ -91,7 +102,13 @@ private:
     double scriptAwakenTime{ 0.0 };
     IOMode ioMode{ IOMode::NotDetermined };
     bool eventHandlerEnabled{ false };
+    std::unique_ptr<LuaProfiler> profiler;
 };
 
+// Create a Lua state for evaluating scripted orbits and rotations on a
+// worker thread. It has the standard libraries (and the package library
+// without loadlib) but none of the celx classes, which are not thread safe.
+lua_State* CreateScriptedObjectWorkerState(const std::string& luaPath, bool systemAccess);
+
 View* getViewByObserver(CelestiaCore*, Observer*);
 void getObservers(CelestiaCore*, std::vector<Observer*>&);
@@ -11,6 +11,7 @@
 
 #include <iostream>
 #include <optional>
+#include <sstream>
 
 #include <fmt/format.h>
 
@@ -25,6 +26,7 @@
 #include <celttf/truetypefont.h>
 #include <celutil/gettext.h>
 #include <celutil/logger.h>
+#include <celutil/memoryusage.h>
 #include <celutil/stringutils.h>
 #include "celx.h"
 #include "celx_internal.h"
@@ -37,6 +39,7 @@
 #include "celx_rotation.h"
 #include "celx_vector.h"
 #include "celx_category.h"
+#include "luaprofiler.h"
 
 
 using namespace std;
@@ -1617,6 +1620,42 @@ static int celestia_getminorbitsize(lua_State* l)
     return 1;
 }
 
+static int celestia_setcategoryfilter(lua_State* l)
+{
+    Celx_CheckArgs(l, 2, 2, "One argument expected in celestia:setcategoryfilter");
+    CelestiaCore* appCore = this_celestia(l);
+
+    const char* expression = Celx_SafeGetString(l, 2, AllErrors, "Argument to celestia:setcategoryfilter() must be a string");
+    Renderer* renderer = appCore->getRenderer();
+    if (renderer == nullptr)
+    {
+        Celx_DoError(l, "Internal Error: renderer is nullptr!");
+        return 0;
+    }
+
+    auto filter = CategoryFilter::parse(expression == nullptr ? "" : expression);
+    if (filter.has_value())
+        renderer->setCategoryFilter(std::move(*filter));
+    lua_pushboolean(l, filter.has_value());
+    return 1;
+}
+
+static int celestia_getcategoryfilter(lua_State* l)
+{
+    Celx_CheckArgs(l, 1, 1, "No argument expected in celestia:getcategoryfilter");
+    CelestiaCore* appCore = this_celestia(l);
+
+    Renderer* renderer = appCore->getRenderer();
+    if (renderer == nullptr)
+    {
+        Celx_DoError(l, "Internal Error: renderer is nullptr!");
+        return 0;
+    }
+
+    lua_pushstring(l, renderer->getCategoryFilter().getExpression().c_str());
+    return 1;
+}
+
 static int celestia_setstardistancelimit(lua_State* l)
 {
     Celx_CheckArgs(l, 2, 2, "One argument expected in celestia:setstardistancelimit");
@@ -2625,6 +2664,8 @@ void CreateCelestiaMetaTable(lua_State* l)
     Celx_RegisterMethod(l, "settintsaturation", celestia_settintsaturation);
     Celx_RegisterMethod(l, "getminorbitsize", celestia_getminorbitsize);
     Celx_RegisterMethod(l, "setminorbitsize", celestia_setminorbitsize);
+    Celx_RegisterMethod(l, "getcategoryfilter", celestia_getcategoryfilter);
+    Celx_RegisterMethod(l, "setcategoryfilter", celestia_setcategoryfilter);
     Celx_RegisterMethod(l, "getstardistancelimit", celestia_getstardistancelimit);
     Celx_RegisterMethod(l, "setstardistancelimit", celestia_setstardistancelimit);
     Celx_RegisterMethod(l, "getstarstyle", celestia_getstarstyle);
@@ -2820,6 +2861,72 @@ static int celestia_settimeslice(lua_State* l)
     return 0;
 }
 
+static int celestia_startprofiler(lua_State* l)
+{
+    Celx_CheckArgs(l, 1, 2, "At most one argument expected for celestia:startprofiler()");
+    this_celestia(l);
+
+    auto interval = static_cast<int>(Celx_SafeGetNumber(l, 2, WrongType,
+                                                        "Argument to celestia:startprofiler must be a number",
+                                                        LuaProfiler::DefaultInterval));
+    if (interval < 1)
+    {
+        Celx_DoError(l, "Instruction interval for celestia:startprofiler must be positive");
+        return 0;
+    }
+
+    getLuaStateObject(l)->startProfiler(interval);
+    return 0;
+}
+
+static int celestia_stopprofiler(lua_State* l)
+{
+    Celx_CheckArgs(l, 1, 1, "No argument expected for celestia:stopprofiler()");
+    this_celestia(l);
+
+    getLuaStateObject(l)->stopProfiler();
+    return 0;
+}
+
+// Return the samples collected since the profiler was started as folded
+// stacks for flame graph tools, or nil if it never was.
+static int celestia_getprofile(lua_State* l)
+{
+    Celx_CheckArgs(l, 1, 1, "No argument expected for celestia:getprofile()");
+    this_celestia(l);
+
+    const LuaProfiler* profiler = getLuaStateObject(l)->getProfiler();
+    if (profiler == nullptr)
+    {
+        lua_pushnil(l);
+        return 1;
+    }
+
+    std::ostringstream report;
+    profiler->write(report);
+    lua_pushstring(l, report.str().c_str());
+    return 1;
+}
+
+// Return a table of the estimated memory in bytes used by each subsystem,
+// keyed by category name
+static int celestia_getmemoryusage(lua_State* l)
+{
+    Celx_CheckArgs(l, 1, 1, "No argument expected for celestia:getmemoryusage()");
+    this_celestia(l);
+
+    lua_newtable(l);
+    for (unsigned int i = 0; i < static_cast<unsigned int>(util::MemoryCategory::Count); ++i)
+    {
+        auto category = static_cast<util::MemoryCategory>(i);
+        std::string_view name = util::GetMemoryCategoryName(category);
+        lua_pushlstring(l, name.data(), name.size());
+        lua_pushnumber(l, static_cast<lua_Number>(util::GetMemoryUsage(category)));
+        lua_settable(l, -3);
+    }
+    return 1;
+}
+
 static int celestia_setluahook(lua_State* l)
 {
     Celx_CheckArgs(l, 2, 2, "One argument required for celestia:setluahook()");
@@ -2937,6 +3044,16 @@ static int celestia_bindtranslationdomain(lua_State *l)
     const char *newdir = bindtextdomain(domain, dir);
     if (newdir == nullptr)
         return 0;
+
+    // Cached label names may come from the rebound domain
+    if (const Universe* universe = celx.appCore(AllErrors)->getSimulation()->getUniverse(); universe != nullptr)
+    {
+        if (const StarDatabase* stars = universe->getStarCatalog(); stars != nullptr)
+            stars->invalidateDisplayNames();
+        if (const DSODatabase* dsos = universe->getDSOCatalog(); dsos != nullptr)
+            dsos->invalidateDisplayNames();
+    }
+
     return celx.push(newdir);
 #else
     return 0;
@@ -2966,6 +3083,10 @@ void ExtendCelestiaMetaTable(lua_State* l)
     celx.registerMethod("log", celestia_log);
     celx.registerMethod("settimeslice", celestia_settimeslice);
     celx.registerMethod("setluahook", celestia_setluahook);
+    celx.registerMethod("startprofiler", celestia_startprofiler);
+    celx.registerMethod("stopprofiler", celestia_stopprofiler);
+    celx.registerMethod("getprofile", celestia_getprofile);
+    celx.registerMethod("getmemoryusage", celestia_getmemoryusage);
     celx.registerMethod("getparamstring", celestia_getparamstring);
     celx.registerMethod("getfont", celestia_getfont);
     celx.registerMethod("gettitlefont", celestia_gettitlefont);
@@ -913,7 +913,14 @@ static int object_preloadtexture(lua_State* l)
     Renderer* renderer = appCore->getRenderer();
     Selection* sel = this_object(l);
 
-    if (sel->body() != nullptr && renderer != nullptr)
+    // Decode the textures in the background; whatever isn't ready when
+    // first drawn is loaded then.
+    if (RoutePreloader* preloader = appCore->getRoutePreloader();
+        sel->body() != nullptr && preloader != nullptr)
+    {
+        preloader->preload(sel->body());
+    }
+    else if (sel->body() != nullptr && renderer != nullptr)
     {
         LuaState* luastate = celx.getLuaStateObject();
         // make sure we don't timeout because of texture-loading:
@@ -0,0 +1,144 @@
+// luaprofiler.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Sampling profiler for celx scripts.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include "luaprofiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <ostream>
+
+#include <fmt/format.h>
+
+namespace
+{
+
+LuaProfiler* activeProfiler = nullptr;
+
+// Name of a stack frame for the report; semicolons separate frames in
+// the folded format, so they can't appear in names.
+void
+frameName(std::string& name, const lua_Debug& ar)
+{
+    name.clear();
+    const char* function = ar.name != nullptr ? ar.name : "?";
+    if (*ar.what == 'C')
+        name = function;
+    else if (*ar.what == 'm')
+        fmt::format_to(std::back_inserter(name), "main ({})", ar.short_src);
+    else
+        fmt::format_to(std::back_inserter(name), "{} ({}:{})", function, ar.short_src, ar.linedefined);
+
+    std::replace(name.begin(), name.end(), ';', ':');
+}
+
+} // end unnamed namespace
+
+
+LuaProfiler::LuaProfiler(int _interval) :
+    interval(std::max(_interval, 1)),
+    lastSample(Clock::now())
+{
+}
+
+
+void
+LuaProfiler::enter()
+{
+    lastSample = Clock::now();
+    callTime = 0.0;
+}
+
+
+void
+LuaProfiler::sample(lua_State* l)
+{
+    auto now = Clock::now();
+    double time = std::chrono::duration<double>(now - lastSample).count() - callTime;
+    lastSample = now;
+    callTime = 0.0;
+
+    if (time > 0.0)
+        stacks[stackKey(l, 0)] += time;
+}
+
+
+void
+LuaProfiler::addCall(lua_State* l, const char* name, double time)
+{
+    // Level 0 is the method itself, named after the call site
+    std::string callKey = stackKey(l, 1);
+    if (!callKey.empty())
+        callKey += ';';
+    callKey += name;
+
+    stacks[callKey] += time;
+    callTime += time;
+}
+
+
+const std::string&
+LuaProfiler::stackKey(lua_State* l, int level)
+{
+    lua_Debug ar;
+    std::size_t depth = 0;
+    for (; lua_getstack(l, level, &ar) != 0; ++level, ++depth)
+    {
+        lua_getinfo(l, "Sn", &ar);
+        if (depth == frames.size())
+            frames.emplace_back();
+        frameName(frames[depth], ar);
+    }
+
+    key.clear();
+    for (std::size_t i = depth; i-- > 0;)
+    {
+        key += frames[i];
+        if (i > 0)
+            key += ';';
+    }
+
+    return key;
+}
+
+
+void
+LuaProfiler::reset()
+{
+    stacks.clear();
+    enter();
+}
+
+
+void
+LuaProfiler::write(std::ostream& out) const
+{
+    for (const auto& [stack, time] : stacks)
+    {
+        auto us = static_cast<long long>(std::llround(time * 1.0e6));
+        if (us > 0)
+            out << stack << ' ' << us << '\n';
+    }
+}
+
+
+LuaProfiler*
+LuaProfiler::getActive()
+{
+    return activeProfiler;
+}
+
+
+void
+LuaProfiler::setActive(LuaProfiler* profiler)
+{
+    activeProfiler = profiler;
+}
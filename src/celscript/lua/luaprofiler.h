@@ -0,0 +1,76 @@
+// luaprofiler.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Sampling profiler for celx scripts.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <chrono>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <lua.hpp>
+
+/*! Statistical profiler for celx scripts. The count hook of the script
+ *  calls sample() every few instructions, which records the Lua call stack
+ *  and charges it with the time since the previous sample. Celx methods
+ *  don't execute Lua instructions, so they report their own run time via
+ *  addCall(); it's charged to the Lua stack of the caller with the method
+ *  appended, and not to the next sample.
+ *
+ *  The result is written in the folded stack format read by
+ *  flamegraph.pl and similar tools: one line per distinct stack, with its
+ *  frames from the outermost separated by semicolons, followed by the time
+ *  in microseconds.
+ */
+class LuaProfiler
+{
+public:
+    static constexpr int DefaultInterval = 1000;
+
+    explicit LuaProfiler(int interval = DefaultInterval);
+    ~LuaProfiler() = default;
+
+    LuaProfiler(const LuaProfiler&) = delete;
+    LuaProfiler& operator=(const LuaProfiler&) = delete;
+
+    //! Number of Lua instructions between samples
+    int getInterval() const { return interval; }
+
+    //! Restart the clock on entry into the script, so that the time the
+    //! script wasn't running isn't charged to the next sample.
+    void enter();
+    void sample(lua_State* l);
+    //! Charge time seconds spent in the celx method name to the caller
+    void addCall(lua_State* l, const char* name, double time);
+
+    void reset();
+    void write(std::ostream& out) const;
+
+    //! The profiler celx methods report to, or nullptr if none is running
+    static LuaProfiler* getActive();
+    static void setActive(LuaProfiler* profiler);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const std::string& stackKey(lua_State* l, int level);
+
+    int interval;
+    Clock::time_point lastSample;
+    // Time reported by addCall() since the last sample
+    double callTime{ 0.0 };
+    std::map<std::string, double> stacks;
+
+    // Reused between samples to avoid allocations
+    std::vector<std::string> frames;
+    std::string key;
+};
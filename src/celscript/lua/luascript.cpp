@@ -256,7 +256,8 @@ bool CreateLuaEnvironment(CelestiaCore *appCore, const CelestiaConfig *config, P
     // Set up the script context; if the system access policy is allow,
     // it will share the same context as the Lua hook. Otherwise, we
     // create a private context.
-    if (appCore->getScriptSystemAccessPolicy() == CelestiaCore::ScriptSystemAccessPolicy::Allow)
+    bool systemAccess = appCore->getScriptSystemAccessPolicy() == CelestiaCore::ScriptSystemAccessPolicy::Allow;
+    if (systemAccess)
     {
         if (luaHook != nullptr)
             celestia::ephem::SetScriptedObjectContext(luaHook->getState());
@@ -281,6 +282,12 @@ bool CreateLuaEnvironment(CelestiaCore *appCore, const CelestiaConfig *config, P
         celestia::ephem::SetScriptedObjectContext(luaSandbox->getState());
     }
 
+    // Worker threads evaluate scripted objects in states of their own
+    celestia::ephem::SetScriptedObjectWorkerFactory([LuaPath, systemAccess]()
+    {
+        return CreateScriptedObjectWorkerState(LuaPath, systemAccess);
+    });
+
     return true;
 }
 
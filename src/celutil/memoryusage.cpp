@@ -0,0 +1,165 @@
+// memoryusage.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Memory accounting of the major consumers of the engine.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include "memoryusage.h"
+
+#include <array>
+#include <atomic>
+#include <iterator>
+
+#include <fmt/format.h>
+
+namespace celestia::util
+{
+
+namespace
+{
+
+constexpr auto CategoryCount = static_cast<std::size_t>(MemoryCategory::Count);
+
+constexpr std::array<std::string_view, CategoryCount> CategoryNames
+{
+    "stars",
+    "dsos",
+    "names",
+    "bodies",
+    "locations",
+    "orbitsamples",
+    "orientationsamples",
+    "models",
+    "images",
+    "textures",
+    "buffers",
+};
+
+std::array<std::atomic<std::size_t>, CategoryCount> counters{};
+
+} // end unnamed namespace
+
+
+std::string_view
+GetMemoryCategoryName(MemoryCategory category)
+{
+    return CategoryNames[static_cast<std::size_t>(category)];
+}
+
+
+bool
+IsVideoMemoryCategory(MemoryCategory category)
+{
+    return category == MemoryCategory::Textures || category == MemoryCategory::Buffers;
+}
+
+
+void
+AddMemoryUsage(MemoryCategory category, std::size_t bytes)
+{
+    counters[static_cast<std::size_t>(category)].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+
+void
+RemoveMemoryUsage(MemoryCategory category, std::size_t bytes)
+{
+    counters[static_cast<std::size_t>(category)].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+
+std::size_t
+GetMemoryUsage(MemoryCategory category)
+{
+    return counters[static_cast<std::size_t>(category)].load(std::memory_order_relaxed);
+}
+
+
+std::string
+FormatMemoryUsage()
+{
+    constexpr double MiB = 1024.0 * 1024.0;
+
+    std::string result;
+    std::size_t systemTotal = 0;
+    std::size_t videoTotal = 0;
+    for (std::size_t i = 0; i < CategoryCount; ++i)
+    {
+        auto category = static_cast<MemoryCategory>(i);
+        std::size_t bytes = GetMemoryUsage(category);
+        (IsVideoMemoryCategory(category) ? videoTotal : systemTotal) += bytes;
+        fmt::format_to(std::back_inserter(result), "{} {:.1f}, ", CategoryNames[i], bytes / MiB);
+    }
+
+    fmt::format_to(std::back_inserter(result), "total {:.1f}, video {:.1f} MiB",
+                   systemTotal / MiB, videoTotal / MiB);
+    return result;
+}
+
+
+MemoryTracker::MemoryTracker(MemoryCategory category, std::size_t bytes) :
+    m_category(category),
+    m_bytes(bytes)
+{
+    AddMemoryUsage(m_category, m_bytes);
+}
+
+
+MemoryTracker::~MemoryTracker()
+{
+    RemoveMemoryUsage(m_category, m_bytes);
+}
+
+
+MemoryTracker::MemoryTracker(const MemoryTracker& other) :
+    MemoryTracker(other.m_category, other.m_bytes)
+{
+}
+
+
+MemoryTracker::MemoryTracker(MemoryTracker&& other) noexcept :
+    m_category(other.m_category),
+    m_bytes(other.m_bytes)
+{
+    other.m_bytes = 0;
+}
+
+
+MemoryTracker&
+MemoryTracker::operator=(const MemoryTracker& other)
+{
+    if (this != &other)
+        set(other.m_bytes);
+    return *this;
+}
+
+
+MemoryTracker&
+MemoryTracker::operator=(MemoryTracker&& other) noexcept
+{
+    if (this != &other)
+    {
+        RemoveMemoryUsage(m_category, m_bytes);
+        m_bytes = other.m_bytes;
+        other.m_bytes = 0;
+    }
+    return *this;
+}
+
+
+void
+MemoryTracker::set(std::size_t bytes)
+{
+    if (bytes >= m_bytes)
+        AddMemoryUsage(m_category, bytes - m_bytes);
+    else
+        RemoveMemoryUsage(m_category, m_bytes - bytes);
+    m_bytes = bytes;
+}
+
+} // end namespace celestia::util
@@ -0,0 +1,83 @@
+// memoryusage.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Memory accounting of the major consumers of the engine.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace celestia::util
+{
+
+enum class MemoryCategory : unsigned int
+{
+    //! Star and DSO catalogs, including their octrees and indexes
+    Stars,
+    DeepSkyObjects,
+    //! Name databases and label caches
+    Names,
+    Bodies,
+    Locations,
+    OrbitSamples,
+    OrientationSamples,
+    //! Geometry of loaded models
+    Models,
+    //! Decoded images in system memory
+    Images,
+    //! Estimated video memory of textures and vertex buffers
+    Textures,
+    Buffers,
+    Count,
+};
+
+//! Short lowercase name of the category, e.g. "orbitsamples"
+std::string_view GetMemoryCategoryName(MemoryCategory category);
+bool IsVideoMemoryCategory(MemoryCategory category);
+
+/*! Counters are updated with relaxed atomic operations by the objects
+ *  they account for, usually from their constructors and destructors, so
+ *  they are cheap enough to stay enabled. Sizes are estimates of the data
+ *  the objects own and don't include allocator overhead.
+ */
+void AddMemoryUsage(MemoryCategory category, std::size_t bytes);
+void RemoveMemoryUsage(MemoryCategory category, std::size_t bytes);
+std::size_t GetMemoryUsage(MemoryCategory category);
+
+//! One line summary of all categories in MiB
+std::string FormatMemoryUsage();
+
+/*! Bytes owned by one object, counted in a category for the lifetime of
+ *  the tracker. A copy counts the same bytes again and a move transfers
+ *  them, so trackers can be members of copyable and movable classes.
+ */
+class MemoryTracker
+{
+ public:
+    explicit MemoryTracker(MemoryCategory category, std::size_t bytes = 0);
+    ~MemoryTracker();
+
+    MemoryTracker(const MemoryTracker& other);
+    MemoryTracker(MemoryTracker&& other) noexcept;
+    MemoryTracker& operator=(const MemoryTracker& other);
+    MemoryTracker& operator=(MemoryTracker&& other) noexcept;
+
+    void set(std::size_t bytes);
+    void add(std::size_t bytes) { set(m_bytes + bytes); }
+    void remove(std::size_t bytes) { set(m_bytes > bytes ? m_bytes - bytes : 0); }
+    std::size_t bytes() const { return m_bytes; }
+
+ private:
+    MemoryCategory m_category;
+    std::size_t    m_bytes{ 0 };
+};
+
+} // end namespace celestia::util
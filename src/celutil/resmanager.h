@@ -9,19 +9,53 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
+#include <optional>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <celcompat/filesystem.h>
 #include <celutil/reshandle.h>
+#include <celutil/taskscheduler.h>
 
 
 enum class ResourceState {
     NotLoaded     = 0,
     Loaded        = 1,
     LoadingFailed = 2,
+    Preloading    = 3,
+};
+
+
+// Resource types that can be preloaded define PreparedType, the result of
+// their prepare() method.
+template<class T, class = void> struct ResourcePreparedType
+{
+    struct type {};
+    static constexpr bool supported = false;
+};
+
+template<class T> struct ResourcePreparedType<T, std::void_t<typename T::PreparedType>>
+{
+    using type = typename T::PreparedType;
+    static constexpr bool supported = true;
+};
+
+
+// Resources that are created asynchronously, like textures uploaded in
+// the background, define isReady(); find() returns them once it's true.
+template<class T, class = void> struct ResourceReadiness
+{
+    static bool isReady(const T&) { return true; }
+};
+
+template<class T> struct ResourceReadiness<T, std::void_t<decltype(std::declval<const T&>().isReady())>>
+{
+    static bool isReady(const T& resource) { return resource.isReady(); }
 };
 
 
@@ -59,24 +93,117 @@ template<class T> class ResourceManager
             return nullptr;
         }
 
-        if (resources[h].state == ResourceState::NotLoaded)
+        if (resources[h].state == ResourceState::Preloading)
+        {
+            // Use the background work if it's done, otherwise load the
+            // resource now and let finishPreloads() drop the result.
+            if (resources[h].preload->ready.load(std::memory_order_acquire))
+                finishPreload(resources[h]);
+            else
+                loadResource(resources[h]);
+        }
+        else if (resources[h].state == ResourceState::NotLoaded)
         {
             loadResource(resources[h]);
         }
 
-        return resources[h].state == ResourceState::Loaded
-            ? resources[h].resource.get()
-            : nullptr;
+        if (resources[h].state != ResourceState::Loaded ||
+            !ResourceReadiness<ResourceType>::isReady(*resources[h].resource))
+        {
+            return nullptr;
+        }
+
+        return resources[h].resource.get();
+    }
+
+    ResourceState getState(ResourceHandle h) const
+    {
+        if (h < 0 || h >= static_cast<ResourceHandle>(handles.size()))
+            return ResourceState::LoadingFailed;
+        return resources[h].state;
+    }
+
+    /*! Resolve and decode a resource on a background task, so that find()
+     *  only has to create it. T must provide prepare(key), which is called
+     *  off the main thread and may not use other managers, and a load(key,
+     *  prepared) overload taking its result. Returns false if the resource
+     *  is loaded, failed or already being preloaded.
+     */
+    bool preload(ResourceHandle h)
+    {
+        if (h < 0 || h >= static_cast<ResourceHandle>(handles.size()) ||
+            resources[h].state != ResourceState::NotLoaded)
+        {
+            return false;
+        }
+
+        auto preload = std::make_shared<Preload>();
+        resources[h].state = ResourceState::Preloading;
+        resources[h].preload = preload;
+        preloading.push_back(h);
+
+        celestia::util::GetTaskScheduler().detach([preload, info = resources[h].info, dir = baseDir]
+        {
+            preload->key.emplace(info.resolve(dir));
+            preload->prepared = info.prepare(*preload->key);
+            preload->ready.store(true, std::memory_order_release);
+        });
+
+        return true;
+    }
+
+    /*! Create the resources whose background part has completed, for at
+     *  most about budget seconds. Returns the number still preloading.
+     */
+    std::size_t finishPreloads(double budget)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto iter = preloading.begin();
+        while (iter != preloading.end())
+        {
+            InfoType& info = resources[*iter];
+            if (info.state == ResourceState::Preloading)
+            {
+                if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > budget ||
+                    !info.preload->ready.load(std::memory_order_acquire))
+                {
+                    ++iter;
+                    continue;
+                }
+
+                finishPreload(info);
+            }
+            else if (info.preload != nullptr && !info.preload->ready.load(std::memory_order_acquire))
+            {
+                // Loaded by find() meanwhile; wait for the task to drop it
+                ++iter;
+                continue;
+            }
+
+            info.preload = nullptr;
+            iter = preloading.erase(iter);
+        }
+
+        return preloading.size();
     }
 
  private:
     using KeyType = typename T::ResourceKey;
 
+    // Written by a background task, read once ready is set
+    struct Preload
+    {
+        std::optional<KeyType> key;
+        std::unique_ptr<typename ResourcePreparedType<T>::type> prepared;
+        std::atomic<bool> ready{ false };
+    };
+
     struct InfoType
     {
         T info;
         ResourceState state{ ResourceState::NotLoaded };
         std::shared_ptr<ResourceType> resource{ nullptr };
+        std::shared_ptr<Preload> preload{ nullptr };
 
         explicit InfoType(T _info) : info(std::move(_info)) {}
         InfoType(const InfoType&) = delete;
@@ -101,27 +228,51 @@ template<class T> class ResourceManager
     ResourceHandleMap handles{ };
     NameMap loadedResources{ };
 
+    std::vector<ResourceHandle> preloading{ };
+
+    // Share the resource already loaded for a key, if there is one
+    bool findLoaded(InfoType& info, const KeyType& resolvedKey)
+    {
+        if (auto iter = loadedResources.find(resolvedKey); iter != loadedResources.end())
+            info.resource = iter->second.lock();
+
+        if (info.resource == nullptr)
+            return false;
+
+        info.state = ResourceState::Loaded;
+        return true;
+    }
+
+    void addLoaded(InfoType& info, KeyType&& resolvedKey)
+    {
+        info.state = ResourceState::Loaded;
+        if (auto [iter, inserted] = loadedResources.try_emplace(std::move(resolvedKey), info.resource); !inserted)
+            iter->second = info.resource;
+    }
+
     void loadResource(InfoType& info)
     {
         KeyType resolvedKey = info.resolve(baseDir);
-        std::shared_ptr<ResourceType> resource = nullptr;
-        if (auto iter = loadedResources.find(resolvedKey); iter != loadedResources.end())
-            resource = iter->second.lock();
+        if (findLoaded(info, resolvedKey))
+            return;
 
-        if (resource != nullptr)
-        {
-            info.resource = std::move(resource);
-            info.state = ResourceState::Loaded;
-        }
-        else if (info.load(resolvedKey))
-        {
-            info.state = ResourceState::Loaded;
-            if (auto [iter, inserted] = loadedResources.try_emplace(std::move(resolvedKey), info.resource); !inserted)
-                iter->second = info.resource;
-        }
+        if (info.load(resolvedKey))
+            addLoaded(info, std::move(resolvedKey));
+        else
+            info.state = ResourceState::LoadingFailed;
+    }
+
+    void finishPreload(InfoType& info)
+    {
+        Preload& preload = *info.preload;
+        if (findLoaded(info, *preload.key))
+            return;
+
+        if constexpr (ResourcePreparedType<T>::supported)
+            info.resource = info.info.load(*preload.key, std::move(preload.prepared));
+        if (info.resource != nullptr)
+            addLoaded(info, std::move(*preload.key));
         else
-        {
             info.state = ResourceState::LoadingFailed;
-        }
     }
 };
@@ -0,0 +1,368 @@
+// taskscheduler.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Work-stealing task scheduler shared by the engine.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include "taskscheduler.h"
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+namespace celestia::util
+{
+
+namespace
+{
+
+// Worker index of the current thread in the scheduler that owns it
+thread_local const TaskScheduler* currentScheduler = nullptr;
+thread_local int currentWorker = -1;
+
+std::unique_ptr<TaskScheduler> engineScheduler;
+
+constexpr std::size_t
+priorityIndex(TaskPriority priority)
+{
+    return priority == TaskPriority::Frame ? 0 : 1;
+}
+
+} // end unnamed namespace
+
+
+struct TaskScheduler::Counters
+{
+    std::uint64_t executed{ 0 };
+    std::uint64_t stolen{ 0 };
+    std::uint64_t cancelled{ 0 };
+    double totalTime{ 0.0 };
+    double maxTime{ 0.0 };
+};
+
+
+// The tasks queued by one worker, or by threads outside the pool for the
+// last queue, together with the counters of the tasks run by them.
+struct TaskScheduler::Queue
+{
+    std::mutex mutex;
+    std::array<std::deque<Task>, 2> tasks;
+
+    std::mutex countersMutex;
+    std::unordered_map<const char*, Counters> counters;
+};
+
+
+TaskScheduler::TaskScheduler(unsigned int threadCount)
+{
+    unsigned int workerCount = threadCount > 1 ? threadCount - 1 : 0;
+    for (unsigned int i = 0; i <= workerCount; ++i)
+        queues.push_back(std::make_unique<Queue>());
+
+    detachedGroups.push_back(std::make_unique<TaskGroup>(*this, TaskPriority::Frame, "detached"));
+    detachedGroups.push_back(std::make_unique<TaskGroup>(*this, TaskPriority::Background, "detached"));
+
+    workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i)
+        workers.emplace_back(&TaskScheduler::workerLoop, this, static_cast<int>(i));
+}
+
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+
+    // Tasks still queued are treated as cancelled so that their groups
+    // complete.
+    for (auto& queue : queues)
+    {
+        for (auto& tasks : queue->tasks)
+        {
+            for (auto& task : tasks)
+            {
+                task.group->cancel();
+                execute(task, false);
+            }
+            tasks.clear();
+        }
+    }
+}
+
+
+void
+TaskScheduler::submit(std::function<void()>&& function, TaskGroup* group)
+{
+    group->pending.fetch_add(1);
+
+    Task task{ std::move(function), group };
+    if (isSerial())
+    {
+        execute(task, false);
+        return;
+    }
+
+    int self = currentScheduler == this ? currentWorker : -1;
+    Queue& queue = self >= 0 ? *queues[self] : *queues.back();
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks[priorityIndex(group->priority)].push_back(std::move(task));
+    }
+
+    queuedTasks.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeCondition.notify_one();
+}
+
+
+bool
+TaskScheduler::take(int self, TaskPriority priority, Task& task, bool& stolen)
+{
+    auto p = priorityIndex(priority);
+
+    // Newest task of our own queue first, as its data is likely in cache
+    if (self >= 0)
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks[p].empty())
+        {
+            task = std::move(own.tasks[p].back());
+            own.tasks[p].pop_back();
+            queuedTasks.fetch_sub(1);
+            stolen = false;
+            return true;
+        }
+    }
+
+    // Then tasks submitted from outside the pool, oldest first
+    {
+        Queue& shared = *queues.back();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        if (!shared.tasks[p].empty())
+        {
+            task = std::move(shared.tasks[p].front());
+            shared.tasks[p].pop_front();
+            queuedTasks.fetch_sub(1);
+            stolen = false;
+            return true;
+        }
+    }
+
+    // Finally steal the oldest task of another worker
+    auto workerCount = static_cast<int>(workers.size());
+    for (int i = 1; i <= workerCount; ++i)
+    {
+        int victim = (self + i) % workerCount;
+        if (victim < 0 || victim == self)
+            continue;
+
+        Queue& other = *queues[victim];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks[p].empty())
+        {
+            task = std::move(other.tasks[p].front());
+            other.tasks[p].pop_front();
+            queuedTasks.fetch_sub(1);
+            stolen = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool
+TaskScheduler::runOne(TaskPriority maxPriority)
+{
+    int self = currentScheduler == this ? currentWorker : -1;
+
+    Task task;
+    bool stolen = false;
+    if (take(self, TaskPriority::Frame, task, stolen) ||
+        (maxPriority == TaskPriority::Background && take(self, TaskPriority::Background, task, stolen)))
+    {
+        execute(task, stolen);
+        return true;
+    }
+
+    return false;
+}
+
+
+void
+TaskScheduler::execute(Task& task, bool stolen)
+{
+    using clock = std::chrono::steady_clock;
+
+    TaskGroup* group = task.group;
+    int self = currentScheduler == this ? currentWorker : -1;
+    Queue& queue = self >= 0 ? *queues[self] : *queues.back();
+
+    if (group->isCancelled())
+    {
+        std::lock_guard<std::mutex> lock(queue.countersMutex);
+        ++queue.counters[group->name].cancelled;
+    }
+    else
+    {
+        auto start = clock::now();
+        task.function();
+        double time = std::chrono::duration<double>(clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(queue.countersMutex);
+        Counters& counters = queue.counters[group->name];
+        ++counters.executed;
+        if (stolen)
+            ++counters.stolen;
+        counters.totalTime += time;
+        counters.maxTime = std::max(counters.maxTime, time);
+    }
+
+    // Release anything captured by the task before the group completes
+    task.function = nullptr;
+    group->finished();
+}
+
+
+void
+TaskScheduler::workerLoop(int index)
+{
+    currentScheduler = this;
+    currentWorker = index;
+
+    for (;;)
+    {
+        if (runOne(TaskPriority::Background))
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeCondition.wait(lock, [this] { return stopping || queuedTasks.load() > 0; });
+        if (stopping)
+            break;
+    }
+}
+
+
+std::vector<TaskScheduler::TaskStatistics>
+TaskScheduler::statistics() const
+{
+    std::map<std::string, TaskStatistics> byName;
+    for (const auto& queue : queues)
+    {
+        std::lock_guard<std::mutex> lock(queue->countersMutex);
+        for (const auto& [name, counters] : queue->counters)
+        {
+            auto& stats = byName[name];
+            stats.name = name;
+            stats.executed += counters.executed;
+            stats.stolen += counters.stolen;
+            stats.cancelled += counters.cancelled;
+            stats.totalTime += counters.totalTime;
+            stats.maxTime = std::max(stats.maxTime, counters.maxTime);
+        }
+    }
+
+    std::vector<TaskStatistics> result;
+    result.reserve(byName.size());
+    for (auto& entry : byName)
+        result.push_back(std::move(entry.second));
+
+    std::sort(result.begin(), result.end(),
+              [](const TaskStatistics& a, const TaskStatistics& b) { return a.totalTime > b.totalTime; });
+    return result;
+}
+
+
+void
+TaskScheduler::resetStatistics()
+{
+    for (auto& queue : queues)
+    {
+        std::lock_guard<std::mutex> lock(queue->countersMutex);
+        queue->counters.clear();
+    }
+}
+
+
+TaskGroup::TaskGroup(TaskScheduler& _scheduler, TaskPriority _priority, const char* _name) :
+    scheduler(_scheduler),
+    priority(_priority),
+    name(_name)
+{
+}
+
+
+TaskGroup::~TaskGroup()
+{
+    wait();
+}
+
+
+void
+TaskGroup::wait()
+{
+    while (pending.load() > 0)
+    {
+        if (!scheduler.runOne(priority))
+            break;
+    }
+
+    // Whatever is left is running on other threads. Taking the mutex also
+    // ensures the last task has finished signalling before we return and
+    // the group can be destroyed.
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending.load() == 0; });
+}
+
+
+void
+TaskGroup::finished()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.fetch_sub(1) == 1)
+        done.notify_all();
+}
+
+
+TaskScheduler&
+GetTaskScheduler()
+{
+    static TaskScheduler serialScheduler(1);
+    return engineScheduler != nullptr ? *engineScheduler : serialScheduler;
+}
+
+
+TaskScheduler&
+CreateTaskScheduler(unsigned int threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    engineScheduler = std::make_unique<TaskScheduler>(threadCount);
+    return *engineScheduler;
+}
+
+
+void
+DestroyTaskScheduler()
+{
+    engineScheduler.reset();
+}
+
+} // end namespace celestia::util
@@ -0,0 +1,263 @@
+// taskscheduler.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Work-stealing task scheduler shared by the engine.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace celestia::util
+{
+
+enum class TaskPriority
+{
+    //! Work the current frame waits for
+    Frame,
+    //! Loading and other work that may take several frames
+    Background,
+};
+
+class TaskGroup;
+
+/*! A pool of worker threads, each with its own double-ended queues of
+ *  tasks. A worker takes the newest task from its own queue and, when that
+ *  is empty, steals the oldest task of another worker, so tasks spawned by
+ *  a running task stay on the same thread while idle threads balance the
+ *  load. Frame tasks are always taken before background tasks.
+ *
+ *  A scheduler created with fewer than two threads starts no workers and
+ *  runs every task immediately on the thread submitting it, in submission
+ *  order. This is the default, so tests and tools are deterministic unless
+ *  they ask for threads.
+ */
+class TaskScheduler
+{
+ public:
+    struct TaskStatistics
+    {
+        std::string name;
+        std::uint64_t executed{ 0 };
+        std::uint64_t stolen{ 0 };
+        std::uint64_t cancelled{ 0 };
+        //! Total and longest run time in seconds
+        double totalTime{ 0.0 };
+        double maxTime{ 0.0 };
+    };
+
+    explicit TaskScheduler(unsigned int threadCount);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    //! Number of threads running tasks, including one waiting thread
+    unsigned int threadCount() const { return static_cast<unsigned int>(workers.size()) + 1; }
+    bool isSerial() const { return workers.empty(); }
+
+    /*! Call f(begin, end) over [first, last) split into ranges of about
+     *  grainSize elements, and return when all have completed.
+     */
+    template<typename F>
+    void parallelFor(std::size_t first, std::size_t last, std::size_t grainSize, F&& f,
+                     const char* name = "parallel for",
+                     TaskPriority priority = TaskPriority::Frame);
+
+    /*! Run f on the pool without waiting for it. Detached tasks still
+     *  queued when the scheduler is destroyed are dropped, so f must not
+     *  depend on objects that might be gone by the time it runs.
+     */
+    template<typename F>
+    void detach(F&& f, TaskPriority priority = TaskPriority::Background);
+
+    //! Counters for each task name, sorted by total run time
+    std::vector<TaskStatistics> statistics() const;
+    void resetStatistics();
+
+ private:
+    struct Task
+    {
+        std::function<void()> function;
+        TaskGroup* group;
+    };
+
+    struct Counters;
+    struct Queue;
+
+    void submit(std::function<void()>&& function, TaskGroup* group);
+    bool runOne(TaskPriority maxPriority);
+    bool take(int self, TaskPriority priority, Task& task, bool& stolen);
+    void execute(Task& task, bool stolen);
+    void workerLoop(int index);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<std::size_t> queuedTasks{ 0 };
+    std::atomic<bool> stopping{ false };
+    std::mutex sleepMutex;
+    std::condition_variable wakeCondition;
+
+    // Groups of the detached tasks of each priority
+    std::vector<std::unique_ptr<TaskGroup>> detachedGroups;
+
+    friend class TaskGroup;
+};
+
+/*! A set of tasks that can be waited for or cancelled together. Tasks of a
+ *  cancelled group that haven't started are skipped; running ones may poll
+ *  isCancelled() to stop early. The destructor waits for all tasks.
+ */
+class TaskGroup
+{
+ public:
+    explicit TaskGroup(TaskScheduler& scheduler,
+                       TaskPriority priority = TaskPriority::Frame,
+                       const char* name = "task");
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template<typename F>
+    void run(F&& f)
+    {
+        scheduler.submit(std::function<void()>(std::forward<F>(f)), this);
+    }
+
+    /*! Wait for all tasks of the group, running queued tasks meanwhile. A
+     *  frame group only helps with frame tasks, so that waiting for it
+     *  never blocks on a long background task.
+     */
+    void wait();
+
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+    TaskPriority getPriority() const { return priority; }
+    const char* getName() const { return name; }
+
+ private:
+    void finished();
+
+    TaskScheduler& scheduler;
+    TaskPriority priority;
+    const char* name;
+
+    std::atomic<std::size_t> pending{ 0 };
+    std::atomic<bool> cancelled{ false };
+    std::mutex mutex;
+    std::condition_variable done;
+
+    friend class TaskScheduler;
+};
+
+
+template<typename F>
+void
+TaskScheduler::parallelFor(std::size_t first, std::size_t last, std::size_t grainSize, F&& f,
+                           const char* name, TaskPriority priority)
+{
+    if (first >= last)
+        return;
+
+    grainSize = std::max<std::size_t>(grainSize, 1);
+    if (isSerial() || last - first <= grainSize)
+    {
+        f(first, last);
+        return;
+    }
+
+    // Aim for a few ranges per thread so that stealing can even out
+    // ranges of uneven cost.
+    std::size_t ranges = std::min((last - first + grainSize - 1) / grainSize,
+                                  static_cast<std::size_t>(threadCount()) * 4);
+    std::size_t step = (last - first + ranges - 1) / ranges;
+
+    TaskGroup group(*this, priority, name);
+    for (std::size_t begin = first + step; begin < last; begin += step)
+    {
+        std::size_t end = std::min(begin + step, last);
+        group.run([&f, begin, end] { f(begin, end); });
+    }
+    f(first, std::min(first + step, last));
+    group.wait();
+}
+
+
+template<typename F>
+void
+TaskScheduler::detach(F&& f, TaskPriority priority)
+{
+    detachedGroups[priority == TaskPriority::Frame ? 0 : 1]->run(std::forward<F>(f));
+}
+
+
+/*! Sort [first, last) by sorting ranges in parallel and then merging them
+ *  pairwise, also in parallel. Not stable.
+ */
+template<typename It, typename Compare>
+void
+ParallelSort(TaskScheduler& scheduler, It first, It last, Compare comp)
+{
+    constexpr std::size_t MinimumRange = 16384;
+
+    auto n = static_cast<std::size_t>(std::distance(first, last));
+    std::size_t ranges = 1;
+    while (ranges < scheduler.threadCount() * 2 && n / (ranges * 2) >= MinimumRange)
+        ranges *= 2;
+
+    if (ranges == 1)
+    {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    std::size_t step = (n + ranges - 1) / ranges;
+    auto at = [&](std::size_t i) { return first + static_cast<std::ptrdiff_t>(std::min(i, n)); };
+
+    scheduler.parallelFor(0, ranges, 1, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+            std::sort(at(i * step), at((i + 1) * step), comp);
+    }, "sort");
+
+    for (std::size_t width = step; width < n; width *= 2)
+    {
+        std::size_t pairs = (n + 2 * width - 1) / (2 * width);
+        scheduler.parallelFor(0, pairs, 1, [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+                std::inplace_merge(at(2 * i * width), at((2 * i + 1) * width), at((2 * i + 2) * width), comp);
+        }, "merge");
+    }
+}
+
+
+/*! The scheduler used by the engine. Until CreateTaskScheduler() is called
+ *  this is a serial scheduler that runs tasks on the calling thread.
+ */
+TaskScheduler& GetTaskScheduler();
+
+//! Replace the engine's scheduler; threadCount 0 uses all hardware threads
+TaskScheduler& CreateTaskScheduler(unsigned int threadCount = 0);
+void DestroyTaskScheduler();
+
+} // end namespace celestia::util
@@ -17,15 +17,19 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include <celcompat/filesystem.h>
 #include <celmath/mathlib.h>
 #include <celmodel/mesh.h>
 #include <celmodel/model.h>
 #include <celmodel/modelfile.h>
+#include <celutil/logger.h>
 
 #include "cmodops.h"
 #include "pathmanager.h"
 
+using celestia::util::CreateLogger;
 
 std::string inputFilename;
 std::string outputFilename;
@@ -36,6 +40,8 @@ bool genTangents = false;
 bool weldVertices = false;
 bool mergeMeshes = false;
 bool stripify = false;
+bool atlasTextures = false;
+cmodtools::MaterialMergeOptions atlasOptions;
 unsigned int vertexCacheSize = 16;
 float smoothAngle = 60.0f;
 
@@ -51,6 +57,11 @@ void usage()
     std::cerr << "   --smooth (or -s) <angle> : smoothing angle for normal generation\n";
     std::cerr << "   --weld (or -w)        : join identical vertices before normal generation\n";
     std::cerr << "   --merge (or -m)       : merge submeshes to improve rendering performance\n";
+    std::cerr << "   --atlas (or -x)       : merge materials differing only in their textures into atlases\n";
+    std::cerr << "   --texdir <dir>        : directory with the model textures, atlases are written\n";
+    std::cerr << "                           to the first one (default: current directory)\n";
+    std::cerr << "   --atlas-size <size>   : maximum atlas width and height, a power of two (default 4096)\n";
+    std::cerr << "   --padding <texels>    : edge texels repeated around each texture (default 8)\n";
 #ifdef TRISTRIP
     std::cerr << "   --optimize (or -o)    : optimize by converting triangle lists to strips\n";
 #endif
@@ -98,6 +109,35 @@ bool parseCommandLine(int argc, char* argv[])
             {
                 stripify = true;
             }
+            else if (!std::strcmp(argv[i], "-x") || !std::strcmp(argv[i], "--atlas"))
+            {
+                atlasTextures = true;
+            }
+            else if (!std::strcmp(argv[i], "--texdir"))
+            {
+                if (i == argc - 1)
+                    return false;
+                atlasOptions.textureDirs.emplace_back(argv[i + 1]);
+                i++;
+            }
+            else if (!std::strcmp(argv[i], "--atlas-size"))
+            {
+                int size = 0;
+                if (i == argc - 1 || std::sscanf(argv[i + 1], " %d", &size) != 1)
+                    return false;
+                if (size < 64 || (size & (size - 1)) != 0)
+                    return false;
+                atlasOptions.maxAtlasSize = size;
+                i++;
+            }
+            else if (!std::strcmp(argv[i], "--padding"))
+            {
+                int padding = 0;
+                if (i == argc - 1 || std::sscanf(argv[i + 1], " %d", &padding) != 1 || padding < 0)
+                    return false;
+                atlasOptions.padding = padding;
+                i++;
+            }
             else if (!std::strcmp(argv[i], "-s") || !std::strcmp(argv[i], "--smooth"))
             {
                 if (i == argc - 1)
@@ -152,6 +192,8 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    CreateLogger();
+
     std::unique_ptr<cmod::Model> model = nullptr;
     if (!inputFilename.empty())
     {
@@ -219,6 +261,33 @@ int main(int argc, char* argv[])
         model = std::move(newModel);
     }
 
+    if (atlasTextures)
+    {
+        if (atlasOptions.textureDirs.empty())
+            atlasOptions.textureDirs.emplace_back(".");
+
+        // Atlases are named after the output file so that several models
+        // can be processed into the same texture directory
+        fs::path stem = outputFilename.empty() ? fs::path("atlas") : fs::path(outputFilename).stem();
+        atlasOptions.atlasPath = atlasOptions.textureDirs.front() / stem;
+        atlasOptions.atlasPath += "-atlas";
+
+        cmodtools::MaterialMergeStatistics statistics;
+        auto newModel = cmodtools::MergeModelMaterials(*model,
+                                                       atlasOptions,
+                                                       cmodtools::GetPathManager()->getSource,
+                                                       cmodtools::GetPathManager()->getHandle,
+                                                       statistics);
+        if (newModel == nullptr)
+            return 1;
+
+        model = std::move(newModel);
+        std::cerr << "Atlased " << statistics.texturesAtlased << " textures into "
+                  << statistics.atlases << " atlases\n";
+        std::cerr << "Materials: " << statistics.materialsBefore << " -> " << statistics.materialsAfter << '\n';
+        std::cerr << "Draw calls: " << statistics.groupsBefore << " -> " << statistics.groupsAfter << '\n';
+    }
+
     if (mergeMeshes)
     {
         model = cmodtools::MergeModelMeshes(*model);
@@ -16,10 +16,16 @@
 #include <cstring>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <numeric>
+#include <optional>
+#include <string>
+#include <system_error>
 #include <utility>
 #include <vector>
 
+#include <celimage/image.h>
+#include <celimage/imageformats.h>
 #include <celmodel/model.h>
 
 #include "cmodops.h"
@@ -1196,6 +1202,479 @@ GenerateModelNormals(const cmod::Model& model, float smoothAngle, bool weldVerti
 }
 
 
+namespace
+{
+
+// Texture coordinates slightly outside [0, 1] are still treated as unwrapped
+constexpr float TexCoordTolerance = 1.0e-3f;
+
+// A texture placed in an atlas; x and y exclude the padding
+struct AtlasEntry
+{
+    ResourceHandle texture{ InvalidResource };
+    std::unique_ptr<Image> image;
+    std::size_t page{ 0 };
+    int x{ 0 };
+    int y{ 0 };
+};
+
+
+struct AtlasPage
+{
+    int width{ 0 };
+    int height{ 0 };
+};
+
+
+// Mapping of texture coordinates of a material into its atlas
+struct TexCoordTransform
+{
+    unsigned int material;
+    Eigen::Vector2f scale;
+    Eigen::Vector2f offset;
+};
+
+
+int
+nextPowerOfTwo(int n)
+{
+    int p = 1;
+    while (p < n)
+        p *= 2;
+    return p;
+}
+
+
+// Atlases are written as RGB PNG files, so only opaque uncompressed
+// textures can be moved into them.
+bool
+isAtlasFormat(celestia::PixelFormat format)
+{
+    switch (format)
+    {
+    case celestia::PixelFormat::RGB:
+    case celestia::PixelFormat::BGR:
+    case celestia::PixelFormat::LUMINANCE:
+    case celestia::PixelFormat::SRGB:
+    case celestia::PixelFormat::SRGB8:
+    case celestia::PixelFormat::SLUMINANCE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+// Read a texel of an image in one of the atlas formats as RGB
+std::array<std::uint8_t, 3>
+getTexel(const Image& image, int x, int y)
+{
+    const std::uint8_t* p = image.getPixels() + y * image.getPitch() + x * image.getComponents();
+    switch (image.getFormat())
+    {
+    case celestia::PixelFormat::BGR:
+        return { p[2], p[1], p[0] };
+    case celestia::PixelFormat::LUMINANCE:
+    case celestia::PixelFormat::SLUMINANCE:
+        return { p[0], p[0], p[0] };
+    default:
+        return { p[0], p[1], p[2] };
+    }
+}
+
+
+std::unique_ptr<Image>
+loadAtlasTexture(const fs::path& filename, const std::vector<fs::path>& textureDirs)
+{
+    for (const auto& dir : textureDirs)
+    {
+        fs::path path = dir / filename;
+        std::error_code ec;
+        if (!fs::exists(path, ec))
+            continue;
+
+        std::unique_ptr<Image> image = LoadImageFromFile(path);
+        if (image == nullptr || image->isCompressed() || !isAtlasFormat(image->getFormat()))
+            return nullptr;
+        return image;
+    }
+
+    return nullptr;
+}
+
+
+/*! Pack textures into shelves ordered by height. All pages share a width
+ *  chosen to make the first page roughly square; a new page is started
+ *  when a page would grow taller than maxSize.
+ */
+std::vector<AtlasPage>
+packAtlas(std::vector<AtlasEntry>& entries, int maxSize, int padding)
+{
+    std::vector<AtlasEntry*> order;
+    double area = 0.0;
+    int widest = 0;
+    for (auto& entry : entries)
+    {
+        order.push_back(&entry);
+        int w = entry.image->getWidth() + 2 * padding;
+        int h = entry.image->getHeight() + 2 * padding;
+        area += static_cast<double>(w) * static_cast<double>(h);
+        widest = std::max(widest, w);
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+                     [](const AtlasEntry* a, const AtlasEntry* b) { return a->image->getHeight() > b->image->getHeight(); });
+
+    int side = static_cast<int>(std::ceil(std::sqrt(area)));
+    int pageWidth = std::min(maxSize, nextPowerOfTwo(std::max(side, widest)));
+
+    std::vector<AtlasPage> pages(1);
+    int shelfX = 0;
+    int shelfY = 0;
+    int shelfHeight = 0;
+    for (AtlasEntry* entry : order)
+    {
+        int w = entry->image->getWidth() + 2 * padding;
+        int h = entry->image->getHeight() + 2 * padding;
+        if (shelfX + w > pageWidth)
+        {
+            shelfY += shelfHeight;
+            shelfX = 0;
+            shelfHeight = 0;
+        }
+
+        if (shelfY + h > maxSize)
+        {
+            pages.emplace_back();
+            shelfX = 0;
+            shelfY = 0;
+            shelfHeight = 0;
+        }
+
+        entry->page = pages.size() - 1;
+        entry->x = shelfX + padding;
+        entry->y = shelfY + padding;
+        shelfX += w;
+        shelfHeight = std::max(shelfHeight, h);
+
+        AtlasPage& page = pages.back();
+        page.width = std::max(page.width, shelfX);
+        page.height = std::max(page.height, shelfY + shelfHeight);
+    }
+
+    for (auto& page : pages)
+    {
+        page.width = nextPowerOfTwo(page.width);
+        page.height = nextPowerOfTwo(page.height);
+    }
+
+    return pages;
+}
+
+
+// Copy a texture into an atlas, repeating its edge texels into the padding
+void
+copyPadded(Image& atlas, const AtlasEntry& entry, int padding)
+{
+    const Image& image = *entry.image;
+    int width = image.getWidth();
+    int height = image.getHeight();
+    for (int y = -padding; y < height + padding; ++y)
+    {
+        std::uint8_t* row = atlas.getPixelRow(entry.y + y);
+        int sourceY = std::clamp(y, 0, height - 1);
+        for (int x = -padding; x < width + padding; ++x)
+        {
+            auto texel = getTexel(image, std::clamp(x, 0, width - 1), sourceY);
+            std::memcpy(row + (entry.x + x) * texel.size(), texel.data(), texel.size());
+        }
+    }
+}
+
+
+/*! Find the materials that may be moved into an atlas: those with only a
+ *  diffuse map, and whose texture coordinates in every mesh lie within
+ *  [0, 1], as wrapped coordinates can't be expressed inside an atlas.
+ */
+std::vector<bool>
+findAtlasCandidates(const cmod::Model& model)
+{
+    std::vector<bool> candidates(model.getMaterialCount(), false);
+    for (unsigned int i = 0; i < model.getMaterialCount(); ++i)
+    {
+        const cmod::Material* material = model.getMaterial(i);
+        candidates[i] = material->getMap(cmod::TextureSemantic::DiffuseMap) != InvalidResource &&
+                        material->getMap(cmod::TextureSemantic::NormalMap) == InvalidResource &&
+                        material->getMap(cmod::TextureSemantic::SpecularMap) == InvalidResource &&
+                        material->getMap(cmod::TextureSemantic::EmissiveMap) == InvalidResource;
+    }
+
+    for (unsigned int i = 0; model.getMesh(i) != nullptr; ++i)
+    {
+        const cmod::Mesh* mesh = model.getMesh(i);
+        const auto& texCoord = mesh->getVertexDescription().getAttribute(cmod::VertexAttributeSemantic::Texture0);
+        std::uint32_t stride = mesh->getVertexStrideWords();
+        for (unsigned int j = 0; mesh->getGroup(j) != nullptr; ++j)
+        {
+            const cmod::PrimitiveGroup* group = mesh->getGroup(j);
+            if (group->materialIndex >= candidates.size() || !candidates[group->materialIndex])
+                continue;
+
+            if (texCoord.format != cmod::VertexAttributeFormat::Float2)
+            {
+                candidates[group->materialIndex] = false;
+                continue;
+            }
+
+            for (cmod::Index32 index : group->indices)
+            {
+                Eigen::Vector2f uv = getTexCoord(mesh->getVertexData(), texCoord.offsetWords, stride, index);
+                if ((uv.array() < -TexCoordTolerance).any() || (uv.array() > 1.0f + TexCoordTolerance).any())
+                {
+                    candidates[group->materialIndex] = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    return candidates;
+}
+
+
+/*! Move the texture coordinates of groups with atlased materials into the
+ *  atlas and switch the groups to the atlas material. Vertices shared by
+ *  groups needing different transforms are duplicated.
+ */
+void
+remapTexCoords(cmod::Mesh& mesh, const std::vector<std::optional<TexCoordTransform>>& transforms)
+{
+    const auto& texCoord = mesh.getVertexDescription().getAttribute(cmod::VertexAttributeSemantic::Texture0);
+    if (texCoord.format != cmod::VertexAttributeFormat::Float2)
+        return;
+
+    constexpr unsigned int Unused = ~0u;
+    constexpr unsigned int Untransformed = ~0u - 1;
+
+    std::uint32_t stride = mesh.getVertexStrideWords();
+    std::uint32_t vertexCount = mesh.getVertexCount();
+    const cmod::VWord* source = mesh.getVertexData();
+    std::vector<cmod::VWord> vertices(source, source + vertexCount * stride);
+
+    // The transform each vertex was written with, keyed by source material
+    std::vector<unsigned int> owners(vertexCount, Unused);
+    std::map<std::pair<cmod::Index32, unsigned int>, cmod::Index32> copies;
+
+    for (unsigned int i = 0; mesh.getGroup(i) != nullptr; ++i)
+    {
+        cmod::PrimitiveGroup* group = mesh.getGroup(i);
+        const auto& transform = group->materialIndex < transforms.size()
+                              ? transforms[group->materialIndex]
+                              : std::nullopt;
+        unsigned int key = transform.has_value() ? group->materialIndex : Untransformed;
+
+        for (cmod::Index32& index : group->indices)
+        {
+            if (owners[index] == key)
+                continue;
+
+            if (owners[index] == Unused)
+            {
+                owners[index] = key;
+            }
+            else
+            {
+                auto [it, inserted] = copies.try_emplace({ index, key }, 0);
+                if (!inserted)
+                {
+                    index = it->second;
+                    continue;
+                }
+
+                it->second = static_cast<cmod::Index32>(vertices.size() / stride);
+                vertices.insert(vertices.end(), source + index * stride, source + (index + 1) * stride);
+                index = it->second;
+            }
+
+            if (transform.has_value())
+            {
+                cmod::VWord* data = vertices.data() + index * stride + texCoord.offsetWords;
+                float uv[2];
+                std::memcpy(uv, data, sizeof(uv));
+                Eigen::Vector2f mapped = transform->offset + transform->scale.cwiseProduct(Eigen::Vector2f(uv));
+                std::memcpy(data, mapped.data(), sizeof(uv));
+            }
+        }
+
+        if (transform.has_value())
+            group->materialIndex = transform->material;
+    }
+
+    auto newCount = static_cast<unsigned int>(vertices.size() / stride);
+    mesh.setVertices(newCount, std::move(vertices));
+}
+
+
+unsigned int
+countGroups(const cmod::Model& model)
+{
+    unsigned int count = 0;
+    for (unsigned int i = 0; model.getMesh(i) != nullptr; ++i)
+        count += model.getMesh(i)->getGroupCount();
+    return count;
+}
+
+} // end unnamed namespace
+
+
+/*! Merge materials that differ only in their diffuse map by packing their
+ *  textures into atlases, then combine the primitive groups that now share
+ *  a material. Return the new model, or null if an atlas couldn't be
+ *  written.
+ */
+std::unique_ptr<cmod::Model>
+MergeModelMaterials(const cmod::Model& model,
+                    const MaterialMergeOptions& options,
+                    const cmod::SourceGetter& getSource,
+                    const cmod::HandleGetter& getHandle,
+                    MaterialMergeStatistics& statistics)
+{
+    statistics = MaterialMergeStatistics();
+    statistics.materialsBefore = model.getMaterialCount();
+    statistics.groupsBefore = countGroups(model);
+
+    std::vector<bool> candidates = findAtlasCandidates(model);
+
+    // Materials are compatible when they're equal apart from the diffuse map
+    std::map<cmod::Material, std::vector<unsigned int>> compatible;
+    for (unsigned int i = 0; i < model.getMaterialCount(); ++i)
+    {
+        if (!candidates[i])
+            continue;
+
+        cmod::Material key = model.getMaterial(i)->clone();
+        key.setMap(cmod::TextureSemantic::DiffuseMap, InvalidResource);
+        compatible[std::move(key)].push_back(i);
+    }
+
+    auto atlasModel = std::make_unique<cmod::Model>();
+    for (unsigned int i = 0; i < model.getMaterialCount(); ++i)
+        atlasModel->addMaterial(model.getMaterial(i)->clone());
+
+    int maxTextureSize = options.maxAtlasSize - 2 * options.padding;
+    std::vector<std::optional<TexCoordTransform>> transforms(model.getMaterialCount());
+    for (const auto& [key, materials] : compatible)
+    {
+        // Load each distinct texture once
+        std::vector<AtlasEntry> entries;
+        std::map<ResourceHandle, std::size_t> entryIndices;
+        for (unsigned int i : materials)
+        {
+            ResourceHandle texture = model.getMaterial(i)->getMap(cmod::TextureSemantic::DiffuseMap);
+            if (entryIndices.find(texture) != entryIndices.end())
+                continue;
+
+            std::unique_ptr<Image> image = loadAtlasTexture(getSource(texture), options.textureDirs);
+            if (image == nullptr || image->getWidth() > maxTextureSize || image->getHeight() > maxTextureSize)
+                continue;
+
+            entryIndices.try_emplace(texture, entries.size());
+            auto& entry = entries.emplace_back();
+            entry.texture = texture;
+            entry.image = std::move(image);
+        }
+
+        if (entries.size() < 2)
+            continue;
+
+        std::vector<AtlasPage> pages = packAtlas(entries, options.maxAtlasSize, options.padding);
+        std::vector<unsigned int> pageMaterials;
+        for (std::size_t i = 0; i < pages.size(); ++i)
+        {
+            Image atlas(celestia::PixelFormat::RGB, pages[i].width, pages[i].height);
+            std::memset(atlas.getPixels(), 0, atlas.getSize());
+            for (const auto& entry : entries)
+            {
+                if (entry.page == i)
+                    copyPadded(atlas, entry, options.padding);
+            }
+
+            fs::path atlasFile = options.atlasPath;
+            atlasFile += "-" + std::to_string(statistics.atlases) + ".png";
+            if (!SavePNGImage(atlasFile, atlas))
+            {
+                std::cerr << "Error writing texture atlas " << atlasFile << '\n';
+                return nullptr;
+            }
+            ++statistics.atlases;
+
+            cmod::Material material = key.clone();
+            material.setMap(cmod::TextureSemantic::DiffuseMap, getHandle(atlasFile.filename()));
+            // addMaterial returns the new material count
+            pageMaterials.push_back(atlasModel->addMaterial(std::move(material)) - 1);
+        }
+
+        for (unsigned int i : materials)
+        {
+            auto it = entryIndices.find(model.getMaterial(i)->getMap(cmod::TextureSemantic::DiffuseMap));
+            if (it == entryIndices.end())
+                continue;
+
+            const AtlasEntry& entry = entries[it->second];
+            const AtlasPage& page = pages[entry.page];
+            Eigen::Vector2f pageSize(static_cast<float>(page.width), static_cast<float>(page.height));
+            transforms[i] = TexCoordTransform
+            {
+                pageMaterials[entry.page],
+                Eigen::Vector2f(static_cast<float>(entry.image->getWidth()),
+                                static_cast<float>(entry.image->getHeight())).cwiseQuotient(pageSize),
+                Eigen::Vector2f(static_cast<float>(entry.x),
+                                static_cast<float>(entry.y)).cwiseQuotient(pageSize),
+            };
+        }
+
+        statistics.texturesAtlased += static_cast<unsigned int>(entries.size());
+    }
+
+    for (unsigned int i = 0; model.getMesh(i) != nullptr; ++i)
+    {
+        cmod::Mesh mesh = model.getMesh(i)->clone();
+        remapTexCoords(mesh, transforms);
+        atlasModel->addMesh(std::move(mesh));
+    }
+
+    // Drop the materials that were replaced by atlases
+    std::vector<bool> used(atlasModel->getMaterialCount(), false);
+    for (unsigned int i = 0; atlasModel->getMesh(i) != nullptr; ++i)
+    {
+        const cmod::Mesh* mesh = atlasModel->getMesh(i);
+        for (unsigned int j = 0; mesh->getGroup(j) != nullptr; ++j)
+            used[mesh->getGroup(j)->materialIndex] = true;
+    }
+
+    auto newModel = std::make_unique<cmod::Model>();
+    std::vector<unsigned int> materialMap(atlasModel->getMaterialCount(), 0);
+    for (unsigned int i = 0; i < atlasModel->getMaterialCount(); ++i)
+    {
+        if (used[i])
+            materialMap[i] = newModel->addMaterial(atlasModel->getMaterial(i)->clone()) - 1;
+    }
+
+    for (unsigned int i = 0; atlasModel->getMesh(i) != nullptr; ++i)
+    {
+        cmod::Mesh mesh = atlasModel->getMesh(i)->clone();
+        mesh.remapMaterials(materialMap);
+        mesh.aggregateByMaterial();
+        newModel->addMesh(std::move(mesh));
+    }
+
+    statistics.materialsAfter = newModel->getMaterialCount();
+    statistics.groupsAfter = countGroups(*newModel);
+
+    return newModel;
+}
+
+
 #ifdef TRISTRIP
 bool
 ConvertToStrips(cmod::Mesh& mesh)
@@ -13,10 +13,13 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include <Eigen/Core>
 
+#include <celcompat/filesystem.h>
 #include <celmodel/mesh.h>
+#include <celmodel/modelfile.h>
 
 
 namespace cmod
@@ -28,6 +31,28 @@ class Model;
 namespace cmodtools
 {
 
+struct MaterialMergeOptions
+{
+    // Directories searched for the textures of the model
+    std::vector<fs::path> textureDirs;
+    // Atlas images are written as <atlasPath>-<n>.png
+    fs::path atlasPath;
+    int maxAtlasSize{ 4096 };
+    // Texels of the texture edges repeated around each texture in an atlas,
+    // so that mipmaps down to this size don't bleed into their neighbours
+    int padding{ 8 };
+};
+
+struct MaterialMergeStatistics
+{
+    unsigned int materialsBefore{ 0 };
+    unsigned int materialsAfter{ 0 };
+    unsigned int groupsBefore{ 0 };
+    unsigned int groupsAfter{ 0 };
+    unsigned int texturesAtlased{ 0 };
+    unsigned int atlases{ 0 };
+};
+
 // Mesh operations
 extern cmod::Mesh GenerateNormals(const cmod::Mesh& mesh, float smoothAngle, bool weld, float weldTolerance = 0.0f);
 extern cmod::Mesh GenerateTangents(const cmod::Mesh& mesh, bool weld);
@@ -39,6 +64,11 @@ extern std::unique_ptr<cmod::Model> GenerateModelNormals(const cmod::Model& mode
                                                          float smoothAngle,
                                                          bool weldVertices,
                                                          float weldTolerance);
+extern std::unique_ptr<cmod::Model> MergeModelMaterials(const cmod::Model& model,
+                                                        const MaterialMergeOptions& options,
+                                                        const cmod::SourceGetter& getSource,
+                                                        const cmod::HandleGetter& getHandle,
+                                                        MaterialMergeStatistics& statistics);
 #ifdef TRISTRIP
 extern bool ConvertToStrips(cmod::Mesh& mesh);
 #endif
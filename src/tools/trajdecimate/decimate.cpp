@@ -0,0 +1,199 @@
+// decimate.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include "decimate.h"
+
+#include <algorithm>
+
+#include <celengine/astro.h>
+#include <celephem/hermite.h>
+
+namespace trajdecimate
+{
+
+namespace
+{
+
+/*! Error at sample k of the span between the kept samples first and last,
+ *  computed the way SampledOrbit, SampledOrbitXYZV and SampledOrientation
+ *  interpolate. Position-only cubic spans also depend on the kept samples
+ *  prev and next around the span, which equal first and last at the ends.
+ */
+double
+SampleError(const Trajectory& traj,
+            Interpolation interpolation,
+            std::size_t prev,
+            std::size_t first,
+            std::size_t last,
+            std::size_t next,
+            std::size_t k)
+{
+    using celestia::ephem::cubicInterpolate;
+
+    double t0 = traj.times[first];
+    double t1 = traj.times[last];
+    double h = t1 - t0;
+    double u = (traj.times[k] - t0) / h;
+
+    if (traj.format == Format::Orientation)
+    {
+        Eigen::Quaternionf q = traj.orientations[first].slerp(static_cast<float>(u), traj.orientations[last]);
+        return static_cast<double>(q.angularDistance(traj.orientations[k]));
+    }
+
+    const Eigen::Vector3d& p0 = traj.positions[first];
+    const Eigen::Vector3d& p1 = traj.positions[last];
+    Eigen::Vector3d p;
+    if (interpolation == Interpolation::Linear)
+    {
+        p = p0 + u * (p1 - p0);
+    }
+    else if (traj.format == Format::XYZ)
+    {
+        // Estimate velocities by averaging the differences at adjacent spans
+        Eigen::Vector3d v21 = p1 - p0;
+        Eigen::Vector3d v0 = prev != first
+            ? ((p0 - traj.positions[prev]) * (0.5 / (t0 - traj.times[prev])) + v21 * (0.5 / h)) * h
+            : v21;
+        Eigen::Vector3d v1 = next != last
+            ? (v21 * (0.5 / h) + (traj.positions[next] - p1) * (0.5 / (traj.times[next] - t1))) * h
+            : v21;
+        p = cubicInterpolate(p0, v0, p1, v1, u);
+    }
+    else
+    {
+        // Velocities are stored in km/s, the engine converts them to km/day
+        double scale = h * astro::daysToSecs(1.0);
+        p = cubicInterpolate(p0, traj.velocities[first] * scale, p1, traj.velocities[last] * scale, u);
+    }
+
+    return (p - traj.positions[k]).norm();
+}
+
+
+double
+SpanError(const Trajectory& traj,
+          Interpolation interpolation,
+          std::size_t prev,
+          std::size_t first,
+          std::size_t last,
+          std::size_t next)
+{
+    double maxError = 0.0;
+    for (std::size_t k = first + 1; k < last; ++k)
+        maxError = std::max(maxError, SampleError(traj, interpolation, prev, first, last, next, k));
+    return maxError;
+}
+
+} // end unnamed namespace
+
+
+std::vector<std::size_t>
+Decimate(const Trajectory& traj, Interpolation interpolation, double tolerance)
+{
+    std::size_t n = traj.size();
+    std::vector<std::size_t> kept;
+    if (n <= 2)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            kept.push_back(i);
+        return kept;
+    }
+
+    bool usesNeighbours = traj.format == Format::XYZ && interpolation == Interpolation::Cubic;
+    auto fits = [&](std::size_t first, std::size_t last)
+    {
+        std::size_t prev = kept.size() > 1 ? kept[kept.size() - 2] : first;
+        if (usesNeighbours && prev != first)
+        {
+            // The end tangent of the previous span depends on this one
+            std::size_t prevPrev = kept.size() > 2 ? kept[kept.size() - 3] : prev;
+            if (SpanError(traj, interpolation, prevPrev, prev, first, last) > tolerance)
+                return false;
+        }
+
+        // Assume the next span will be about as long as this one
+        std::size_t next = std::min(last + (last - first), n - 1);
+        return SpanError(traj, interpolation, prev, first, last, next) <= tolerance;
+    };
+
+    std::size_t maxLength = n;
+    kept.push_back(0);
+    while (kept.back() < n - 1)
+    {
+        std::size_t first = kept.back();
+        std::size_t limit = std::min(maxLength, n - 1 - first) + 1;
+
+        // Spans that depend on their neighbours are most accurate at even
+        // spacing, so start from the length of the previous span. If that
+        // fits, find a failing length by doubling and bisect, otherwise
+        // try shorter spans, longest first.
+        std::size_t hint = std::min(kept.size() > 1 ? first - kept[kept.size() - 2] : 1, limit - 1);
+        std::size_t good = 0;
+        if (fits(first, first + hint))
+        {
+            good = hint;
+            std::size_t bad = hint * 2;
+            while (bad < limit && fits(first, first + bad))
+            {
+                good = bad;
+                bad *= 2;
+            }
+
+            bad = std::min(bad, limit);
+            while (bad - good > 1)
+            {
+                std::size_t mid = good + (bad - good) / 2;
+                if (fits(first, first + mid))
+                    good = mid;
+                else
+                    bad = mid;
+            }
+        }
+        else
+        {
+            for (std::size_t length = hint - 1; length > 0 && good == 0; --length)
+            {
+                if (fits(first, first + length))
+                    good = length;
+            }
+        }
+
+        if (good == 0)
+        {
+            // Only possible when even the shortest span breaks the
+            // previous one, whose last sample can't be the first one
+            maxLength = first - kept[kept.size() - 2] - 1;
+            kept.pop_back();
+            continue;
+        }
+
+        kept.push_back(first + good);
+        maxLength = n;
+    }
+
+    return kept;
+}
+
+
+double
+MaxError(const Trajectory& traj, Interpolation interpolation, const std::vector<std::size_t>& kept)
+{
+    double maxError = 0.0;
+    for (std::size_t i = 0; i + 1 < kept.size(); ++i)
+    {
+        std::size_t prev = kept[i > 0 ? i - 1 : i];
+        std::size_t next = kept[i + 2 < kept.size() ? i + 2 : i + 1];
+        maxError = std::max(maxError, SpanError(traj, interpolation, prev, kept[i], kept[i + 1], next));
+    }
+
+    return maxError;
+}
+
+} // end namespace trajdecimate
@@ -0,0 +1,64 @@
+// decimate.h
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// Choose the samples of a trajectory or orientation to keep within a
+// tolerance of the interpolation error.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+namespace trajdecimate
+{
+
+enum class Format
+{
+    // Time and position, used by SampledTrajectory and SampledOrbit
+    XYZ,
+    // Time, position and velocity
+    XYZV,
+    XYZVBinary,
+    // Time and orientation quaternion, used by SampledOrientation
+    Orientation,
+};
+
+enum class Interpolation
+{
+    Linear,
+    Cubic,
+};
+
+struct Trajectory
+{
+    Format format{ Format::XYZ };
+    std::vector<double> times;
+    std::vector<Eigen::Vector3d> positions;
+    std::vector<Eigen::Vector3d> velocities;
+    // The engine interpolates orientations in single precision
+    std::vector<Eigen::Quaternionf> orientations;
+
+    std::size_t size() const { return times.size(); }
+};
+
+/*! Select the samples to keep. Spans are grown greedily from each kept
+ *  sample, using a galloping search for the longest span within tolerance.
+ *  Position-only cubic spans also depend on their neighbours: choosing a
+ *  span rechecks the previous one, and when no span fits, the previous span
+ *  is chosen again with a shorter length.
+ */
+std::vector<std::size_t> Decimate(const Trajectory& traj, Interpolation interpolation, double tolerance);
+
+// Maximum interpolation error over all spans between the kept samples
+double MaxError(const Trajectory& traj, Interpolation interpolation, const std::vector<std::size_t>& kept);
+
+} // end namespace trajdecimate
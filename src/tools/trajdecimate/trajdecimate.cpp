@@ -0,0 +1,444 @@
+// trajdecimate.cpp
+//
+// Copyright (C) 2023-present, the Celestia Development Team
+//
+// Remove samples from sampled trajectory and orientation files while
+// keeping the interpolation error below a tolerance.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <fmt/format.h>
+
+#include <celcompat/bit.h>
+#include <celcompat/filesystem.h>
+#include <celcompat/numbers.h>
+#include <celephem/xyzvbinary.h>
+
+#include "decimate.h"
+
+using celestia::ephem::XYZVBinaryData;
+using celestia::ephem::XYZVBinaryHeader;
+using celestia::ephem::XYZV_MAGIC;
+using trajdecimate::Decimate;
+using trajdecimate::Format;
+using trajdecimate::Interpolation;
+using trajdecimate::MaxError;
+using trajdecimate::Trajectory;
+
+namespace
+{
+
+struct Options
+{
+    double tolerance{ 1.0 };        // kilometers
+    double angleTolerance{ 0.01 };  // degrees
+    Interpolation interpolation{ Interpolation::Cubic };
+    bool writeText{ false };
+    bool writeBinary{ false };
+    unsigned int jobs{ 0 };
+    fs::path outputDir;
+    std::vector<fs::path> inputs;
+};
+
+
+// Scan past comments. A comment begins with the # character and ends
+// with a newline. Return true if the stream state is good. The stream
+// position will be at the first non-comment, non-whitespace character.
+bool
+SkipComments(std::istream& in)
+{
+    bool inComment = false;
+    for (;;)
+    {
+        int c = in.get();
+        if (in.eof())
+            break;
+
+        if (inComment)
+        {
+            if (c == '\n')
+                inComment = false;
+        }
+        else if (c == '#')
+        {
+            inComment = true;
+        }
+        else if (std::isspace(static_cast<unsigned char>(c)) == 0)
+        {
+            in.unget();
+            break;
+        }
+    }
+
+    return in.good();
+}
+
+
+bool
+GetFormat(const fs::path& path, Format& format)
+{
+    auto ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (ext == ".xyz")
+        format = Format::XYZ;
+    else if (ext == ".xyzv")
+        format = Format::XYZV;
+    else if (ext == ".xyzvbin")
+        format = Format::XYZVBinary;
+    else if (ext == ".q")
+        format = Format::Orientation;
+    else
+        return false;
+
+    return true;
+}
+
+
+bool
+ReadText(const fs::path& path, Trajectory& traj)
+{
+    std::ifstream in(path);
+    if (!in.good() || !SkipComments(in))
+        return false;
+
+    for (;;)
+    {
+        double t;
+        std::array<double, 6> v;
+        in >> t;
+        if (traj.format == Format::Orientation)
+        {
+            in >> v[0] >> v[1] >> v[2] >> v[3];
+            if (!in)
+                break;
+            Eigen::Quaternionf q(static_cast<float>(v[0]), static_cast<float>(v[1]),
+                                 static_cast<float>(v[2]), static_cast<float>(v[3]));
+            traj.orientations.push_back(q.normalized());
+        }
+        else
+        {
+            in >> v[0] >> v[1] >> v[2];
+            if (traj.format == Format::XYZV)
+                in >> v[3] >> v[4] >> v[5];
+            if (!in)
+                break;
+            traj.positions.emplace_back(v[0], v[1], v[2]);
+            if (traj.format == Format::XYZV)
+                traj.velocities.emplace_back(v[3], v[4], v[5]);
+        }
+
+        traj.times.push_back(t);
+    }
+
+    return in.eof();
+}
+
+
+bool
+ReadBinary(const fs::path& path, Trajectory& traj)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::array<char, sizeof(XYZVBinaryHeader)> header;
+    if (!in.read(header.data(), header.size())) /* Flawfinder: ignore */
+        return false;
+
+    if (std::string_view(header.data() + offsetof(XYZVBinaryHeader, magic), XYZV_MAGIC.size()) != XYZV_MAGIC)
+        return false;
+
+    decltype(XYZVBinaryHeader::byteOrder) byteOrder;
+    std::memcpy(&byteOrder, header.data() + offsetof(XYZVBinaryHeader, byteOrder), sizeof(byteOrder));
+    decltype(XYZVBinaryHeader::digits) digits;
+    std::memcpy(&digits, header.data() + offsetof(XYZVBinaryHeader, digits), sizeof(digits));
+    if (byteOrder != static_cast<decltype(byteOrder)>(celestia::compat::endian::native) ||
+        digits != std::numeric_limits<double>::digits)
+    {
+        return false;
+    }
+
+    decltype(XYZVBinaryHeader::count) count;
+    std::memcpy(&count, header.data() + offsetof(XYZVBinaryHeader, count), sizeof(count));
+    for (decltype(count) i = 0; i < count; ++i)
+    {
+        std::array<char, sizeof(XYZVBinaryData)> data;
+        if (!in.read(data.data(), data.size())) /* Flawfinder: ignore */
+            return false;
+
+        double t;
+        std::array<double, 3> position;
+        std::array<double, 3> velocity;
+        std::memcpy(&t, data.data() + offsetof(XYZVBinaryData, tdb), sizeof(t));
+        std::memcpy(position.data(), data.data() + offsetof(XYZVBinaryData, position), sizeof(double) * 3);
+        std::memcpy(velocity.data(), data.data() + offsetof(XYZVBinaryData, velocity), sizeof(double) * 3);
+
+        traj.times.push_back(t);
+        traj.positions.emplace_back(position[0], position[1], position[2]);
+        traj.velocities.emplace_back(velocity[0], velocity[1], velocity[2]);
+    }
+
+    return true;
+}
+
+
+bool
+WriteText(const fs::path& path, const Trajectory& traj, const std::vector<std::size_t>& kept)
+{
+    std::ofstream out(path);
+    if (!out.good())
+        return false;
+
+    for (std::size_t i : kept)
+    {
+        if (traj.format == Format::Orientation)
+        {
+            const Eigen::Quaternionf& q = traj.orientations[i];
+            out << fmt::format("{} {} {} {} {}\n", traj.times[i], q.w(), q.x(), q.y(), q.z());
+            continue;
+        }
+
+        const Eigen::Vector3d& p = traj.positions[i];
+        if (traj.format == Format::XYZ)
+        {
+            out << fmt::format("{} {} {} {}\n", traj.times[i], p.x(), p.y(), p.z());
+        }
+        else
+        {
+            const Eigen::Vector3d& v = traj.velocities[i];
+            out << fmt::format("{} {} {} {} {} {} {}\n",
+                               traj.times[i], p.x(), p.y(), p.z(), v.x(), v.y(), v.z());
+        }
+    }
+
+    return out.good();
+}
+
+
+bool
+WriteBinary(const fs::path& path, const Trajectory& traj, const std::vector<std::size_t>& kept)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out.good())
+        return false;
+
+    std::array<char, sizeof(XYZVBinaryHeader)> header = {};
+    auto byteOrder = static_cast<decltype(XYZVBinaryHeader::byteOrder)>(celestia::compat::endian::native);
+    auto digits =    static_cast<decltype(XYZVBinaryHeader::digits)   >(std::numeric_limits<double>::digits);
+    auto count =     static_cast<decltype(XYZVBinaryHeader::count)    >(kept.size());
+    std::memcpy(header.data() + offsetof(XYZVBinaryHeader, magic), XYZV_MAGIC.data(), XYZV_MAGIC.size());
+    std::memcpy(header.data() + offsetof(XYZVBinaryHeader, byteOrder), &byteOrder, sizeof(byteOrder));
+    std::memcpy(header.data() + offsetof(XYZVBinaryHeader, digits),    &digits,    sizeof(digits));
+    std::memcpy(header.data() + offsetof(XYZVBinaryHeader, count),     &count,     sizeof(count));
+    out.write(header.data(), header.size());
+
+    for (std::size_t i : kept)
+    {
+        std::array<double, 7> values
+        {
+            traj.times[i],
+            traj.positions[i].x(), traj.positions[i].y(), traj.positions[i].z(),
+            traj.velocities[i].x(), traj.velocities[i].y(), traj.velocities[i].z(),
+        };
+        out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+    }
+
+    return out.good();
+}
+
+
+bool
+IsSameFile(const fs::path& output, const fs::path& input)
+{
+    std::error_code ec;
+    return fs::equivalent(output, input, ec);
+}
+
+
+struct Result
+{
+    bool success;
+    std::string report;
+};
+
+
+Result
+Failure(const fs::path& input, std::string_view error)
+{
+    return { false, fmt::format("{}: {}\n", input.string(), error) };
+}
+
+
+// Decimate one file and write the decimated data to the output directory
+Result
+ProcessFile(const Options& options, const fs::path& input)
+{
+    Trajectory traj;
+    if (!GetFormat(input, traj.format))
+        return Failure(input, "unknown file type");
+
+    bool loaded = traj.format == Format::XYZVBinary ? ReadBinary(input, traj) : ReadText(input, traj);
+    if (!loaded || traj.size() == 0)
+        return Failure(input, "error reading file");
+
+    for (std::size_t i = 1; i < traj.size(); ++i)
+    {
+        if (traj.times[i] <= traj.times[i - 1])
+            return Failure(input, fmt::format("sample times must increase, record {}", i + 1));
+    }
+
+    bool isOrientation = traj.format == Format::Orientation;
+    // Orientations are always interpolated linearly
+    Interpolation interpolation = isOrientation ? Interpolation::Linear : options.interpolation;
+    double tolerance = isOrientation
+        ? options.angleTolerance * celestia::numbers::pi / 180.0
+        : options.tolerance;
+
+    std::vector<std::size_t> kept = Decimate(traj, interpolation, tolerance);
+    double maxError = MaxError(traj, interpolation, kept);
+
+    bool hasVelocities = traj.format == Format::XYZV || traj.format == Format::XYZVBinary;
+    bool writeBinary = hasVelocities && (options.writeBinary || (!options.writeText && traj.format == Format::XYZVBinary));
+    bool writeText = !hasVelocities || options.writeText || (!options.writeBinary && traj.format == Format::XYZV);
+    if (traj.format == Format::XYZVBinary)
+        traj.format = Format::XYZV;
+
+    fs::path output = options.outputDir / input.filename();
+    if (writeText)
+    {
+        if (hasVelocities)
+            output.replace_extension(".xyzv");
+        if (IsSameFile(output, input) || !WriteText(output, traj, kept))
+            return Failure(input, fmt::format("error writing {}", output.string()));
+    }
+
+    if (writeBinary)
+    {
+        output.replace_extension(".xyzvbin");
+        if (IsSameFile(output, input) || !WriteBinary(output, traj, kept))
+            return Failure(input, fmt::format("error writing {}", output.string()));
+    }
+
+    return { true, fmt::format("{}: {} -> {} samples, ratio {:.1f}:1, max error {:.6g} {}\n",
+                               input.string(), traj.size(), kept.size(),
+                               static_cast<double>(traj.size()) / static_cast<double>(kept.size()),
+                               isOrientation ? maxError * 180.0 / celestia::numbers::pi : maxError,
+                               isOrientation ? "deg" : "km") };
+}
+
+
+void
+Usage()
+{
+    fmt::print(stderr,
+               "Usage: trajdecimate [options] <file>...\n"
+               "Input files are .xyz, .xyzv, .xyzvbin trajectories or .q orientations.\n"
+               "  -o, --output <dir>        directory for the decimated files (required)\n"
+               "  -t, --tolerance <km>      maximum position error, default 1\n"
+               "  -a, --angle <degrees>     maximum orientation error, default 0.01\n"
+               "  -l, --linear              trajectories use linear interpolation\n"
+               "      --text                write xyzv trajectories as text\n"
+               "      --binary              write xyzv trajectories as binary\n"
+               "  -j, --jobs <n>            number of files processed in parallel\n");
+}
+
+
+bool
+ParseCommandLine(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ((arg == "-o" || arg == "--output") && hasValue)
+            options.outputDir = argv[++i];
+        else if ((arg == "-t" || arg == "--tolerance") && hasValue)
+            options.tolerance = std::atof(argv[++i]);
+        else if ((arg == "-a" || arg == "--angle") && hasValue)
+            options.angleTolerance = std::atof(argv[++i]);
+        else if ((arg == "-j" || arg == "--jobs") && hasValue)
+            options.jobs = static_cast<unsigned int>(std::atoi(argv[++i]));
+        else if (arg == "-l" || arg == "--linear")
+            options.interpolation = Interpolation::Linear;
+        else if (arg == "--text")
+            options.writeText = true;
+        else if (arg == "--binary")
+            options.writeBinary = true;
+        else if (!arg.empty() && arg[0] == '-')
+            return false;
+        else
+            options.inputs.emplace_back(arg);
+    }
+
+    return !options.outputDir.empty() && !options.inputs.empty() &&
+           options.tolerance > 0.0 && options.angleTolerance > 0.0;
+}
+
+} // end unnamed namespace
+
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseCommandLine(argc, argv, options))
+    {
+        Usage();
+        return 1;
+    }
+
+    if (!fs::is_directory(options.outputDir))
+    {
+        fmt::print(stderr, "Output directory {} does not exist.\n", options.outputDir.string());
+        return 1;
+    }
+
+    unsigned int jobs = options.jobs > 0 ? options.jobs : std::max(std::thread::hardware_concurrency(), 1u);
+    jobs = std::min(jobs, static_cast<unsigned int>(options.inputs.size()));
+
+    std::vector<Result> results(options.inputs.size());
+    std::atomic<std::size_t> nextInput{ 0 };
+    auto worker = [&]
+    {
+        for (std::size_t i = nextInput++; i < options.inputs.size(); i = nextInput++)
+            results[i] = ProcessFile(options, options.inputs[i]);
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < jobs; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    int status = 0;
+    for (const auto& result : results)
+    {
+        fmt::print(stderr, "{}", result.report);
+        if (!result.success)
+            status = 1;
+    }
+
+    return status;
+}
@@ -0,0 +1,129 @@
+#include <array>
+#include <cmath>
+
+#include <Eigen/Core>
+
+#include <celengine/astro.h>
+#include <celengine/body.h>
+#include <celengine/bodyphotometry.h>
+#include <celengine/star.h>
+
+#include <doctest.h>
+
+namespace
+{
+
+struct Light
+{
+    Eigen::Vector3d position;
+    float luminosity;
+};
+
+// Scalar reference, as Body::getApparentMagnitude()
+float
+lambertianMagnitude(float luminosity, float radius, float reflectivity,
+                    const Eigen::Vector3d& sunPosition,
+                    const Eigen::Vector3d& viewerPosition)
+{
+    double distanceToViewer = viewerPosition.norm();
+    double distanceToSun = sunPosition.norm();
+    float illuminatedFraction = (float) (1.0 + (viewerPosition / distanceToViewer).dot(sunPosition / distanceToSun)) / 2.0f;
+    float lum = (float) (luminosity * radius * radius * reflectivity / (4.0 * distanceToSun * distanceToSun));
+    return astro::lumToAppMag(lum * illuminatedFraction, (float) astro::kilometersToLightYears(distanceToViewer));
+}
+
+} // end unnamed namespace
+
+TEST_SUITE_BEGIN("BodyPhotometry");
+
+TEST_CASE("Lambertian magnitudes match the scalar computation")
+{
+    constexpr double au = KM_PER_AU<double>;
+    std::array<Light, 1> lights{ Light{ Eigen::Vector3d(-0.3 * au, 0.9 * au, 0.0), 1.0f } };
+
+    std::array<Eigen::Vector3d, 5> positions
+    {
+        Eigen::Vector3d(5.2 * au, 0.1 * au, 0.0),
+        Eigen::Vector3d(0.0, 0.7 * au, 0.1 * au),
+        Eigen::Vector3d(-1.2 * au, 0.4 * au, 0.0),
+        Eigen::Vector3d(384400.0, 0.0, 0.0),
+        Eigen::Vector3d(30.0 * au, -2.0 * au, 1.0 * au),
+    };
+
+    BodyPhotometry photometry;
+    for (const auto& p : positions)
+        photometry.add(p, 2500.0f, 0.3f);
+    photometry.evaluate(0, BodyPhotometry::Model::Lambertian, lights, 0.001f);
+
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        Eigen::Vector3d sunPos = positions[i] - lights[0].position;
+        float expected = lambertianMagnitude(1.0f, 2500.0f, 0.3f, sunPos, positions[i]);
+        REQUIRE(photometry.appMag(i) == doctest::Approx(expected).epsilon(1e-4));
+        REQUIRE(photometry.distance(i) == doctest::Approx(positions[i].norm()));
+        REQUIRE(photometry.discSize(i) == doctest::Approx(2500.0 / (positions[i].norm() * 0.001)));
+    }
+}
+
+TEST_CASE("Body magnitudes ignore rings and comae")
+{
+    constexpr double au = KM_PER_AU<double>;
+    std::array<Light, 1> sun{ Light{ Eigen::Vector3d(-9.5 * au, 0.0, 0.0), 1.0f } };
+    Eigen::Vector3d position(0.0, 0.0, 1.0 * au);
+
+    Star star;
+    PlanetarySystem system(&star);
+
+    Body saturn(&system, "Saturn");
+    saturn.setSemiAxes(Eigen::Vector3f(60268.0f, 54364.0f, 60268.0f));
+    saturn.setReflectivity(0.342f);
+    saturn.setRings(RingSystem(74658.0f, 140220.0f));
+
+    Body comet(&system, "Comet");
+    comet.setSemiAxes(Eigen::Vector3f::Constant(5.0f));
+    comet.setReflectivity(0.04f);
+    comet.setClassification(Body::Comet);
+
+    for (const Body* body : { &saturn, &comet })
+    {
+        REQUIRE(body->getCullingRadius() > body->getRadius());
+
+        BodyPhotometry photometry;
+        photometry.add(position, *body);
+        photometry.evaluate(0, BodyPhotometry::Model::Lambertian, sun, 0.001f);
+
+        float expected = lambertianMagnitude(1.0f, body->getRadius(), body->getReflectivity(),
+                                             position - sun[0].position, position);
+        REQUIRE(photometry.appMag(0) == doctest::Approx(expected).epsilon(1e-4));
+        REQUIRE(photometry.discSize(0) == doctest::Approx(body->getCullingRadius() / (position.norm() * 0.001)));
+    }
+}
+
+TEST_CASE("H-G magnitudes")
+{
+    constexpr double au = KM_PER_AU<double>;
+    std::array<Light, 1> sun{ Light{ Eigen::Vector3d(-1.0 * au, 0.0, 0.0), 1.0f } };
+
+    BodyPhotometry photometry;
+    // At opposition 2 au from the sun and 1 au from the viewer
+    photometry.add(Eigen::Vector3d(0.0, 0.0, au), 470.0f, 3.34f, 0.12f);
+    photometry.add(Eigen::Vector3d(au, 0.0, 0.0), 470.0f, 3.34f, 0.12f);
+    photometry.evaluate(1, BodyPhotometry::Model::HG, sun, 0.001f);
+    REQUIRE(photometry.appMag(1) == doctest::Approx(3.34f + 5.0f * std::log10(2.0f)).epsilon(1e-4));
+
+    photometry.evaluate(0, BodyPhotometry::Model::HG, sun, 0.001f);
+    // 45 degree phase angle, sqrt(2) au from the sun
+    double tanHalf = std::tan(0.125 * 3.141592653589793);
+    double phi1 = std::exp(-3.33 * std::pow(tanHalf, 0.63));
+    double phi2 = std::exp(-1.87 * std::pow(tanHalf, 1.22));
+    double expected = 3.34 + 5.0 * std::log10(std::sqrt(2.0)) - 2.5 * std::log10(0.88 * phi1 + 0.12 * phi2);
+    REQUIRE(photometry.appMag(0) == doctest::Approx(expected).epsilon(1e-4));
+
+    // Truncating drops entries; with no lights nothing is visible
+    photometry.truncate(1);
+    REQUIRE(photometry.size() == 1);
+    photometry.evaluate(0, BodyPhotometry::Model::HG, std::array<Light, 0>{}, 0.001f);
+    REQUIRE(photometry.appMag(0) == 100.0f);
+}
+
+TEST_SUITE_END();
@@ -1,6 +1,7 @@
 #include <doctest.h>
 
 #include <celengine/category.h>
+#include <celengine/categoryfilter.h>
 #include <celengine/star.h>
 
 TEST_SUITE_BEGIN("Category");
@@ -224,4 +225,105 @@ TEST_CASE("Objects in categories")
     }
 }
 
+TEST_CASE("Object category masks")
+{
+    UserCategoryManager manager;
+    auto fooId = manager.create("foo", UserCategoryId::Invalid, {});
+    auto barId = manager.create("bar", UserCategoryId::Invalid, {});
+    REQUIRE(fooId != UserCategoryId::Invalid);
+    REQUIRE(barId != UserCategoryId::Invalid);
+
+    Star star;
+    Selection sel{&star};
+    REQUIRE(star.getCategoryMask() == 0);
+
+    REQUIRE(manager.addObject(sel, fooId));
+    REQUIRE(manager.addObject(sel, barId));
+    REQUIRE(star.getCategoryMask() == (UserCategoryBit(fooId) | UserCategoryBit(barId)));
+
+    SUBCASE("Remove object")
+    {
+        REQUIRE(manager.removeObject(sel, fooId));
+        REQUIRE(star.getCategoryMask() == UserCategoryBit(barId));
+    }
+
+    SUBCASE("Clear categories")
+    {
+        manager.clearCategories(sel);
+        REQUIRE(star.getCategoryMask() == 0);
+    }
+
+    SUBCASE("Destroy category")
+    {
+        REQUIRE(manager.destroy(barId));
+        REQUIRE(star.getCategoryMask() == UserCategoryBit(fooId));
+    }
+}
+
+TEST_CASE("Category filter")
+{
+    UserCategoryManager manager;
+    auto neoId = manager.create("near earth asteroids", UserCategoryId::Invalid, {});
+    auto cometId = manager.create("comets", UserCategoryId::Invalid, {});
+    UserCategoryMask neo = UserCategoryBit(neoId);
+    UserCategoryMask comet = UserCategoryBit(cometId);
+
+    SUBCASE("Empty filter")
+    {
+        auto filter = CategoryFilter::parse(" ; ", &manager);
+        REQUIRE(filter.has_value());
+        REQUIRE(filter->isEmpty());
+        REQUIRE(filter->isVisible(0));
+    }
+
+    SUBCASE("Show and hide")
+    {
+        auto filter = CategoryFilter::parse("show near earth asteroids; show comets; hide comets", &manager);
+        REQUIRE(filter.has_value());
+        REQUIRE(filter->hidesObjects());
+        REQUIRE(filter->isVisible(neo));
+        REQUIRE(!filter->isVisible(comet));
+        REQUIRE(!filter->isVisible(neo | comet));
+        REQUIRE(!filter->isVisible(0));
+    }
+
+    SUBCASE("Color and label")
+    {
+        auto filter = CategoryFilter::parse("color #ff0000 comets; label near earth asteroids", &manager);
+        REQUIRE(filter.has_value());
+        REQUIRE(!filter->hidesObjects());
+        REQUIRE(filter->isVisible(0));
+        REQUIRE(filter->isLabeled(neo));
+        REQUIRE(!filter->isLabeled(comet));
+        REQUIRE(filter->getColor(neo) == nullptr);
+        const Color* color = filter->getColor(comet | neo);
+        REQUIRE(color != nullptr);
+        REQUIRE(color->red() == doctest::Approx(1.0f));
+        REQUIRE(color->green() == doctest::Approx(0.0f));
+    }
+
+    SUBCASE("Invalid filters")
+    {
+        REQUIRE(!CategoryFilter::parse("show", &manager).has_value());
+        REQUIRE(!CategoryFilter::parse("show planets", &manager).has_value());
+        REQUIRE(!CategoryFilter::parse("shade comets", &manager).has_value());
+        REQUIRE(!CategoryFilter::parse("color notacolor comets", &manager).has_value());
+    }
+
+    SUBCASE("Destroyed category")
+    {
+        auto filter = CategoryFilter::parse("hide comets", &manager);
+        REQUIRE(filter.has_value());
+        REQUIRE(filter->isCurrent(&manager));
+        REQUIRE(manager.destroy(cometId));
+        REQUIRE(!filter->isCurrent(&manager));
+
+        // The bit of the destroyed category goes to the next one created
+        auto planetId = manager.create("planets", UserCategoryId::Invalid, {});
+        REQUIRE(UserCategoryBit(planetId) == comet);
+        REQUIRE(!CategoryFilter::parse(filter->getExpression(), &manager).has_value());
+        REQUIRE(CategoryFilter::parse("", &manager)->isCurrent(&manager));
+    }
+}
+
 TEST_SUITE_END();
@@ -0,0 +1,45 @@
+#include <array>
+#include <cmath>
+
+#include <Eigen/Core>
+
+#include <celmath/chebyshev.h>
+
+#include <doctest.h>
+
+TEST_SUITE_BEGIN("Chebyshev");
+
+TEST_CASE("Chebyshev series reproduces a smooth function")
+{
+    constexpr std::size_t N = 16;
+    auto nodes = celmath::ChebyshevNodes<double, N>();
+    std::array<double, N> values;
+    for (std::size_t k = 0; k < N; ++k)
+        values[k] = std::sin(2.0 * nodes[k]);
+
+    auto coeffs = celmath::ChebyshevFit<double, double>(values);
+    auto deriv = celmath::ChebyshevDerivative<double, double>(coeffs);
+    for (double x = -1.0; x <= 1.0; x += 0.125)
+    {
+        REQUIRE(celmath::ChebyshevEvaluate(coeffs, x) == doctest::Approx(std::sin(2.0 * x)).epsilon(1e-12));
+        REQUIRE(celmath::ChebyshevEvaluate(deriv, x) == doctest::Approx(2.0 * std::cos(2.0 * x)).epsilon(1e-10));
+    }
+}
+
+TEST_CASE("Chebyshev series of vectors")
+{
+    constexpr std::size_t N = 4;
+    auto nodes = celmath::ChebyshevNodes<double, N>();
+    std::array<Eigen::Vector3d, N> values;
+    for (std::size_t k = 0; k < N; ++k)
+        values[k] = Eigen::Vector3d(1.0, nodes[k], nodes[k] * nodes[k] * nodes[k]);
+
+    auto coeffs = celmath::ChebyshevFit<Eigen::Vector3d, double>(values);
+    auto deriv = celmath::ChebyshevDerivative<Eigen::Vector3d, double>(coeffs);
+    Eigen::Vector3d p = celmath::ChebyshevEvaluate(coeffs, 0.5);
+    Eigen::Vector3d v = celmath::ChebyshevEvaluate(deriv, 0.5);
+    REQUIRE((p - Eigen::Vector3d(1.0, 0.5, 0.125)).norm() < 1e-14);
+    REQUIRE((v - Eigen::Vector3d(0.0, 1.0, 0.75)).norm() < 1e-14);
+}
+
+TEST_SUITE_END();
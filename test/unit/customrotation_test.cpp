@@ -0,0 +1,102 @@
+#include <array>
+#include <vector>
+
+#include <Eigen/Geometry>
+
+#include <celephem/customrotation.h>
+#include <celephem/rotation.h>
+
+#include <doctest.h>
+
+using namespace celestia::ephem;
+
+namespace
+{
+
+struct ReferenceOrientation
+{
+    const char* model;
+    double tjd;
+    double w, x, y, z;
+};
+
+// Computed with the hand-coded rotation model classes that the tables
+// replaced, at 1600, J2000, 2023 and 3000
+constexpr std::array<ReferenceOrientation, 32> referenceOrientations
+{{
+    { "iau-earth", 2305447.5, 0.79628264194726794, -0.012437627482829901, 0.60461226062731077, -0.014942351060330709 },
+    { "iau-earth", 2451545.0, -0.6418043862296835, 0.0, 0.76686839145732111, 0.0 },
+    { "iau-earth", 2460000.5, 0.97424781829205287, 0.00025087962930549554, 0.22547709939348615, 0.0010969328541235038 },
+    { "iau-earth", 2816787.5, 0.67689949149892081, 0.031828718547237358, 0.73447011798039519, 0.036710446442498559 },
+    { "iau-moon", 2305447.5, 0.59329485540520988, -0.12728295241170479, -0.78072970575636258, -0.14920251715254043 },
+    { "iau-moon", 2451545.0, 0.31866756229443033, -0.079608157216247144, 0.92408921324623217, 0.19537822808060917 },
+    { "iau-moon", 2460000.5, -0.94594753240563412, 0.18332532359694875, 0.26097748533479054, 0.058871417615807546 },
+    { "iau-moon", 2816787.5, 0.86379412888898832, -0.18543063456561359, 0.45632064897683583, 0.10605021442159901 },
+    { "iau-mars", 2305447.5, -0.90059377654861494, 0.12646479817691156, -0.29821270175831471, -0.28983907427050404 },
+    { "iau-mars", 2451545.0, 0.87801015666125881, -0.2871806430187927, -0.35751790777010478, 0.13713638721605281 },
+    { "iau-mars", 2460000.5, 0.55346736059705093, 0.065839896012432439, 0.76962362359801939, 0.31147787537265031 },
+    { "iau-mars", 2816787.5, 0.94119002128355433, -0.19644083719428765, 0.098250056152265064, 0.25674747863366976 },
+    { "iau-jupiter", 2305447.5, 0.13558521323042982, -0.03795922848932471, 0.96587618508687001, 0.21739121879181006 },
+    { "iau-jupiter", 2451545.0, 0.60715287862578204, -0.1314813193453046, -0.76329578021723588, -0.1773628950547588 },
+    { "iau-jupiter", 2460000.5, -0.97416796027137842, 0.22003358665607681, 0.047426165202894041, 0.018241841412332874 },
+    { "iau-jupiter", 2816787.5, 0.90933778957470734, -0.20312138562894766, -0.35248693912944257, -0.087174795065535465 },
+    { "iau-io", 2305447.5, -0.88768344466794735, 0.2038487714779611, -0.40416095184571399, -0.084366494727109678 },
+    { "iau-io", 2451545.0, 0.96277350372064274, -0.21636204218994512, -0.15620359033457112, -0.043070704654828082 },
+    { "iau-io", 2460000.5, -0.0061297948661000173, -0.0064157826041992931, 0.97537018700312361, 0.22039569336528989 },
+    { "iau-io", 2816787.5, 0.54145228337879392, -0.11593661176680584, -0.81122466574579488, -0.18789004380633509 },
+    { "iau-titan", 2305447.5, -0.98858371736550277, -0.022618454176097987, 0.14165548887155233, -0.046090799114889294 },
+    { "iau-titan", 2451545.0, -0.37355264525586962, 0.027811610371565994, 0.92596943780688057, -0.047597644883882989 },
+    { "iau-titan", 2460000.5, 0.46625017954089487, 0.054617452707718943, 0.88291924798078036, -0.0090169552985766496 },
+    { "iau-titan", 2816787.5, -0.91541294571437337, -0.0093704523979340065, 0.39920967311279171, -0.050625787239013544 },
+    { "iau-neptune", 2305447.5, 0.34343720151106483, -0.30704444736484404, -0.85365216141950617, -0.24300737286031238 },
+    { "iau-neptune", 2451545.0, 0.57370312698925607, -0.37025885324744817, -0.71522510602541511, -0.14908437673199654 },
+    { "iau-neptune", 2460000.5, -0.89666665412443225, 0.29869649954470501, -0.19161928995191943, -0.26467217507580609 },
+    { "iau-neptune", 2816787.5, -0.76100806000998267, 0.38991878446393652, 0.51752582879953624, 0.031576742190449647 },
+    { "iau-miranda", 2305447.5, 0.68123229294310861, 0.41523497893317912, -0.40031543109369327, 0.450832597479494 },
+    { "iau-miranda", 2451545.0, 0.27851196541193435, 0.12694398665858184, -0.74828591309522041, 0.58854439223975219 },
+    { "iau-miranda", 2460000.5, 0.18535052405036884, 0.0095672742117977883, -0.7483217214715, 0.63684240725028729 },
+    { "iau-miranda", 2816787.5, 0.77205287775017051, 0.62061068668278097, -0.017475506635058841, 0.13590929401867829 },
+}};
+
+} // end unnamed namespace
+
+TEST_SUITE_BEGIN("Custom rotations");
+
+TEST_CASE("Rotation models match the previous implementation")
+{
+    for (const auto& ref : referenceOrientations)
+    {
+        INFO(ref.model, " at ", ref.tjd);
+        const RotationModel* model = GetCustomRotationModel(ref.model);
+        REQUIRE(model != nullptr);
+        Eigen::Quaterniond expected(ref.w, ref.x, ref.y, ref.z);
+        REQUIRE(model->orientationAtTime(ref.tjd).angularDistance(expected) < 1.0e-9);
+    }
+}
+
+TEST_CASE("System evaluation matches the individual rotation models")
+{
+    constexpr double tjd = 2460000.5;
+
+    std::vector<CustomRotationState> states;
+    REQUIRE(ComputeIAUSystemRotations("saturn", tjd, states));
+    REQUIRE(states.size() == 16);
+
+    for (const auto& state : states)
+    {
+        const RotationModel* model = GetCustomRotationModel(state.name);
+        REQUIRE(model != nullptr);
+        Eigen::Quaterniond expected = model->orientationAtTime(tjd);
+        REQUIRE((state.spin * state.equatorOrientation).angularDistance(expected) < 1.0e-12);
+    }
+}
+
+TEST_CASE("Unknown systems and models")
+{
+    std::vector<CustomRotationState> states;
+    REQUIRE_FALSE(ComputeIAUSystemRotations("vulcan", 2451545.0, states));
+    REQUIRE(states.empty());
+    REQUIRE(GetCustomRotationModel("iau-vulcan") == nullptr);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,44 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <celengine/displaynames.h>
+
+#include <doctest.h>
+
+TEST_SUITE_BEGIN("DisplayNameTable");
+
+TEST_CASE("Names are computed once and stay valid")
+{
+    DisplayNameTable table;
+    table.reset(20000);
+
+    int calls = 0;
+    auto name = [&calls](std::size_t i) { ++calls; return "Object " + std::to_string(i); };
+
+    std::vector<std::string_view> views;
+    for (std::size_t i = 0; i < table.size(); ++i)
+        views.push_back(table.get(i, [&] { return name(i); }));
+    REQUIRE(calls == 20000);
+
+    // Later additions fill several blocks without moving earlier names
+    for (std::size_t i = 0; i < table.size(); ++i)
+    {
+        REQUIRE(views[i] == "Object " + std::to_string(i));
+        REQUIRE(table.get(i, [&] { return name(i); }).data() == views[i].data());
+    }
+    REQUIRE(calls == 20000);
+}
+
+TEST_CASE("Long names are truncated")
+{
+    DisplayNameTable table;
+    table.reset(2);
+    std::string_view empty = table.get(0, [] { return std::string(); });
+    std::string_view name = table.get(1, [] { return std::string(100000, 'x'); });
+    REQUIRE(empty.empty());
+    REQUIRE(name.size() < 65536);
+    REQUIRE(name.find_first_not_of('x') == std::string_view::npos);
+}
+
+TEST_SUITE_END();
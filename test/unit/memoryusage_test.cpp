@@ -0,0 +1,44 @@
+#include <utility>
+
+#include <celutil/memoryusage.h>
+
+#include <doctest.h>
+
+using namespace celestia::util;
+
+TEST_SUITE_BEGIN("MemoryUsage");
+
+TEST_CASE("Memory trackers count their bytes while they live")
+{
+    std::size_t initial = GetMemoryUsage(MemoryCategory::Locations);
+    {
+        MemoryTracker tracker(MemoryCategory::Locations, 100);
+        REQUIRE(GetMemoryUsage(MemoryCategory::Locations) == initial + 100);
+
+        tracker.add(50);
+        tracker.remove(20);
+        REQUIRE(tracker.bytes() == 130);
+        REQUIRE(GetMemoryUsage(MemoryCategory::Locations) == initial + 130);
+
+        MemoryTracker copy(tracker);
+        REQUIRE(GetMemoryUsage(MemoryCategory::Locations) == initial + 260);
+
+        MemoryTracker moved(std::move(copy));
+        REQUIRE(GetMemoryUsage(MemoryCategory::Locations) == initial + 260);
+
+        MemoryTracker assigned(MemoryCategory::Locations, 10);
+        assigned = std::move(moved);
+        REQUIRE(assigned.bytes() == 130);
+        REQUIRE(GetMemoryUsage(MemoryCategory::Locations) == initial + 260);
+    }
+    REQUIRE(GetMemoryUsage(MemoryCategory::Locations) == initial);
+}
+
+TEST_CASE("Memory usage summary lists every category")
+{
+    auto summary = FormatMemoryUsage();
+    REQUIRE(summary.find("orbitsamples") != std::string::npos);
+    REQUIRE(summary.find("video") != std::string::npos);
+}
+
+TEST_SUITE_END();
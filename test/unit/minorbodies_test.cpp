@@ -0,0 +1,158 @@
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include <celengine/astro.h>
+#include <celengine/body.h>
+#include <celengine/minorbodies.h>
+#include <celengine/solarsys.h>
+#include <celengine/stardb.h>
+#include <celengine/starname.h>
+#include <celengine/universe.h>
+
+#include <doctest.h>
+
+namespace
+{
+
+// Place a value at 1-based columns as in the MPCORB.DAT documentation
+void
+setColumns(std::string& line, std::size_t first, std::string_view value)
+{
+    if (line.size() < first - 1 + value.size())
+        line.resize(first - 1 + value.size(), ' ');
+    line.replace(first - 1, value.size(), value);
+}
+
+std::string
+ceresLine()
+{
+    std::string line(202, ' ');
+    setColumns(line, 1, "00001");
+    setColumns(line, 9, " 3.34");
+    setColumns(line, 15, " 0.15");
+    setColumns(line, 21, "K239D");
+    setColumns(line, 27, "188.70269");
+    setColumns(line, 38, " 73.27343");
+    setColumns(line, 49, " 80.25221");
+    setColumns(line, 60, " 10.58780");
+    setColumns(line, 71, "0.0789126");
+    setColumns(line, 81, "0.21424651");
+    setColumns(line, 93, "  2.7660512");
+    setColumns(line, 167, "(1) Ceres");
+    return line;
+}
+
+std::unique_ptr<MinorBodyCatalog>
+loadCeres(Star* primary)
+{
+    std::istringstream in(ceresLine() + "\n");
+    auto catalog = std::make_unique<MinorBodyCatalog>(primary);
+    REQUIRE(LoadMPCOrbitElements(in, *catalog) == 1);
+    catalog->finish();
+    return catalog;
+}
+
+} // end unnamed namespace
+
+TEST_SUITE_BEGIN("MinorBodyCatalog");
+
+TEST_CASE("MPCORB elements are read into the catalog")
+{
+    std::istringstream in("MINOR PLANET CENTER ORBIT DATABASE (MPCORB)\n"
+                          "----------------------------------------------------------------------------------------------------------------------------------------\n"
+                          + ceresLine() + "\n");
+    MinorBodyCatalog catalog(nullptr);
+    REQUIRE(LoadMPCOrbitElements(in, catalog) == 1);
+    catalog.finish();
+
+    auto index = catalog.find("ceres");
+    REQUIRE(index != MinorBodyCatalog::InvalidIndex);
+    REQUIRE(catalog.getName(index) == "Ceres");
+    REQUIRE(catalog.getNumber(index) == 1);
+    REQUIRE(catalog.find("Vesta") == MinorBodyCatalog::InvalidIndex);
+
+    auto elements = catalog.getElements(index);
+    REQUIRE(elements.epoch == double(astro::Date(2023, 9, 13)));
+    REQUIRE(elements.meanAnomaly == doctest::Approx(188.70269));
+    REQUIRE(elements.inclination == doctest::Approx(10.58780));
+    REQUIRE(elements.eccentricity == doctest::Approx(0.0789126));
+    REQUIRE(elements.semiMajorAxis == doctest::Approx(2.7660512));
+    REQUIRE(elements.absMag == doctest::Approx(3.34f));
+
+    // D = 1329 km / sqrt(0.15) * 10^(-3.34/5), about 736 km
+    REQUIRE(catalog.getRadius(index) == doctest::Approx(368.0f).epsilon(1e-2));
+
+    // Period from Kepler's third law: about 4.6 years
+    REQUIRE(catalog.getPeriod(index) == doctest::Approx(1680.3).epsilon(1e-3));
+
+    // Distance from the Sun lies between perihelion and aphelion
+    double r = catalog.getPosition(index, elements.epoch).norm() / astro::AUtoKilometers(1.0);
+    REQUIRE(r >= 2.7660512 * (1.0 - 0.0789126));
+    REQUIRE(r <= 2.7660512 * (1.0 + 0.0789126));
+}
+
+TEST_CASE("Names prefixed with the number find catalog entries")
+{
+    auto catalog = loadCeres(nullptr);
+    auto index = catalog->find("Ceres");
+    REQUIRE(index != MinorBodyCatalog::InvalidIndex);
+    REQUIRE(catalog->find("1 Ceres") == index);
+    REQUIRE(catalog->find("2 Ceres") == MinorBodyCatalog::InvalidIndex);
+}
+
+TEST_CASE("Solar system bodies stand in for their catalog entries")
+{
+    std::istringstream stars(R"(0 "Sol" { RA 0 Dec 0 Distance 0.00001 SpectralType "G2V" AppMag -26.7 })");
+    StarDatabaseBuilder builder;
+    builder.setNameDatabase(std::make_unique<StarNameDatabase>());
+    REQUIRE(builder.load(stars));
+
+    Universe universe;
+    universe.setStarCatalog(builder.finish());
+    universe.setSolarSystemCatalog(std::make_unique<SolarSystemCatalog>());
+    Star* sun = universe.getStarCatalog()->find(0);
+    REQUIRE(sun != nullptr);
+
+    constexpr std::string_view ceresSsc = R"("Ceres:1 Ceres" "Sol"
+{
+    Class "asteroid"
+    Radius 470
+    EllipticalOrbit { Period 4.6 SemiMajorAxis 2.77 Eccentricity 0.079 }
+}
+)";
+
+    auto checkLinked = [&universe](const MinorBodyCatalog& catalog)
+    {
+        const PlanetarySystem* planets = universe.getSolarSystem(universe.getStarCatalog()->find(0))->getPlanets();
+        REQUIRE(planets->getSystemSize() == 1);
+        Body* ceres = planets->getBody(0);
+        REQUIRE(ceres->getRadius() == 470.0f);
+
+        auto index = catalog.find("Ceres");
+        REQUIRE(catalog.getBody(index) == ceres);
+        REQUIRE(universe.promoteMinorBody(index) == ceres);
+        REQUIRE(planets->getSystemSize() == 1);
+        REQUIRE(catalog.getBodyCount() == 1);
+    };
+
+    SUBCASE("Body added after the catalog")
+    {
+        universe.setMinorBodyCatalog(loadCeres(sun));
+        std::istringstream in{ std::string(ceresSsc) };
+        REQUIRE(LoadSolarSystemObjects(in, universe));
+        checkLinked(*universe.getMinorBodyCatalog());
+    }
+
+    SUBCASE("Catalog loaded after the body")
+    {
+        std::istringstream in{ std::string(ceresSsc) };
+        REQUIRE(LoadSolarSystemObjects(in, universe));
+        universe.setMinorBodyCatalog(loadCeres(sun));
+        checkLinked(*universe.getMinorBodyCatalog());
+    }
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,34 @@
+#include <cmath>
+
+#include <Eigen/Core>
+
+#include <celengine/octree.h>
+#include <celmath/mathlib.h>
+
+#include <doctest.h>
+
+TEST_SUITE_BEGIN("Octree");
+
+TEST_CASE("Occluder hides spheres behind it")
+{
+    // A body of radius 1 at distance 2, subtending 30 degrees
+    OctreeOccluder<double> occluder{ Eigen::Vector3d::UnitX(), 2.0, std::cos(celmath::degToRad(30.0)) };
+
+    SUBCASE("Points")
+    {
+        REQUIRE(occluder.hides(Eigen::Vector3d(10.0, 0.0, 0.0), 0.0));
+        REQUIRE(occluder.hides(Eigen::Vector3d(10.0, 5.0, 0.0), 0.0));
+        REQUIRE_FALSE(occluder.hides(Eigen::Vector3d(10.0, 6.0, 0.0), 0.0));
+        REQUIRE_FALSE(occluder.hides(Eigen::Vector3d(1.0, 0.0, 0.0), 0.0));
+        REQUIRE_FALSE(occluder.hides(Eigen::Vector3d(-10.0, 0.0, 0.0), 0.0));
+    }
+
+    SUBCASE("Spheres")
+    {
+        REQUIRE(occluder.hides(Eigen::Vector3d(10.0, 0.0, 0.0), 4.0));
+        REQUIRE_FALSE(occluder.hides(Eigen::Vector3d(10.0, 0.0, 0.0), 6.0));
+        REQUIRE_FALSE(occluder.hides(Eigen::Vector3d(10.0, 4.0, 0.0), 2.0));
+    }
+}
+
+TEST_SUITE_END();
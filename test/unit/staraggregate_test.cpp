@@ -0,0 +1,70 @@
+#include <cmath>
+#include <memory>
+#include <sstream>
+
+#include <fmt/format.h>
+
+#include <Eigen/Core>
+
+#include <celengine/astro.h>
+#include <celengine/stardb.h>
+
+#include <doctest.h>
+
+namespace
+{
+
+constexpr int ClusterSize = 300;
+constexpr float ClusterAbsMag = 15.0f;
+
+class AggregateCollector : public StarHandler
+{
+public:
+    void process(const Star& /*star*/, float /*distance*/, float /*appMag*/) override
+    {
+        ++nStars;
+    }
+
+    void processAggregate(const OctreeAggregate<float>& aggregate, float /*distance*/, float /*appMag*/) override
+    {
+        double lum = astro::absMagToLum(aggregate.absMag);
+        luminosity += lum;
+        center += aggregate.center.cast<double>() * lum;
+    }
+
+    int nStars{ 0 };
+    double luminosity{ 0.0 };
+    Eigen::Vector3d center{ Eigen::Vector3d::Zero() };
+};
+
+} // end unnamed namespace
+
+TEST_SUITE_BEGIN("StarDatabase");
+
+TEST_CASE("Invisible clusters of stars are aggregated")
+{
+    std::ostringstream stc;
+    for (int i = 0; i < ClusterSize; ++i)
+    {
+        stc << fmt::format("{} {{ RA {} Dec {} Distance {} SpectralType \"M5V\" AbsMag {} }}\n",
+                           i + 1, 45.0 + (i % 10) * 0.01, 30.0 + (i / 10 % 10) * 0.01,
+                           1000.0 + i / 100, ClusterAbsMag);
+    }
+
+    std::istringstream in(stc.str());
+    StarDatabaseBuilder builder;
+    REQUIRE(builder.load(in));
+    auto starDB = builder.finish();
+
+    Eigen::Vector3f cluster = astro::equatorialToCelestialCart(3.0f, 30.0f, 1000.0f);
+    AggregateCollector collector;
+    starDB->findVisibleStars(collector, -cluster, -30.0f);
+
+    double total = ClusterSize * astro::absMagToLum(ClusterAbsMag);
+    REQUIRE(collector.nStars == 0);
+    REQUIRE(collector.luminosity > 0.0);
+    REQUIRE(collector.luminosity <= total * 1.0001);
+    REQUIRE((collector.center / collector.luminosity - cluster.cast<double>()).norm() < 10.0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,92 @@
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <celengine/astro.h>
+#include <celengine/stardb.h>
+
+#include <doctest.h>
+
+namespace
+{
+
+class StarCollector : public StarHandler
+{
+public:
+    void process(const Star& star, float /*distance*/, float /*appMag*/) override
+    {
+        found.push_back(&star);
+    }
+
+    std::vector<const Star*> found;
+};
+
+std::unique_ptr<StarDatabase>
+loadStars()
+{
+    // Star 1 moves 1000 arcsec/yr towards increasing right ascension, about
+    // 0.0485 ly/yr at 10 ly; star 2 doesn't move.
+    std::istringstream in(R"(
+1 { RA 0 Dec 0 Distance 10 SpectralType "G2V" AbsMag 5 ProperMotionRA 1000000 }
+2 { RA 180 Dec 0 Distance 10 SpectralType "G2V" AbsMag 5 }
+)");
+    StarDatabaseBuilder builder;
+    REQUIRE(builder.load(in));
+    return builder.finish();
+}
+
+} // end unnamed namespace
+
+TEST_SUITE_BEGIN("StarDatabase");
+
+TEST_CASE("Stars with proper motion are found at the epoch")
+{
+    auto starDB = loadStars();
+    REQUIRE(starDB->hasMotion());
+
+    double years = 1000.0;
+    starDB->setEpoch(astro::J2000 + years * DAYS_PER_YEAR);
+
+    Eigen::Vector3f start = astro::equatorialToCelestialCart(0.0f, 0.0f, 10.0f);
+    Eigen::Vector3f east = astro::equatorialToCelestialCart(6.0f, 0.0f, 1.0f);
+    Eigen::Vector3f expected = start + east * static_cast<float>(celmath::degToRad(1000.0 / 3600.0) * 10.0 * years);
+
+    // Stars are moved by setting the epoch, not by the searches
+    REQUIRE((starDB->find(1)->getPosition() - expected).norm() < 1.0e-3f);
+
+    StarCollector atStart;
+    starDB->findCloseStars(atStart, start, 1.0f);
+    REQUIRE(atStart.found.empty());
+
+    StarCollector atEpoch;
+    starDB->findCloseStars(atEpoch, expected, 1.0f);
+    REQUIRE(atEpoch.found.size() == 1);
+    REQUIRE(atEpoch.found[0]->getIndex() == 1);
+    REQUIRE((atEpoch.found[0]->getPosition() - expected).norm() < 1.0e-3f);
+
+    StarCollector visible;
+    starDB->findVisibleStars(visible, Eigen::Vector3f::Zero(), 10.0f);
+    REQUIRE(visible.found.size() == 2);
+}
+
+TEST_CASE("Node bounds are recomputed outside of the motion window")
+{
+    auto starDB = loadStars();
+    starDB->setMotionWindow(DAYS_PER_YEAR);
+
+    // The first call starts the computation, which is complete by the next
+    // one since tests use a serial task scheduler.
+    double tdb = astro::J2000 + 5000.0 * DAYS_PER_YEAR;
+    starDB->setEpoch(tdb);
+    starDB->setEpoch(tdb);
+    starDB->setEpoch(astro::J2000);
+
+    StarCollector atStart;
+    starDB->findCloseStars(atStart, astro::equatorialToCelestialCart(0.0f, 0.0f, 10.0f), 1.0f);
+    REQUIRE(atStart.found.size() == 1);
+    REQUIRE(atStart.found[0]->getIndex() == 1);
+}
+
+TEST_SUITE_END();
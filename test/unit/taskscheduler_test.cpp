@@ -0,0 +1,105 @@
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <celutil/taskscheduler.h>
+
+#include <doctest.h>
+
+using namespace celestia::util;
+
+TEST_SUITE_BEGIN("TaskScheduler");
+
+TEST_CASE("Serial scheduler runs tasks in order")
+{
+    TaskScheduler scheduler(1);
+    REQUIRE(scheduler.isSerial());
+
+    std::vector<int> order;
+    {
+        TaskGroup group(scheduler, TaskPriority::Background, "ordered");
+        for (int i = 0; i < 5; ++i)
+            group.run([&order, i] { order.push_back(i); });
+
+        group.cancel();
+        group.run([&order] { order.push_back(100); });
+    }
+    REQUIRE(order == std::vector<int>{ 0, 1, 2, 3, 4 });
+
+    auto stats = scheduler.statistics();
+    REQUIRE(stats.size() == 1);
+    REQUIRE(stats[0].name == "ordered");
+    REQUIRE(stats[0].executed == 5);
+    REQUIRE(stats[0].cancelled == 1);
+}
+
+TEST_CASE("Parallel for covers the range once")
+{
+    TaskScheduler scheduler(4);
+    REQUIRE(scheduler.threadCount() == 4);
+
+    std::vector<std::atomic<int>> visits(100000);
+    scheduler.parallelFor(0, visits.size(), 1000, [&visits](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+            ++visits[i];
+    });
+
+    for (const auto& v : visits)
+        REQUIRE(v.load() == 1);
+}
+
+TEST_CASE("Nested task groups complete")
+{
+    TaskScheduler scheduler(3);
+    std::atomic<int> count{ 0 };
+    {
+        TaskGroup outer(scheduler);
+        for (int i = 0; i < 8; ++i)
+        {
+            outer.run([&scheduler, &count]
+            {
+                scheduler.parallelFor(0, 64, 4, [&count](std::size_t begin, std::size_t end)
+                {
+                    count += static_cast<int>(end - begin);
+                }, "inner");
+            });
+        }
+    }
+    REQUIRE(count.load() == 8 * 64);
+}
+
+TEST_CASE("Parallel sort")
+{
+    TaskScheduler scheduler(4);
+    std::mt19937 rng(42);
+    std::vector<std::uint32_t> values(200000);
+    for (auto& v : values)
+        v = rng();
+
+    auto expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    ParallelSort(scheduler, values.begin(), values.end(), std::less<std::uint32_t>());
+    REQUIRE(values == expected);
+}
+
+TEST_CASE("Detached tasks run before the scheduler is destroyed")
+{
+    auto count = std::make_shared<std::atomic<int>>(0);
+    {
+        TaskScheduler scheduler(3);
+        for (int i = 0; i < 16; ++i)
+            scheduler.detach([count] { ++*count; });
+
+        while (count->load() < 16)
+            std::this_thread::yield();
+    }
+    REQUIRE(count->load() == 16);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,60 @@
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <celengine/astro.h>
+#include <trajdecimate/decimate.h>
+
+#include <doctest.h>
+
+using trajdecimate::Decimate;
+using trajdecimate::Format;
+using trajdecimate::Interpolation;
+using trajdecimate::MaxError;
+using trajdecimate::Trajectory;
+
+namespace
+{
+
+// Circular low Earth orbit sampled every 10 seconds, velocities in km/s
+Trajectory
+circularOrbit()
+{
+    constexpr double radius = 7000.0;
+    constexpr double gm = 398600.4418;
+    const double omega = std::sqrt(gm / (radius * radius * radius));
+
+    Trajectory traj;
+    traj.format = Format::XYZV;
+    for (int i = 0; i <= 864; ++i)
+    {
+        double t = i * 10.0;
+        double angle = omega * t;
+        traj.times.push_back(astro::J2000 + astro::secsToDays(t));
+        traj.positions.emplace_back(radius * std::cos(angle), radius * std::sin(angle), 0.0);
+        traj.velocities.emplace_back(-radius * omega * std::sin(angle), radius * omega * std::cos(angle), 0.0);
+    }
+
+    return traj;
+}
+
+} // end unnamed namespace
+
+TEST_SUITE_BEGIN("trajdecimate");
+
+TEST_CASE("Cubic xyzv trajectories keep fewer samples than linear")
+{
+    Trajectory traj = circularOrbit();
+    std::vector<std::size_t> cubic = Decimate(traj, Interpolation::Cubic, 1.0);
+    std::vector<std::size_t> linear = Decimate(traj, Interpolation::Linear, 1.0);
+
+    REQUIRE(cubic.front() == 0);
+    REQUIRE(cubic.back() == traj.size() - 1);
+    REQUIRE(MaxError(traj, Interpolation::Cubic, cubic) <= 1.0);
+    REQUIRE(MaxError(traj, Interpolation::Linear, linear) <= 1.0);
+    // Hermite tangents from the stored velocities follow the orbit much
+    // more closely than chords do
+    REQUIRE(cubic.size() * 10 < linear.size());
+}
+
+TEST_SUITE_END();
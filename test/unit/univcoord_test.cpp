@@ -0,0 +1,143 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <Eigen/Core>
+
+#include <celengine/univcoord.h>
+
+#include <doctest.h>
+
+namespace
+{
+
+// Positions spread from kilometers to thousands of light years around
+// the origin, in micro-light years
+std::vector<UniversalCoord>
+makeCoords(UniversalCoord origin, std::size_t count)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::uniform_real_distribution<double> scale(-10.0, 9.5);
+
+    std::vector<UniversalCoord> coords;
+    coords.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Eigen::Vector3d v(unit(rng), unit(rng), unit(rng));
+        coords.push_back(origin.offsetUly(v * std::pow(10.0, scale(rng))));
+    }
+
+    return coords;
+}
+
+
+template<typename F>
+double
+timeLoop(F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // end unnamed namespace
+
+
+TEST_SUITE_BEGIN("UniversalCoord");
+
+TEST_CASE("Origin offsets match UniversalCoord")
+{
+    UniversalCoord origin = UniversalCoord::CreateLy(Eigen::Vector3d(8000.123456789, -2.5e-7, -1500.0));
+    UniversalCoordOrigin fastOrigin(origin);
+    std::vector<UniversalCoord> coords = makeCoords(origin, 1000);
+
+    for (const UniversalCoord& uc : coords)
+    {
+        Eigen::Vector3d expected = uc.offsetFromKm(origin);
+        Eigen::Vector3d offset = fastOrigin.offsetKm(uc);
+        REQUIRE((offset - expected).norm() <= 1.0e-14 * expected.norm() + 1.0e-9);
+    }
+}
+
+TEST_CASE("Origin offsets borrow across the integer part")
+{
+    // Fractions of a micro-light year on either side of an integer boundary
+    UniversalCoord origin(R128(0x8000000000000000ULL, 41ULL),
+                          R128(0ULL, 0ULL),
+                          R128(0ULL, ~0ULL));
+    UniversalCoord uc(R128(0x4000000000000000ULL, 41ULL),
+                      R128(0xC000000000000000ULL, ~0ULL),
+                      R128(0x4000000000000000ULL, 0ULL));
+    Eigen::Vector3d offset = UniversalCoordOrigin(origin).offsetUly(uc);
+    REQUIRE(offset.x() == -0.25);
+    REQUIRE(offset.y() == -0.25);
+    REQUIRE(offset.z() == 1.25);
+}
+
+TEST_CASE("Origin offsets of points in light years")
+{
+    // Far enough from the origin that a float can't resolve the offset
+    UniversalCoord origin = UniversalCoord::CreateLy(Eigen::Vector3d(123456.789, -98765.4321, 5.0e5));
+    UniversalCoordOrigin fastOrigin(origin);
+    Eigen::Vector3f p(123456.78f, -98765.43f, 500000.03f);
+
+    Eigen::Vector3d expected = UniversalCoord::CreateLy(p.cast<double>()).offsetFromUly(origin) * 1.0e-6;
+    Eigen::Vector3d offset = fastOrigin.offsetLy(p.cast<double>());
+    REQUIRE((offset - expected).norm() <= 1.0e-12);
+}
+
+// Run with --no-skip to print the timings
+TEST_CASE("Benchmark offset conversions" * doctest::skip())
+{
+    constexpr std::size_t Count = 1000000;
+    UniversalCoord origin = UniversalCoord::CreateLy(Eigen::Vector3d(26000.0, 12.5, -20.0));
+    UniversalCoordOrigin fastOrigin(origin);
+    std::vector<UniversalCoord> coords = makeCoords(origin, Count);
+    std::vector<Eigen::Vector3d> offsets(Count);
+    std::vector<Eigen::Vector3f> offsetsf(Count);
+
+    double tOffsetFromKm = timeLoop([&]
+    {
+        for (std::size_t i = 0; i < Count; ++i)
+            offsets[i] = coords[i].offsetFromKm(origin);
+    });
+    double tOriginKm = timeLoop([&]
+    {
+        for (std::size_t i = 0; i < Count; ++i)
+            offsets[i] = fastOrigin.offsetKm(coords[i]);
+    });
+
+    std::vector<Eigen::Vector3f> points(Count);
+    for (std::size_t i = 0; i < Count; ++i)
+        points[i] = (origin.offsetUly(offsets[i] * 1.0e-3)).toLy().cast<float>();
+
+    double tOffsetFromLy = timeLoop([&]
+    {
+        for (std::size_t i = 0; i < Count; ++i)
+            offsetsf[i] = -origin.offsetFromLy(points[i]);
+    });
+    double tOriginLy = timeLoop([&]
+    {
+        for (std::size_t i = 0; i < Count; ++i)
+            offsetsf[i] = fastOrigin.offsetLy(points[i].cast<double>()).cast<float>();
+    });
+
+    double sum = 0.0;
+    for (std::size_t i = 0; i < Count; ++i)
+        sum += offsets[i].x() + offsetsf[i].x();
+    CHECK(std::isfinite(sum));
+
+    MESSAGE(fmt::format("{} conversions, ms:\n"
+                        "  UniversalCoord::offsetFromKm    {:8.2f}\n"
+                        "  UniversalCoordOrigin::offsetKm  {:8.2f}\n"
+                        "  UniversalCoord::offsetFromLy    {:8.2f}\n"
+                        "  UniversalCoordOrigin::offsetLy  {:8.2f}",
+                        Count, tOffsetFromKm, tOriginKm, tOffsetFromLy, tOriginLy));
+}
+
+TEST_SUITE_END();